@@ -11,6 +11,10 @@ REM Testbed
 make -f "Makefile.testbed.windows.mak" all 
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
 
+REM Packer
+make -f "Makefile.packer.windows.mak" all 
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
 REM Tests
 make -f "Makefile.tests.windows.mak" all 
 IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
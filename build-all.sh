@@ -17,6 +17,13 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
+# Packer
+make -f "Makefile.packer.linux.mak" all
+if [ $? -ne 0 ]; then
+    echo "Error: $?"
+    exit 1
+fi
+
 # Tests
 make -f "Makefile.tests.linux.mak" all
 if [ $? -ne 0 ]; then
@@ -0,0 +1,373 @@
+#include "containers/aabb_tree.h"
+
+#include "core/asserts.h"
+#include "math/frustum.h"
+#include "memory/hmemory.h"
+
+// Deep enough for any balanced tree, they stay under 1.44 * log2(node count) levels.
+#define AABB_TREE_STACK_SIZE 256
+
+// Set on frustum query stack entries whose box is entirely inside, so nothing below needs testing.
+#define AABB_TREE_INSIDE_BIT 0x80000000
+
+HINLINE b8 is_leaf(const aabb_tree_node* node) {
+    return node->child_a == AABB_TREE_NULL;
+}
+
+HINLINE i32 max_height(i32 a, i32 b) {
+    return a > b ? a : b;
+}
+
+// Links nodes [first, end) into a free list, in order.
+static void chain_free_nodes(aabb_tree_node* nodes, u32 first, u32 end) {
+    for (u32 i = first; i < end; ++i) {
+        nodes[i].parent = i + 1 < end ? i + 1 : AABB_TREE_NULL;
+        nodes[i].height = -1;
+    }
+}
+
+static u32 allocate_node(aabb_tree* tree) {
+    if (tree->free_list == AABB_TREE_NULL) {
+        u32 new_capacity = tree->capacity ? tree->capacity * 2 : 16;
+        aabb_tree_node* nodes = Hallocate(sizeof(aabb_tree_node) * new_capacity, MEMORY_TAG_BST);
+        if (tree->nodes) {
+            HcopyMemory(nodes, tree->nodes, sizeof(aabb_tree_node) * tree->capacity);
+            Hfree(tree->nodes, sizeof(aabb_tree_node) * tree->capacity, MEMORY_TAG_BST);
+        }
+        chain_free_nodes(nodes, tree->capacity, new_capacity);
+        tree->free_list = tree->capacity;
+        tree->nodes = nodes;
+        tree->capacity = new_capacity;
+    }
+
+    u32 index = tree->free_list;
+    aabb_tree_node* node = &tree->nodes[index];
+    tree->free_list = node->parent;
+    node->parent = AABB_TREE_NULL;
+    node->child_a = AABB_TREE_NULL;
+    node->child_b = AABB_TREE_NULL;
+    node->height = 0;
+    node->user_data = 0;
+    tree->node_count++;
+    return index;
+}
+
+static void free_node(aabb_tree* tree, u32 index) {
+    tree->nodes[index].parent = tree->free_list;
+    tree->nodes[index].height = -1;
+    tree->free_list = index;
+    tree->node_count--;
+}
+
+// Recomputes the height and box of a node from its children.
+HINLINE void refit_node(aabb_tree_node* nodes, u32 index) {
+    aabb_tree_node* node = &nodes[index];
+    const aabb_tree_node* a = &nodes[node->child_a];
+    const aabb_tree_node* b = &nodes[node->child_b];
+    node->height = 1 + max_height(a->height, b->height);
+    node->bounds = aabb_union(a->bounds, b->bounds);
+}
+
+// Points the parent of old_child (or the root) at new_child.
+HINLINE void replace_child(aabb_tree* tree, u32 parent, u32 old_child, u32 new_child) {
+    if (parent == AABB_TREE_NULL) {
+        tree->root = new_child;
+    } else if (tree->nodes[parent].child_a == old_child) {
+        tree->nodes[parent].child_a = new_child;
+    } else {
+        tree->nodes[parent].child_b = new_child;
+    }
+}
+
+/*
+ * If one child of node is more than 1 level taller than the other, rotates it up to take
+ * node's place. Node then takes the taller child's shorter child, and the taller one stays.
+ * Returns the node now at node's place.
+ */
+static u32 balance(aabb_tree* tree, u32 index_a) {
+    aabb_tree_node* nodes = tree->nodes;
+    aabb_tree_node* a = &nodes[index_a];
+    if (is_leaf(a) || a->height < 2) {
+        return index_a;
+    }
+
+    i32 difference = nodes[a->child_b].height - nodes[a->child_a].height;
+    if (difference >= -1 && difference <= 1) {
+        return index_a;
+    }
+
+    // The taller child, and the side of a it comes from.
+    b8 b_taller = difference > 1;
+    u32 index_up = b_taller ? a->child_b : a->child_a;
+    aabb_tree_node* up = &nodes[index_up];
+    u32 index_tall = nodes[up->child_a].height > nodes[up->child_b].height ? up->child_a : up->child_b;
+    u32 index_short = index_tall == up->child_a ? up->child_b : up->child_a;
+
+    // up takes a's place, with a and its own taller child as children.
+    up->parent = a->parent;
+    replace_child(tree, a->parent, index_a, index_up);
+    up->child_a = index_a;
+    up->child_b = index_tall;
+    a->parent = index_up;
+
+    // a keeps its shorter child and takes up's shorter one in place of up.
+    if (b_taller) {
+        a->child_b = index_short;
+    } else {
+        a->child_a = index_short;
+    }
+    nodes[index_short].parent = index_a;
+
+    refit_node(nodes, index_a);
+    refit_node(nodes, index_up);
+    return index_up;
+}
+
+// Rebalances and refits every node from index up to the root.
+static void refit_upwards(aabb_tree* tree, u32 index) {
+    while (index != AABB_TREE_NULL) {
+        index = balance(tree, index);
+        refit_node(tree->nodes, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+static void insert_leaf(aabb_tree* tree, u32 leaf) {
+    if (tree->root == AABB_TREE_NULL) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    // Walks down to the sibling that costs the least surface area, the cost of pairing with a
+    // node being its grown area plus how much every node above it grows.
+    aabb_tree_node* nodes = tree->nodes;
+    aabb leaf_bounds = nodes[leaf].bounds;
+    u32 index = tree->root;
+    while (!is_leaf(&nodes[index])) {
+        const aabb_tree_node* node = &nodes[index];
+        f32 area = aabb_surface_area(node->bounds);
+        f32 combined_area = aabb_surface_area(aabb_union(node->bounds, leaf_bounds));
+
+        // Pairing with this node makes a new parent covering both.
+        f32 cost = 2.0f * combined_area;
+        // Going further down still grows this node.
+        f32 inherited_cost = 2.0f * (combined_area - area);
+
+        f32 child_costs[2];
+        u32 children[2] = {node->child_a, node->child_b};
+        for (u32 i = 0; i < 2; ++i) {
+            const aabb_tree_node* child = &nodes[children[i]];
+            f32 grown = aabb_surface_area(aabb_union(child->bounds, leaf_bounds));
+            child_costs[i] = (is_leaf(child) ? grown : grown - aabb_surface_area(child->bounds)) + inherited_cost;
+        }
+
+        if (cost < child_costs[0] && cost < child_costs[1]) {
+            break;
+        }
+        index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+    }
+
+    u32 sibling = index;
+    u32 old_parent = nodes[sibling].parent;
+    u32 new_parent = allocate_node(tree);
+    // The nodes may have moved to make room.
+    nodes = tree->nodes;
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].child_a = sibling;
+    nodes[new_parent].child_b = leaf;
+    replace_child(tree, old_parent, sibling, new_parent);
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    refit_upwards(tree, new_parent);
+}
+
+static void remove_leaf(aabb_tree* tree, u32 leaf) {
+    if (leaf == tree->root) {
+        tree->root = AABB_TREE_NULL;
+        return;
+    }
+
+    // The leaf's sibling takes the place of their parent.
+    aabb_tree_node* nodes = tree->nodes;
+    u32 parent = nodes[leaf].parent;
+    u32 grandparent = nodes[parent].parent;
+    u32 sibling = nodes[parent].child_a == leaf ? nodes[parent].child_b : nodes[parent].child_a;
+    replace_child(tree, grandparent, parent, sibling);
+    nodes[sibling].parent = grandparent;
+    free_node(tree, parent);
+
+    refit_upwards(tree, grandparent);
+}
+
+void aabb_tree_create(u32 initial_capacity, f32 margin, aabb_tree* out_tree) {
+    HzeroMemory(out_tree, sizeof(aabb_tree));
+    out_tree->root = AABB_TREE_NULL;
+    out_tree->free_list = AABB_TREE_NULL;
+    out_tree->margin = margin;
+    if (initial_capacity) {
+        out_tree->nodes = Hallocate(sizeof(aabb_tree_node) * initial_capacity, MEMORY_TAG_BST);
+        out_tree->capacity = initial_capacity;
+        chain_free_nodes(out_tree->nodes, 0, initial_capacity);
+        out_tree->free_list = 0;
+    }
+}
+
+void aabb_tree_destroy(aabb_tree* tree) {
+    if (tree->nodes) {
+        Hfree(tree->nodes, sizeof(aabb_tree_node) * tree->capacity, MEMORY_TAG_BST);
+    }
+    HzeroMemory(tree, sizeof(aabb_tree));
+    tree->root = AABB_TREE_NULL;
+    tree->free_list = AABB_TREE_NULL;
+}
+
+u32 aabb_tree_insert(aabb_tree* tree, aabb bounds, u64 user_data) {
+    u32 leaf = allocate_node(tree);
+    tree->nodes[leaf].bounds = aabb_expand(bounds, tree->margin);
+    tree->nodes[leaf].user_data = user_data;
+    insert_leaf(tree, leaf);
+    tree->leaf_count++;
+    return leaf;
+}
+
+void aabb_tree_remove(aabb_tree* tree, u32 proxy) {
+    HASSERT(proxy < tree->capacity && is_leaf(&tree->nodes[proxy]) && tree->nodes[proxy].height == 0);
+    remove_leaf(tree, proxy);
+    free_node(tree, proxy);
+    tree->leaf_count--;
+}
+
+b8 aabb_tree_move(aabb_tree* tree, u32 proxy, aabb bounds) {
+    HASSERT(proxy < tree->capacity && is_leaf(&tree->nodes[proxy]) && tree->nodes[proxy].height == 0);
+    if (aabb_contains(tree->nodes[proxy].bounds, bounds)) {
+        return false;
+    }
+    remove_leaf(tree, proxy);
+    tree->nodes[proxy].bounds = aabb_expand(bounds, tree->margin);
+    insert_leaf(tree, proxy);
+    return true;
+}
+
+u32 aabb_tree_query_aabb(const aabb_tree* tree, aabb bounds, u32* out_proxies, u32 max_results) {
+    if (tree->root == AABB_TREE_NULL) {
+        return 0;
+    }
+    const aabb_tree_node* nodes = tree->nodes;
+    u32 stack[AABB_TREE_STACK_SIZE];
+    u32 stack_count = 0;
+    u32 found = 0;
+    stack[stack_count++] = tree->root;
+    while (stack_count) {
+        u32 index = stack[--stack_count];
+        const aabb_tree_node* node = &nodes[index];
+        if (!aabb_overlaps(node->bounds, bounds)) {
+            continue;
+        }
+        if (is_leaf(node)) {
+            if (found < max_results) {
+                out_proxies[found] = index;
+            }
+            found++;
+        } else {
+            HASSERT(stack_count + 2 <= AABB_TREE_STACK_SIZE);
+            stack[stack_count++] = node->child_a;
+            stack[stack_count++] = node->child_b;
+        }
+    }
+    return found;
+}
+
+u32 aabb_tree_query_frustum(const aabb_tree* tree, const frustum* f, u32* out_proxies, u32 max_results) {
+    if (tree->root == AABB_TREE_NULL) {
+        return 0;
+    }
+    const aabb_tree_node* nodes = tree->nodes;
+    u32 stack[AABB_TREE_STACK_SIZE];
+    u32 stack_count = 0;
+    u32 found = 0;
+    stack[stack_count++] = tree->root;
+    while (stack_count) {
+        u32 entry = stack[--stack_count];
+        u32 index = entry & ~AABB_TREE_INSIDE_BIT;
+        const aabb_tree_node* node = &nodes[index];
+        b8 inside = (entry & AABB_TREE_INSIDE_BIT) != 0;
+        if (!inside && !frustum_classify_aabb(f, node->bounds, &inside)) {
+            continue;
+        }
+        if (is_leaf(node)) {
+            if (found < max_results) {
+                out_proxies[found] = index;
+            }
+            found++;
+        } else {
+            HASSERT(stack_count + 2 <= AABB_TREE_STACK_SIZE);
+            u32 inside_bit = inside ? AABB_TREE_INSIDE_BIT : 0;
+            stack[stack_count++] = node->child_a | inside_bit;
+            stack[stack_count++] = node->child_b | inside_bit;
+        }
+    }
+    return found;
+}
+
+u32 aabb_tree_raycast(const aabb_tree* tree, vec3 origin, vec3 direction, f32 max_distance, aabb_tree_ray_callback callback, void* context, f32* out_distance) {
+    u32 closest = AABB_TREE_NULL;
+    if (tree->root == AABB_TREE_NULL) {
+        return closest;
+    }
+    const aabb_tree_node* nodes = tree->nodes;
+    vec3 inverse_direction = vec3_create(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    f32 closest_distance = max_distance;
+    f32 distance;
+    if (!aabb_intersects_ray(nodes[tree->root].bounds, origin, inverse_direction, closest_distance, &distance)) {
+        return closest;
+    }
+
+    // Entries hold a node the ray reaches and the distance it does at, nearer children are popped first.
+    u32 stack[AABB_TREE_STACK_SIZE];
+    f32 stack_distances[AABB_TREE_STACK_SIZE];
+    u32 stack_count = 0;
+    stack[stack_count] = tree->root;
+    stack_distances[stack_count++] = distance;
+    while (stack_count) {
+        --stack_count;
+        // Boxes the ray reaches after the closest hit can't hold anything closer.
+        if (stack_distances[stack_count] > closest_distance) {
+            continue;
+        }
+        u32 index = stack[stack_count];
+        const aabb_tree_node* node = &nodes[index];
+        if (is_leaf(node)) {
+            f32 hit = callback ? callback(context, index, node->user_data) : stack_distances[stack_count];
+            if (hit >= 0.0f && hit <= closest_distance) {
+                closest_distance = hit;
+                closest = index;
+            }
+            continue;
+        }
+
+        f32 distance_a, distance_b;
+        b8 hit_a = aabb_intersects_ray(nodes[node->child_a].bounds, origin, inverse_direction, closest_distance, &distance_a);
+        b8 hit_b = aabb_intersects_ray(nodes[node->child_b].bounds, origin, inverse_direction, closest_distance, &distance_b);
+        HASSERT(stack_count + 2 <= AABB_TREE_STACK_SIZE);
+        if (hit_a && hit_b) {
+            b8 a_first = distance_a <= distance_b;
+            stack[stack_count] = a_first ? node->child_b : node->child_a;
+            stack_distances[stack_count++] = a_first ? distance_b : distance_a;
+            stack[stack_count] = a_first ? node->child_a : node->child_b;
+            stack_distances[stack_count++] = a_first ? distance_a : distance_b;
+        } else if (hit_a) {
+            stack[stack_count] = node->child_a;
+            stack_distances[stack_count++] = distance_a;
+        } else if (hit_b) {
+            stack[stack_count] = node->child_b;
+            stack_distances[stack_count++] = distance_b;
+        }
+    }
+
+    if (closest != AABB_TREE_NULL && out_distance) {
+        *out_distance = closest_distance;
+    }
+    return closest;
+}
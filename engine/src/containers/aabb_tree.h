@@ -0,0 +1,129 @@
+#pragma once
+
+#include "defines.h"
+#include "math/hmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Dynamic bounding volume tree for broadphase queries. Objects are leaves holding their box
+ * grown by a margin, so objects that move a little don't have to be reinserted. Inserting
+ * picks the sibling that grows the total surface area the least, and rotations keep the
+ * tree balanced, so queries visit O(log n) nodes plus the ones they find.
+ * Queries test the grown boxes, so they may report objects just outside of what was asked.
+ */
+
+// Marks a missing node, and the result of failed searches.
+#define AABB_TREE_NULL 0xFFFFFFFF
+
+typedef struct aabb_tree_node {
+    // Leaves: the object's box grown by the margin. Other nodes: the union of both children.
+    aabb bounds;
+    // Leaves: what was passed to aabb_tree_insert.
+    u64 user_data;
+    // The parent node, or the next free node for nodes not in use.
+    u32 parent;
+    // Both AABB_TREE_NULL for leaves.
+    u32 child_a;
+    u32 child_b;
+    // Leaves are 0, each level up adds 1. -1 for nodes not in use.
+    i32 height;
+} aabb_tree_node;
+
+typedef struct aabb_tree {
+    aabb_tree_node* nodes;
+    u32 capacity;
+    // Nodes in use, leaves and the rest.
+    u32 node_count;
+    u32 leaf_count;
+    u32 root;
+    u32 free_list;
+    f32 margin;
+} aabb_tree;
+
+/**
+ * Called for each object whose box a ray reaches, to test the object itself.
+ * @param context What was passed to aabb_tree_raycast.
+ * @param proxy The object.
+ * @param user_data What was passed when the object was inserted.
+ * @returns The distance along the ray where the object was hit, wich stops the search at it, or a negative number if it was missed.
+ */
+typedef f32 (*aabb_tree_ray_callback)(void* context, u32 proxy, u64 user_data);
+
+/**
+ * Creates an empty tree.
+ * @param initial_capacity The amount of nodes to make room for. Holding n objects takes 2n - 1 nodes. Grows as needed.
+ * @param margin How much to grow object boxes on each side. Larger margins reinsert less and query more.
+ * @param out_tree A pointer to the tree to be created.
+ */
+HAPI void aabb_tree_create(u32 initial_capacity, f32 margin, aabb_tree* out_tree);
+HAPI void aabb_tree_destroy(aabb_tree* tree);
+
+/**
+ * Adds an object.
+ * @param tree A pointer to the tree.
+ * @param bounds The object's box.
+ * @param user_data Anything to identify the object by, reported back by the queries.
+ * @returns The object's proxy, wich stays the same until it is removed.
+ */
+HAPI u32 aabb_tree_insert(aabb_tree* tree, aabb bounds, u64 user_data);
+
+// Removes an object, its proxy can be handed out again afterwards.
+HAPI void aabb_tree_remove(aabb_tree* tree, u32 proxy);
+
+/**
+ * Updates the box of an object. Boxes still within the grown one only cost the check,
+ * others reinsert the object.
+ * @param tree A pointer to the tree.
+ * @param proxy The object.
+ * @param bounds The object's new box.
+ * @returns True if the object had to be reinserted, otherwise false.
+ */
+HAPI b8 aabb_tree_move(aabb_tree* tree, u32 proxy, aabb bounds);
+
+/**
+ * Finds the objects whose box overlaps bounds.
+ * @param tree A pointer to the tree.
+ * @param bounds The box to search.
+ * @param out_proxies Receives up to max_results proxies, in no particular order.
+ * @param max_results The room in out_proxies.
+ * @returns The amount of objects found, wich may be more than max_results.
+ */
+HAPI u32 aabb_tree_query_aabb(const aabb_tree* tree, aabb bounds, u32* out_proxies, u32 max_results);
+
+// The same as aabb_tree_query_aabb for the objects that may be visible in a frustum.
+HAPI u32 aabb_tree_query_frustum(const aabb_tree* tree, const frustum* f, u32* out_proxies, u32 max_results);
+
+/**
+ * Finds the closest object along a ray. Boxes are searched front to back, and boxes past
+ * the closest hit so far are skipped.
+ * @param tree A pointer to the tree.
+ * @param origin Where the ray starts.
+ * @param direction The direction of the ray. Distances are in multiples of it.
+ * @param max_distance How far along the ray to look.
+ * @param callback Tests the objects themselves. Pass NULL to hit the (grown) boxes.
+ * @param context Passed along to callback.
+ * @param out_distance Receives the distance of the hit. May be NULL.
+ * @returns The proxy of the closest object hit, or AABB_TREE_NULL.
+ */
+HAPI u32 aabb_tree_raycast(const aabb_tree* tree, vec3 origin, vec3 direction, f32 max_distance, aabb_tree_ray_callback callback, void* context, f32* out_distance);
+
+HINLINE u64 aabb_tree_user_data(const aabb_tree* tree, u32 proxy) {
+    return tree->nodes[proxy].user_data;
+}
+
+// The grown box of an object.
+HINLINE aabb aabb_tree_bounds(const aabb_tree* tree, u32 proxy) {
+    return tree->nodes[proxy].bounds;
+}
+
+// The amount of levels below the root, 0 for a single object.
+HINLINE u32 aabb_tree_height(const aabb_tree* tree) {
+    return tree->root == AABB_TREE_NULL ? 0 : (u32)tree->nodes[tree->root].height;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,524 @@
+#include "containers/spatial_grid.h"
+
+#include "core/asserts.h"
+#include "math/frustum.h"
+#include "memory/hmemory.h"
+
+// Marks a hash table slot that never held a cell, as opposed to an empty cell.
+#define SPATIAL_GRID_UNUSED_CELL 0xFFFFFFFE
+// Frustum queries test blocks of this many cells along each axis before the cells in them.
+#define SPATIAL_GRID_BLOCK_SIZE 4
+
+// The cell holding a coordinate, rounding down so cells don't double up around 0.
+HINLINE i32 cell_coordinate(f32 value, f32 inverse_cell_size) {
+    f32 scaled = value * inverse_cell_size;
+    i32 truncated = (i32)scaled;
+    return truncated - (scaled < (f32)truncated);
+}
+
+// Neighbours along x land in neighbouring slots, so walking a range of cells reads the table in runs.
+HINLINE u32 cell_hash(i32 x, i32 y, i32 z) {
+    return (u32)x + (u32)y * 0xD8163841u + (u32)z * 0xCB1AB31Fu;
+}
+
+static void cell_range(const spatial_grid* grid, aabb bounds, i32* out_min, i32* out_max) {
+    out_min[0] = cell_coordinate(bounds.min.x, grid->inverse_cell_size);
+    out_min[1] = cell_coordinate(bounds.min.y, grid->inverse_cell_size);
+    out_min[2] = cell_coordinate(bounds.min.z, grid->inverse_cell_size);
+    out_max[0] = cell_coordinate(bounds.max.x, grid->inverse_cell_size);
+    out_max[1] = cell_coordinate(bounds.max.y, grid->inverse_cell_size);
+    out_max[2] = cell_coordinate(bounds.max.z, grid->inverse_cell_size);
+}
+
+// The box of the cells from min to max included.
+HINLINE aabb cells_bounds(const spatial_grid* grid, const i32* min, const i32* max) {
+    f32 size = grid->cell_size;
+    return aabb_create(vec3_create(min[0] * size, min[1] * size, min[2] * size),
+                       vec3_create((max[0] + 1) * size, (max[1] + 1) * size, (max[2] + 1) * size));
+}
+
+// Narrows a range of cells to the ones objects touched, false if nothing is left.
+static b8 clamp_to_occupied(const spatial_grid* grid, i32* min, i32* max) {
+    for (u32 axis = 0; axis < 3; ++axis) {
+        min[axis] = min[axis] > grid->min_cell[axis] ? min[axis] : grid->min_cell[axis];
+        max[axis] = max[axis] < grid->max_cell[axis] ? max[axis] : grid->max_cell[axis];
+        if (min[axis] > max[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void grow_occupied(spatial_grid* grid, const i32* min, const i32* max) {
+    b8 empty = grid->min_cell[0] > grid->max_cell[0];
+    for (u32 axis = 0; axis < 3; ++axis) {
+        grid->min_cell[axis] = empty || min[axis] < grid->min_cell[axis] ? min[axis] : grid->min_cell[axis];
+        grid->max_cell[axis] = empty || max[axis] > grid->max_cell[axis] ? max[axis] : grid->max_cell[axis];
+    }
+}
+
+HINLINE b8 range_contains(const i32* min, const i32* max, i32 x, i32 y, i32 z) {
+    return x >= min[0] && x <= max[0] && y >= min[1] && y <= max[1] && z >= min[2] && z <= max[2];
+}
+
+static void allocate_cells(spatial_grid* grid, u32 capacity) {
+    grid->cells = Hallocate(sizeof(spatial_grid_cell) * capacity, MEMORY_TAG_SCENE);
+    grid->cell_capacity = capacity;
+    grid->cell_count = 0;
+    for (u32 i = 0; i < capacity; ++i) {
+        grid->cells[i].first_entry = SPATIAL_GRID_UNUSED_CELL;
+    }
+}
+
+// Places a cell in the first free slot of its probe sequence. The cell must not be in the table.
+static u32 place_cell(spatial_grid* grid, i32 x, i32 y, i32 z) {
+    u32 mask = grid->cell_capacity - 1;
+    u32 slot = cell_hash(x, y, z) & mask;
+    while (grid->cells[slot].first_entry != SPATIAL_GRID_UNUSED_CELL) {
+        slot = (slot + 1) & mask;
+    }
+    spatial_grid_cell* cell = &grid->cells[slot];
+    cell->x = x;
+    cell->y = y;
+    cell->z = z;
+    cell->first_entry = SPATIAL_GRID_NULL;
+    grid->cell_count++;
+    return slot;
+}
+
+// Rebuilds the hash table without the empty cells, growing it if the rest fill over a quarter of it.
+static void rehash_cells(spatial_grid* grid) {
+    spatial_grid_cell* old_cells = grid->cells;
+    u32 old_capacity = grid->cell_capacity;
+    u32 occupied = 0;
+    for (u32 i = 0; i < old_capacity; ++i) {
+        u32 first = old_cells[i].first_entry;
+        occupied += first != SPATIAL_GRID_UNUSED_CELL && first != SPATIAL_GRID_NULL;
+    }
+
+    allocate_cells(grid, occupied * 4 > old_capacity ? old_capacity * 2 : old_capacity);
+    for (u32 i = 0; i < old_capacity; ++i) {
+        const spatial_grid_cell* cell = &old_cells[i];
+        if (cell->first_entry != SPATIAL_GRID_UNUSED_CELL && cell->first_entry != SPATIAL_GRID_NULL) {
+            u32 slot = place_cell(grid, cell->x, cell->y, cell->z);
+            grid->cells[slot].first_entry = cell->first_entry;
+        }
+    }
+    Hfree(old_cells, sizeof(spatial_grid_cell) * old_capacity, MEMORY_TAG_SCENE);
+}
+
+// Finds the slot of a cell, SPATIAL_GRID_NULL if it isn't in the table and create is false.
+static u32 find_cell(spatial_grid* grid, i32 x, i32 y, i32 z, b8 create) {
+    u32 mask = grid->cell_capacity - 1;
+    u32 slot = cell_hash(x, y, z) & mask;
+    while (true) {
+        const spatial_grid_cell* cell = &grid->cells[slot];
+        if (cell->first_entry == SPATIAL_GRID_UNUSED_CELL) {
+            break;
+        }
+        if (cell->x == x && cell->y == y && cell->z == z) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (!create) {
+        return SPATIAL_GRID_NULL;
+    }
+    // Keeps the table at most half full, so probe sequences stay short.
+    if ((grid->cell_count + 1) * 2 > grid->cell_capacity) {
+        rehash_cells(grid);
+    }
+    return place_cell(grid, x, y, z);
+}
+
+static u32 allocate_entry(spatial_grid* grid) {
+    if (grid->free_entry == SPATIAL_GRID_NULL) {
+        u32 new_capacity = grid->entry_capacity * 2;
+        spatial_grid_entry* entries = Hallocate(sizeof(spatial_grid_entry) * new_capacity, MEMORY_TAG_SCENE);
+        HcopyMemory(entries, grid->entries, sizeof(spatial_grid_entry) * grid->entry_capacity);
+        Hfree(grid->entries, sizeof(spatial_grid_entry) * grid->entry_capacity, MEMORY_TAG_SCENE);
+        for (u32 i = grid->entry_capacity; i < new_capacity; ++i) {
+            entries[i].next = i + 1 < new_capacity ? i + 1 : SPATIAL_GRID_NULL;
+        }
+        grid->free_entry = grid->entry_capacity;
+        grid->entries = entries;
+        grid->entry_capacity = new_capacity;
+    }
+    u32 entry = grid->free_entry;
+    grid->free_entry = grid->entries[entry].next;
+    return entry;
+}
+
+static void add_to_cell(spatial_grid* grid, i32 x, i32 y, i32 z, u32 object) {
+    u32 slot = find_cell(grid, x, y, z, true);
+    u32 entry = allocate_entry(grid);
+    grid->entries[entry].object = object;
+    grid->entries[entry].next = grid->cells[slot].first_entry;
+    grid->cells[slot].first_entry = entry;
+}
+
+static void remove_from_cell(spatial_grid* grid, i32 x, i32 y, i32 z, u32 object) {
+    u32 slot = find_cell(grid, x, y, z, false);
+    HASSERT(slot != SPATIAL_GRID_NULL);
+    u32* link = &grid->cells[slot].first_entry;
+    while (*link != SPATIAL_GRID_NULL) {
+        u32 entry = *link;
+        if (grid->entries[entry].object == object) {
+            *link = grid->entries[entry].next;
+            grid->entries[entry].next = grid->free_entry;
+            grid->free_entry = entry;
+            return;
+        }
+        link = &grid->entries[entry].next;
+    }
+}
+
+// Starts a query, objects with the returned stamp were already found by it.
+static u32 next_query_stamp(spatial_grid* grid) {
+    if (++grid->query_stamp == 0) {
+        // Wrapped around, so old stamps could match again.
+        for (u32 i = 0; i < grid->object_capacity; ++i) {
+            grid->objects[i].query_stamp = 0;
+        }
+        grid->query_stamp = 1;
+    }
+    return grid->query_stamp;
+}
+
+void spatial_grid_create(f32 cell_size, u32 initial_capacity, spatial_grid* out_grid) {
+    HzeroMemory(out_grid, sizeof(spatial_grid));
+    out_grid->cell_size = cell_size;
+    out_grid->inverse_cell_size = 1.0f / cell_size;
+    if (initial_capacity < 16) {
+        initial_capacity = 16;
+    }
+
+    out_grid->objects = Hallocate(sizeof(spatial_grid_object) * initial_capacity, MEMORY_TAG_SCENE);
+    out_grid->object_capacity = initial_capacity;
+    for (u32 i = 0; i < initial_capacity; ++i) {
+        out_grid->objects[i].next_free = i + 1 < initial_capacity ? i + 1 : SPATIAL_GRID_NULL;
+        out_grid->objects[i].query_stamp = 0;
+    }
+    out_grid->free_object = 0;
+
+    // Objects about the cell size touch up to 8 cells, most touch fewer.
+    out_grid->entry_capacity = initial_capacity * 4;
+    out_grid->entries = Hallocate(sizeof(spatial_grid_entry) * out_grid->entry_capacity, MEMORY_TAG_SCENE);
+    for (u32 i = 0; i < out_grid->entry_capacity; ++i) {
+        out_grid->entries[i].next = i + 1 < out_grid->entry_capacity ? i + 1 : SPATIAL_GRID_NULL;
+    }
+    out_grid->free_entry = 0;
+
+    u32 cell_capacity = 16;
+    while (cell_capacity < initial_capacity * 4) {
+        cell_capacity *= 2;
+    }
+    allocate_cells(out_grid, cell_capacity);
+    // Nothing occupied yet, so the range is empty.
+    for (u32 axis = 0; axis < 3; ++axis) {
+        out_grid->min_cell[axis] = 1;
+        out_grid->max_cell[axis] = 0;
+    }
+}
+
+void spatial_grid_destroy(spatial_grid* grid) {
+    if (grid->objects) {
+        Hfree(grid->objects, sizeof(spatial_grid_object) * grid->object_capacity, MEMORY_TAG_SCENE);
+        Hfree(grid->entries, sizeof(spatial_grid_entry) * grid->entry_capacity, MEMORY_TAG_SCENE);
+        Hfree(grid->cells, sizeof(spatial_grid_cell) * grid->cell_capacity, MEMORY_TAG_SCENE);
+    }
+    HzeroMemory(grid, sizeof(spatial_grid));
+}
+
+u32 spatial_grid_insert(spatial_grid* grid, aabb bounds, u64 user_data) {
+    if (grid->free_object == SPATIAL_GRID_NULL) {
+        u32 new_capacity = grid->object_capacity * 2;
+        spatial_grid_object* objects = Hallocate(sizeof(spatial_grid_object) * new_capacity, MEMORY_TAG_SCENE);
+        HcopyMemory(objects, grid->objects, sizeof(spatial_grid_object) * grid->object_capacity);
+        Hfree(grid->objects, sizeof(spatial_grid_object) * grid->object_capacity, MEMORY_TAG_SCENE);
+        for (u32 i = grid->object_capacity; i < new_capacity; ++i) {
+            objects[i].next_free = i + 1 < new_capacity ? i + 1 : SPATIAL_GRID_NULL;
+            objects[i].query_stamp = 0;
+        }
+        grid->free_object = grid->object_capacity;
+        grid->objects = objects;
+        grid->object_capacity = new_capacity;
+    }
+
+    u32 index = grid->free_object;
+    spatial_grid_object* object = &grid->objects[index];
+    grid->free_object = object->next_free;
+    object->next_free = SPATIAL_GRID_NULL;
+    object->bounds = bounds;
+    object->user_data = user_data;
+    cell_range(grid, bounds, object->min_cell, object->max_cell);
+    grow_occupied(grid, object->min_cell, object->max_cell);
+    grid->object_count++;
+
+    for (i32 z = object->min_cell[2]; z <= object->max_cell[2]; ++z) {
+        for (i32 y = object->min_cell[1]; y <= object->max_cell[1]; ++y) {
+            for (i32 x = object->min_cell[0]; x <= object->max_cell[0]; ++x) {
+                add_to_cell(grid, x, y, z, index);
+            }
+        }
+    }
+    return index;
+}
+
+void spatial_grid_remove(spatial_grid* grid, u32 object) {
+    HASSERT(object < grid->object_capacity && grid->objects[object].next_free == SPATIAL_GRID_NULL);
+    spatial_grid_object* removed = &grid->objects[object];
+    for (i32 z = removed->min_cell[2]; z <= removed->max_cell[2]; ++z) {
+        for (i32 y = removed->min_cell[1]; y <= removed->max_cell[1]; ++y) {
+            for (i32 x = removed->min_cell[0]; x <= removed->max_cell[0]; ++x) {
+                remove_from_cell(grid, x, y, z, object);
+            }
+        }
+    }
+    removed->next_free = grid->free_object;
+    grid->free_object = object;
+    grid->object_count--;
+}
+
+void spatial_grid_move(spatial_grid* grid, u32 object, aabb bounds) {
+    HASSERT(object < grid->object_capacity && grid->objects[object].next_free == SPATIAL_GRID_NULL);
+    spatial_grid_object* moved = &grid->objects[object];
+    moved->bounds = bounds;
+    i32 old_min[3] = {moved->min_cell[0], moved->min_cell[1], moved->min_cell[2]};
+    i32 old_max[3] = {moved->max_cell[0], moved->max_cell[1], moved->max_cell[2]};
+    i32 min[3], max[3];
+    cell_range(grid, bounds, min, max);
+    if (min[0] == old_min[0] && min[1] == old_min[1] && min[2] == old_min[2] &&
+        max[0] == old_max[0] && max[1] == old_max[1] && max[2] == old_max[2]) {
+        return;
+    }
+
+    // Only the cells that are in one range and not the other change.
+    for (i32 z = old_min[2]; z <= old_max[2]; ++z) {
+        for (i32 y = old_min[1]; y <= old_max[1]; ++y) {
+            for (i32 x = old_min[0]; x <= old_max[0]; ++x) {
+                if (!range_contains(min, max, x, y, z)) {
+                    remove_from_cell(grid, x, y, z, object);
+                }
+            }
+        }
+    }
+    for (i32 z = min[2]; z <= max[2]; ++z) {
+        for (i32 y = min[1]; y <= max[1]; ++y) {
+            for (i32 x = min[0]; x <= max[0]; ++x) {
+                if (!range_contains(old_min, old_max, x, y, z)) {
+                    add_to_cell(grid, x, y, z, object);
+                }
+            }
+        }
+    }
+    HcopyMemory(moved->min_cell, min, sizeof(min));
+    HcopyMemory(moved->max_cell, max, sizeof(max));
+    grow_occupied(grid, min, max);
+}
+
+// Reports the objects in a cell's list that overlap bounds and weren't found yet.
+HINLINE u32 query_cell(spatial_grid* grid, u32 first_entry, aabb bounds, u32 stamp, u32* out_objects, u32 max_results, u32 found) {
+    for (u32 entry = first_entry; entry != SPATIAL_GRID_NULL; entry = grid->entries[entry].next) {
+        u32 index = grid->entries[entry].object;
+        spatial_grid_object* object = &grid->objects[index];
+        if (object->query_stamp == stamp) {
+            continue;
+        }
+        object->query_stamp = stamp;
+        if (aabb_overlaps(object->bounds, bounds)) {
+            if (found < max_results) {
+                out_objects[found] = index;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+u32 spatial_grid_query_aabb(spatial_grid* grid, aabb bounds, u32* out_objects, u32 max_results) {
+    u32 stamp = next_query_stamp(grid);
+    i32 min[3], max[3];
+    cell_range(grid, bounds, min, max);
+    u32 found = 0;
+    if (!clamp_to_occupied(grid, min, max)) {
+        return 0;
+    }
+
+    // Large boxes would look up more cells than there are, those go through the occupied ones instead.
+    u64 range_cells = (u64)(max[0] - min[0] + 1) * (u64)(max[1] - min[1] + 1) * (u64)(max[2] - min[2] + 1);
+    if (range_cells > grid->cell_count) {
+        for (u32 i = 0; i < grid->cell_capacity; ++i) {
+            const spatial_grid_cell* cell = &grid->cells[i];
+            if (cell->first_entry != SPATIAL_GRID_UNUSED_CELL && range_contains(min, max, cell->x, cell->y, cell->z)) {
+                found = query_cell(grid, cell->first_entry, bounds, stamp, out_objects, max_results, found);
+            }
+        }
+        return found;
+    }
+
+    for (i32 z = min[2]; z <= max[2]; ++z) {
+        for (i32 y = min[1]; y <= max[1]; ++y) {
+            for (i32 x = min[0]; x <= max[0]; ++x) {
+                u32 slot = find_cell(grid, x, y, z, false);
+                if (slot != SPATIAL_GRID_NULL) {
+                    found = query_cell(grid, grid->cells[slot].first_entry, bounds, stamp, out_objects, max_results, found);
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// Reports the objects in a cell's list that may be visible and weren't found yet. Those in a cell entirely inside need no test.
+HINLINE u32 query_cell_frustum(spatial_grid* grid, u32 first_entry, const frustum* f, b8 inside, u32 stamp, u32* out_objects, u32 max_results, u32 found) {
+    for (u32 entry = first_entry; entry != SPATIAL_GRID_NULL; entry = grid->entries[entry].next) {
+        u32 index = grid->entries[entry].object;
+        spatial_grid_object* object = &grid->objects[index];
+        if (object->query_stamp == stamp) {
+            continue;
+        }
+        object->query_stamp = stamp;
+        if (inside || frustum_intersects_aabb(f, object->bounds)) {
+            if (found < max_results) {
+                out_objects[found] = index;
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+u32 spatial_grid_query_frustum(spatial_grid* grid, const frustum* f, u32* out_objects, u32 max_results) {
+    u32 stamp = next_query_stamp(grid);
+    i32 min[3], max[3];
+    cell_range(grid, frustum_bounds(f), min, max);
+    u32 found = 0;
+    if (!clamp_to_occupied(grid, min, max)) {
+        return 0;
+    }
+
+    // The same fallback as spatial_grid_query_aabb, testing the occupied cells one by one.
+    u64 range_cells = (u64)(max[0] - min[0] + 1) * (u64)(max[1] - min[1] + 1) * (u64)(max[2] - min[2] + 1);
+    if (range_cells > grid->cell_count) {
+        for (u32 i = 0; i < grid->cell_capacity; ++i) {
+            const spatial_grid_cell* cell = &grid->cells[i];
+            if (cell->first_entry == SPATIAL_GRID_UNUSED_CELL || cell->first_entry == SPATIAL_GRID_NULL) {
+                continue;
+            }
+            i32 coordinates[3] = {cell->x, cell->y, cell->z};
+            b8 inside;
+            if (range_contains(min, max, cell->x, cell->y, cell->z) && frustum_classify_aabb(f, cells_bounds(grid, coordinates, coordinates), &inside)) {
+                found = query_cell_frustum(grid, cell->first_entry, f, inside, stamp, out_objects, max_results, found);
+            }
+        }
+        return found;
+    }
+
+    // Blocks entirely outside skip their cells at once, and those entirely inside skip testing them.
+    i32 block_min[3];
+    for (block_min[2] = min[2]; block_min[2] <= max[2]; block_min[2] += SPATIAL_GRID_BLOCK_SIZE) {
+        for (block_min[1] = min[1]; block_min[1] <= max[1]; block_min[1] += SPATIAL_GRID_BLOCK_SIZE) {
+            for (block_min[0] = min[0]; block_min[0] <= max[0]; block_min[0] += SPATIAL_GRID_BLOCK_SIZE) {
+                i32 block_max[3];
+                for (u32 axis = 0; axis < 3; ++axis) {
+                    i32 last = block_min[axis] + SPATIAL_GRID_BLOCK_SIZE - 1;
+                    block_max[axis] = last < max[axis] ? last : max[axis];
+                }
+                b8 block_inside;
+                if (!frustum_classify_aabb(f, cells_bounds(grid, block_min, block_max), &block_inside)) {
+                    continue;
+                }
+
+                i32 cell[3];
+                for (cell[2] = block_min[2]; cell[2] <= block_max[2]; ++cell[2]) {
+                    for (cell[1] = block_min[1]; cell[1] <= block_max[1]; ++cell[1]) {
+                        for (cell[0] = block_min[0]; cell[0] <= block_max[0]; ++cell[0]) {
+                            u32 slot = find_cell(grid, cell[0], cell[1], cell[2], false);
+                            if (slot == SPATIAL_GRID_NULL || grid->cells[slot].first_entry == SPATIAL_GRID_NULL) {
+                                continue;
+                            }
+                            b8 inside = block_inside;
+                            if (inside || frustum_classify_aabb(f, cells_bounds(grid, cell, cell), &inside)) {
+                                found = query_cell_frustum(grid, grid->cells[slot].first_entry, f, inside, stamp, out_objects, max_results, found);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return found;
+}
+
+u32 spatial_grid_raycast(spatial_grid* grid, vec3 origin, vec3 direction, f32 max_distance, spatial_grid_ray_callback callback, void* context, f32* out_distance) {
+    u32 stamp = next_query_stamp(grid);
+    vec3 inverse_direction = vec3_create(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    f32 size = grid->cell_size;
+
+    // Walks the cells the ray crosses (Amanatides & Woo). next is the distance to the next cell
+    // boundary on each axis, and step how far apart those boundaries are.
+    i32 cell[3];
+    i32 cell_step[3];
+    f32 next[3];
+    f32 step[3];
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 start = origin.elements[axis];
+        f32 inverse = inverse_direction.elements[axis];
+        cell[axis] = cell_coordinate(start, grid->inverse_cell_size);
+        if (direction.elements[axis] > 0.0f) {
+            cell_step[axis] = 1;
+            next[axis] = ((cell[axis] + 1) * size - start) * inverse;
+            step[axis] = size * inverse;
+        } else if (direction.elements[axis] < 0.0f) {
+            cell_step[axis] = -1;
+            next[axis] = (cell[axis] * size - start) * inverse;
+            step[axis] = -size * inverse;
+        } else {
+            cell_step[axis] = 0;
+            next[axis] = H_INFINITY;
+            step[axis] = 0.0f;
+        }
+    }
+
+    u32 closest = SPATIAL_GRID_NULL;
+    f32 closest_distance = max_distance;
+    while (true) {
+        u32 slot = find_cell(grid, cell[0], cell[1], cell[2], false);
+        u32 first_entry = slot != SPATIAL_GRID_NULL ? grid->cells[slot].first_entry : SPATIAL_GRID_NULL;
+        for (u32 entry = first_entry; entry != SPATIAL_GRID_NULL; entry = grid->entries[entry].next) {
+            u32 index = grid->entries[entry].object;
+            spatial_grid_object* object = &grid->objects[index];
+            if (object->query_stamp == stamp) {
+                continue;
+            }
+            object->query_stamp = stamp;
+            f32 distance;
+            if (!aabb_intersects_ray(object->bounds, origin, inverse_direction, closest_distance, &distance)) {
+                continue;
+            }
+            f32 hit = callback ? callback(context, index, object->user_data) : distance;
+            if (hit >= 0.0f && hit <= closest_distance) {
+                closest_distance = hit;
+                closest = index;
+            }
+        }
+
+        // Objects the ray first reaches in later cells are further away than a hit in this one.
+        u32 axis = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+        if (closest_distance <= next[axis] || next[axis] > max_distance) {
+            break;
+        }
+        cell[axis] += cell_step[axis];
+        next[axis] += step[axis];
+        // Past the occupied cells, there is nothing further along to hit.
+        if ((cell_step[axis] > 0 && cell[axis] > grid->max_cell[axis]) || (cell_step[axis] < 0 && cell[axis] < grid->min_cell[axis])) {
+            break;
+        }
+    }
+
+    if (closest != SPATIAL_GRID_NULL && out_distance) {
+        *out_distance = closest_distance;
+    }
+    return closest;
+}
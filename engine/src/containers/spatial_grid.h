@@ -0,0 +1,150 @@
+#pragma once
+
+#include "defines.h"
+#include "math/hmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Uniform grid of cubic cells for broadphase queries, hashed so only occupied cells take
+ * memory and the world has no bounds. Each object is listed in every cell its box touches,
+ * so cells should be about the size of typical objects: much larger and cells hold many
+ * objects, much smaller and objects span many cells. Best for lots of similarly sized,
+ * moving objects, where aabb_tree suits mixed sizes better.
+ * Queries test the objects' exact boxes, and use a counter in the grid to report each
+ * object once, so they change the grid and must not run at the same time.
+ */
+
+// Marks a missing object or entry, and the result of failed searches.
+#define SPATIAL_GRID_NULL 0xFFFFFFFF
+
+typedef struct spatial_grid_object {
+    aabb bounds;
+    u64 user_data;
+    // The cells covered, from min_cell to max_cell included.
+    i32 min_cell[3];
+    i32 max_cell[3];
+    // The last query that found the object.
+    u32 query_stamp;
+    // The next free object, or SPATIAL_GRID_NULL while in use.
+    u32 next_free;
+} spatial_grid_object;
+
+// One object in a cell's list.
+typedef struct spatial_grid_entry {
+    u32 object;
+    u32 next;
+} spatial_grid_entry;
+
+typedef struct spatial_grid_cell {
+    i32 x, y, z;
+    // The first entry of the list, SPATIAL_GRID_NULL for an empty cell.
+    u32 first_entry;
+} spatial_grid_cell;
+
+typedef struct spatial_grid {
+    f32 cell_size;
+    f32 inverse_cell_size;
+
+    spatial_grid_object* objects;
+    u32 object_capacity;
+    u32 object_count;
+    u32 free_object;
+
+    spatial_grid_entry* entries;
+    u32 entry_capacity;
+    u32 free_entry;
+
+    // Open addressing hash table, cells stay once used until it grows.
+    spatial_grid_cell* cells;
+    u32 cell_capacity;
+    u32 cell_count;
+    // The range of cells objects ever touched, queries don't look outside it.
+    i32 min_cell[3];
+    i32 max_cell[3];
+
+    u32 query_stamp;
+} spatial_grid;
+
+/**
+ * Called for each object a ray reaches the box of, to test the object itself.
+ * @param context What was passed to spatial_grid_raycast.
+ * @param object The object.
+ * @param user_data What was passed when the object was inserted.
+ * @returns The distance along the ray where the object was hit, or a negative number if it was missed.
+ */
+typedef f32 (*spatial_grid_ray_callback)(void* context, u32 object, u64 user_data);
+
+/**
+ * Creates an empty grid.
+ * @param cell_size The edge length of the cells.
+ * @param initial_capacity The amount of objects to make room for. Grows as needed.
+ * @param out_grid A pointer to the grid to be created.
+ */
+HAPI void spatial_grid_create(f32 cell_size, u32 initial_capacity, spatial_grid* out_grid);
+HAPI void spatial_grid_destroy(spatial_grid* grid);
+
+/**
+ * Adds an object.
+ * @param grid A pointer to the grid.
+ * @param bounds The object's box.
+ * @param user_data Anything to identify the object by, reported back by the queries.
+ * @returns The object's index, wich stays the same until it is removed.
+ */
+HAPI u32 spatial_grid_insert(spatial_grid* grid, aabb bounds, u64 user_data);
+
+// Removes an object, its index can be handed out again afterwards.
+HAPI void spatial_grid_remove(spatial_grid* grid, u32 object);
+
+/**
+ * Updates the box of an object. Only the cells it enters or leaves are touched.
+ * @param grid A pointer to the grid.
+ * @param object The object.
+ * @param bounds The object's new box.
+ */
+HAPI void spatial_grid_move(spatial_grid* grid, u32 object, aabb bounds);
+
+/**
+ * Finds the objects whose box overlaps bounds.
+ * @param grid A pointer to the grid.
+ * @param bounds The box to search.
+ * @param out_objects Receives up to max_results objects, in no particular order.
+ * @param max_results The room in out_objects.
+ * @returns The amount of objects found, wich may be more than max_results.
+ */
+HAPI u32 spatial_grid_query_aabb(spatial_grid* grid, aabb bounds, u32* out_objects, u32 max_results);
+
+/**
+ * The same as spatial_grid_query_aabb for the objects that may be visible in a frustum. Cells are
+ * culled in blocks, so it may leave out boxes just outside a corner wich frustum_intersects_aabb keeps.
+ * Every cell of the view still has to be looked up, so long views over sparse grids are better
+ * served by aabb_tree_query_frustum or frustum_cull_aabbs.
+ */
+HAPI u32 spatial_grid_query_frustum(spatial_grid* grid, const frustum* f, u32* out_objects, u32 max_results);
+
+/**
+ * Finds the closest object along a ray, walking the cells it crosses in order.
+ * @param grid A pointer to the grid.
+ * @param origin Where the ray starts.
+ * @param direction The direction of the ray. Distances are in multiples of it.
+ * @param max_distance How far along the ray to look. Every cell up to it may be visited, occupied or not.
+ * @param callback Tests the objects themselves. Pass NULL to hit their boxes.
+ * @param context Passed along to callback.
+ * @param out_distance Receives the distance of the hit. May be NULL.
+ * @returns The closest object hit, or SPATIAL_GRID_NULL.
+ */
+HAPI u32 spatial_grid_raycast(spatial_grid* grid, vec3 origin, vec3 direction, f32 max_distance, spatial_grid_ray_callback callback, void* context, f32* out_distance);
+
+HINLINE u64 spatial_grid_user_data(const spatial_grid* grid, u32 object) {
+    return grid->objects[object].user_data;
+}
+
+HINLINE aabb spatial_grid_bounds(const spatial_grid* grid, u32 object) {
+    return grid->objects[object].bounds;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,13 +4,19 @@
 #include "core/logger.h"
 
 #include "platform/platform.h"
+#include "platform/filesystem.h"
+#include "platform/vfs.h"
 #include "memory/hmemory.h"
 #include "core/events.h"
 #include "core/input.h"
 #include "core/hclock.h"
+#include "core/job_system.h"
 
 #include "memory/linear_allocator.h"
 
+// Archive produced by the packer at build time. Its entries take precedence over loose asset files.
+#define ASSET_ARCHIVE_PATH "assets.hpak"
+
 #include "renderer/frontend.h"
 
 typedef struct appState {
@@ -36,6 +42,15 @@ typedef struct appState {
     u64 input_system_memory_requirement;
     void* input_system_state;
 
+    u64 vfs_memory_requirement;
+    void* vfs_state;
+
+    u64 job_system_memory_requirement;
+    void* job_system_state;
+
+    u64 filesystem_async_memory_requirement;
+    void* filesystem_async_state;
+
     u64 platform_system_memory_requirement;
     void* platform_system_state;
 
@@ -85,12 +100,40 @@ b8 appCreate(game* gameInstance) {
         HERROR("Failed to initialize logging system, shutting down...");
         return false;
     }
+
+    // Buffered files, the log included, are written out if the process crashes.
+    platformSetCrashHandler(filesystem_writer_flush_all);
     
     // Input subsystem
     inputInit(&app->input_system_memory_requirement, NULL);
     app->input_system_state = allocate_linear_allocator(&app->systems_allocator, app->input_system_memory_requirement);
     inputInit(&app->input_system_memory_requirement, app->input_system_state);
 
+    // Virtual file system
+    vfs_initialize(&app->vfs_memory_requirement, NULL);
+    app->vfs_state = allocate_linear_allocator(&app->systems_allocator, app->vfs_memory_requirement);
+    vfs_initialize(&app->vfs_memory_requirement, app->vfs_state);
+
+    // Job subsystem
+    job_system_initialize(&app->job_system_memory_requirement, NULL, 0);
+    app->job_system_state = allocate_linear_allocator(&app->systems_allocator, app->job_system_memory_requirement);
+    if (!job_system_initialize(&app->job_system_memory_requirement, app->job_system_state, 0)) {
+        HERROR("Failed to initialize job system, shutting down...");
+        return false;
+    }
+
+    // Asynchronous file read subsystem
+    filesystem_async_initialize(&app->filesystem_async_memory_requirement, NULL, false);
+    app->filesystem_async_state = allocate_linear_allocator(&app->systems_allocator, app->filesystem_async_memory_requirement);
+    if (!filesystem_async_initialize(&app->filesystem_async_memory_requirement, app->filesystem_async_state, false)) {
+        HERROR("Failed to initialize asynchronous file read system, shutting down...");
+        return false;
+    }
+
+    if (filesystem_exists(ASSET_ARCHIVE_PATH) && !vfs_mount_archive("", ASSET_ARCHIVE_PATH)) {
+        HWARNING("Failed to mount '%s', loading loose asset files instead.", ASSET_ARCHIVE_PATH);
+    }
+
     // Register for engine-level events
     eventRegister(EVENT_CODE_APPLICATION_QUIT, NULL, appOnEvent);
     eventRegister(EVENT_CODE_KEY_PRESSED, NULL, appOnKey);
@@ -114,7 +157,8 @@ b8 appCreate(game* gameInstance) {
 
     // Renderer subsystem
     initRenderer(&app->renderer_system_memory_requirement, NULL, NULL);
-    app->renderer_system_state = allocate_linear_allocator(&app->systems_allocator, app->renderer_system_memory_requirement);
+    // The renderer state holds matrices, wich are 16 byte aligned.
+    app->renderer_system_state = allocate_linear_allocator_aligned(&app->systems_allocator, app->renderer_system_memory_requirement, 16);
     if (!initRenderer(&app->renderer_system_memory_requirement, app->renderer_system_state, gameInstance->config.name)) {
         HFATAL("Failed to initialize renderer. Aborting application.");
         return false;
@@ -142,7 +186,11 @@ b8 appRun() {
     f64 frame_count = 0;
     f64 target_framerate = 1.0f / 60;
 
-    HINFO(GetMemoryUsage_str());
+    stringBuilder usage;
+    string_builder_create(1024, NULL, &usage);
+    GetMemoryUsage_str(&usage);
+    HINFO("%s", usage.data);
+    string_builder_destroy(&usage);
 
     while (app->isRunning) {
         if (!platformPumpMessages()) {
@@ -155,6 +203,9 @@ b8 appRun() {
             f64 delta = (curTime - app->lastTime);
             f64 frame_start_time = platformGetAbsoluteTime();
 
+            // Hand finished file reads to their owners before the game updates.
+            filesystem_async_update();
+
             if(!app->gameInstance->update(app->gameInstance, (f32)delta)) {
                 HFATAL("Game update failed, shutting down...");
                 app->isRunning = false;
@@ -208,12 +259,20 @@ b8 appRun() {
     eventUnregister(EVENT_CODE_KEY_RELEASED, 0, appOnKey);
     eventUnregister(EVENT_CODE_RESIZED, 0, appOnResized);
 
+    filesystem_async_shutdown(app->filesystem_async_state);
+
+    job_system_shutdown(app->job_system_state);
+
     inputShutdown(app->input_system_state);
 
     shutdownRenderer(app->renderer_system_state);
 
+    vfs_shutdown(app->vfs_state);
+
     platformShutdown(app->platform_system_state);
 
+    shutdownLog(app->logging_system_state);
+
     shutdownMemory(app->memory_system_state);
 
     eventShutdown(app->event_system_state);
@@ -256,7 +315,7 @@ b8 appOnKey(u16 code, void* sender, void* listenerInstance, eventContext context
             // Example on checking for a key
             HDEBUG("Explicit key A was pressed");
         }*/
-        HDEBUG("Key %c was pressed", keyCode);
+        HDEBUG_FAST("Key %c was pressed", keyCode);
     }
     else if(code == EVENT_CODE_KEY_RELEASED) {
         u16 keyCode = context.data.u16[0];
@@ -265,7 +324,7 @@ b8 appOnKey(u16 code, void* sender, void* listenerInstance, eventContext context
             // Example on checking for a key
             HDEBUG("Explicit key A was released");
         }*/
-        HDEBUG("Key %c was released", keyCode);
+        HDEBUG_FAST("Key %c was released", keyCode);
     }
     return false;
 }
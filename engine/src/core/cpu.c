@@ -0,0 +1,59 @@
+#include "core/cpu.h"
+
+#if HARCH_X64
+#include <cpuid.h>
+#endif
+
+// Set once detection ran, so 0 features can be told apart from not detected yet.
+#define CPU_FEATURES_DETECTED 0x80000000
+
+static u32 detected_features;
+static u32 feature_mask = 0xFFFFFFFF;
+
+#if HARCH_X64
+static u32 cpu_detect() {
+    u32 features = 0;
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+
+    if (edx & (1 << 26)) features |= CPU_FEATURE_SSE2;
+    if (ecx & (1 << 19)) features |= CPU_FEATURE_SSE41;
+
+    // AVX state has to be enabled by the OS as well, or the registers aren't saved across context switches.
+    b8 os_saves_avx = false;
+    if ((ecx & (1 << 27)) && (ecx & (1 << 28))) {
+        u32 xcr0_low, xcr0_high;
+        __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+        os_saves_avx = (xcr0_low & 0x6) == 0x6;
+    }
+    if (os_saves_avx) {
+        features |= CPU_FEATURE_AVX;
+        if (ecx & (1 << 12)) features |= CPU_FEATURE_FMA;
+        if (ecx & (1 << 29)) features |= CPU_FEATURE_F16C;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 5))) {
+            features |= CPU_FEATURE_AVX2;
+        }
+    }
+    return features;
+}
+#else
+static u32 cpu_detect() {
+    return 0;
+}
+#endif
+
+u32 cpu_get_features() {
+    u32 features = __atomic_load_n(&detected_features, __ATOMIC_RELAXED);
+    if (!features) {
+        // Every thread detects the same thing, racing here is harmless.
+        features = cpu_detect() | CPU_FEATURES_DETECTED;
+        __atomic_store_n(&detected_features, features, __ATOMIC_RELAXED);
+    }
+    return features & __atomic_load_n(&feature_mask, __ATOMIC_RELAXED) & ~CPU_FEATURES_DETECTED;
+}
+
+void cpu_set_feature_mask(u32 mask) {
+    __atomic_store_n(&feature_mask, mask, __ATOMIC_RELAXED);
+}
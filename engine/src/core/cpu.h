@@ -0,0 +1,46 @@
+#pragma once
+
+#include "defines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The engine is 64 bit only, so x86 always comes with SSE2.
+#if defined(__x86_64__) || defined(_M_X64)
+#define HARCH_X64 1
+#endif
+
+#if HARCH_X64
+// Compiles a function for AVX2 without requiring it from the whole build. Only call it after checking CPU_FEATURE_AVX2.
+#define HTARGET_AVX2 __attribute__((target("avx2")))
+// The same for the half precision conversions. Only call it after checking CPU_FEATURE_F16C.
+#define HTARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+typedef enum cpuFeatures {
+    CPU_FEATURE_SSE2 = 0x1,
+    CPU_FEATURE_SSE41 = 0x2,
+    CPU_FEATURE_AVX = 0x4,
+    CPU_FEATURE_AVX2 = 0x8,
+    CPU_FEATURE_FMA = 0x10,
+    CPU_FEATURE_F16C = 0x20
+} cpuFeatures;
+
+/**
+ * Obtains the instruction set extensions the processor and OS support, detected once.
+ * Code with vectorized paths picks one at runtime from these, the build only assumes the
+ * baseline of the architecture (SSE2 on x86-64).
+ * @returns A combination of cpuFeatures flags.
+ */
+HAPI u32 cpu_get_features();
+
+/**
+ * Hides features from cpu_get_features, e.g. to exercise and benchmark fallback paths.
+ * @param mask The features allowed to be reported. Pass 0xFFFFFFFF to report everything again.
+ */
+HAPI void cpu_set_feature_mask(u32 mask);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,10 +2,27 @@
 
 #include "memory/hmemory.h"
 #include "containers/darray.h"
+#include "platform/platform.h"
+#include "utils/hstring.h"
+
+typedef struct eventProfile {
+    // Number of times the event was dispatched.
+    u64 fire_count;
+    // Number of dispatches wich were handled.
+    u64 handled_count;
+    // Number of dispatches wich nobody handled.
+    u64 unhandled_count;
+    // Cumulative time spent in handlers, in seconds.
+    f64 total_time;
+} eventProfile;
 
 typedef struct registeredEvent {
     void* listener;
     PFNC_onEvent callback;
+#ifdef HEVENT_PROFILING_ENABLED
+    // Per listener stats. fire_count is the amount of times the callback was invoked.
+    eventProfile profile;
+#endif
 } registeredEvent;
 
 typedef struct eventCodeEntry {
@@ -19,6 +36,10 @@ typedef struct eventCodeEntry {
 typedef struct eventSystemState {
     // Lookup table for event codes.
     eventCodeEntry* registered[MAX_MESSAGE_CODES];
+#ifdef HEVENT_PROFILING_ENABLED
+    // Per code stats, also tracks codes fired without listeners.
+    eventProfile profiles[MAX_MESSAGE_CODES];
+#endif
 } eventSystemState;
 
 // *Event system internal state pointer*
@@ -29,7 +50,7 @@ void eventInit(u64* memory_requirement, void* state) {
     if (state == NULL) {
         return;
     }
-    HzeroMemory(state, sizeof(state));
+    HzeroMemory(state, sizeof(eventSystemState));
     state_ptr = state;
 }
 
@@ -76,6 +97,7 @@ b8 eventRegister(u16 code, void* listener, PFNC_onEvent onEvent) {
 
     // If at this point no duplicate was found. Proceed with registration.
     registeredEvent event;
+    HzeroMemory(&event, sizeof(registeredEvent));
     event.listener = listener;
     event.callback = onEvent;
     darray_push(state_ptr->registered[code]->events, event);
@@ -114,19 +136,107 @@ b8 eventFire(u16 code, void* sender, eventContext context) {
         return false;
     }
 
+#ifdef HEVENT_PROFILING_ENABLED
+    eventProfile* code_profile = &state_ptr->profiles[code];
+    code_profile->fire_count++;
+#endif
+
     // If nothing is registered for this event code, boot out
     if (!state_ptr->registered[code] || !state_ptr->registered[code]->events) {
+#ifdef HEVENT_PROFILING_ENABLED
+        code_profile->unhandled_count++;
+#endif
         return false; 
     }
 
     u64 registeredCount = darray_length(state_ptr->registered[code]->events);
     for(u64 i = 0; i < registeredCount; i++) {
         registeredEvent e = state_ptr->registered[code]->events[i];
+#ifdef HEVENT_PROFILING_ENABLED
+        f64 start_time = platformGetAbsoluteTime();
+        b8 handled = e.callback(code, sender, e.listener, context);
+        f64 elapsed = platformGetAbsoluteTime() - start_time;
+
+        // The callback could have (un)registered listeners, so index the array again.
+        if (state_ptr->registered[code]->events && i < darray_length(state_ptr->registered[code]->events)) {
+            eventProfile* listener_profile = &state_ptr->registered[code]->events[i].profile;
+            listener_profile->fire_count++;
+            listener_profile->total_time += elapsed;
+            if (handled) {
+                listener_profile->handled_count++;
+            } else {
+                listener_profile->unhandled_count++;
+            }
+        }
+        code_profile->total_time += elapsed;
+
+        if (handled) {
+            code_profile->handled_count++;
+            return true;
+        }
+#else
         if (e.callback(code, sender, e.listener, context)) {
             // Event has been handled, do not send to other listeners
             return true;
         }
+#endif
     }
+#ifdef HEVENT_PROFILING_ENABLED
+    code_profile->unhandled_count++;
+#endif
     // Not found
     return false;
+}
+
+void eventGetProfile_str(stringBuilder* builder) {
+#ifdef HEVENT_PROFILING_ENABLED
+    string_builder_append(builder, string_view("Event System Profile:\n"));
+
+    if (state_ptr) {
+        for (u32 code = 0; code < MAX_MESSAGE_CODES; code++) {
+            eventProfile* p = &state_ptr->profiles[code];
+            if (p->fire_count == 0) {
+                continue;
+            }
+
+            string_builder_append_format(
+                builder,
+                "  code 0x%04X: fired %llu (handled %llu, unhandled %llu), %.3fms in handlers\n",
+                code, p->fire_count, p->handled_count, p->unhandled_count, p->total_time * 1000.0);
+
+            if (!state_ptr->registered[code] || !state_ptr->registered[code]->events) {
+                continue;
+            }
+
+            u64 registeredCount = darray_length(state_ptr->registered[code]->events);
+            for (u64 i = 0; i < registeredCount; i++) {
+                registeredEvent* e = &state_ptr->registered[code]->events[i];
+                string_builder_append_format(
+                    builder,
+                    "    listener %p callback %p: called %llu (handled %llu), %.3fms\n",
+                    e->listener, (void*)e->callback, e->profile.fire_count, e->profile.handled_count, e->profile.total_time * 1000.0);
+            }
+        }
+    }
+#else
+    string_builder_append(builder, string_view("Event System Profile: disabled (HEVENT_PROFILING_ENABLED not defined)\n"));
+#endif
+}
+
+void eventResetProfile() {
+#ifdef HEVENT_PROFILING_ENABLED
+    if (!state_ptr) {
+        return;
+    }
+
+    HzeroMemory(state_ptr->profiles, sizeof(state_ptr->profiles));
+    for (u32 code = 0; code < MAX_MESSAGE_CODES; code++) {
+        if (state_ptr->registered[code] && state_ptr->registered[code]->events) {
+            u64 registeredCount = darray_length(state_ptr->registered[code]->events);
+            for (u64 i = 0; i < registeredCount; i++) {
+                HzeroMemory(&state_ptr->registered[code]->events[i].profile, sizeof(eventProfile));
+            }
+        }
+    }
+#endif
 }
\ No newline at end of file
@@ -5,6 +5,13 @@ extern "C" {
 #endif
 
 #include "defines.h"
+#include "utils/hstring.h"
+
+// Event profiling is only compiled into debug builds.
+// Disable it entirely by commenting out the below line.
+#ifdef _DEBUG
+#define HEVENT_PROFILING_ENABLED
+#endif
 
 typedef struct eventContext { // *Without pretext*
     // 128 bytes
@@ -63,6 +70,20 @@ HAPI b8 eventUnregister(u16 code, void* listener, PFNC_onEvent onEvent);
  */
 HAPI b8 eventFire(u16 code, void* sender, eventContext context);
 
+/**
+ * Builds a report of the collected event profiling data. For every event code that has
+ * been fired it lists the fire count, how many fires were handled/unhandled and the
+ * cumulative time spent in handlers, followed by the same data per listener callback.
+ * Handler time is inclusive, so events fired from inside a handler are counted twice.
+ * @param builder A pointer to the stringBuilder the report is appended to.
+ */
+HAPI void eventGetProfile_str(stringBuilder* builder);
+
+/**
+ * Resets all collected event profiling data to zero.
+ */
+HAPI void eventResetProfile();
+
 // System internal event codes. Application should use codes beyond 255.
 typedef enum systemEventCode {
     // Shuts the application down on the next frame.
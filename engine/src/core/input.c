@@ -56,22 +56,22 @@ void input_process_key(keys key, b8 pressed) {
         state_ptr->kcur.keys[key] = pressed;
 
         if (key == KEY_LALT) {
-            HINFO("Left alt %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Left alt %s.", (pressed ? "pressed" : "released"));
         }
         else if (key == KEY_RALT) {
-            HINFO("Right alt %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Right alt %s.", (pressed ? "pressed" : "released"));
         }
         else if (key == KEY_LCONTROL) {
-            HINFO("Left ctrl %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Left ctrl %s.", (pressed ? "pressed" : "released"));
         }
         else if (key == KEY_RCONTROL) {
-            HINFO("Right ctrl %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Right ctrl %s.", (pressed ? "pressed" : "released"));
         }
         else if (key == KEY_LSHIFT) {
-            HINFO("Left shift %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Left shift %s.", (pressed ? "pressed" : "released"));
         }
         else if (key == KEY_RSHIFT) {
-            HINFO("Right shift %s.", (pressed ? "pressed" : "released"));
+            HINFO_FAST("Right shift %s.", (pressed ? "pressed" : "released"));
         }
 
         // Fire an event for inmediate processing
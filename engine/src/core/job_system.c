@@ -0,0 +1,197 @@
+#include "core/job_system.h"
+
+#include "core/logger.h"
+#include "memory/hmemory.h"
+#include "platform/platform.h"
+
+// Maximum amount of worker threads.
+#define JOB_MAX_THREADS 32
+// Time a worker waits for work before checking if it should exit.
+#define JOB_WORKER_TIMEOUT_MS 100
+
+// A range being run. Lives on the stack of the thread that called job_system_parallel_for.
+typedef struct job_range {
+    PFN_job_range function;
+    void* params;
+    u32 count;
+    // Next index to be claimed.
+    u32 next_index;
+    // Indices not finished yet. Whoever finishes the last one signals done.
+    u32 remaining;
+} job_range;
+
+typedef struct job_system_state {
+    b8 running;
+    u32 thread_count;
+    platformThread threads[JOB_MAX_THREADS];
+
+    // Signaled to wake workers up when a range is published.
+    platformSemaphore work_semaphore;
+    // Signaled once the last index of a range is done.
+    platformSemaphore done_semaphore;
+    // Signaled by the last worker to let go of a retired range.
+    platformSemaphore idle_semaphore;
+    // Held by the thread running a range, so ranges from several threads run one after the other.
+    platformSemaphore range_lock;
+
+    // The range being run, NULL when idle.
+    job_range* range;
+    // Workers currently looking at range. The range may only go away once this drops to 0.
+    u32 active_workers;
+} job_system_state;
+
+static job_system_state* state_ptr;
+
+// Claims and runs indices until none are left.
+static void job_run_range(job_range* range) {
+    for (;;) {
+        u32 index = __atomic_fetch_add(&range->next_index, 1, __ATOMIC_RELAXED);
+        if (index >= range->count) {
+            return;
+        }
+        range->function(index, range->params);
+        if (__atomic_sub_fetch(&range->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+            platformSemaphoreSignal(&state_ptr->done_semaphore);
+        }
+    }
+}
+
+static u32 job_worker(void* params) {
+    job_system_state* state = (job_system_state*)params;
+
+    while (__atomic_load_n(&state->running, __ATOMIC_ACQUIRE)) {
+        if (!platformSemaphoreWait(&state->work_semaphore, JOB_WORKER_TIMEOUT_MS)) {
+            continue;
+        }
+
+        // Announce before looking at the range, so the caller knows to wait for this worker.
+        __atomic_add_fetch(&state->active_workers, 1, __ATOMIC_SEQ_CST);
+        job_range* range = __atomic_load_n(&state->range, __ATOMIC_SEQ_CST);
+        if (range) {
+            job_run_range(range);
+        }
+        // The caller may be waiting for this worker to let go of its range.
+        if (__atomic_sub_fetch(&state->active_workers, 1, __ATOMIC_SEQ_CST) == 0 && !__atomic_load_n(&state->range, __ATOMIC_SEQ_CST)) {
+            platformSemaphoreSignal(&state->idle_semaphore);
+        }
+    }
+
+    return 0;
+}
+
+// Stops and joins the worker threads started so far.
+static void job_stop_workers(job_system_state* state) {
+    __atomic_store_n(&state->running, false, __ATOMIC_RELEASE);
+    for (u32 i = 0; i < state->thread_count; ++i) {
+        platformThreadJoin(&state->threads[i]);
+    }
+    state->thread_count = 0;
+}
+
+// Destroys the semaphores. Ones that were never created are skipped.
+static void job_destroy_semaphores(job_system_state* state) {
+    platformSemaphoreDestroy(&state->work_semaphore);
+    platformSemaphoreDestroy(&state->done_semaphore);
+    platformSemaphoreDestroy(&state->idle_semaphore);
+    platformSemaphoreDestroy(&state->range_lock);
+}
+
+b8 job_system_initialize(u64* memory_requirement, void* state, u32 thread_count) {
+    *memory_requirement = sizeof(job_system_state);
+    if (state == 0) {
+        return true;
+    }
+
+    HzeroMemory(state, sizeof(job_system_state));
+    job_system_state* job_state = (job_system_state*)state;
+
+    if (thread_count == 0) {
+        // Leave a processor for the thread handing out the work.
+        u32 processor_count = platformGetProcessorCount();
+        thread_count = processor_count > 1 ? processor_count - 1 : 1;
+    }
+    if (thread_count > JOB_MAX_THREADS) {
+        thread_count = JOB_MAX_THREADS;
+    }
+
+    if (!platformSemaphoreCreate(0, &job_state->work_semaphore) || !platformSemaphoreCreate(0, &job_state->done_semaphore) ||
+        !platformSemaphoreCreate(0, &job_state->idle_semaphore) || !platformSemaphoreCreate(1, &job_state->range_lock)) {
+        HERROR("Failed to create the job system semaphores.");
+        job_destroy_semaphores(job_state);
+        return false;
+    }
+
+    job_state->running = true;
+    for (u32 i = 0; i < thread_count; ++i) {
+        if (!platformThreadCreate(job_worker, job_state, &job_state->threads[i])) {
+            HERROR("Failed to create job worker thread %u.", i);
+            job_stop_workers(job_state);
+            job_destroy_semaphores(job_state);
+            return false;
+        }
+        job_state->thread_count++;
+    }
+
+    state_ptr = job_state;
+    HDEBUG("Job system started with %u worker threads.", thread_count);
+    return true;
+}
+
+void job_system_shutdown(void* state) {
+    if (!state_ptr) {
+        return;
+    }
+
+    job_stop_workers(state_ptr);
+    job_destroy_semaphores(state_ptr);
+    state_ptr = 0;
+}
+
+void job_system_parallel_for(u32 count, PFN_job_range function, void* params) {
+    if (count == 0) {
+        return;
+    }
+
+    if (!state_ptr || count == 1) {
+        for (u32 i = 0; i < count; ++i) {
+            function(i, params);
+        }
+        return;
+    }
+
+    // One range at a time, other callers block until it is done.
+    while (!platformSemaphoreWait(&state_ptr->range_lock, JOB_WORKER_TIMEOUT_MS)) {
+    }
+
+    job_range range;
+    range.function = function;
+    range.params = params;
+    range.count = count;
+    range.next_index = 0;
+    range.remaining = count;
+    __atomic_store_n(&state_ptr->range, &range, __ATOMIC_SEQ_CST);
+
+    // The calling thread takes a share as well, so one index less needs a worker.
+    u32 wake_count = count - 1 < state_ptr->thread_count ? count - 1 : state_ptr->thread_count;
+    for (u32 i = 0; i < wake_count; ++i) {
+        platformSemaphoreSignal(&state_ptr->work_semaphore);
+    }
+
+    job_run_range(&range);
+    while (__atomic_load_n(&range.remaining, __ATOMIC_ACQUIRE) != 0) {
+        platformSemaphoreWait(&state_ptr->done_semaphore, JOB_WORKER_TIMEOUT_MS);
+    }
+
+    // Workers woken late may still be reading the range, wait for them to let go of it.
+    // Leftover signals from earlier ranges only cause an extra check.
+    __atomic_store_n(&state_ptr->range, 0, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&state_ptr->active_workers, __ATOMIC_SEQ_CST) != 0) {
+        platformSemaphoreWait(&state_ptr->idle_semaphore, JOB_WORKER_TIMEOUT_MS);
+    }
+
+    platformSemaphoreSignal(&state_ptr->range_lock);
+}
+
+u32 job_system_thread_count() {
+    return state_ptr ? state_ptr->thread_count + 1 : 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "defines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Function run for every index of a parallel range.
+typedef void (*PFN_job_range)(u32 index, void* params);
+
+/**
+ * Initializes the job system and starts its worker threads.
+ * @param memory_requirement A pointer to a number wich will be populated with the size of the system state.
+ * @param state The memory block for the system state. Pass NULL to only obtain the memory requirement.
+ * @param thread_count The amount of worker threads. Pass 0 to use one per logical processor, minus the calling thread.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 job_system_initialize(u64* memory_requirement, void* state, u32 thread_count);
+HAPI void job_system_shutdown(void* state);
+
+/**
+ * Runs function(i, params) for every i in [0, count) spread across the worker
+ * threads and the calling thread, and returns once all of them are done.
+ * Indices may run in any order. Runs everything on the calling thread when the
+ * job system isn't initialized. Only one range runs at a time, calls from
+ * several threads wait for each other, so it must not be called from inside a job.
+ * @param count The amount of indices to run.
+ * @param function The function to be run for each index.
+ * @param params Passed unchanged to every call of function.
+ */
+HAPI void job_system_parallel_for(u32 count, PFN_job_range function, void* params);
+
+/**
+ * @returns The amount of threads running jobs, including the calling thread.
+ */
+HAPI u32 job_system_thread_count();
+
+#ifdef __cplusplus
+}
+#endif
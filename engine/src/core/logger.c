@@ -9,24 +9,316 @@
 
 // TODO: temporary
 #include <stdarg.h>
+#include <stddef.h>
+
+// Amount of preallocated message slots. Must be a power of 2.
+#define LOG_QUEUE_SLOT_COUNT 256
+// Maximum size of a single queued log entry, including the level prefix and '\n'.
+#define LOG_QUEUE_SLOT_SIZE 4096
+// Size of the buffer the writer thread batches file writes into.
+#define LOG_BATCH_SIZE (64 * 1024)
+// Time the writer thread may hold on to unwritten entries. Errors are flushed right away.
+#define LOG_FLUSH_INTERVAL_MS 100
+// Maximum amount of deferred log call sites. Sites beyond this are formatted immediately.
+#define LOG_MAX_DEFERRED_SITES 1024
+
+// Registration state of a deferred log site.
+enum {
+    LOG_SITE_UNREGISTERED = 0,
+    LOG_SITE_REGISTERING = 1,
+    LOG_SITE_READY = 2,
+    // The format string uses something the deferred path can't capture (e.g. '*' widths).
+    LOG_SITE_UNSUPPORTED = 3
+};
+
+// Raw argument types captured by deferred log entries.
+enum {
+    LOG_ARG_I32,
+    LOG_ARG_I64,
+    LOG_ARG_F64,
+    LOG_ARG_PTR,
+    LOG_ARG_STR
+};
+
+// Conversions simple enough to be written without printf: no flags, width or 'h' modifiers.
+enum {
+    LOG_FAST_NONE,
+    // %d and %i.
+    LOG_FAST_SIGNED,
+    // %u.
+    LOG_FAST_UNSIGNED,
+    // %s without a precision.
+    LOG_FAST_STRING,
+    // %f, with the precision (at most 15) in the upper 4 bits.
+    LOG_FAST_FIXED
+};
+
+static const char* levelStrings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARNING]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: " };
+static const u32 levelLengths[6] = {9, 9, 11, 8, 9, 9};
+
+STATIC_ASSERT((LOG_QUEUE_SLOT_COUNT & (LOG_QUEUE_SLOT_COUNT - 1)) == 0, "LOG_QUEUE_SLOT_COUNT must be a power of 2.");
+
+typedef struct log_slot {
+    // Slot state for the queue. Equals the queue position when the slot is free to
+    // be claimed and position + 1 once the message has been published.
+    u64 sequence;
+    log_level level;
+    // Id of the deferred log site that recorded this entry. 0 for pre-formatted text.
+    u32 site_id;
+    // Length of the text, or of the raw argument data for deferred entries.
+    u32 length;
+    char message[LOG_QUEUE_SLOT_SIZE];
+} log_slot;
 
 typedef struct logger_system_state {
-    fileHandle log_file_handle;
+    // Batches entries into the log file. Only touched by the writer thread.
+    fileWriter log_writer;
+
+    platformThread writer_thread;
+    // Signaled by producers when entries are published, at most once per writer wake up.
+    platformSemaphore pending;
+    // Set when the writer thread has already been signaled and has yet to drain the queue.
+    b8 wake_pending;
+    b8 running;
+    // Cleared when shutdown begins, later entries go straight to the console.
+    b8 accepting;
+    // Threads between checking accepting and publishing their entry.
+    u32 producers;
+
+    // Next position to be claimed by a producer. Shared between all threads.
+    u64 enqueue_pos;
+    // Next position to be consumed. Only modified by the writer thread.
+    u64 dequeue_pos;
+    // Every entry before this position has been written and flushed.
+    u64 flushed_pos;
+
+    log_slot slots[LOG_QUEUE_SLOT_COUNT];
+
+    // Registered deferred log sites, indexed by id - 1.
+    u32 site_count;
+    log_site* sites[LOG_MAX_DEFERRED_SITES];
 } logger_system_state;
 
 static logger_system_state* state_ptr;
 
-void append_to_log_file(const char* message) {
-    if (state_ptr && state_ptr->log_file_handle.isValid) {
-        // Since the message already contains a '\n', just write bytes directly.
-        u64 length = string_length(message);
-        u64 writen = 0;
-        if (!filesystem_write(&state_ptr->log_file_handle, length, message, &writen)) {
-            platformConsoleWriteError("ERROR writing to consoole.log for writing.", LOG_LEVEL_ERROR);
+// Kept outside of the state so filtering works before the logging system starts.
+#if RELEASE == 1
+static log_level max_level = LOG_LEVEL_INFO;
+#else
+static log_level max_level = LOG_LEVEL_TRACE;
+#endif
+
+// Reports a failed write to the log file. Can't go through the log itself.
+static void log_write_result(b8 result) {
+    if (!result) {
+        platformConsoleWriteError("ERROR writing to console.log.\n", LOG_LEVEL_ERROR);
+    }
+}
+
+// Size of a raw argument in a deferred entry.
+static u32 log_arg_size(u8 type, const u8* data) {
+    switch (type) {
+        case LOG_ARG_I32: return sizeof(i32);
+        case LOG_ARG_I64: return sizeof(i64);
+        case LOG_ARG_F64: return sizeof(f64);
+        case LOG_ARG_PTR: return sizeof(void*);
+        default: {
+            // Strings are stored as a u16 length followed by the null terminated characters.
+            u16 length;
+            HcopyMemory(&length, data, sizeof(u16));
+            return sizeof(u16) + length + 1;
+        }
+    }
+}
+
+// Writes a raw argument of a LOG_FAST_* conversion. Returns the length written, -1 to leave it to printf.
+static i32 log_write_fast(u8 fast, u8 type, const u8* data, char* out, u32 room) {
+    char number[STRING_NUMBER_BUFFER_SIZE];
+    u32 length;
+    switch (fast & 0xF) {
+        case LOG_FAST_SIGNED:
+        case LOG_FAST_UNSIGNED: {
+            i64 value;
+            if (type == LOG_ARG_I32) {
+                i32 value32;
+                HcopyMemory(&value32, data, sizeof(i32));
+                value = (fast & 0xF) == LOG_FAST_SIGNED ? (i64)value32 : (i64)(u32)value32;
+            } else {
+                HcopyMemory(&value, data, sizeof(i64));
+            }
+            length = (fast & 0xF) == LOG_FAST_SIGNED ? string_write_i64(number, value) : string_write_u64(number, (u64)value);
+        } break;
+        case LOG_FAST_STRING: {
+            u16 string_length;
+            HcopyMemory(&string_length, data, sizeof(u16));
+            // Too long is fine, it's cut off like printf would.
+            length = string_length < room ? string_length : room;
+            HcopyMemory(out, data + sizeof(u16), length);
+            return length;
+        }
+        case LOG_FAST_FIXED: {
+            f64 value;
+            HcopyMemory(&value, data, sizeof(f64));
+            length = string_write_f64(number, sizeof(number), value, fast >> 4);
+            if (!length) {
+                return -1;
+            }
+        } break;
+        default:
+            return -1;
+    }
+    if (length > room) {
+        return -1;
+    }
+    HcopyMemory(out, number, length);
+    return length;
+}
+
+// Formats a deferred entry from its site and raw arguments. Only called by the writer thread.
+// Each conversion is formatted on its own along with the literal text preceding it.
+static u32 log_decode_deferred(const log_site* site, log_level level, const u8* data, char* out, u32 out_size) {
+    u32 offset = levelLengths[level];
+    HcopyMemory(out, levelStrings[level], offset);
+
+    // Leave room for the '\n'.
+    u32 limit = out_size - 1;
+    char segment[LOG_QUEUE_SLOT_SIZE];
+    u32 segment_start = 0;
+    for (u32 i = 0; i <= site->arg_count && offset < limit; ++i) {
+        u32 segment_end = i < site->arg_count ? site->arg_ends[i] : (u32)string_length(site->format);
+        u32 segment_length = segment_end - segment_start;
+
+        // Plain conversions skip printf, along with the literal text before them unless it has a "%%".
+        i32 written = -1;
+        if (i < site->arg_count && site->arg_fast[i] != LOG_FAST_NONE) {
+            stringView literal = {site->format + segment_start, site->arg_starts[i] - segment_start};
+            if (literal.length < limit - offset && string_find_char(literal, '%') < 0) {
+                HcopyMemory(out + offset, literal.data, literal.length);
+                written = log_write_fast(site->arg_fast[i], site->arg_types[i], data, out + offset + literal.length, limit - offset - (u32)literal.length);
+                if (written >= 0) {
+                    written += literal.length;
+                    data += log_arg_size(site->arg_types[i], data);
+                }
+            }
+        }
+
+        if (written < 0) {
+            HcopyMemory(segment, site->format + segment_start, segment_length);
+            segment[segment_length] = 0;
+            if (i == site->arg_count) {
+                // Trailing literal text, can still contain "%%".
+                written = string_format_n(out + offset, limit - offset, segment);
+            } else {
+                switch (site->arg_types[i]) {
+                    case LOG_ARG_I32: {
+                        i32 value;
+                        HcopyMemory(&value, data, sizeof(i32));
+                        data += sizeof(i32);
+                        written = string_format_n(out + offset, limit - offset, segment, value);
+                    } break;
+                    case LOG_ARG_I64: {
+                        i64 value;
+                        HcopyMemory(&value, data, sizeof(i64));
+                        data += sizeof(i64);
+                        written = string_format_n(out + offset, limit - offset, segment, value);
+                    } break;
+                    case LOG_ARG_F64: {
+                        f64 value;
+                        HcopyMemory(&value, data, sizeof(f64));
+                        data += sizeof(f64);
+                        written = string_format_n(out + offset, limit - offset, segment, value);
+                    } break;
+                    case LOG_ARG_PTR: {
+                        void* value;
+                        HcopyMemory(&value, data, sizeof(void*));
+                        data += sizeof(void*);
+                        written = string_format_n(out + offset, limit - offset, segment, value);
+                    } break;
+                    default: {
+                        // Strings are stored as a u16 length followed by the null terminated characters.
+                        u16 length;
+                        HcopyMemory(&length, data, sizeof(u16));
+                        written = string_format_n(out + offset, limit - offset, segment, (const char*)data + sizeof(u16));
+                        data += sizeof(u16) + length + 1;
+                    } break;
+                }
+            }
+        }
+        segment_start = segment_end;
+
+        if (written < 0) {
+            break;
+        }
+        offset += written;
+    }
+
+    if (offset > limit) {
+        offset = limit;
+    }
+    out[offset++] = '\n';
+    out[offset] = 0;
+    return offset;
+}
+
+// Consumes every published slot.
+static void log_drain_queue(logger_system_state* logger) {
+    for (;;) {
+        u64 pos = logger->dequeue_pos;
+        log_slot* slot = &logger->slots[pos & (LOG_QUEUE_SLOT_COUNT - 1)];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1) {
+            // Nothing else has been published yet.
+            break;
+        }
+
+        const char* message = slot->message;
+        u32 length = slot->length;
+        char decoded[LOG_QUEUE_SLOT_SIZE];
+        if (slot->site_id != 0) {
+            // Deferred entry, this is where the formatting actually happens.
+            const log_site* site = logger->sites[slot->site_id - 1];
+            length = log_decode_deferred(site, slot->level, (const u8*)slot->message, decoded, LOG_QUEUE_SLOT_SIZE);
+            message = decoded;
+        }
+
+        log_write_result(filesystem_writer_write(&logger->log_writer, length, message));
+        if (slot->level < LOG_LEVEL_WARNING) {
+            platformConsoleWriteError(message, slot->level);
+            // Errors and fatal entries reach the file before anything else happens.
+            log_write_result(filesystem_writer_mark_error(&logger->log_writer));
+        } else {
+            platformConsoleWrite(message, slot->level);
         }
+
+        // Hand the slot back to the producers for the next lap around the queue.
+        __atomic_store_n(&slot->sequence, pos + LOG_QUEUE_SLOT_COUNT, __ATOMIC_RELEASE);
+        logger->dequeue_pos = pos + 1;
     }
 }
 
+static u32 log_writer_thread(void* params) {
+    logger_system_state* logger = params;
+    for (;;) {
+        platformSemaphoreWait(&logger->pending, LOG_FLUSH_INTERVAL_MS);
+        __atomic_store_n(&logger->wake_pending, false, __ATOMIC_SEQ_CST);
+        b8 running = __atomic_load_n(&logger->running, __ATOMIC_ACQUIRE);
+
+        log_drain_queue(logger);
+        if (running) {
+            log_write_result(filesystem_writer_update(&logger->log_writer));
+        } else {
+            log_write_result(filesystem_writer_flush(&logger->log_writer));
+        }
+        if (logger->log_writer.length == 0) {
+            __atomic_store_n(&logger->flushed_pos, logger->dequeue_pos, __ATOMIC_RELEASE);
+        }
+
+        if (!running) {
+            break;
+        }
+    }
+    return 0;
+}
+
 b8 initLog(u64* memory_requirement, void* state) {
     *memory_requirement = sizeof(logger_system_state);
     if (state == 0) {
@@ -36,45 +328,425 @@ b8 initLog(u64* memory_requirement, void* state) {
     state_ptr = state;
 
     // Create or wipe existing log file, then open it.
-    if (!filesystem_open("console.log", FILE_MODE_WRITE, false, &state_ptr->log_file_handle)) {
+    fileWriterPolicy policy = {0};
+    policy.flush_interval = LOG_FLUSH_INTERVAL_MS / 1000.0;
+    policy.flush_on_error = true;
+    if (!filesystem_writer_open("console.log", LOG_BATCH_SIZE, &policy, &state_ptr->log_writer)) {
         platformConsoleWriteError("ERROR: Unable to open console.log for writing.", LOG_LEVEL_ERROR);
+        state_ptr = 0;
+        return false;
+    }
+
+    state_ptr->enqueue_pos = 0;
+    state_ptr->dequeue_pos = 0;
+    state_ptr->flushed_pos = 0;
+    state_ptr->site_count = 0;
+    state_ptr->wake_pending = false;
+    state_ptr->accepting = true;
+    state_ptr->producers = 0;
+    for (u64 i = 0; i < LOG_QUEUE_SLOT_COUNT; ++i) {
+        state_ptr->slots[i].sequence = i;
+    }
+
+    if (!platformSemaphoreCreate(0, &state_ptr->pending)) {
+        platformConsoleWriteError("ERROR: Unable to create the log writer semaphore.", LOG_LEVEL_ERROR);
+        filesystem_writer_close(&state_ptr->log_writer);
+        state_ptr = 0;
+        return false;
+    }
+
+    state_ptr->running = true;
+    if (!platformThreadCreate(log_writer_thread, state_ptr, &state_ptr->writer_thread)) {
+        platformConsoleWriteError("ERROR: Unable to start the log writer thread.", LOG_LEVEL_ERROR);
+        platformSemaphoreDestroy(&state_ptr->pending);
+        filesystem_writer_close(&state_ptr->log_writer);
+        state_ptr = 0;
         return false;
     }
 
     return true;
 }
 
-void shutdown_logging(void* state) {
-    // TODO: cleanup logging/write queued entries.
+// Wakes up the writer thread, unless it already has been since it last drained the queue.
+static void log_wake_writer() {
+    if (!__atomic_exchange_n(&state_ptr->wake_pending, true, __ATOMIC_SEQ_CST)) {
+        platformSemaphoreSignal(&state_ptr->pending);
+    }
+}
+
+void shutdownLog(void* state) {
+    logger_system_state* logger = state_ptr;
+    if (!logger) {
+        return;
+    }
+
+    // Stop accepting entries, then wait for the ones being published. The writer keeps
+    // draining meanwhile, so producers waiting on a full queue get through.
+    __atomic_store_n(&logger->accepting, false, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&logger->producers, __ATOMIC_SEQ_CST) != 0) {
+        log_wake_writer();
+        platformSleep(0);
+    }
+
+    // The writer drains the queue once more on its way out.
+    __atomic_store_n(&logger->running, false, __ATOMIC_RELEASE);
+    platformSemaphoreSignal(&logger->pending);
+    platformThreadJoin(&logger->writer_thread);
+
+    // Nothing can be published anymore, so this catches whatever is left.
+    log_drain_queue(logger);
+    log_write_result(filesystem_writer_flush(&logger->log_writer));
     state_ptr = 0;
+
+    platformSemaphoreDestroy(&logger->pending);
+    filesystem_writer_close(&logger->log_writer);
+}
+
+// Counts the calling thread as publishing an entry. False when the logger isn't running or
+// is shutting down, the entry then goes straight to the console.
+static b8 log_begin_entry() {
+    logger_system_state* logger = state_ptr;
+    if (!logger) {
+        return false;
+    }
+    // Counted before checking, so shutdown either sees the count or this thread sees it stopped.
+    __atomic_add_fetch(&logger->producers, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&logger->accepting, __ATOMIC_SEQ_CST)) {
+        __atomic_sub_fetch(&logger->producers, 1, __ATOMIC_SEQ_CST);
+        return false;
+    }
+    return true;
+}
+
+static void log_end_entry() {
+    __atomic_sub_fetch(&state_ptr->producers, 1, __ATOMIC_SEQ_CST);
+}
+
+// Claims the next free slot in the queue, waiting for the writer thread if the queue is full.
+static log_slot* log_claim_slot(u64* out_pos) {
+    u64 pos = __atomic_load_n(&state_ptr->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        log_slot* slot = &state_ptr->slots[pos & (LOG_QUEUE_SLOT_COUNT - 1)];
+        u64 sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        i64 difference = (i64)sequence - (i64)pos;
+        if (difference == 0) {
+            // The slot is free, try to claim it. On failure pos is reloaded.
+            if (__atomic_compare_exchange_n(&state_ptr->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *out_pos = pos;
+                return slot;
+            }
+        } else if (difference < 0) {
+            // Queue is full. Give the writer thread a chance to catch up.
+            log_wake_writer();
+            platformSleep(0);
+            pos = __atomic_load_n(&state_ptr->enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            // Another producer claimed this slot first.
+            pos = __atomic_load_n(&state_ptr->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Publishes a filled slot to the writer thread. Fatal entries wait until they have been flushed.
+static void log_publish(log_slot* slot, u64 pos, log_level level) {
+    slot->level = level;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_SEQ_CST);
+    log_wake_writer();
+
+    if (level == LOG_LEVEL_FATAL) {
+        // Fatal entries are flushed synchronously, the application is likely about to go down.
+        while (__atomic_load_n(&state_ptr->flushed_pos, __ATOMIC_ACQUIRE) <= pos) {
+            platformSleep(0);
+        }
+        // Whatever other files have buffered goes out too.
+        filesystem_writer_flush_all();
+    }
+}
+
+// Writes the level prefix, the formatted message and a '\n' to dest. Returns the length written.
+static u32 log_format_entry(char* dest, u64 dest_size, log_level level, const char* message, void* va_listp) {
+    u32 length = levelLengths[level];
+    HcopyMemory(dest, levelStrings[level], length);
+
+    // Leave room for the '\n' and null terminator.
+    i32 written = string_format_nv(dest + length, dest_size - length - 1, message, va_listp);
+    if (written > 0) {
+        length += written;
+    }
+    dest[length++] = '\n';
+    dest[length] = 0;
+    return length;
+}
+
+static void log_output_v(log_level level, const char* message, void* va_listp) {
+    if (!log_begin_entry()) {
+        // Logging system not running (yet, or anymore), write directly to the console.
+        //Technically imposes a 32k character limit on a single log entry, but...
+        //It's not recomended to do this
+        char outMessage[32000];
+        log_format_entry(outMessage, sizeof(outMessage), level, message, va_listp);
+        if (level < LOG_LEVEL_WARNING) platformConsoleWriteError(outMessage, level);
+        else platformConsoleWrite(outMessage, level);
+        return;
+    }
+
+    // Format straight into the queue. Entries longer than a slot are truncated.
+    u64 pos;
+    log_slot* slot = log_claim_slot(&pos);
+    slot->length = log_format_entry(slot->message, LOG_QUEUE_SLOT_SIZE, level, message, va_listp);
+    slot->site_id = 0;
+    log_publish(slot, pos, level);
+    log_end_entry();
 }
 
 void logOutput(log_level level, const char* message, ...) {
-    // TODO: This string operations are all pretty slow.
-    // This will be moved in the future to another thread along with the
-    // file writes to avoid slowing things down while the engine is running.
-    const char* levelStrings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARNING]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: " };
-    b8 isError = (level < LOG_LEVEL_WARNING);
-
-    //Technically imposes a 32k character limit on a single log entry, but...
-    //It's not recomended to do this
-    #define msgLength 32000
-    char outMessage[msgLength];
-    HzeroMemory(outMessage, sizeof(outMessage));
-
-    //Format original message
+    if (level > max_level) {
+        return;
+    }
+
     __builtin_va_list argPtr;
     va_start(argPtr, message);
-    string_format_v(outMessage, message, argPtr);
+    log_output_v(level, message, argPtr);
     va_end(argPtr);
+}
+
+// Works out the raw argument types of the site's format string and assigns it an id.
+static void log_register_site(log_site* site) {
+    const char* format = site->format;
+    u32 arg_count = 0;
+    u8 state = LOG_SITE_READY;
+
+    u64 i = 0;
+    while (format[i] && state == LOG_SITE_READY) {
+        if (format[i++] != '%') {
+            continue;
+        }
+        if (format[i] == '%') {
+            i++;
+            continue;
+        }
+        u64 start = i - 1;
+
+        // Flags, width and precision. '*' would need an extra argument, which isn't supported.
+        u64 flags_start = i;
+        while (format[i] == '-' || format[i] == '+' || format[i] == ' ' || format[i] == '#' || format[i] == '0') i++;
+        while (format[i] >= '0' && format[i] <= '9') i++;
+        b8 padded = i != flags_start;
+        i32 precision = -1;
+        if (format[i] == '.') {
+            i++;
+            precision = 0;
+            while (format[i] >= '0' && format[i] <= '9') {
+                precision = precision < 1000 ? precision * 10 + (format[i] - '0') : precision;
+                i++;
+            }
+        }
+
+        // Length modifiers, sized by the type they stand for (long is only 32 bits on Win64).
+        // Integers wider than an int are read as 64 bits.
+        u32 integer_size = sizeof(i32);
+        b8 wide = false;
+        b8 narrow = false;
+        for (b8 modifier = true; modifier; ) {
+            switch (format[i]) {
+                case 'h': narrow = true; break;
+                case 'l': integer_size = format[i + 1] == 'l' ? sizeof(long long) : sizeof(long); break;
+                case 'j': case 'q': integer_size = sizeof(i64); break;
+                case 'z': integer_size = sizeof(size_t); break;
+                case 't': integer_size = sizeof(ptrdiff_t); break;
+                default: modifier = false; break;
+            }
+            if (modifier) {
+                wide = wide || format[i] != 'h';
+                // "ll" is a single modifier.
+                i += format[i] == 'l' && format[i + 1] == 'l' ? 2 : 1;
+            }
+        }
 
-    char outMessage2[32000];
-    string_format(outMessage2, "%s%s\n", levelStrings[level], outMessage);
+        u8 fast = LOG_FAST_NONE;
+        if (!padded && !narrow) {
+            switch (format[i]) {
+                case 'd': case 'i': fast = precision < 0 ? LOG_FAST_SIGNED : LOG_FAST_NONE; break;
+                case 'u': fast = precision < 0 ? LOG_FAST_UNSIGNED : LOG_FAST_NONE; break;
+                case 's': fast = precision < 0 && !wide ? LOG_FAST_STRING : LOG_FAST_NONE; break;
+                case 'f':
+                    if (precision < 0) precision = 6;
+                    fast = precision <= 15 ? (u8)(LOG_FAST_FIXED | precision << 4) : LOG_FAST_NONE;
+                    break;
+            }
+        }
 
-    // Platform-specific output
-    if(isError) platformConsoleWriteError(outMessage2, level);
-    else platformConsoleWrite(outMessage2, level);
+        u8 type;
+        switch (format[i]) {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+                type = integer_size > sizeof(i32) ? LOG_ARG_I64 : LOG_ARG_I32;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                type = LOG_ARG_F64;
+                break;
+            case 'p':
+                type = LOG_ARG_PTR;
+                break;
+            case 's':
+                type = wide ? LOG_ARG_PTR : LOG_ARG_STR;
+                if (wide) state = LOG_SITE_UNSUPPORTED;
+                break;
+            default:
+                // '*', 'n', 'L' and friends.
+                state = LOG_SITE_UNSUPPORTED;
+                type = 0;
+                break;
+        }
+        i++;
+
+        if (arg_count == LOG_DEFERRED_MAX_ARGS || i > 0xFFFF) {
+            state = LOG_SITE_UNSUPPORTED;
+        }
+        if (state == LOG_SITE_READY) {
+            site->arg_types[arg_count] = type;
+            site->arg_ends[arg_count] = (u16)i;
+            site->arg_starts[arg_count] = (u16)start;
+            site->arg_fast[arg_count] = fast;
+            arg_count++;
+        }
+    }
+
+    if (i >= LOG_QUEUE_SLOT_SIZE) {
+        state = LOG_SITE_UNSUPPORTED;
+    }
 
-    // Queue a copy to be writen to the log file
-    append_to_log_file(outMessage2);
-}
\ No newline at end of file
+    if (state == LOG_SITE_READY) {
+        u32 index = __atomic_fetch_add(&state_ptr->site_count, 1, __ATOMIC_RELAXED);
+        if (index >= LOG_MAX_DEFERRED_SITES) {
+            state = LOG_SITE_UNSUPPORTED;
+        } else {
+            site->arg_count = (u8)arg_count;
+            site->id = index + 1;
+            state_ptr->sites[index] = site;
+        }
+    }
+    __atomic_store_n(&site->state, state, __ATOMIC_RELEASE);
+}
+
+void logDeferred(log_level level, log_site* site, ...) {
+    if (level > max_level) {
+        return;
+    }
+
+    __builtin_va_list argPtr;
+    va_start(argPtr, site);
+
+    b8 queued = log_begin_entry();
+    u8 site_state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+    if (site_state == LOG_SITE_UNREGISTERED && queued) {
+        u8 expected = LOG_SITE_UNREGISTERED;
+        if (__atomic_compare_exchange_n(&site->state, &expected, LOG_SITE_REGISTERING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            log_register_site(site);
+        }
+        site_state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+    }
+
+    if (site_state != LOG_SITE_READY || !queued) {
+        // Can't be deferred (logger not running, site still registering or unsupported).
+        if (queued) {
+            log_end_entry();
+        }
+        log_output_v(level, site->format, argPtr);
+        va_end(argPtr);
+        return;
+    }
+
+    // Copy the raw arguments into the slot. No formatting happens on this thread.
+    u64 pos;
+    log_slot* slot = log_claim_slot(&pos);
+    u8* data = (u8*)slot->message;
+    u8* end = data + LOG_QUEUE_SLOT_SIZE;
+    for (u32 i = 0; i < site->arg_count; ++i) {
+        switch (site->arg_types[i]) {
+            case LOG_ARG_I32: {
+                i32 value = va_arg(argPtr, i32);
+                HcopyMemory(data, &value, sizeof(i32));
+                data += sizeof(i32);
+            } break;
+            case LOG_ARG_I64: {
+                i64 value = va_arg(argPtr, i64);
+                HcopyMemory(data, &value, sizeof(i64));
+                data += sizeof(i64);
+            } break;
+            case LOG_ARG_F64: {
+                f64 value = va_arg(argPtr, f64);
+                HcopyMemory(data, &value, sizeof(f64));
+                data += sizeof(f64);
+            } break;
+            case LOG_ARG_PTR: {
+                void* value = va_arg(argPtr, void*);
+                HcopyMemory(data, &value, sizeof(void*));
+                data += sizeof(void*);
+            } break;
+            default: {
+                // Strings can't be referenced later on, so the characters are copied.
+                // Leave enough room for the remaining arguments, either values or empty strings.
+                const char* value = va_arg(argPtr, const char*);
+                if (!value) {
+                    value = "(null)";
+                }
+                i64 available = (i64)(end - data) - (i64)sizeof(u16) - 1 - (i64)(site->arg_count - i - 1) * 8;
+                if (available < 0) {
+                    available = 0;
+                }
+                u64 length = string_length(value);
+                if (length > (u64)available) {
+                    length = (u64)available;
+                }
+                u16 stored_length = (u16)length;
+                HcopyMemory(data, &stored_length, sizeof(u16));
+                HcopyMemory(data + sizeof(u16), value, length);
+                data[sizeof(u16) + length] = 0;
+                data += sizeof(u16) + length + 1;
+            } break;
+        }
+    }
+    va_end(argPtr);
+
+    slot->length = (u32)(data - (u8*)slot->message);
+    slot->site_id = site->id;
+    log_publish(slot, pos, level);
+    log_end_entry();
+}
+
+void logSetLevel(log_level level) {
+    // Errors can't be silenced.
+    if (level < LOG_LEVEL_ERROR) {
+        level = LOG_LEVEL_ERROR;
+    }
+    max_level = level;
+}
+
+log_level logGetLevel() {
+    return max_level;
+}
+
+b8 logRateLimit(log_level level, log_rate_limit* limit, u32 max_per_second, const char* message) {
+    if (level > max_level) {
+        return false;
+    }
+
+    f64 now = platformGetAbsoluteTime();
+    if (now - limit->window_start >= 1.0) {
+        // New window.
+        limit->window_start = now;
+        limit->count = 0;
+    }
+
+    if (limit->count >= max_per_second) {
+        limit->suppressed++;
+        return false;
+    }
+
+    limit->count++;
+    if (limit->suppressed > 0) {
+        logOutput(level, "Previous message repeated %u more times: \"%s\"", limit->suppressed, message);
+        limit->suppressed = 0;
+    }
+    return true;
+}
@@ -6,17 +6,23 @@ extern "C" {
 
 #include "defines.h"
 
-#define LOG_WARNING_ENABLED 1
-#define LOG_INFO_ENABLED 1
-#define LOG_DEBUG_ENABLED 1
-#define LOG_TRACE_ENABLED 1
-
-//Disable debugg and trace logging for release builds
+// Most verbose level compiled into the build (matches log_level: 2 = warning ... 5 = trace).
+// Anything above it expands to nothing, so its arguments aren't even evaluated.
+// Can be overridden from the build flags, e.g. -DLOG_COMPILE_LEVEL=2
+#ifndef LOG_COMPILE_LEVEL
 #if RELEASE == 1
-#define LOG_DEBUG_ENABLED 0
-#define LOG_TRACE_ENABLED 0
+//Disable debugg and trace logging for release builds
+#define LOG_COMPILE_LEVEL 3
+#else
+#define LOG_COMPILE_LEVEL 5
+#endif
 #endif
 
+#define LOG_WARNING_ENABLED (LOG_COMPILE_LEVEL >= 2)
+#define LOG_INFO_ENABLED (LOG_COMPILE_LEVEL >= 3)
+#define LOG_DEBUG_ENABLED (LOG_COMPILE_LEVEL >= 4)
+#define LOG_TRACE_ENABLED (LOG_COMPILE_LEVEL >= 5)
+
 typedef enum log_level {
     LOG_LEVEL_FATAL = 0,
     LOG_LEVEL_ERROR = 1,
@@ -40,6 +46,92 @@ void shutdownLog(void* state);
 
 HAPI void logOutput(log_level level, const char* message, ...);
 
+/**
+ * @brief Sets the most verbose level that will be logged at runtime. Entries above it
+ * are discarded before any formatting happens. Defaults to LOG_LEVEL_TRACE, or
+ * LOG_LEVEL_INFO for release builds. Fatal and error entries are always logged.
+ *
+ * @param level The new maximum level.
+ */
+HAPI void logSetLevel(log_level level);
+
+// Returns the most verbose level currently being logged.
+HAPI log_level logGetLevel();
+
+// Per call site rate limiting state. Created statically by the H*_LIMITED macros.
+typedef struct log_rate_limit {
+    f64 window_start;
+    // Entries logged in the current window.
+    u32 count;
+    // Entries discarded since the last one that was logged.
+    u32 suppressed;
+} log_rate_limit;
+
+/**
+ * @brief Checks if a rate limited call site may log. At most max_per_second entries are
+ * let through per one second window. When an entry is let through after others were
+ * discarded, a "repeated N times" note is logged first. Not synchronized; with multiple
+ * threads hitting the same site the counts are approximate.
+ *
+ * @param level The level of the entry.
+ * @param limit The call site state.
+ * @param max_per_second Maximum entries per one second window.
+ * @param message The format string of the call site, used in the repeat note.
+ * @return b8 true if the entry should be logged; otherwise false.
+ */
+HAPI b8 logRateLimit(log_level level, log_rate_limit* limit, u32 max_per_second, const char* message);
+
+// Logs a message, but at most max_per_second times per second from this call site.
+#define HLOG_LIMITED(level, max_per_second, message, ...) {                         \
+        static log_rate_limit _log_limit;                                           \
+        if (logRateLimit(level, &_log_limit, max_per_second, message)) {            \
+            logOutput(level, message, ##__VA_ARGS__);                               \
+        }                                                                           \
+    }
+
+// Maximum amount of arguments a deferred log entry can carry.
+#define LOG_DEFERRED_MAX_ARGS 8
+
+/**
+ * @brief A single deferred log call site. Created statically by the H*_FAST macros.
+ * On first use the format string is parsed once and the site gets an id, after that
+ * each call only copies its raw arguments into the log queue.
+ */
+typedef struct log_site {
+    // The (static) format string of the call site.
+    const char* format;
+    // Assigned on registration, 0 until then.
+    u32 id;
+    // Registration state, managed by the logger.
+    u8 state;
+    u8 arg_count;
+    u8 arg_types[LOG_DEFERRED_MAX_ARGS];
+    // Offset in format right after each conversion specifier.
+    u16 arg_ends[LOG_DEFERRED_MAX_ARGS];
+    // Offset in format of each conversion specifier's '%'.
+    u16 arg_starts[LOG_DEFERRED_MAX_ARGS];
+    // How each conversion can be written without printf, if at all.
+    u8 arg_fast[LOG_DEFERRED_MAX_ARGS];
+} log_site;
+
+/**
+ * @brief Records a log entry whose formatting is deferred to the log writer thread.
+ * Use the H*_FAST macros instead of calling this directly. Arguments are copied raw
+ * (strings are copied by value), so this is cheap enough for hot paths. Falls back to
+ * regular formatting if the logger isn't running or the format string uses '*' widths,
+ * %n or long double arguments.
+ *
+ * @param level The log level.
+ * @param site The static call site holding the format string.
+ */
+HAPI void logDeferred(log_level level, log_site* site, ...);
+
+// Logs a message through the deferred path from a static call site.
+#define HLOG_FAST(level, message, ...) {                    \
+        static log_site _log_site = {message};              \
+        logDeferred(level, &_log_site, ##__VA_ARGS__);      \
+    }
+
 //Logs a fatal-level message
 #define HFATAL(message, ...) logOutput(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
 
@@ -48,37 +140,55 @@ HAPI void logOutput(log_level level, const char* message, ...);
 #define HERROR(message, ...) logOutput(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
 #endif
 
+//Logs an error-level message, at most 5 times per second from the same call site
+#define HERROR_LIMITED(message, ...) HLOG_LIMITED(LOG_LEVEL_ERROR, 5, message, ##__VA_ARGS__)
+
 //*Optional Logs*
 #if LOG_WARNING_ENABLED == true
 //Logs a warning-level message
 #define HWARNING(message, ...) logOutput(LOG_LEVEL_WARNING, message, ##__VA_ARGS__);
+//Logs a warning-level message, formatting it on the log writer thread
+#define HWARNING_FAST(message, ...) HLOG_FAST(LOG_LEVEL_WARNING, message, ##__VA_ARGS__)
+//Logs a warning-level message, at most 5 times per second from the same call site
+#define HWARNING_LIMITED(message, ...) HLOG_LIMITED(LOG_LEVEL_WARNING, 5, message, ##__VA_ARGS__)
 #else
 //Does nothing when LOG_WARNING_ENABLED != 1
 #define HWARNING(message, ...)
+#define HWARNING_FAST(message, ...)
+#define HWARNING_LIMITED(message, ...)
 #endif
 
 #if LOG_INFO_ENABLED == true
 //Logs an info-level message
 #define HINFO(message, ...) logOutput(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+//Logs an info-level message, formatting it on the log writer thread
+#define HINFO_FAST(message, ...) HLOG_FAST(LOG_LEVEL_INFO, message, ##__VA_ARGS__)
 #else
 //Does nothing when LOG_INFO_ENABLED != 1
 #define HINFO(message, ...)
+#define HINFO_FAST(message, ...)
 #endif
 
 #if LOG_DEBUG_ENABLED == true
 //Logs a debug-level message
 #define HDEBUG(message, ...) logOutput(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+//Logs a debug-level message, formatting it on the log writer thread
+#define HDEBUG_FAST(message, ...) HLOG_FAST(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__)
 #else
 //Does nothing when LOG_DEBUG_ENABLED != 1
 #define HDEBUG(message, ...)
+#define HDEBUG_FAST(message, ...)
 #endif
 
 #if LOG_TRACE_ENABLED == true
 //Logs a trace-level message
 #define HTRACE(message, ...) logOutput(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+//Logs a trace-level message, formatting it on the log writer thread
+#define HTRACE_FAST(message, ...) HLOG_FAST(LOG_LEVEL_TRACE, message, ##__VA_ARGS__)
 #else
 //Does nothing when LOG_TRACE_ENABLED != 1
 #define HTRACE(message, ...)
+#define HTRACE_FAST(message, ...)
 #endif
 
 #ifdef __cplusplus
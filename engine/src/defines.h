@@ -115,4 +115,18 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #else
 #define HINLINE static inline
 #define HNOINLINE
+#endif
+
+// Alignment of a type or variable, in bytes.
+#ifdef _MSC_VER
+#define HALIGN(bytes) __declspec(align(bytes))
+#else
+#define HALIGN(bytes) __attribute__((aligned(bytes)))
+#endif
+
+// Gives every thread its own copy of a static variable.
+#ifdef _MSC_VER
+#define HTHREAD_LOCAL __declspec(thread)
+#else
+#define HTHREAD_LOCAL __thread
 #endif
\ No newline at end of file
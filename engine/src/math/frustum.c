@@ -0,0 +1,249 @@
+#include "math/frustum.h"
+
+#include "core/cpu.h"
+
+// Appends the indices of the set bits in visible_mask, without branching on them.
+HINLINE u32 append_visible(u32* out_visible, u32 visible_count, u32 first_index, u32 visible_mask, u32 lanes) {
+    for (u32 lane = 0; lane < lanes; ++lane) {
+        out_visible[visible_count] = first_index + lane;
+        visible_count += (visible_mask >> lane) & 1;
+    }
+    return visible_count;
+}
+
+#if defined(HUSE_SIMD)
+// The planes splat across lanes once, so each bound only costs multiplies and adds. Boxes also need the absolute normals.
+typedef struct frustum_lanes {
+    __m128 x[6];
+    __m128 y[6];
+    __m128 z[6];
+    __m128 w[6];
+    __m128 abs_x[6];
+    __m128 abs_y[6];
+    __m128 abs_z[6];
+} frustum_lanes;
+
+static void frustum_lanes_create(const frustum* f, frustum_lanes* out_lanes) {
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* plane = &f->planes[i];
+        out_lanes->x[i] = _mm_set1_ps(plane->x);
+        out_lanes->y[i] = _mm_set1_ps(plane->y);
+        out_lanes->z[i] = _mm_set1_ps(plane->z);
+        out_lanes->w[i] = _mm_set1_ps(plane->w);
+        out_lanes->abs_x[i] = _mm_set1_ps(habs(plane->x));
+        out_lanes->abs_y[i] = _mm_set1_ps(habs(plane->y));
+        out_lanes->abs_z[i] = _mm_set1_ps(habs(plane->z));
+    }
+}
+
+// Returns a mask of the lanes whose sphere (or box reaching radius towards each plane) is inside every plane.
+HINLINE u32 frustum_test4(const frustum_lanes* lanes, __m128 x, __m128 y, __m128 z, __m128 radius, __m128 extent_x, __m128 extent_y, __m128 extent_z, b8 boxes) {
+    __m128 outside = _mm_setzero_ps();
+    for (u32 i = 0; i < 6; ++i) {
+        __m128 distance = hsimd_madd(lanes->x[i], x, hsimd_madd(lanes->y[i], y, hsimd_madd(lanes->z[i], z, lanes->w[i])));
+        __m128 reach = radius;
+        if (boxes) {
+            reach = hsimd_madd(lanes->abs_x[i], extent_x, hsimd_madd(lanes->abs_y[i], extent_y, _mm_mul_ps(lanes->abs_z[i], extent_z)));
+        }
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+    }
+    return ~(u32)_mm_movemask_ps(outside) & 0xF;
+}
+
+static u32 cull_spheres_sse(const frustum* f, const sphere* spheres, u32 count, u32* out_visible, u32* visible_count) {
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // One sphere per register, transposed into center x, y, z and radius.
+        const f32* data = (const f32*)(spheres + i);
+        __m128 x = _mm_loadu_ps(data);
+        __m128 y = _mm_loadu_ps(data + 4);
+        __m128 z = _mm_loadu_ps(data + 8);
+        __m128 radius = _mm_loadu_ps(data + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, radius);
+        u32 mask = frustum_test4(&lanes, x, y, z, radius, radius, radius, radius, false);
+        *visible_count = append_visible(out_visible, *visible_count, i, mask, 4);
+    }
+    return i;
+}
+
+static u32 cull_aabbs_sse(const frustum* f, const aabb* boxes, u32 count, u32* out_visible, u32* visible_count) {
+    frustum_lanes lanes;
+    frustum_lanes_create(f, &lanes);
+    const __m128 half = _mm_set1_ps(0.5f);
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        /*
+         * 4 boxes are 24 floats: a0-a5 b0-b5 c0-c5 d0-d5. Boxes a and b go into (a0-a3), (b0-b3)
+         * and (a4 a5 b4 b5), c and d the same way, then a 4x4 transpose and 2 shuffles sort them
+         * into min x, y, z and max x, y, z.
+         */
+        const f32* data = (const f32*)(boxes + i);
+        __m128 a = _mm_loadu_ps(data);
+        __m128 ab = _mm_loadu_ps(data + 4);
+        __m128 b = _mm_loadu_ps(data + 8);
+        __m128 c = _mm_loadu_ps(data + 12);
+        __m128 cd = _mm_loadu_ps(data + 16);
+        __m128 d = _mm_loadu_ps(data + 20);
+        __m128 ab_tail = HSIMD_SHUFFLE(ab, b, 0, 1, 2, 3);
+        __m128 cd_tail = HSIMD_SHUFFLE(cd, d, 0, 1, 2, 3);
+        b = HSIMD_SHUFFLE(ab, b, 2, 3, 0, 1);
+        d = HSIMD_SHUFFLE(cd, d, 2, 3, 0, 1);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        __m128 max_y = HSIMD_SHUFFLE(ab_tail, cd_tail, 0, 2, 0, 2);
+        __m128 max_z = HSIMD_SHUFFLE(ab_tail, cd_tail, 1, 3, 1, 3);
+
+        __m128 x = _mm_mul_ps(_mm_add_ps(a, d), half);
+        __m128 y = _mm_mul_ps(_mm_add_ps(b, max_y), half);
+        __m128 z = _mm_mul_ps(_mm_add_ps(c, max_z), half);
+        __m128 extent_x = _mm_mul_ps(_mm_sub_ps(d, a), half);
+        __m128 extent_y = _mm_mul_ps(_mm_sub_ps(max_y, b), half);
+        __m128 extent_z = _mm_mul_ps(_mm_sub_ps(max_z, c), half);
+        u32 mask = frustum_test4(&lanes, x, y, z, x, extent_x, extent_y, extent_z, true);
+        *visible_count = append_visible(out_visible, *visible_count, i, mask, 4);
+    }
+    return i;
+}
+
+/*
+ * The AVX2 versions hold bounds i to i + 3 in the low halves and i + 4 to i + 7 in the high
+ * ones, so the shuffles above work unchanged within each half.
+ */
+HTARGET_AVX2 static inline __m256 load_halves(const f32* low, const f32* high) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+HTARGET_AVX2 static inline void transpose_halves(__m256* a, __m256* b, __m256* c, __m256* d) {
+    __m256 t0 = _mm256_unpacklo_ps(*a, *b);
+    __m256 t1 = _mm256_unpacklo_ps(*c, *d);
+    __m256 t2 = _mm256_unpackhi_ps(*a, *b);
+    __m256 t3 = _mm256_unpackhi_ps(*c, *d);
+    *a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    *b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    *c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    *d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// frustum_test4 for 8 lanes.
+HTARGET_AVX2 static inline u32 frustum_test8(const frustum* f, __m256 x, __m256 y, __m256 z, __m256 radius, __m256 extent_x, __m256 extent_y, __m256 extent_z, b8 boxes) {
+    __m256 outside = _mm256_setzero_ps();
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* plane = &f->planes[i];
+        __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane->x), x), _mm256_mul_ps(_mm256_set1_ps(plane->y), y)),
+                                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane->z), z), _mm256_set1_ps(plane->w)));
+        __m256 reach = radius;
+        if (boxes) {
+            reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(habs(plane->x)), extent_x), _mm256_mul_ps(_mm256_set1_ps(habs(plane->y)), extent_y)),
+                                  _mm256_mul_ps(_mm256_set1_ps(habs(plane->z)), extent_z));
+        }
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+    return ~(u32)_mm256_movemask_ps(outside) & 0xFF;
+}
+
+HTARGET_AVX2 static u32 cull_spheres_avx2(const frustum* f, const sphere* spheres, u32 count, u32* out_visible, u32* visible_count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const f32* data = (const f32*)(spheres + i);
+        __m256 x = load_halves(data, data + 16);
+        __m256 y = load_halves(data + 4, data + 20);
+        __m256 z = load_halves(data + 8, data + 24);
+        __m256 radius = load_halves(data + 12, data + 28);
+        transpose_halves(&x, &y, &z, &radius);
+        u32 mask = frustum_test8(f, x, y, z, radius, radius, radius, radius, false);
+        *visible_count = append_visible(out_visible, *visible_count, i, mask, 8);
+    }
+    return i;
+}
+
+HTARGET_AVX2 static u32 cull_aabbs_avx2(const frustum* f, const aabb* boxes, u32 count, u32* out_visible, u32* visible_count) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // See cull_aabbs_sse.
+        const f32* data = (const f32*)(boxes + i);
+        __m256 a = load_halves(data, data + 24);
+        __m256 ab = load_halves(data + 4, data + 28);
+        __m256 b = load_halves(data + 8, data + 32);
+        __m256 c = load_halves(data + 12, data + 36);
+        __m256 cd = load_halves(data + 16, data + 40);
+        __m256 d = load_halves(data + 20, data + 44);
+        __m256 ab_tail = _mm256_shuffle_ps(ab, b, _MM_SHUFFLE(3, 2, 1, 0));
+        __m256 cd_tail = _mm256_shuffle_ps(cd, d, _MM_SHUFFLE(3, 2, 1, 0));
+        b = _mm256_shuffle_ps(ab, b, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm256_shuffle_ps(cd, d, _MM_SHUFFLE(1, 0, 3, 2));
+        transpose_halves(&a, &b, &c, &d);
+        __m256 max_y = _mm256_shuffle_ps(ab_tail, cd_tail, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 max_z = _mm256_shuffle_ps(ab_tail, cd_tail, _MM_SHUFFLE(3, 1, 3, 1));
+
+        __m256 x = _mm256_mul_ps(_mm256_add_ps(a, d), half);
+        __m256 y = _mm256_mul_ps(_mm256_add_ps(b, max_y), half);
+        __m256 z = _mm256_mul_ps(_mm256_add_ps(c, max_z), half);
+        __m256 extent_x = _mm256_mul_ps(_mm256_sub_ps(d, a), half);
+        __m256 extent_y = _mm256_mul_ps(_mm256_sub_ps(max_y, b), half);
+        __m256 extent_z = _mm256_mul_ps(_mm256_sub_ps(max_z, c), half);
+        u32 mask = frustum_test8(f, x, y, z, x, extent_x, extent_y, extent_z, true);
+        *visible_count = append_visible(out_visible, *visible_count, i, mask, 8);
+    }
+    return i;
+}
+#endif
+
+u32 frustum_cull_spheres(const frustum* f, const sphere* spheres, u32 count, u32* out_visible) {
+    u32 visible_count = 0;
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (cpu_get_features() & CPU_FEATURE_AVX2) {
+        i = cull_spheres_avx2(f, spheres, count, out_visible, &visible_count);
+    } else {
+        i = cull_spheres_sse(f, spheres, count, out_visible, &visible_count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_visible[visible_count] = i;
+        visible_count += frustum_intersects_sphere(f, spheres[i]) ? 1 : 0;
+    }
+    return visible_count;
+}
+
+u32 frustum_cull_aabbs(const frustum* f, const aabb* boxes, u32 count, u32* out_visible) {
+    u32 visible_count = 0;
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (cpu_get_features() & CPU_FEATURE_AVX2) {
+        i = cull_aabbs_avx2(f, boxes, count, out_visible, &visible_count);
+    } else {
+        i = cull_aabbs_sse(f, boxes, count, out_visible, &visible_count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_visible[visible_count] = i;
+        visible_count += frustum_intersects_aabb(f, boxes[i]) ? 1 : 0;
+    }
+    return visible_count;
+}
+
+// The point where three planes meet (n1.p + d1 = 0 and so on).
+static vec3 planes_intersection(vec4 a, vec4 b, vec4 c) {
+    vec3 normal_a = vec3_create(a.x, a.y, a.z);
+    vec3 normal_b = vec3_create(b.x, b.y, b.z);
+    vec3 normal_c = vec3_create(c.x, c.y, c.z);
+    vec3 bc = vec3_cross(normal_b, normal_c);
+    vec3 ca = vec3_cross(normal_c, normal_a);
+    vec3 ab = vec3_cross(normal_a, normal_b);
+    f32 scale = -1.0f / vec3_dot(normal_a, bc);
+    return vec3_mul_scalar(vec3_add(vec3_add(vec3_mul_scalar(bc, a.w), vec3_mul_scalar(ca, b.w)), vec3_mul_scalar(ab, c.w)), scale);
+}
+
+aabb frustum_bounds(const frustum* f) {
+    aabb result;
+    for (u32 i = 0; i < 8; ++i) {
+        vec4 side = f->planes[(i & 1) ? FRUSTUM_PLANE_RIGHT : FRUSTUM_PLANE_LEFT];
+        vec4 height = f->planes[(i & 2) ? FRUSTUM_PLANE_TOP : FRUSTUM_PLANE_BOTTOM];
+        vec4 depth = f->planes[(i & 4) ? FRUSTUM_PLANE_FAR : FRUSTUM_PLANE_NEAR];
+        vec3 corner = planes_intersection(side, height, depth);
+        result = i == 0 ? aabb_create(corner, corner) : aabb_union(result, aabb_create(corner, corner));
+    }
+    return result;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "defines.h"
+#include "math/hmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Order of the planes in a frustum.
+typedef enum frustumPlane {
+    FRUSTUM_PLANE_LEFT,
+    FRUSTUM_PLANE_RIGHT,
+    FRUSTUM_PLANE_BOTTOM,
+    FRUSTUM_PLANE_TOP,
+    FRUSTUM_PLANE_NEAR,
+    FRUSTUM_PLANE_FAR
+} frustumPlane;
+
+/**
+ * @brief Extracts the frustum planes from a combined view and projection matrix (Gribb & Hartmann).
+ *
+ * @param view_projection mat4_mul(view, projection). The near plane assumes a -1 to 1 depth
+ * range like mat4_perspective, wich is never tighter than a 0 to 1 one.
+ * @return The frustum, with normalized planes.
+ */
+HINLINE frustum frustum_from_matrix(mat4 view_projection) {
+    // Points are row vectors, so clip space coordinate i comes from column i.
+    const f32* m = view_projection.data;
+    vec4 x = vec4_create(m[0], m[4], m[8], m[12]);
+    vec4 y = vec4_create(m[1], m[5], m[9], m[13]);
+    vec4 z = vec4_create(m[2], m[6], m[10], m[14]);
+    vec4 w = vec4_create(m[3], m[7], m[11], m[15]);
+
+    frustum result;
+    result.planes[FRUSTUM_PLANE_LEFT] = vec4_add(w, x);
+    result.planes[FRUSTUM_PLANE_RIGHT] = vec4_sub(w, x);
+    result.planes[FRUSTUM_PLANE_BOTTOM] = vec4_add(w, y);
+    result.planes[FRUSTUM_PLANE_TOP] = vec4_sub(w, y);
+    result.planes[FRUSTUM_PLANE_NEAR] = vec4_add(w, z);
+    result.planes[FRUSTUM_PLANE_FAR] = vec4_sub(w, z);
+    for (u32 i = 0; i < 6; ++i) {
+        vec4* plane = &result.planes[i];
+        f32 inverse_length = 1.0f / hsqrt_inline(plane->x * plane->x + plane->y * plane->y + plane->z * plane->z);
+        plane->x *= inverse_length;
+        plane->y *= inverse_length;
+        plane->z *= inverse_length;
+        plane->w *= inverse_length;
+    }
+    return result;
+}
+
+/**
+ * @brief Indicates if a sphere is at least partly inside the frustum. May report spheres
+ * just outside a corner as inside, wich only costs drawing something that gets clipped.
+ *
+ * @param f A pointer to the frustum.
+ * @param bounds The sphere.
+ * @return True if the sphere may be visible, otherwise false.
+ */
+HINLINE b8 frustum_intersects_sphere(const frustum* f, sphere bounds) {
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* plane = &f->planes[i];
+        f32 distance = plane->x * bounds.center.x + plane->y * bounds.center.y + plane->z * bounds.center.z + plane->w;
+        if (distance < -bounds.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Indicates if a box is at least partly inside the frustum. Conservative in the same
+ * way as frustum_intersects_sphere.
+ *
+ * @param f A pointer to the frustum.
+ * @param bounds The box.
+ * @return True if the box may be visible, otherwise false.
+ */
+HINLINE b8 frustum_intersects_aabb(const frustum* f, aabb bounds) {
+    vec3 center = vec3_mul_scalar(vec3_add(bounds.min, bounds.max), 0.5f);
+    vec3 extents = vec3_mul_scalar(vec3_sub(bounds.max, bounds.min), 0.5f);
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* plane = &f->planes[i];
+        f32 distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+        // How far the box reaches towards the plane normal.
+        f32 radius = habs(plane->x) * extents.x + habs(plane->y) * extents.y + habs(plane->z) * extents.z;
+        if (distance < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The same test as frustum_intersects_aabb, that also tells boxes entirely inside apart.
+ *
+ * @param f A pointer to the frustum.
+ * @param bounds The box.
+ * @param out_inside Set to true if the box is inside every plane. Only written when the box may be visible.
+ * @return True if the box may be visible, otherwise false.
+ */
+HINLINE b8 frustum_classify_aabb(const frustum* f, aabb bounds, b8* out_inside) {
+    vec3 center = vec3_mul_scalar(vec3_add(bounds.min, bounds.max), 0.5f);
+    vec3 extents = vec3_mul_scalar(vec3_sub(bounds.max, bounds.min), 0.5f);
+    b8 inside = true;
+    for (u32 i = 0; i < 6; ++i) {
+        const vec4* plane = &f->planes[i];
+        f32 distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+        f32 radius = habs(plane->x) * extents.x + habs(plane->y) * extents.y + habs(plane->z) * extents.z;
+        if (distance < -radius) {
+            return false;
+        }
+        inside = inside && distance >= radius;
+    }
+    *out_inside = inside;
+    return true;
+}
+
+/**
+ * @brief The box around the 8 corners of a frustum, where each 3 planes meet.
+ *
+ * @param f A pointer to the frustum. Its far plane must not be at infinity.
+ * @return The bounding box.
+ */
+HAPI aabb frustum_bounds(const frustum* f);
+
+/**
+ * Tests many spheres against a frustum, 4 or 8 at a time (SSE or AVX2).
+ * @param f A pointer to the frustum.
+ * @param spheres The bounds to be tested.
+ * @param count The amount of spheres.
+ * @param out_visible Receives the indices of the spheres that may be visible, in order. Needs room for count indices.
+ * @returns The amount of indices written to out_visible.
+ */
+HAPI u32 frustum_cull_spheres(const frustum* f, const sphere* spheres, u32 count, u32* out_visible);
+
+// The same as frustum_cull_spheres for boxes.
+HAPI u32 frustum_cull_aabbs(const frustum* f, const aabb* boxes, u32 count, u32* out_visible);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,15 +1,19 @@
 #include "math/hmath.h"
+#include "math/hrandom.h"
 #include "platform/platform.h"
 
 #include <math.h>
-#include <stdlib.h>
 
 // ****************************************************************** //
 // *  Note that this are here in order to prevent having to import  * //
 // *  the entire <math.h> / <cmath> everywhere.                     * //
 // ****************************************************************** //
 
-static b8 rand_seeded = false;
+// Generator behind hrandom and the rest, one per thread so nothing is shared or locked.
+static HTHREAD_LOCAL random_state thread_random_state;
+static HTHREAD_LOCAL b8 thread_random_seeded;
+// Threads that seeded their generator so far.
+static u64 threads_seeded;
 
 f32 hsin(f32 x) {
     return sinf(x);
@@ -35,30 +39,37 @@ f32 hpow(f32 x, f32 e) {
     return pow(x, e);
 }
 
-f32 habs(f32 x) {
-    return fabsf(x);
+// Seeds the calling thread's generator the first time it's used, unless hrandom_seed did already.
+static random_state* thread_random() {
+    if (!thread_random_seeded) {
+        // Threads starting in the same tick still get different seeds from the counter.
+        f64 now = platformGetAbsoluteTime();
+        u64 time_bits;
+        HcopyMemory(&time_bits, &now, sizeof(u64));
+        u64 thread_number = __atomic_add_fetch(&threads_seeded, 1, __ATOMIC_RELAXED);
+        random_seed(&thread_random_state, time_bits ^ (thread_number * 0x9E3779B97F4A7C15ull));
+        thread_random_seeded = true;
+    }
+    return &thread_random_state;
+}
+
+void hrandom_seed(u64 seed) {
+    random_seed(&thread_random_state, seed);
+    thread_random_seeded = true;
 }
 
 i32 hrandom() {
-    if (!rand_seeded) {
-        srand((u32)platformGetAbsoluteTime());
-        rand_seeded = true;
-    }
-    return rand();
+    return (i32)(random_u32(thread_random()) >> 1);
 }
 
 i32 hrandomInRange(i32 min, i32 max) {
-    if (!rand_seeded) {
-        srand((u32)platformGetAbsoluteTime());
-        rand_seeded = true;
-    }
-    return (rand() % (max - min + 1)) + min;
+    return random_range_i32(thread_random(), min, max);
 }
 
 f32 fhrandom() {
-    return (float)hrandom() / (f32)RAND_MAX;
+    return random_f32(thread_random());
 }
 
 f32 fhrandomInRange(f32 min, f32 max) {
-    return min + ((float)hrandom() / ((f32)RAND_MAX / (max - min)));
-}
\ No newline at end of file
+    return random_f32_range(thread_random(), min, max);
+}
@@ -10,17 +10,17 @@ extern "C" {
 #include "memory/hmemory.h"
 
 #define H_PI 3.14159265358979323846f
-#define H_PI_2 2.0f * H_PI
-#define H_HALF_PI 0.5f * H_PI
-#define H_QUARTER_PI 0.25f * H_PI
-#define H_ONE_OVER_PI 1.0f / H_PI
-#define H_ONE_OVER_TWO_PI 1.0f / H_PI_2
+#define H_PI_2 (2.0f * H_PI)
+#define H_HALF_PI (0.5f * H_PI)
+#define H_QUARTER_PI (0.25f * H_PI)
+#define H_ONE_OVER_PI (1.0f / H_PI)
+#define H_ONE_OVER_TWO_PI (1.0f / H_PI_2)
 #define H_SQRT_TWO 1.41421356237309504880f
 #define H_SQRT_THREE 1.73205080756887729352f
 #define H_SQRT_ONE_OVER_TWO 0.70710678118654752440f
 #define H_SQRT_ONE_OVER_THREE 0.57735026918962576450f
-#define H_DEG2RAD_MULTIPLIER H_PI / 180.0f
-#define H_RAD2DEG_MULTIPLIER 180.0f / H_PI
+#define H_DEG2RAD_MULTIPLIER (H_PI / 180.0f)
+#define H_RAD2DEG_MULTIPLIER (180.0f / H_PI)
 
 // The multiplier to convert seconds to miliseconds.
 #define H_SEC_TO_MS_MULTIPLIER 1000.0f
@@ -43,7 +43,11 @@ HAPI f32 htan(f32 x);
 HAPI f32 hacos(f32 x);
 HAPI f32 hsqrt(f32 x);
 HAPI f32 hpow(f32 x, f32 e);
-HAPI f32 habs(f32 x);
+
+// Inline since it's a single instruction, called from most comparisons below.
+HINLINE f32 habs(f32 x) {
+    return __builtin_fabsf(x);
+}
 
 /**
  * Indicates if the value is a power of 2. 0 is considered _not_ as a power of 2.
@@ -54,12 +58,281 @@ HINLINE b8 isPowerOf2(u64 val) {
     return (val != 0) && ((val & (val -1)) == 0); 
 }
 
+/*
+ * Random numbers from a generator owned by the calling thread (see math/hrandom.h), seeded
+ * from the clock on first use. Systems that need their own sequence should keep a
+ * random_state instead.
+ */
+
+/**
+ * Seeds the calling thread's generator, so the values after it repeat on every run.
+ * @param seed The seed.
+ */
+HAPI void hrandom_seed(u64 seed);
+
+// Obtains a value in [0, 2^31).
 HAPI i32 hrandom();
+// Obtains a value in [min, max], both included. Evenly distributed.
 HAPI i32 hrandomInRange(i32 min, i32 max);
 
+// Obtains a value in [0, 1).
 HAPI f32 fhrandom();
+// Obtains a value in [min, max).
 HAPI f32 fhrandomInRange(f32 min, f32 max);
 
+#if defined(HUSE_SIMD)
+// Rearranges the lanes of v, e.g. HSIMD_SWIZZLE(v, 3, 2, 1, 0) reverses them.
+#define HSIMD_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+// Takes lanes x and y from a, and z and w from b.
+#define HSIMD_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+
+// Returns the dot product of a and b in every lane.
+HINLINE __m128 hsimd_dot4(__m128 a, __m128 b) {
+#if defined(__SSE4_1__)
+    return _mm_dp_ps(a, b, 0xFF);
+#else
+    __m128 products = _mm_mul_ps(a, b);
+    __m128 sums = _mm_add_ps(products, HSIMD_SWIZZLE(products, 1, 0, 3, 2));
+    return _mm_add_ps(sums, HSIMD_SWIZZLE(sums, 2, 3, 0, 1));
+#endif
+}
+
+// Returns a * b + c, fused if the build targets FMA.
+HINLINE __m128 hsimd_madd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+/**
+ * The same as hsqrt, but inlined instead of calling into libm where SSE has an exact square root.
+ * @param x The value.
+ * @returns The square root of x.
+ */
+HINLINE f32 hsqrt_inline(f32 x) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(x)));
+#else
+    return hsqrt(x);
+#endif
+}
+
+// ******************************** //
+// **    Fast approximations     ** //
+// ******************************** //
+
+/*
+ * Inline replacements for hsin, hcos and 1 / hsqrt in hot loops, where a libm call per value
+ * costs more than the math itself. sin and cos are an odd polynomial after reducing the angle
+ * to [-pi/2, pi/2], they stay accurate for angles up to a few thousand radians and get worse
+ * past that, since the reduction is done in f32.
+ */
+
+typedef enum hmathPrecision {
+    // Max error around 7e-5, for visuals and animation.
+    HMATH_PRECISION_LOW,
+    // Max error around 2e-7, close to what f32 can hold.
+    HMATH_PRECISION_HIGH
+} hmathPrecision;
+
+// pi split in 3 parts so the reduction x - k * pi loses no bits to rounding for small k.
+#define H_FAST_PI_A 3.140625f
+#define H_FAST_PI_B 9.67502593994140625e-4f
+#define H_FAST_PI_C 1.509957990978376432e-7f
+
+// Minimax coefficients for sin(r) = r * (c1 + c3 r^2 + c5 r^4 ...) over [-pi/2, pi/2].
+#define H_FAST_SIN_LOW_C1 9.996967731e-01f
+#define H_FAST_SIN_LOW_C3 -1.656730793e-01f
+#define H_FAST_SIN_LOW_C5 7.514377180e-03f
+#define H_FAST_SIN_HIGH_C1 9.999999766e-01f
+#define H_FAST_SIN_HIGH_C3 -1.666664763e-01f
+#define H_FAST_SIN_HIGH_C5 8.332899823e-03f
+#define H_FAST_SIN_HIGH_C7 -1.980089776e-04f
+#define H_FAST_SIN_HIGH_C9 2.590488501e-06f
+
+#if defined(HUSE_SIMD)
+// sin of 4 values in [-pi/2, pi/2].
+HINLINE __m128 hsimd_sin4_reduced(__m128 r, hmathPrecision precision) {
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p;
+    if (precision == HMATH_PRECISION_LOW) {
+        p = hsimd_madd(r2, _mm_set1_ps(H_FAST_SIN_LOW_C5), _mm_set1_ps(H_FAST_SIN_LOW_C3));
+        p = hsimd_madd(r2, p, _mm_set1_ps(H_FAST_SIN_LOW_C1));
+    } else {
+        p = hsimd_madd(r2, _mm_set1_ps(H_FAST_SIN_HIGH_C9), _mm_set1_ps(H_FAST_SIN_HIGH_C7));
+        p = hsimd_madd(r2, p, _mm_set1_ps(H_FAST_SIN_HIGH_C5));
+        p = hsimd_madd(r2, p, _mm_set1_ps(H_FAST_SIN_HIGH_C3));
+        p = hsimd_madd(r2, p, _mm_set1_ps(H_FAST_SIN_HIGH_C1));
+    }
+    return _mm_mul_ps(r, p);
+}
+
+// Reduces x by k * pi, where k is already rounded.
+HINLINE __m128 hsimd_reduce4(__m128 x, __m128 k) {
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(H_FAST_PI_A)));
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(H_FAST_PI_B)));
+    return _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(H_FAST_PI_C)));
+}
+
+// hsin_fast for 4 values.
+HINLINE __m128 hsimd_sin4(__m128 x, hmathPrecision precision) {
+    // Rounds to nearest, flipping the sign for odd k.
+    __m128i k = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.318309886f)));
+    __m128 r = hsimd_reduce4(x, _mm_cvtepi32_ps(k));
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(k, 31));
+    return _mm_xor_ps(hsimd_sin4_reduced(r, precision), sign);
+}
+
+// hcos_fast for 4 values.
+HINLINE __m128 hsimd_cos4(__m128 x, hmathPrecision precision) {
+    // Rounding x / pi - 1/2 to nearest gives k, the reduction is by k + 1/2.
+    __m128i k = _mm_cvtps_epi32(_mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(0.318309886f)), _mm_set1_ps(0.5f)));
+    __m128 r = hsimd_reduce4(x, _mm_add_ps(_mm_cvtepi32_ps(k), _mm_set1_ps(0.5f)));
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(k, _mm_set1_epi32(1)), 31));
+    return _mm_xor_ps(hsimd_sin4_reduced(r, precision), sign);
+}
+
+// hrsqrt for 4 values.
+HINLINE __m128 hsimd_rsqrt4(__m128 x) {
+    __m128 estimate = _mm_rsqrt_ps(x);
+    __m128 refine = _mm_mul_ps(_mm_mul_ps(x, estimate), estimate);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), estimate), _mm_sub_ps(_mm_set1_ps(3.0f), refine));
+}
+
+/*
+ * The same for 8 values. Only usable from functions compiled for AVX2 (HTARGET_AVX2),
+ * after checking CPU_FEATURE_AVX2.
+ */
+HTARGET_AVX2 static inline __m256 hsimd_sin8_reduced(__m256 r, hmathPrecision precision) {
+    __m256 r2 = _mm256_mul_ps(r, r);
+    __m256 p;
+    if (precision == HMATH_PRECISION_LOW) {
+        p = _mm256_add_ps(_mm256_mul_ps(r2, _mm256_set1_ps(H_FAST_SIN_LOW_C5)), _mm256_set1_ps(H_FAST_SIN_LOW_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(H_FAST_SIN_LOW_C1));
+    } else {
+        p = _mm256_add_ps(_mm256_mul_ps(r2, _mm256_set1_ps(H_FAST_SIN_HIGH_C9)), _mm256_set1_ps(H_FAST_SIN_HIGH_C7));
+        p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(H_FAST_SIN_HIGH_C5));
+        p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(H_FAST_SIN_HIGH_C3));
+        p = _mm256_add_ps(_mm256_mul_ps(r2, p), _mm256_set1_ps(H_FAST_SIN_HIGH_C1));
+    }
+    return _mm256_mul_ps(r, p);
+}
+
+HTARGET_AVX2 static inline __m256 hsimd_reduce8(__m256 x, __m256 k) {
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(H_FAST_PI_A)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(H_FAST_PI_B)));
+    return _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(H_FAST_PI_C)));
+}
+
+HTARGET_AVX2 static inline __m256 hsimd_sin8(__m256 x, hmathPrecision precision) {
+    __m256i k = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(0.318309886f)));
+    __m256 r = hsimd_reduce8(x, _mm256_cvtepi32_ps(k));
+    __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(k, 31));
+    return _mm256_xor_ps(hsimd_sin8_reduced(r, precision), sign);
+}
+
+HTARGET_AVX2 static inline __m256 hsimd_cos8(__m256 x, hmathPrecision precision) {
+    __m256i k = _mm256_cvtps_epi32(_mm256_sub_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.318309886f)), _mm256_set1_ps(0.5f)));
+    __m256 r = hsimd_reduce8(x, _mm256_add_ps(_mm256_cvtepi32_ps(k), _mm256_set1_ps(0.5f)));
+    __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(k, _mm256_set1_epi32(1)), 31));
+    return _mm256_xor_ps(hsimd_sin8_reduced(r, precision), sign);
+}
+
+HTARGET_AVX2 static inline __m256 hsimd_rsqrt8(__m256 x) {
+    __m256 estimate = _mm256_rsqrt_ps(x);
+    __m256 refine = _mm256_mul_ps(_mm256_mul_ps(x, estimate), estimate);
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), estimate), _mm256_sub_ps(_mm256_set1_ps(3.0f), refine));
+}
+#endif
+
+#if !defined(HUSE_SIMD)
+// Rounds to the nearest integer without branching, the sign of x changes too often to predict. Needs |x| < 2^22.
+HINLINE f32 hround_fast(f32 x) {
+    // Adding 1.5 * 2^23 leaves no bits for the fraction.
+    return (x + 12582912.0f) - 12582912.0f;
+}
+
+// sin of r in [-pi/2, pi/2].
+HINLINE f32 hsin_reduced(f32 r, hmathPrecision precision) {
+    f32 r2 = r * r;
+    if (precision == HMATH_PRECISION_LOW) {
+        return r * (H_FAST_SIN_LOW_C1 + r2 * (H_FAST_SIN_LOW_C3 + r2 * H_FAST_SIN_LOW_C5));
+    }
+    return r * (H_FAST_SIN_HIGH_C1 + r2 * (H_FAST_SIN_HIGH_C3 + r2 * (H_FAST_SIN_HIGH_C5 + r2 * (H_FAST_SIN_HIGH_C7 + r2 * H_FAST_SIN_HIGH_C9))));
+}
+
+// Flips the sign of value when k is odd.
+HINLINE f32 hflip_sign_odd(f32 value, i32 k) {
+    union {
+        f32 f;
+        u32 i;
+    } bits = {value};
+    bits.i ^= (u32)k << 31;
+    return bits.f;
+}
+#endif
+
+/**
+ * Approximates the sine of an angle, without calling into libm.
+ * @param x The angle in radians.
+ * @param precision How accurate the result needs to be.
+ * @returns The approximate sine of x.
+ */
+HINLINE f32 hsin_fast(f32 x, hmathPrecision precision) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(hsimd_sin4(_mm_set_ss(x), precision));
+#else
+    // x = k * pi + r, and sin(k * pi + r) is sin(r) with the sign flipped for odd k.
+    f32 k = hround_fast(x * 0.318309886f);
+    f32 r = ((x - k * H_FAST_PI_A) - k * H_FAST_PI_B) - k * H_FAST_PI_C;
+    return hflip_sign_odd(hsin_reduced(r, precision), (i32)k);
+#endif
+}
+
+/**
+ * Approximates the cosine of an angle, without calling into libm.
+ * @param x The angle in radians.
+ * @param precision How accurate the result needs to be.
+ * @returns The approximate cosine of x.
+ */
+HINLINE f32 hcos_fast(f32 x, hmathPrecision precision) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(hsimd_cos4(_mm_set_ss(x), precision));
+#else
+    // x = (k + 1/2) * pi + r, and cos((k + 1/2) * pi + r) is -sin(r) with the sign flipped for odd k.
+    f32 k = hround_fast(x * 0.318309886f - 0.5f);
+    f32 half_k = k + 0.5f;
+    f32 r = ((x - half_k * H_FAST_PI_A) - half_k * H_FAST_PI_B) - half_k * H_FAST_PI_C;
+    return hflip_sign_odd(hsin_reduced(r, precision), (i32)k + 1);
+#endif
+}
+
+/**
+ * Approximates 1 / sqrt(x) with a relative error around 2e-7. Cheaper than a square root
+ * followed by a division, so normalizing multiplies by it.
+ * @param x The value, should be positive. 0 gives NaN instead of infinity.
+ * @returns The approximate reciprocal square root of x.
+ */
+HINLINE f32 hrsqrt(f32 x) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(hsimd_rsqrt4(_mm_set_ss(x)));
+#else
+    // Bit level first guess, wich needs 3 Newton steps where the hardware estimate needs 1.
+    union {
+        f32 f;
+        u32 i;
+    } bits = {x};
+    bits.i = 0x5F375A86 - (bits.i >> 1);
+    f32 y = bits.f;
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y * (1.5f - 0.5f * x * y * y);
+#endif
+}
+
 // ---------------------------------------
 // Vector 2 (vec2)
 // ---------------------------------------
@@ -143,8 +416,8 @@ HINLINE vec2 vec2_add(vec2 vector_a, vec2 vector_b) {
  */
 HINLINE vec2 vec2_sub(vec2 vector_a, vec2 vector_b) {
     return (vec2){
-        vector_a.x + vector_b.x,
-        vector_a.y + vector_b.y
+        vector_a.x - vector_b.x,
+        vector_a.y - vector_b.y
     };
 }
 
@@ -195,7 +468,7 @@ HINLINE f32 vec2_length_squared(vec2 vector) {
  */
 HINLINE f32 vec2_length(vec2 vector) {
     // Uses piragora's algorithm.
-    return hsqrt(vec2_length_squared(vector));
+    return hsqrt_inline(vec2_length_squared(vector));
 }
 
 /**
@@ -204,9 +477,9 @@ HINLINE f32 vec2_length(vec2 vector) {
  * @param vector A pointer to the vector to be normalized.
  */
 HINLINE void vec2_normalize(vec2* vector) {
-    const f32 length = vec2_length(*vector);
-    vector->x /= length;
-    vector->y /= length;
+    const f32 inverse_length = hrsqrt(vec2_length_squared(*vector));
+    vector->x *= inverse_length;
+    vector->y *= inverse_length;
 }
 
 /**
@@ -436,7 +709,7 @@ HINLINE f32 vec3_length_squared(vec3 vector) {
  * @return The length.
  */
 HINLINE f32 vec3_length(vec3 vector) {
-    return hsqrt(vec3_length_squared(vector));
+    return hsqrt_inline(vec3_length_squared(vector));
 }
 
 /**
@@ -445,10 +718,10 @@ HINLINE f32 vec3_length(vec3 vector) {
  * @param vector A pointer to the vector to be normalized.
  */
 HINLINE void vec3_normalize(vec3* vector) {
-    const f32 length = vec3_length(*vector);
-    vector->x /= length;
-    vector->y /= length;
-    vector->z /= length;
+    const f32 inverse_length = hrsqrt(vec3_length_squared(*vector));
+    vector->x *= inverse_length;
+    vector->y *= inverse_length;
+    vector->z *= inverse_length;
 }
 
 /**
@@ -580,9 +853,9 @@ HINLINE vec3 vec4_to_vec3(vec4 vector) {
  */
 HINLINE vec4 vec4_from_vec3(vec3 vector, f32 w) {
 #if defined(HUSE_SIMD)
-    vec4 vector;
-    vector.data = _mm_setr_ps(x, y, z, w);
-    return vector;
+    vec4 result;
+    result.data = _mm_setr_ps(vector.x, vector.y, vector.z, w);
+    return result;
 #else
     return (vec4){vector.x, vector.y, vector.z, w};
 #endif
@@ -611,9 +884,13 @@ HINLINE vec4 vec4_one() {
  */
 HINLINE vec4 vec4_add(vec4 vector_a, vec4 vector_b) {
     vec4 result;
+#if defined(HUSE_SIMD)
+    result.data = _mm_add_ps(vector_a.data, vector_b.data);
+#else
     for (u64 i = 0; i < 4; i++) {
         result.elements[i] = vector_a.elements[i] + vector_b.elements[i];
     }
+#endif
     return result;
 }
 
@@ -626,9 +903,13 @@ HINLINE vec4 vec4_add(vec4 vector_a, vec4 vector_b) {
  */
 HINLINE vec4 vec4_sub(vec4 vector_a, vec4 vector_b) {
     vec4 result;
+#if defined(HUSE_SIMD)
+    result.data = _mm_sub_ps(vector_a.data, vector_b.data);
+#else
     for (u64 i = 0; i < 4; i++) {
         result.elements[i] = vector_a.elements[i] - vector_b.elements[i];
     }
+#endif
     return result;
 }
 
@@ -641,9 +922,13 @@ HINLINE vec4 vec4_sub(vec4 vector_a, vec4 vector_b) {
  */
 HINLINE vec4 vec4_mul(vec4 vector_a, vec4 vector_b) {
     vec4 result;
+#if defined(HUSE_SIMD)
+    result.data = _mm_mul_ps(vector_a.data, vector_b.data);
+#else
     for (u64 i = 0; i < 4; i++) {
         result.elements[i] = vector_a.elements[i] * vector_b.elements[i];
     }
+#endif
     return result;
 }
 
@@ -656,9 +941,13 @@ HINLINE vec4 vec4_mul(vec4 vector_a, vec4 vector_b) {
  */
 HINLINE vec4 vec4_div(vec4 vector_a, vec4 vector_b) {
     vec4 result;
+#if defined(HUSE_SIMD)
+    result.data = _mm_div_ps(vector_a.data, vector_b.data);
+#else
     for (u64 i = 0; i < 4; i++) {
         result.elements[i] = vector_a.elements[i] / vector_b.elements[i];
     }
+#endif
     return result;
 }
 
@@ -669,7 +958,11 @@ HINLINE vec4 vec4_div(vec4 vector_a, vec4 vector_b) {
  * @return The squared length.
  */
 HINLINE f32 vec4_length_squared(vec4 vector) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(hsimd_dot4(vector.data, vector.data));
+#else
     return vector.x * vector.x + vector.y * vector.y + vector.z * vector.z + vector.w * vector.w;
+#endif
 }
 
 /**
@@ -679,7 +972,7 @@ HINLINE f32 vec4_length_squared(vec4 vector) {
  * @return The length.
  */
 HINLINE f32 vec4_length(vec4 vector) {
-    return hsqrt(vec4_length_squared(vector));
+    return hsqrt_inline(vec4_length_squared(vector));
 }
 
 /**
@@ -688,11 +981,15 @@ HINLINE f32 vec4_length(vec4 vector) {
  * @param vector A pointer to the vector to be normalized.
  */
 HINLINE void vec4_normalize(vec4* vector) {
-    const f32 length = vec4_length(*vector);
-    vector->x /= length;
-    vector->y /= length;
-    vector->z /= length;
-    vector->w /= length;
+#if defined(HUSE_SIMD)
+    vector->data = _mm_mul_ps(vector->data, hsimd_rsqrt4(hsimd_dot4(vector->data, vector->data)));
+#else
+    const f32 inverse_length = hrsqrt(vec4_length_squared(*vector));
+    vector->x *= inverse_length;
+    vector->y *= inverse_length;
+    vector->z *= inverse_length;
+    vector->w *= inverse_length;
+#endif
 }
 
 /**
@@ -736,11 +1033,18 @@ HINLINE f32 vec4_dot_f32(
  */
 HINLINE mat4 mat4_identity() {
     mat4 matrix;
+#if defined(HUSE_SIMD)
+    matrix.rows[0] = _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    matrix.rows[1] = _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f);
+    matrix.rows[2] = _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f);
+    matrix.rows[3] = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+#else
     HzeroMemory(matrix.data, sizeof(f32) * 16);
     matrix.data[0] = 1.0f;
     matrix.data[5] = 1.0f;
     matrix.data[10] = 1.0f;
     matrix.data[15] = 1.0f;
+#endif
     return matrix;
 }
 
@@ -752,6 +1056,19 @@ HINLINE mat4 mat4_identity() {
  * @return The result of the matrix multiplication.
  */
 HINLINE mat4 mat4_mul(mat4 matrix_a, mat4 matrix_b) {
+#if defined(HUSE_SIMD)
+    // Each row of the result is matrix_b's rows weighted by the matching row of matrix_a.
+    mat4 result;
+    for (i32 i = 0; i < 4; i++) {
+        __m128 row = matrix_a.rows[i];
+        __m128 sum = _mm_mul_ps(HSIMD_SWIZZLE(row, 0, 0, 0, 0), matrix_b.rows[0]);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 1, 1, 1, 1), matrix_b.rows[1], sum);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 2, 2, 2, 2), matrix_b.rows[2], sum);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 3, 3, 3, 3), matrix_b.rows[3], sum);
+        result.rows[i] = sum;
+    }
+    return result;
+#else
     mat4 matrix = mat4_identity();
 
     const f32* ma_ptr = matrix_a.data;
@@ -770,6 +1087,7 @@ HINLINE mat4 mat4_mul(mat4 matrix_a, mat4 matrix_b) {
         ma_ptr += 4;
     }
     return matrix;
+#endif
 }
 
 /**
@@ -875,6 +1193,10 @@ HINLINE mat4 mat4_look_at(vec3 position, vec3 target, vec3 up) {
  * @return A transposed copy of the provided matrix.
  */
 HINLINE mat4 mat4_transposed(mat4 matrix) {
+#if defined(HUSE_SIMD)
+    _MM_TRANSPOSE4_PS(matrix.rows[0], matrix.rows[1], matrix.rows[2], matrix.rows[3]);
+    return matrix;
+#else
     mat4 out_matrix = mat4_identity();
 
     out_matrix.data[0] = matrix.data[0];
@@ -895,6 +1217,7 @@ HINLINE mat4 mat4_transposed(mat4 matrix) {
     out_matrix.data[15] = matrix.data[15];
 
     return out_matrix;
+#endif
 }
 
 /**
@@ -904,6 +1227,56 @@ HINLINE mat4 mat4_transposed(mat4 matrix) {
  * @return A inverted copy of the provided matrix.
  */
 HINLINE mat4 mat4_inverse(mat4 matrix) {
+#if defined(HUSE_SIMD)
+    // Block-wise inverse from the 2x2 sub matrices | A B |, each held in one register (row-major).
+    //                                              | C D |
+    // The inverse is 1/|M| * | X Y | with the adjugates X# = |D|A - B(D#C),  Y# = |B|C - D(A#B)#,
+    //                        | Z W |                     Z# = |C|B - A(D#C)#, W# = |A|D - C(A#B).
+    __m128 a = _mm_movelh_ps(matrix.rows[0], matrix.rows[1]);
+    __m128 b = _mm_movehl_ps(matrix.rows[1], matrix.rows[0]);
+    __m128 c = _mm_movelh_ps(matrix.rows[2], matrix.rows[3]);
+    __m128 d = _mm_movehl_ps(matrix.rows[3], matrix.rows[2]);
+
+    // Determinants of A, B, C and D.
+    __m128 determinants = _mm_sub_ps(
+        _mm_mul_ps(HSIMD_SHUFFLE(matrix.rows[0], matrix.rows[2], 0, 2, 0, 2), HSIMD_SHUFFLE(matrix.rows[1], matrix.rows[3], 1, 3, 1, 3)),
+        _mm_mul_ps(HSIMD_SHUFFLE(matrix.rows[0], matrix.rows[2], 1, 3, 1, 3), HSIMD_SHUFFLE(matrix.rows[1], matrix.rows[3], 0, 2, 0, 2)));
+    __m128 det_a = HSIMD_SWIZZLE(determinants, 0, 0, 0, 0);
+    __m128 det_b = HSIMD_SWIZZLE(determinants, 1, 1, 1, 1);
+    __m128 det_c = HSIMD_SWIZZLE(determinants, 2, 2, 2, 2);
+    __m128 det_d = HSIMD_SWIZZLE(determinants, 3, 3, 3, 3);
+
+    // D#C and A#B (adjugate times matrix).
+    __m128 d_c = _mm_sub_ps(_mm_mul_ps(HSIMD_SWIZZLE(d, 3, 3, 0, 0), c), _mm_mul_ps(HSIMD_SWIZZLE(d, 1, 1, 2, 2), HSIMD_SWIZZLE(c, 2, 3, 0, 1)));
+    __m128 a_b = _mm_sub_ps(_mm_mul_ps(HSIMD_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(HSIMD_SWIZZLE(a, 1, 1, 2, 2), HSIMD_SWIZZLE(b, 2, 3, 0, 1)));
+
+    // Matrix times matrix, B(D#C) and C(A#B).
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), _mm_add_ps(_mm_mul_ps(b, HSIMD_SWIZZLE(d_c, 0, 3, 0, 3)), _mm_mul_ps(HSIMD_SWIZZLE(b, 1, 0, 3, 2), HSIMD_SWIZZLE(d_c, 2, 1, 2, 1))));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), _mm_add_ps(_mm_mul_ps(c, HSIMD_SWIZZLE(a_b, 0, 3, 0, 3)), _mm_mul_ps(HSIMD_SWIZZLE(c, 1, 0, 3, 2), HSIMD_SWIZZLE(a_b, 2, 1, 2, 1))));
+    // Matrix times adjugate, D(A#B)# and A(D#C)#.
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), _mm_sub_ps(_mm_mul_ps(d, HSIMD_SWIZZLE(a_b, 3, 0, 3, 0)), _mm_mul_ps(HSIMD_SWIZZLE(d, 1, 0, 3, 2), HSIMD_SWIZZLE(a_b, 2, 1, 2, 1))));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), _mm_sub_ps(_mm_mul_ps(a, HSIMD_SWIZZLE(d_c, 3, 0, 3, 0)), _mm_mul_ps(HSIMD_SWIZZLE(a, 1, 0, 3, 2), HSIMD_SWIZZLE(d_c, 2, 1, 2, 1))));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C)).
+    __m128 trace = _mm_mul_ps(a_b, HSIMD_SWIZZLE(d_c, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, HSIMD_SWIZZLE(trace, 1, 0, 3, 2));
+    trace = _mm_add_ps(trace, HSIMD_SWIZZLE(trace, 2, 3, 0, 1));
+    __m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+
+    // The signs turn X#, Y#, Z# and W# back into adjugates once shuffled below.
+    __m128 inverse_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+    x = _mm_mul_ps(x, inverse_det);
+    y = _mm_mul_ps(y, inverse_det);
+    z = _mm_mul_ps(z, inverse_det);
+    w = _mm_mul_ps(w, inverse_det);
+
+    mat4 out_matrix;
+    out_matrix.rows[0] = HSIMD_SHUFFLE(x, y, 3, 1, 3, 1);
+    out_matrix.rows[1] = HSIMD_SHUFFLE(x, y, 2, 0, 2, 0);
+    out_matrix.rows[2] = HSIMD_SHUFFLE(z, w, 3, 1, 3, 1);
+    out_matrix.rows[3] = HSIMD_SHUFFLE(z, w, 2, 0, 2, 0);
+    return out_matrix;
+#else
     const f32* m = matrix.data;
 
     f32 t0 = m[10] * m[15];
@@ -959,6 +1332,7 @@ HINLINE mat4 mat4_inverse(mat4 matrix) {
     o[15] = d * ((t22 * m[10] + t16 * m[2] + t21 * m[6]) - (t20 * m[6] + t23 * m[10] + t17 * m[2]));
 
     return out_matrix;
+#endif
 }
 
 HINLINE mat4 mat4_translation(vec3 position) {
@@ -1135,15 +1509,23 @@ HINLINE quat quat_identify() {
 }
 
 HINLINE f32 quat_normal(quat q) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(_mm_sqrt_ss(hsimd_dot4(q.data, q.data)));
+#else
     return hsqrt(
         q.x * q.x +
         q.y * q.y +
         q.z * q.z +
         q.w * q.w
     );
+#endif
 }
 
 HINLINE quat quat_normalize(quat q) {
+#if defined(HUSE_SIMD)
+    q.data = _mm_mul_ps(q.data, hsimd_rsqrt4(hsimd_dot4(q.data, q.data)));
+    return q;
+#else
     f32 normal = quat_normal(q);
     
     return (quat){
@@ -1152,15 +1534,21 @@ HINLINE quat quat_normalize(quat q) {
         q.z / normal,
         q.w / normal
     };
+#endif
 }
 
 HINLINE quat quat_conjugate(quat q) {
+#if defined(HUSE_SIMD)
+    q.data = _mm_xor_ps(q.data, _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f));
+    return q;
+#else
     return (quat){
         -q.x,
         -q.y,
         -q.z,
         q.w
     };
+#endif
 }
 
 HINLINE quat quat_inverse(quat q) {
@@ -1170,6 +1558,19 @@ HINLINE quat quat_inverse(quat q) {
 HINLINE quat quat_mul(quat q_a, quat q_b) {
     quat quaternion;
 
+#if defined(HUSE_SIMD)
+    // The same sums as below, one component of q_a at a time.
+    __m128 a = q_a.data;
+    __m128 b = q_b.data;
+    __m128 sum = _mm_mul_ps(HSIMD_SWIZZLE(a, 3, 3, 3, 3), b);
+    __m128 b_wzyx = _mm_xor_ps(HSIMD_SWIZZLE(b, 3, 2, 1, 0), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+    sum = hsimd_madd(HSIMD_SWIZZLE(a, 0, 0, 0, 0), b_wzyx, sum);
+    __m128 b_zwxy = _mm_xor_ps(HSIMD_SWIZZLE(b, 2, 3, 0, 1), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+    sum = hsimd_madd(HSIMD_SWIZZLE(a, 1, 1, 1, 1), b_zwxy, sum);
+    __m128 b_yxwz = _mm_xor_ps(HSIMD_SWIZZLE(b, 1, 0, 3, 2), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+    quaternion.data = hsimd_madd(HSIMD_SWIZZLE(a, 2, 2, 2, 2), b_yxwz, sum);
+    return quaternion;
+#else
     quaternion.x = q_a.x * q_b.w +
                    q_a.y * q_b.z -
                    q_a.z * q_b.y +
@@ -1182,8 +1583,8 @@ HINLINE quat quat_mul(quat q_a, quat q_b) {
 
     quaternion.z = q_a.x * q_b.y -
                    q_a.y * q_b.x +
-                   q_a.z * q_b.z +
-                   q_a.w * q_b.w;
+                   q_a.z * q_b.w +
+                   q_a.w * q_b.z;
 
     quaternion.w = -q_a.x * q_b.x -
                    q_a.y * q_b.y -
@@ -1191,13 +1592,18 @@ HINLINE quat quat_mul(quat q_a, quat q_b) {
                    q_a.w * q_b.w;
 
     return quaternion;
+#endif
 }
 
 HINLINE f32 quat_dot(quat q_a, quat q_b) {
+#if defined(HUSE_SIMD)
+    return _mm_cvtss_f32(hsimd_dot4(q_a.data, q_b.data));
+#else
     return q_a.x * q_b.x +
            q_a.y * q_b.y +
            q_a.z * q_b.z +
            q_a.w * q_b.w;
+#endif
 }
 
 HINLINE mat4 quat_to_mat4(quat q) {
@@ -1222,30 +1628,21 @@ HINLINE mat4 quat_to_mat4(quat q) {
     return matrix;
 }
 
-// Calculates a rotation matrix based on the quaternion and the passed in center point.
+/**
+ * @brief Calculates a matrix that rotates like quat_to_mat4, but around center instead of the origin.
+ *
+ * @param q The rotation.
+ * @param center The point to rotate around, wich stays in place.
+ * @return The rotation matrix.
+ */
 HINLINE mat4 quat_to_rotaion_matrix(quat q, vec3 center) {
-    mat4 matrix;
+    mat4 matrix = quat_to_mat4(q);
     f32* d = matrix.data;
 
-    d[0] = (q.x * q.x) - (q.y * q.y) - (q.z * q.z) + (q.w * q.w);
-    d[1] = 2.0f * ((q.x * q.y) + (q.z * q.w));
-    d[2] = 2.0f * ((q.x * q.z) - (q.y * q.w));
-    d[3] = center.x - center.x * d[0] - center.y * d[1] - center.z * d[2];
-
-    d[4] = 2.0f * ((q.x * q.y) - (q.z * q.w));
-    d[5] = -(q.x * q.x) + (q.y * q.y) - (q.z * q.z) + (q.w * q.w);
-    d[6] = 2.0f * ((q.y * q.z) - (q.x * q.w));
-    d[7] = center.y - center.x * d[4] - center.y * d[5] - center.z * d[6];
-
-    d[8] = 2.0f * ((q.x * q.z) - (q.y * q.w));
-    d[9] = 2.0f * ((q.y * q.z) - (q.x * q.w));
-    d[10] = -(q.x * q.x) - (q.y * q.y) + (q.z * q.z) + (q.w * q.w);
-    d[11] = center.z - center.x * d[8] - center.y * d[9] - center.z * d[10];
-
-    d[12] = 0.0f;
-    d[13] = 0.0f;
-    d[14] = 0.0f;
-    d[15] = 1.0f;
+    // Moves center to the origin, rotates and moves it back: center - center * rotation.
+    d[12] = center.x - (center.x * d[0] + center.y * d[4] + center.z * d[8]);
+    d[13] = center.y - (center.x * d[1] + center.y * d[5] + center.z * d[9]);
+    d[14] = center.z - (center.x * d[2] + center.y * d[6] + center.z * d[10]);
 
     return matrix;
 }
@@ -1261,6 +1658,37 @@ HINLINE quat quat_from_axis_angle(vec3 axis, f32 angle, b8 normalize) {
     return q;
 }
 
+/**
+ * @brief Interpolates linearly along the shorter arc and normalizes. Several times cheaper than
+ * quat_slerp and almost the same for the small angles between animation keys, but it moves
+ * slower near the ends than in the middle.
+ *
+ * @param q_a The rotation at percentage 0. Both need to be normalized.
+ * @param q_b The rotation at percentage 1.
+ * @param percentage How far from q_a to q_b, from 0 to 1.
+ * @return The normalized result.
+ */
+HINLINE quat quat_nlerp(quat q_a, quat q_b, f32 percentage) {
+#if defined(HUSE_SIMD)
+    // Copies the sign of the dot product onto q_b, wich negates it when it is on the longer arc.
+    __m128 sign = _mm_and_ps(hsimd_dot4(q_a.data, q_b.data), _mm_set1_ps(-0.0f));
+    __m128 b = _mm_xor_ps(q_b.data, sign);
+    quat result;
+    result.data = hsimd_madd(_mm_sub_ps(b, q_a.data), _mm_set1_ps(percentage), q_a.data);
+    result.data = _mm_mul_ps(result.data, hsimd_rsqrt4(hsimd_dot4(result.data, result.data)));
+    return result;
+#else
+    f32 sign = quat_dot(q_a, q_b) < 0.0f ? -1.0f : 1.0f;
+    quat result = (quat){
+        q_a.x + (q_b.x * sign - q_a.x) * percentage,
+        q_a.y + (q_b.y * sign - q_a.y) * percentage,
+        q_a.z + (q_b.z * sign - q_a.z) * percentage,
+        q_a.w + (q_b.w * sign - q_a.w) * percentage
+    };
+    return quat_normalize(result);
+#endif
+}
+
 HINLINE quat quat_slerp(quat q_a, quat q_b, f32 percentage) {
     quat quaternion;
 
@@ -1316,6 +1744,332 @@ HINLINE quat quat_slerp(quat q_a, quat q_b, f32 percentage) {
     };
 }
 
+// ---------------------------------------------------
+// Affine transform (affine)
+// ---------------------------------------------------
+
+/*
+ * Affine transforms hold the same rotation, scale and translation as a mat4 in 12 floats
+ * instead of 16, and their products skip the constant last column. They follow the mat4
+ * conventions, affine_mul(a, b) applies a and then b.
+ */
+
+HINLINE affine affine_identity() {
+    affine result = {0};
+    result.data[0] = 1.0f;
+    result.data[5] = 1.0f;
+    result.data[10] = 1.0f;
+    return result;
+}
+
+// Drops the last column of matrix, wich has to be (0, 0, 0, 1) for the result to be the same transform.
+HINLINE affine affine_from_mat4(mat4 matrix) {
+    affine result;
+    for (i32 i = 0; i < 3; i++) {
+        for (i32 j = 0; j < 4; j++) {
+            result.data[i * 4 + j] = matrix.data[j * 4 + i];
+        }
+    }
+    return result;
+}
+
+HINLINE mat4 affine_to_mat4(affine transform) {
+    mat4 result;
+    for (i32 i = 0; i < 4; i++) {
+        for (i32 j = 0; j < 3; j++) {
+            result.data[i * 4 + j] = transform.data[j * 4 + i];
+        }
+        result.data[i * 4 + 3] = 0.0f;
+    }
+    result.data[15] = 1.0f;
+    return result;
+}
+
+/**
+ * @brief Combines two transforms, the same as mat4_mul on the equivalent matrices.
+ *
+ * @param transform_a The transform applied first, e.g. a local transform.
+ * @param transform_b The transform applied second, e.g. the parent's world transform.
+ * @return The combined transform.
+ */
+HINLINE affine affine_mul(affine transform_a, affine transform_b) {
+    affine result;
+#if defined(HUSE_SIMD)
+    // Each row of the result is transform_a's rows weighted by the matching row of transform_b,
+    // plus transform_b's own translation.
+    const __m128 translation_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+    for (i32 i = 0; i < 3; i++) {
+        __m128 row = transform_b.rows[i];
+        __m128 sum = _mm_and_ps(row, translation_mask);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 0, 0, 0, 0), transform_a.rows[0], sum);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 1, 1, 1, 1), transform_a.rows[1], sum);
+        sum = hsimd_madd(HSIMD_SWIZZLE(row, 2, 2, 2, 2), transform_a.rows[2], sum);
+        result.rows[i] = sum;
+    }
+#else
+    const f32* a = transform_a.data;
+    const f32* b = transform_b.data;
+    for (i32 i = 0; i < 3; i++) {
+        for (i32 j = 0; j < 4; j++) {
+            result.data[i * 4 + j] =
+                b[i * 4 + 0] * a[0 + j] +
+                b[i * 4 + 1] * a[4 + j] +
+                b[i * 4 + 2] * a[8 + j];
+        }
+        result.data[i * 4 + 3] += b[i * 4 + 3];
+    }
+#endif
+    return result;
+}
+
+/**
+ * @brief Obtains the inverse of the transform. Only the 3x3 part has to be inverted,
+ * the translation is then moved back through it.
+ *
+ * @param transform The transform to invert. Must not scale anything to 0.
+ * @return The inverted transform.
+ */
+HINLINE affine affine_inverse(affine transform) {
+    const f32* m = transform.data;
+    vec3 r0 = (vec3){m[0], m[1], m[2]};
+    vec3 r1 = (vec3){m[4], m[5], m[6]};
+    vec3 r2 = (vec3){m[8], m[9], m[10]};
+
+    // The columns of the inverse are the cross products of the rows, over the determinant.
+    vec3 c0 = vec3_cross(r1, r2);
+    vec3 c1 = vec3_cross(r2, r0);
+    vec3 c2 = vec3_cross(r0, r1);
+    f32 inverse_determinant = 1.0f / vec3_dot(r0, c0);
+    c0 = vec3_mul_scalar(c0, inverse_determinant);
+    c1 = vec3_mul_scalar(c1, inverse_determinant);
+    c2 = vec3_mul_scalar(c2, inverse_determinant);
+
+    f32 tx = m[3], ty = m[7], tz = m[11];
+    affine result;
+    f32* o = result.data;
+    o[0] = c0.x; o[1] = c1.x; o[2] = c2.x;  o[3] = -(c0.x * tx + c1.x * ty + c2.x * tz);
+    o[4] = c0.y; o[5] = c1.y; o[6] = c2.y;  o[7] = -(c0.y * tx + c1.y * ty + c2.y * tz);
+    o[8] = c0.z; o[9] = c1.z; o[10] = c2.z; o[11] = -(c0.z * tx + c1.z * ty + c2.z * tz);
+    return result;
+}
+
+HINLINE vec3 affine_transform_point(affine transform, vec3 point) {
+    const f32* m = transform.data;
+    return (vec3){
+        m[0] * point.x + m[1] * point.y + m[2] * point.z + m[3],
+        m[4] * point.x + m[5] * point.y + m[6] * point.z + m[7],
+        m[8] * point.x + m[9] * point.y + m[10] * point.z + m[11]
+    };
+}
+
+// Transforms a direction, wich ignores the translation.
+HINLINE vec3 affine_transform_direction(affine transform, vec3 direction) {
+    const f32* m = transform.data;
+    return (vec3){
+        m[0] * direction.x + m[1] * direction.y + m[2] * direction.z,
+        m[4] * direction.x + m[5] * direction.y + m[6] * direction.z,
+        m[8] * direction.x + m[9] * direction.y + m[10] * direction.z
+    };
+}
+
+// ---------------------------------------------------
+// Dual quaternion (dual_quat)
+// ---------------------------------------------------
+
+/*
+ * A rigid transform (rotation and translation, no scale) in 8 floats. Rotations follow
+ * quat_to_mat4, and dual_quat_mul(a, b) applies a and then b like mat4_mul. Unlike
+ * matrices, blending dual quaternions and normalizing the result gives a rigid transform
+ * again, wich is what skinning with several bones per vertex needs.
+ */
+
+HINLINE dual_quat dual_quat_identity() {
+    return (dual_quat){quat_identify(), (quat){0, 0, 0, 0}};
+}
+
+/**
+ * @brief Creates a dual quaternion that rotates and then translates, the same as
+ * mat4_mul(quat_to_mat4(rotation), mat4_translation(translation)).
+ *
+ * @param rotation The rotation. Does not need to be normalized.
+ * @param translation The translation applied after the rotation.
+ * @return The dual quaternion.
+ */
+HINLINE dual_quat dual_quat_from_rotation_translation(quat rotation, vec3 translation) {
+    dual_quat result;
+    result.real = quat_normalize(rotation);
+    quat t = (quat){translation.x * -0.5f, translation.y * -0.5f, translation.z * -0.5f, 0.0f};
+    result.dual = quat_mul(result.real, t);
+    return result;
+}
+
+// Combines two dual quaternions, dual_quat_a is applied first.
+HINLINE dual_quat dual_quat_mul(dual_quat dual_quat_a, dual_quat dual_quat_b) {
+    dual_quat result;
+    result.real = quat_mul(dual_quat_a.real, dual_quat_b.real);
+    quat dual_a = quat_mul(dual_quat_a.real, dual_quat_b.dual);
+    quat dual_b = quat_mul(dual_quat_a.dual, dual_quat_b.real);
+#if defined(HUSE_SIMD)
+    result.dual.data = _mm_add_ps(dual_a.data, dual_b.data);
+#else
+    result.dual = (quat){dual_a.x + dual_b.x, dual_a.y + dual_b.y, dual_a.z + dual_b.z, dual_a.w + dual_b.w};
+#endif
+    return result;
+}
+
+// The inverse of a normalized dual quaternion.
+HINLINE dual_quat dual_quat_inverse(dual_quat dq) {
+    return (dual_quat){quat_conjugate(dq.real), quat_conjugate(dq.dual)};
+}
+
+/**
+ * @brief Makes the dual quaternion a rigid transform again, e.g. after blending several
+ * of them by weights. Scales both parts so the real part has a length of 1 and removes
+ * the part of dual along real.
+ *
+ * @param dq The dual quaternion. The real part must not have a length of 0.
+ * @return The normalized dual quaternion.
+ */
+HINLINE dual_quat dual_quat_normalize(dual_quat dq) {
+#if defined(HUSE_SIMD)
+    __m128 inverse_length = hsimd_rsqrt4(hsimd_dot4(dq.real.data, dq.real.data));
+    __m128 real = _mm_mul_ps(dq.real.data, inverse_length);
+    __m128 dual = _mm_mul_ps(dq.dual.data, inverse_length);
+    dual = _mm_sub_ps(dual, _mm_mul_ps(real, hsimd_dot4(real, dual)));
+    dq.real.data = real;
+    dq.dual.data = dual;
+    return dq;
+#else
+    f32 inverse_length = 1.0f / quat_normal(dq.real);
+    quat real = (quat){dq.real.x * inverse_length, dq.real.y * inverse_length, dq.real.z * inverse_length, dq.real.w * inverse_length};
+    quat dual = (quat){dq.dual.x * inverse_length, dq.dual.y * inverse_length, dq.dual.z * inverse_length, dq.dual.w * inverse_length};
+    f32 along = quat_dot(real, dual);
+    dual.x -= real.x * along;
+    dual.y -= real.y * along;
+    dual.z -= real.z * along;
+    dual.w -= real.w * along;
+    return (dual_quat){real, dual};
+#endif
+}
+
+// Obtains the translation of a normalized dual quaternion.
+HINLINE vec3 dual_quat_get_translation(dual_quat dq) {
+    quat t = quat_mul(quat_conjugate(dq.real), dq.dual);
+    return (vec3){t.x * -2.0f, t.y * -2.0f, t.z * -2.0f};
+}
+
+// Transforms a point by a normalized dual quaternion.
+HINLINE vec3 dual_quat_transform_point(dual_quat dq, vec3 point) {
+    // Rotates by the conjugate of real to match quat_to_mat4, v + w * t + u x t with t = 2 * (u x v).
+    vec3 u = (vec3){-dq.real.x, -dq.real.y, -dq.real.z};
+    vec3 t = vec3_mul_scalar(vec3_cross(u, point), 2.0f);
+    vec3 rotated = vec3_add(vec3_add(point, vec3_mul_scalar(t, dq.real.w)), vec3_cross(u, t));
+    return vec3_add(rotated, dual_quat_get_translation(dq));
+}
+
+// Converts a normalized dual quaternion to the equivalent affine transform.
+HINLINE affine dual_quat_to_affine(dual_quat dq) {
+    quat q = dq.real;
+    vec3 t = dual_quat_get_translation(dq);
+    affine result;
+    f32* o = result.data;
+    o[0] = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+    o[1] = 2.0f * (q.x * q.y + q.z * q.w);
+    o[2] = 2.0f * (q.x * q.z - q.y * q.w);
+    o[3] = t.x;
+    o[4] = 2.0f * (q.x * q.y - q.z * q.w);
+    o[5] = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+    o[6] = 2.0f * (q.y * q.z + q.x * q.w);
+    o[7] = t.y;
+    o[8] = 2.0f * (q.x * q.z + q.y * q.w);
+    o[9] = 2.0f * (q.y * q.z - q.x * q.w);
+    o[10] = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+    o[11] = t.z;
+    return result;
+}
+
+// ---------------------------------------------------
+// Bounds (aabb)
+// ---------------------------------------------------
+
+HINLINE aabb aabb_create(vec3 min, vec3 max) {
+    return (aabb){min, max};
+}
+
+// The smallest box holding both boxes.
+HINLINE aabb aabb_union(aabb box_a, aabb box_b) {
+    return (aabb){
+        {{box_a.min.x < box_b.min.x ? box_a.min.x : box_b.min.x,
+          box_a.min.y < box_b.min.y ? box_a.min.y : box_b.min.y,
+          box_a.min.z < box_b.min.z ? box_a.min.z : box_b.min.z}},
+        {{box_a.max.x > box_b.max.x ? box_a.max.x : box_b.max.x,
+          box_a.max.y > box_b.max.y ? box_a.max.y : box_b.max.y,
+          box_a.max.z > box_b.max.z ? box_a.max.z : box_b.max.z}}
+    };
+}
+
+// Grows the box by amount on every side.
+HINLINE aabb aabb_expand(aabb box, f32 amount) {
+    return (aabb){
+        {{box.min.x - amount, box.min.y - amount, box.min.z - amount}},
+        {{box.max.x + amount, box.max.y + amount, box.max.z + amount}}
+    };
+}
+
+// Indicates if the boxes share any point. Boxes that only touch count.
+HINLINE b8 aabb_overlaps(aabb box_a, aabb box_b) {
+    return box_a.min.x <= box_b.max.x && box_a.max.x >= box_b.min.x &&
+           box_a.min.y <= box_b.max.y && box_a.max.y >= box_b.min.y &&
+           box_a.min.z <= box_b.max.z && box_a.max.z >= box_b.min.z;
+}
+
+// Indicates if inner is entirely inside outer.
+HINLINE b8 aabb_contains(aabb outer, aabb inner) {
+    return outer.min.x <= inner.min.x && outer.max.x >= inner.max.x &&
+           outer.min.y <= inner.min.y && outer.max.y >= inner.max.y &&
+           outer.min.z <= inner.min.z && outer.max.z >= inner.max.z;
+}
+
+HINLINE f32 aabb_surface_area(aabb box) {
+    f32 x = box.max.x - box.min.x;
+    f32 y = box.max.y - box.min.y;
+    f32 z = box.max.z - box.min.z;
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+/**
+ * @brief Intersects a ray with the box (slab test).
+ *
+ * @param box The box.
+ * @param origin Where the ray starts.
+ * @param inverse_direction 1 / direction for each component. Components of the direction
+ * that are 0 give infinities, wich is fine.
+ * @param max_distance How far along the ray to look, in multiples of the direction.
+ * @param out_distance Receives where the ray enters the box, 0 if it starts inside.
+ * @return True if the ray reaches the box within max_distance, otherwise false.
+ */
+HINLINE b8 aabb_intersects_ray(aabb box, vec3 origin, vec3 inverse_direction, f32 max_distance, f32* out_distance) {
+    f32 near_x = (box.min.x - origin.x) * inverse_direction.x;
+    f32 far_x = (box.max.x - origin.x) * inverse_direction.x;
+    f32 near_y = (box.min.y - origin.y) * inverse_direction.y;
+    f32 far_y = (box.max.y - origin.y) * inverse_direction.y;
+    f32 near_z = (box.min.z - origin.z) * inverse_direction.z;
+    f32 far_z = (box.max.z - origin.z) * inverse_direction.z;
+
+    // Negative directions cross the max side first.
+    f32 enter = 0.0f;
+    f32 exit = max_distance;
+    enter = near_x < far_x ? (near_x > enter ? near_x : enter) : (far_x > enter ? far_x : enter);
+    exit = near_x < far_x ? (far_x < exit ? far_x : exit) : (near_x < exit ? near_x : exit);
+    enter = near_y < far_y ? (near_y > enter ? near_y : enter) : (far_y > enter ? far_y : enter);
+    exit = near_y < far_y ? (far_y < exit ? far_y : exit) : (near_y < exit ? near_y : exit);
+    enter = near_z < far_z ? (near_z > enter ? near_z : enter) : (far_z > enter ? far_z : enter);
+    exit = near_z < far_z ? (far_z < exit ? far_z : exit) : (near_z < exit ? near_z : exit);
+
+    *out_distance = enter;
+    return enter <= exit;
+}
+
 /**
  * @brief Converts provided degrees to radians.
  *
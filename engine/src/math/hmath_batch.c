@@ -0,0 +1,386 @@
+#include "math/hmath_batch.h"
+#include "math/hmath.h"
+
+#include "core/cpu.h"
+#include "core/job_system.h"
+
+// Items each job takes when a batch is split across threads. A multiple of 8.
+#define MATH_BATCH_CHUNK_SIZE 4096
+
+struct math_batch_job;
+
+// Runs a batch function over the items [start, start + count).
+typedef void (*PFN_math_batch_range)(const struct math_batch_job* job, u32 start, u32 count);
+
+// A batch call, as handed to the job system.
+typedef struct math_batch_job {
+    PFN_math_batch_range range;
+    const void* input_a;
+    const void* input_b;
+    void* output;
+    vec3_soa soa_input;
+    vec3_soa soa_output;
+    u32 count;
+} math_batch_job;
+
+static void math_batch_run_chunk(u32 index, void* params) {
+    const math_batch_job* job = (const math_batch_job*)params;
+    u32 start = index * MATH_BATCH_CHUNK_SIZE;
+    u32 remaining = job->count - start;
+    job->range(job, start, remaining < MATH_BATCH_CHUNK_SIZE ? remaining : MATH_BATCH_CHUNK_SIZE);
+}
+
+static void math_batch_run(math_batch_job* job) {
+    if (job->count >= MATH_BATCH_JOB_THRESHOLD && job_system_thread_count() > 1) {
+        u32 chunk_count = (job->count + MATH_BATCH_CHUNK_SIZE - 1) / MATH_BATCH_CHUNK_SIZE;
+        job_system_parallel_for(chunk_count, math_batch_run_chunk, job);
+    } else if (job->count) {
+        job->range(job, 0, job->count);
+    }
+}
+
+HINLINE vec3 transform_point(const mat4* matrix, vec3 point) {
+    const f32* m = matrix->data;
+    return (vec3){
+        point.x * m[0] + point.y * m[4] + point.z * m[8] + m[12],
+        point.x * m[1] + point.y * m[5] + point.z * m[9] + m[13],
+        point.x * m[2] + point.y * m[6] + point.z * m[10] + m[14]};
+}
+
+#if defined(HUSE_SIMD)
+static b8 math_batch_use_avx2() {
+    return (cpu_get_features() & CPU_FEATURE_AVX2) != 0;
+}
+
+/*
+ * 8 vec3s are 3 registers of interleaved x, y and z. Blending the 3 registers puts all x
+ * (or y, or z) in one register in a scrambled order, wich a permute then sorts out.
+ * The blend masks pick every third lane: 0x49 is lanes 0, 3, 6, 0x92 lanes 1, 4, 7 and 0x24 lanes 2, 5.
+ */
+HTARGET_AVX2 static inline void load_vec3x8(const vec3* points, __m256* x, __m256* y, __m256* z) {
+    const f32* data = (const f32*)points;
+    __m256 a0 = _mm256_loadu_ps(data);
+    __m256 a1 = _mm256_loadu_ps(data + 8);
+    __m256 a2 = _mm256_loadu_ps(data + 16);
+    *x = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x92), a2, 0x24), _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+    *y = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x24), a2, 0x49), _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+    *z = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(a0, a1, 0x49), a2, 0x92), _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+}
+
+// The reverse of load_vec3x8.
+HTARGET_AVX2 static inline void store_vec3x8(vec3* points, __m256 x, __m256 y, __m256 z) {
+    f32* data = (f32*)points;
+    x = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+    y = _mm256_permutevar8x32_ps(y, _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2));
+    z = _mm256_permutevar8x32_ps(z, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+    _mm256_storeu_ps(data, _mm256_blend_ps(_mm256_blend_ps(x, y, 0x92), z, 0x24));
+    _mm256_storeu_ps(data + 8, _mm256_blend_ps(_mm256_blend_ps(x, y, 0x24), z, 0x49));
+    _mm256_storeu_ps(data + 16, _mm256_blend_ps(_mm256_blend_ps(x, y, 0x49), z, 0x92));
+}
+
+// Transposes the 4x4 blocks in each half of a, b, c and d.
+HTARGET_AVX2 static inline void transpose_4x4x2(__m256* a, __m256* b, __m256* c, __m256* d) {
+    __m256 t0 = _mm256_unpacklo_ps(*a, *b);
+    __m256 t1 = _mm256_unpacklo_ps(*c, *d);
+    __m256 t2 = _mm256_unpackhi_ps(*a, *b);
+    __m256 t3 = _mm256_unpackhi_ps(*c, *d);
+    *a = _mm256_shuffle_ps(t0, t1, 0x44);
+    *b = _mm256_shuffle_ps(t0, t1, 0xEE);
+    *c = _mm256_shuffle_ps(t2, t3, 0x44);
+    *d = _mm256_shuffle_ps(t2, t3, 0xEE);
+}
+
+HTARGET_AVX2 static void mat4_mul_avx2(const mat4* matrices_a, const mat4* matrices_b, mat4* out_matrices, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* b = matrices_b[i].data;
+        __m256 b0 = _mm256_broadcast_ps((const __m128*)b);
+        __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+        __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+        __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+        // Two rows of the first matrix at a time. Both are read before out_matrices[i] is written.
+        __m256 rows01 = _mm256_loadu_ps(matrices_a[i].data);
+        __m256 rows23 = _mm256_loadu_ps(matrices_a[i].data + 8);
+
+        __m256 sum01 = _mm256_mul_ps(_mm256_shuffle_ps(rows01, rows01, 0x00), b0);
+        __m256 sum23 = _mm256_mul_ps(_mm256_shuffle_ps(rows23, rows23, 0x00), b0);
+        sum01 = _mm256_add_ps(sum01, _mm256_mul_ps(_mm256_shuffle_ps(rows01, rows01, 0x55), b1));
+        sum23 = _mm256_add_ps(sum23, _mm256_mul_ps(_mm256_shuffle_ps(rows23, rows23, 0x55), b1));
+        sum01 = _mm256_add_ps(sum01, _mm256_mul_ps(_mm256_shuffle_ps(rows01, rows01, 0xAA), b2));
+        sum23 = _mm256_add_ps(sum23, _mm256_mul_ps(_mm256_shuffle_ps(rows23, rows23, 0xAA), b2));
+        sum01 = _mm256_add_ps(sum01, _mm256_mul_ps(_mm256_shuffle_ps(rows01, rows01, 0xFF), b3));
+        sum23 = _mm256_add_ps(sum23, _mm256_mul_ps(_mm256_shuffle_ps(rows23, rows23, 0xFF), b3));
+        _mm256_storeu_ps(out_matrices[i].data, sum01);
+        _mm256_storeu_ps(out_matrices[i].data + 8, sum23);
+    }
+}
+
+// x, y and z of 8 points times the matrix, with w = 1.
+HTARGET_AVX2 static inline void transform_x8(const mat4* matrix, __m256* x, __m256* y, __m256* z) {
+    const f32* m = matrix->data;
+    __m256 out_x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(*x, _mm256_set1_ps(m[0])), _mm256_mul_ps(*y, _mm256_set1_ps(m[4]))),
+                                 _mm256_add_ps(_mm256_mul_ps(*z, _mm256_set1_ps(m[8])), _mm256_set1_ps(m[12])));
+    __m256 out_y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(*x, _mm256_set1_ps(m[1])), _mm256_mul_ps(*y, _mm256_set1_ps(m[5]))),
+                                 _mm256_add_ps(_mm256_mul_ps(*z, _mm256_set1_ps(m[9])), _mm256_set1_ps(m[13])));
+    __m256 out_z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(*x, _mm256_set1_ps(m[2])), _mm256_mul_ps(*y, _mm256_set1_ps(m[6]))),
+                                 _mm256_add_ps(_mm256_mul_ps(*z, _mm256_set1_ps(m[10])), _mm256_set1_ps(m[14])));
+    *x = out_x;
+    *y = out_y;
+    *z = out_z;
+}
+
+// Returns how many points were transformed, the rest is left for the scalar loop.
+HTARGET_AVX2 static u32 transform_points_avx2(const mat4* matrix, const vec3* points, vec3* out_points, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        load_vec3x8(points + i, &x, &y, &z);
+        transform_x8(matrix, &x, &y, &z);
+        store_vec3x8(out_points + i, x, y, z);
+    }
+    return i;
+}
+
+HTARGET_AVX2 static u32 transform_points_soa_avx2(const mat4* matrix, vec3_soa points, vec3_soa out_points, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(points.x + i);
+        __m256 y = _mm256_loadu_ps(points.y + i);
+        __m256 z = _mm256_loadu_ps(points.z + i);
+        transform_x8(matrix, &x, &y, &z);
+        _mm256_storeu_ps(out_points.x + i, x);
+        _mm256_storeu_ps(out_points.y + i, y);
+        _mm256_storeu_ps(out_points.z + i, z);
+    }
+    return i;
+}
+
+HTARGET_AVX2 static inline void normalize_x8(__m256* x, __m256* y, __m256* z) {
+    __m256 inverse_length = hsimd_rsqrt8(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(*x, *x), _mm256_mul_ps(*y, *y)), _mm256_mul_ps(*z, *z)));
+    *x = _mm256_mul_ps(*x, inverse_length);
+    *y = _mm256_mul_ps(*y, inverse_length);
+    *z = _mm256_mul_ps(*z, inverse_length);
+}
+
+HTARGET_AVX2 static u32 normalize_avx2(vec3* vectors, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        load_vec3x8(vectors + i, &x, &y, &z);
+        normalize_x8(&x, &y, &z);
+        store_vec3x8(vectors + i, x, y, z);
+    }
+    return i;
+}
+
+HTARGET_AVX2 static u32 normalize_soa_avx2(vec3_soa vectors, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(vectors.x + i);
+        __m256 y = _mm256_loadu_ps(vectors.y + i);
+        __m256 z = _mm256_loadu_ps(vectors.z + i);
+        normalize_x8(&x, &y, &z);
+        _mm256_storeu_ps(vectors.x + i, x);
+        _mm256_storeu_ps(vectors.y + i, y);
+        _mm256_storeu_ps(vectors.z + i, z);
+    }
+    return i;
+}
+
+HTARGET_AVX2 static u32 quat_to_mat4_avx2(const quat* quats, mat4* out_matrices, u32 count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Quats i..i+3 in the low halves and i+4..i+7 in the high ones, transposed into x, y, z and w.
+        const f32* q = quats[i].elements;
+        __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(q)), _mm_loadu_ps(q + 16), 1);
+        __m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(q + 4)), _mm_loadu_ps(q + 20), 1);
+        __m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(q + 8)), _mm_loadu_ps(q + 24), 1);
+        __m256 w = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(q + 12)), _mm_loadu_ps(q + 28), 1);
+        transpose_4x4x2(&x, &y, &z, &w);
+
+        // Normalized like quat_to_mat4 does.
+        __m256 inverse_length = hsimd_rsqrt8(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                                                           _mm256_add_ps(_mm256_mul_ps(z, z), _mm256_mul_ps(w, w))));
+        x = _mm256_mul_ps(x, inverse_length);
+        y = _mm256_mul_ps(y, inverse_length);
+        z = _mm256_mul_ps(z, inverse_length);
+        w = _mm256_mul_ps(w, inverse_length);
+
+        __m256 xx = _mm256_mul_ps(two, _mm256_mul_ps(x, x));
+        __m256 yy = _mm256_mul_ps(two, _mm256_mul_ps(y, y));
+        __m256 zz = _mm256_mul_ps(two, _mm256_mul_ps(z, z));
+        __m256 xy = _mm256_mul_ps(two, _mm256_mul_ps(x, y));
+        __m256 xz = _mm256_mul_ps(two, _mm256_mul_ps(x, z));
+        __m256 yz = _mm256_mul_ps(two, _mm256_mul_ps(y, z));
+        __m256 xw = _mm256_mul_ps(two, _mm256_mul_ps(x, w));
+        __m256 yw = _mm256_mul_ps(two, _mm256_mul_ps(y, w));
+        __m256 zw = _mm256_mul_ps(two, _mm256_mul_ps(z, w));
+
+        __m256 rows[3][4] = {
+            {_mm256_sub_ps(_mm256_sub_ps(one, yy), zz), _mm256_sub_ps(xy, zw), _mm256_add_ps(xz, yw), zero},
+            {_mm256_add_ps(xy, zw), _mm256_sub_ps(_mm256_sub_ps(one, xx), zz), _mm256_sub_ps(yz, xw), zero},
+            {_mm256_sub_ps(xz, yw), _mm256_add_ps(yz, xw), _mm256_sub_ps(_mm256_sub_ps(one, xx), yy), zero}};
+        const __m128 last_row = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        for (u32 r = 0; r < 3; ++r) {
+            // Back from one register per element to one row per matrix.
+            transpose_4x4x2(&rows[r][0], &rows[r][1], &rows[r][2], &rows[r][3]);
+            for (u32 m = 0; m < 4; ++m) {
+                _mm_storeu_ps(out_matrices[i + m].data + r * 4, _mm256_castps256_ps128(rows[r][m]));
+                _mm_storeu_ps(out_matrices[i + m + 4].data + r * 4, _mm256_extractf128_ps(rows[r][m], 1));
+            }
+        }
+        for (u32 m = 0; m < 8; ++m) {
+            _mm_storeu_ps(out_matrices[i + m].data + 12, last_row);
+        }
+    }
+    return i;
+}
+#endif
+
+static void mat4_mul_range(const math_batch_job* job, u32 start, u32 count) {
+    const mat4* matrices_a = (const mat4*)job->input_a + start;
+    const mat4* matrices_b = (const mat4*)job->input_b + start;
+    mat4* out_matrices = (mat4*)job->output + start;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        mat4_mul_avx2(matrices_a, matrices_b, out_matrices, count);
+        return;
+    }
+#endif
+    for (u32 i = 0; i < count; ++i) {
+        out_matrices[i] = mat4_mul(matrices_a[i], matrices_b[i]);
+    }
+}
+
+static void transform_points_range(const math_batch_job* job, u32 start, u32 count) {
+    const mat4* matrix = (const mat4*)job->input_a;
+    const vec3* points = (const vec3*)job->input_b + start;
+    vec3* out_points = (vec3*)job->output + start;
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        i = transform_points_avx2(matrix, points, out_points, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_points[i] = transform_point(matrix, points[i]);
+    }
+}
+
+static void transform_points_soa_range(const math_batch_job* job, u32 start, u32 count) {
+    const mat4* matrix = (const mat4*)job->input_a;
+    vec3_soa points = {job->soa_input.x + start, job->soa_input.y + start, job->soa_input.z + start};
+    vec3_soa out_points = {job->soa_output.x + start, job->soa_output.y + start, job->soa_output.z + start};
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        i = transform_points_soa_avx2(matrix, points, out_points, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        vec3 point = transform_point(matrix, (vec3){points.x[i], points.y[i], points.z[i]});
+        out_points.x[i] = point.x;
+        out_points.y[i] = point.y;
+        out_points.z[i] = point.z;
+    }
+}
+
+static void normalize_range(const math_batch_job* job, u32 start, u32 count) {
+    vec3* vectors = (vec3*)job->output + start;
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        i = normalize_avx2(vectors, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        vec3_normalize(&vectors[i]);
+    }
+}
+
+static void normalize_soa_range(const math_batch_job* job, u32 start, u32 count) {
+    vec3_soa vectors = {job->soa_output.x + start, job->soa_output.y + start, job->soa_output.z + start};
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        i = normalize_soa_avx2(vectors, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        vec3 vector = vec3_normalized((vec3){vectors.x[i], vectors.y[i], vectors.z[i]});
+        vectors.x[i] = vector.x;
+        vectors.y[i] = vector.y;
+        vectors.z[i] = vector.z;
+    }
+}
+
+static void quat_to_mat4_range(const math_batch_job* job, u32 start, u32 count) {
+    const quat* quats = (const quat*)job->input_a + start;
+    mat4* out_matrices = (mat4*)job->output + start;
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (math_batch_use_avx2()) {
+        i = quat_to_mat4_avx2(quats, out_matrices, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_matrices[i] = quat_to_mat4(quats[i]);
+    }
+}
+
+void mat4_mul_batch(const mat4* matrices_a, const mat4* matrices_b, mat4* out_matrices, u32 count) {
+    math_batch_job job = {0};
+    job.range = mat4_mul_range;
+    job.input_a = matrices_a;
+    job.input_b = matrices_b;
+    job.output = out_matrices;
+    job.count = count;
+    math_batch_run(&job);
+}
+
+void mat4_transform_points(const mat4* matrix, const vec3* points, vec3* out_points, u32 count) {
+    math_batch_job job = {0};
+    job.range = transform_points_range;
+    job.input_a = matrix;
+    job.input_b = points;
+    job.output = out_points;
+    job.count = count;
+    math_batch_run(&job);
+}
+
+void mat4_transform_points_soa(const mat4* matrix, vec3_soa points, vec3_soa out_points, u32 count) {
+    math_batch_job job = {0};
+    job.range = transform_points_soa_range;
+    job.input_a = matrix;
+    job.soa_input = points;
+    job.soa_output = out_points;
+    job.count = count;
+    math_batch_run(&job);
+}
+
+void vec3_normalize_batch(vec3* vectors, u32 count) {
+    math_batch_job job = {0};
+    job.range = normalize_range;
+    job.output = vectors;
+    job.count = count;
+    math_batch_run(&job);
+}
+
+void vec3_normalize_batch_soa(vec3_soa vectors, u32 count) {
+    math_batch_job job = {0};
+    job.range = normalize_soa_range;
+    job.soa_output = vectors;
+    job.count = count;
+    math_batch_run(&job);
+}
+
+void quat_to_mat4_batch(const quat* quats, mat4* out_matrices, u32 count) {
+    math_batch_job job = {0};
+    job.range = quat_to_mat4_range;
+    job.input_a = quats;
+    job.output = out_matrices;
+    job.count = count;
+    math_batch_run(&job);
+}
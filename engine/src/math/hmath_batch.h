@@ -0,0 +1,60 @@
+#pragma once
+
+#include "defines.h"
+#include "math/math_types.inl"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Math over whole arrays. Runs 8 values at a time with AVX2 when the processor has it
+ * (picked at runtime from cpu_get_features), otherwise one at a time with the hmath.h
+ * functions. Counts of MATH_BATCH_JOB_THRESHOLD and up are split across the job system,
+ * so like job_system_parallel_for these must not be called from inside a job.
+ * Results match the hmath.h functions up to rounding.
+ */
+
+// Smallest count split across the job system.
+#define MATH_BATCH_JOB_THRESHOLD 16384
+
+// 3-component vectors stored as separate arrays (structure of arrays).
+typedef struct vec3_soa {
+    f32* x;
+    f32* y;
+    f32* z;
+} vec3_soa;
+
+/**
+ * Multiplies matrices pairwise, out_matrices[i] = mat4_mul(matrices_a[i], matrices_b[i]).
+ * @param matrices_a The first matrix of each pair.
+ * @param matrices_b The second matrix of each pair.
+ * @param out_matrices The results. May be the same array as matrices_a or matrices_b.
+ * @param count The amount of pairs.
+ */
+HAPI void mat4_mul_batch(const mat4* matrices_a, const mat4* matrices_b, mat4* out_matrices, u32 count);
+
+/**
+ * Transforms points by a matrix, as row vectors with w = 1: (x, y, z, 1) * matrix.
+ * @param matrix The transform.
+ * @param points The points to be transformed.
+ * @param out_points The transformed points. May be the same array as points.
+ * @param count The amount of points.
+ */
+HAPI void mat4_transform_points(const mat4* matrix, const vec3* points, vec3* out_points, u32 count);
+
+// Structure of arrays version of mat4_transform_points. out_points may be the same arrays as points.
+HAPI void mat4_transform_points_soa(const mat4* matrix, vec3_soa points, vec3_soa out_points, u32 count);
+
+// Normalizes count vectors in place, like vec3_normalize.
+HAPI void vec3_normalize_batch(vec3* vectors, u32 count);
+
+// Structure of arrays version of vec3_normalize_batch.
+HAPI void vec3_normalize_batch_soa(vec3_soa vectors, u32 count);
+
+// Converts count quaternions to rotation matrices, out_matrices[i] = quat_to_mat4(quats[i]).
+HAPI void quat_to_mat4_batch(const quat* quats, mat4* out_matrices, u32 count);
+
+#ifdef __cplusplus
+}
+#endif
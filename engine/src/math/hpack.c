@@ -0,0 +1,47 @@
+#include "math/hpack.h"
+
+#include "core/cpu.h"
+
+#if defined(HUSE_SIMD)
+HTARGET_F16C static u32 f32_to_f16_f16c(const f32* values, f16* out_values, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(out_values + i), halves);
+    }
+    return i;
+}
+
+HTARGET_F16C static u32 f16_to_f32_f16c(const f16* values, f32* out_values, u32 count) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i halves = _mm_loadu_si128((const __m128i*)(values + i));
+        _mm256_storeu_ps(out_values + i, _mm256_cvtph_ps(halves));
+    }
+    return i;
+}
+#endif
+
+void f32_to_f16_array(const f32* values, f16* out_values, u32 count) {
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (cpu_get_features() & CPU_FEATURE_F16C) {
+        i = f32_to_f16_f16c(values, out_values, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_values[i] = f32_to_f16(values[i]);
+    }
+}
+
+void f16_to_f32_array(const f16* values, f32* out_values, u32 count) {
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (cpu_get_features() & CPU_FEATURE_F16C) {
+        i = f16_to_f32_f16c(values, out_values, count);
+    }
+#endif
+    for (; i < count; ++i) {
+        out_values[i] = f16_to_f32(values[i]);
+    }
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "defines.h"
+#include "math/hmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Smaller encodings for vertex data. Positions fit in half floats, UVs in 16 bit unorm and
+ * normals in 2 16 bit snorms (octahedral), wich halves what a mesh costs to store and upload.
+ * The snorm and unorm conventions match the Vulkan formats of the same name, so packed data
+ * can be handed to the GPU as is.
+ */
+
+// An IEEE 754 half precision float, as its bits.
+typedef u16 f16;
+
+/**
+ * Converts to half precision, rounding to nearest even like the F16C instructions.
+ * Values too large become infinity, NaNs stay NaN.
+ * @param value The value to be converted.
+ * @returns The half precision value.
+ */
+HINLINE f16 f32_to_f16(f32 value) {
+#if defined(HUSE_SIMD) && defined(__F16C__)
+    return (f16)_cvtss_sh(value, 0);
+#else
+    union {
+        f32 f;
+        u32 u;
+    } bits = {value};
+    // Adding this moves a denormal's bits to the bottom of the mantissa, rounded by the FPU.
+    const union {
+        u32 u;
+        f32 f;
+    } denormal_magic = {((127 - 15) + (23 - 10) + 1) << 23};
+
+    u32 sign = bits.u & 0x80000000;
+    bits.u ^= sign;
+    u16 result;
+    if (bits.u >= (127 + 16) << 23) {
+        // Too large for a half, infinity or NaN.
+        result = bits.u > 0x7F800000 ? 0x7E00 : 0x7C00;
+    } else if (bits.u < (113 << 23)) {
+        bits.f += denormal_magic.f;
+        result = (u16)(bits.u - denormal_magic.u);
+    } else {
+        // Rebias the exponent and round the 13 dropped mantissa bits to nearest even.
+        u32 mantissa_odd = (bits.u >> 13) & 1;
+        bits.u += ((u32)(15 - 127) << 23) + 0xFFF + mantissa_odd;
+        result = (u16)(bits.u >> 13);
+    }
+    return result | (u16)(sign >> 16);
+#endif
+}
+
+/**
+ * Converts from half precision. Exact, every half has a f32 with the same value.
+ * @param value The half precision value.
+ * @returns The value as a f32.
+ */
+HINLINE f32 f16_to_f32(f16 value) {
+#if defined(HUSE_SIMD) && defined(__F16C__)
+    return _cvtsh_ss(value);
+#else
+    const union {
+        u32 u;
+        f32 f;
+    } denormal_magic = {113 << 23};
+    const u32 shifted_exponent = 0x7C00 << 13;
+
+    union {
+        u32 u;
+        f32 f;
+    } bits;
+    bits.u = (u32)(value & 0x7FFF) << 13;
+    u32 exponent = bits.u & shifted_exponent;
+    bits.u += (127 - 15) << 23;
+    if (exponent == shifted_exponent) {
+        // Infinity or NaN.
+        bits.u += (128 - 16) << 23;
+    } else if (exponent == 0) {
+        // Denormal, renormalized by the FPU.
+        bits.u += 1 << 23;
+        bits.f -= denormal_magic.f;
+    }
+    bits.u |= (u32)(value & 0x8000) << 16;
+    return bits.f;
+#endif
+}
+
+// Converts an array to half precision, 8 at a time with F16C when the processor has it.
+HAPI void f32_to_f16_array(const f32* values, f16* out_values, u32 count);
+
+// Converts an array from half precision, 8 at a time with F16C when the processor has it.
+HAPI void f16_to_f32_array(const f16* values, f32* out_values, u32 count);
+
+// Rounds to the nearest integer, halfway cases away from 0. |value| must fit in an i32.
+HINLINE i32 pack_round(f32 value) {
+    return (i32)(value + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+HINLINE f32 pack_clamp(f32 value, f32 min, f32 max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+// Packs a value in [0, 1] to 16 bits. Values outside are clamped.
+HINLINE u16 pack_unorm16(f32 value) {
+    return (u16)pack_round(pack_clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+HINLINE f32 unpack_unorm16(u16 value) {
+    return (f32)value * (1.0f / 65535.0f);
+}
+
+// Packs a value in [-1, 1] to 16 bits. Values outside are clamped.
+HINLINE i16 pack_snorm16(f32 value) {
+    return (i16)pack_round(pack_clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+HINLINE f32 unpack_snorm16(i16 value) {
+    // -32768 also means -1.
+    f32 result = (f32)value * (1.0f / 32767.0f);
+    return result < -1.0f ? -1.0f : result;
+}
+
+// Packs a value in [0, 1] to 8 bits. Values outside are clamped.
+HINLINE u8 pack_unorm8(f32 value) {
+    return (u8)pack_round(pack_clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+HINLINE f32 unpack_unorm8(u8 value) {
+    return (f32)value * (1.0f / 255.0f);
+}
+
+// Packs a value in [-1, 1] to 8 bits. Values outside are clamped.
+HINLINE i8 pack_snorm8(f32 value) {
+    return (i8)pack_round(pack_clamp(value, -1.0f, 1.0f) * 127.0f);
+}
+
+HINLINE f32 unpack_snorm8(i8 value) {
+    f32 result = (f32)value * (1.0f / 127.0f);
+    return result < -1.0f ? -1.0f : result;
+}
+
+// Packs texture coordinates in [0, 1] into 2 unorm16s, x in the low bits (VK_FORMAT_R16G16_UNORM).
+HINLINE u32 pack_unorm16x2(vec2 value) {
+    return (u32)pack_unorm16(value.x) | ((u32)pack_unorm16(value.y) << 16);
+}
+
+HINLINE vec2 unpack_unorm16x2(u32 value) {
+    return vec2_create(unpack_unorm16((u16)value), unpack_unorm16((u16)(value >> 16)));
+}
+
+// Packs 2 values in [-1, 1] into snorm16s, x in the low bits (VK_FORMAT_R16G16_SNORM).
+HINLINE u32 pack_snorm16x2(vec2 value) {
+    return (u32)(u16)pack_snorm16(value.x) | ((u32)(u16)pack_snorm16(value.y) << 16);
+}
+
+HINLINE vec2 unpack_snorm16x2(u32 value) {
+    return vec2_create(unpack_snorm16((i16)(u16)value), unpack_snorm16((i16)(u16)(value >> 16)));
+}
+
+// Packs 4 values in [-1, 1] into snorm8s, x in the low bits (VK_FORMAT_R8G8B8A8_SNORM). E.g. a tangent and its handedness.
+HINLINE u32 pack_snorm8x4(vec4 value) {
+    return (u32)(u8)pack_snorm8(value.x) | ((u32)(u8)pack_snorm8(value.y) << 8) |
+           ((u32)(u8)pack_snorm8(value.z) << 16) | ((u32)(u8)pack_snorm8(value.w) << 24);
+}
+
+HINLINE vec4 unpack_snorm8x4(u32 value) {
+    return vec4_create(unpack_snorm8((i8)(u8)value), unpack_snorm8((i8)(u8)(value >> 8)),
+                       unpack_snorm8((i8)(u8)(value >> 16)), unpack_snorm8((i8)(u8)(value >> 24)));
+}
+
+// -1 for negative values, otherwise 1.
+HINLINE f32 pack_sign(f32 value) {
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+/**
+ * Maps a unit vector onto the octahedron |x| + |y| + |z| = 1, then unfolds it into a square.
+ * 2 components spread the precision far more evenly over the sphere than dropping one.
+ * @param normal A unit vector.
+ * @returns The encoded normal, both components in [-1, 1].
+ */
+HINLINE vec2 octahedral_encode(vec3 normal) {
+    f32 inverse_l1 = 1.0f / (habs(normal.x) + habs(normal.y) + habs(normal.z));
+    vec2 result = vec2_create(normal.x * inverse_l1, normal.y * inverse_l1);
+    if (normal.z < 0.0f) {
+        // Fold the lower half over the diagonals.
+        f32 x = result.x;
+        result.x = (1.0f - habs(result.y)) * pack_sign(x);
+        result.y = (1.0f - habs(x)) * pack_sign(result.y);
+    }
+    return result;
+}
+
+// The reverse of octahedral_encode. Returns a unit vector.
+HINLINE vec3 octahedral_decode(vec2 encoded) {
+    vec3 normal = vec3_create(encoded.x, encoded.y, 1.0f - habs(encoded.x) - habs(encoded.y));
+    if (normal.z < 0.0f) {
+        f32 x = normal.x;
+        normal.x = (1.0f - habs(normal.y)) * pack_sign(x);
+        normal.y = (1.0f - habs(x)) * pack_sign(normal.y);
+    }
+    return vec3_normalized(normal);
+}
+
+// Packs a unit vector into 32 bits, octahedral in 2 snorm16s. The direction is kept to about 0.005 degrees.
+HINLINE u32 pack_normal(vec3 normal) {
+    return pack_snorm16x2(octahedral_encode(normal));
+}
+
+HINLINE vec3 unpack_normal(u32 packed) {
+    return octahedral_decode(unpack_snorm16x2(packed));
+}
+
+#ifdef __cplusplus
+}
+#endif
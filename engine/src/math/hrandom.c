@@ -0,0 +1,161 @@
+#include "math/hrandom.h"
+#include "math/math_types.inl"
+
+#include "core/cpu.h"
+
+// Generators random_fill_f32 runs side by side.
+#define RANDOM_LANES 4
+
+void random_seed(random_state* state, u64 seed) {
+    // splitmix64, so seeds that differ in few bits still give unrelated states.
+    for (u32 i = 0; i < 4; ++i) {
+        seed += 0x9E3779B97F4A7C15ull;
+        u64 z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state->s[i] = z ^ (z >> 31);
+    }
+}
+
+void random_jump(random_state* state) {
+    static const u64 jump[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+    u64 s[4] = {0, 0, 0, 0};
+    for (u32 i = 0; i < 4; ++i) {
+        for (u32 bit = 0; bit < 64; ++bit) {
+            if (jump[i] & (1ull << bit)) {
+                s[0] ^= state->s[0];
+                s[1] ^= state->s[1];
+                s[2] ^= state->s[2];
+                s[3] ^= state->s[3];
+            }
+            random_u64(state);
+        }
+    }
+    state->s[0] = s[0];
+    state->s[1] = s[1];
+    state->s[2] = s[2];
+    state->s[3] = s[3];
+}
+
+/*
+ * The side generators are stored by state word, lanes[word][lane], so each word loads as
+ * one vector. Every step gives 4 u64, each split into 2 floats: the low half goes first.
+ */
+
+// One step of every lane, writing 8 floats. The reference the vector versions must match.
+static void fill_step(u64 lanes[4][RANDOM_LANES], f32* out_values) {
+    for (u32 lane = 0; lane < RANDOM_LANES; ++lane) {
+        random_state state = {{lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane]}};
+        u64 bits = random_u64(&state);
+        out_values[lane * 2] = (f32)((u32)bits >> 8) * (1.0f / 16777216.0f);
+        out_values[lane * 2 + 1] = (f32)((u32)(bits >> 32) >> 8) * (1.0f / 16777216.0f);
+        for (u32 word = 0; word < 4; ++word) {
+            lanes[word][lane] = state.s[word];
+        }
+    }
+}
+
+#if defined(HUSE_SIMD)
+// rotl(s1 * 5, 7) * 9 for 2 lanes. There is no 64 bit multiply, but x * 5 and x * 9 are a shift and an add.
+HINLINE __m128i random_scramble2(__m128i s1) {
+    __m128i x = _mm_add_epi64(_mm_slli_epi64(s1, 2), s1);
+    x = _mm_or_si128(_mm_slli_epi64(x, 7), _mm_srli_epi64(x, 57));
+    return _mm_add_epi64(_mm_slli_epi64(x, 3), x);
+}
+
+// Advances 2 lanes, the same as random_u64.
+HINLINE void random_advance2(__m128i* s0, __m128i* s1, __m128i* s2, __m128i* s3) {
+    __m128i t = _mm_slli_epi64(*s1, 17);
+    *s2 = _mm_xor_si128(*s2, *s0);
+    *s3 = _mm_xor_si128(*s3, *s1);
+    *s1 = _mm_xor_si128(*s1, *s2);
+    *s0 = _mm_xor_si128(*s0, *s3);
+    *s2 = _mm_xor_si128(*s2, t);
+    *s3 = _mm_or_si128(_mm_slli_epi64(*s3, 45), _mm_srli_epi64(*s3, 19));
+}
+
+// Turns the 32 bit halves into floats in [0, 1) from their upper 24 bits.
+HINLINE __m128 random_to_f32x4(__m128i bits) {
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+static u32 fill_sse2(u64 lanes[4][RANDOM_LANES], f32* out_values, u32 count) {
+    // Lanes 0 and 1 in the first register of each word, 2 and 3 in the second.
+    __m128i s[4][2];
+    for (u32 word = 0; word < 4; ++word) {
+        s[word][0] = _mm_loadu_si128((const __m128i*)lanes[word]);
+        s[word][1] = _mm_loadu_si128((const __m128i*)(lanes[word] + 2));
+    }
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        for (u32 half = 0; half < 2; ++half) {
+            _mm_storeu_ps(out_values + i + half * 4, random_to_f32x4(random_scramble2(s[1][half])));
+            random_advance2(&s[0][half], &s[1][half], &s[2][half], &s[3][half]);
+        }
+    }
+    for (u32 word = 0; word < 4; ++word) {
+        _mm_storeu_si128((__m128i*)lanes[word], s[word][0]);
+        _mm_storeu_si128((__m128i*)(lanes[word] + 2), s[word][1]);
+    }
+    return i;
+}
+
+// The same as fill_sse2 with all 4 lanes in one register.
+HTARGET_AVX2 static u32 fill_avx2(u64 lanes[4][RANDOM_LANES], f32* out_values, u32 count) {
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)lanes[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)lanes[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*)lanes[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*)lanes[3]);
+    const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+        x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+        x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+        _mm256_storeu_ps(out_values + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), scale));
+
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+    }
+    _mm256_storeu_si256((__m256i*)lanes[0], s0);
+    _mm256_storeu_si256((__m256i*)lanes[1], s1);
+    _mm256_storeu_si256((__m256i*)lanes[2], s2);
+    _mm256_storeu_si256((__m256i*)lanes[3], s3);
+    return i;
+}
+#endif
+
+void random_fill_f32(random_state* state, f32* out_values, u32 count) {
+    u64 lanes[4][RANDOM_LANES];
+    for (u32 lane = 0; lane < RANDOM_LANES; ++lane) {
+        random_state lane_state;
+        random_seed(&lane_state, random_u64(state));
+        for (u32 word = 0; word < 4; ++word) {
+            lanes[word][lane] = lane_state.s[word];
+        }
+    }
+
+    u32 i = 0;
+#if defined(HUSE_SIMD)
+    if (cpu_get_features() & CPU_FEATURE_AVX2) {
+        i = fill_avx2(lanes, out_values, count);
+    } else {
+        i = fill_sse2(lanes, out_values, count);
+    }
+#endif
+    for (; i + 8 <= count; i += 8) {
+        fill_step(lanes, out_values + i);
+    }
+    if (i < count) {
+        f32 last[8];
+        fill_step(lanes, last);
+        for (u32 j = 0; i + j < count; ++j) {
+            out_values[i + j] = last[j];
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "defines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * xoshiro256** random number generator. All the state lives in a random_state owned by the
+ * caller, so each thread (or system) keeps its own and nothing is locked or shared. Seeding
+ * with the same value gives the same sequence on every platform and build, wich is what
+ * replays rely on. Not suitable for cryptography.
+ */
+typedef struct random_state {
+    u64 s[4];
+} random_state;
+
+/**
+ * Seeds a generator. The 4 state words are expanded from the seed with splitmix64, so any
+ * seed works, 0 included.
+ * @param state The generator to be seeded.
+ * @param seed The seed. The same seed always gives the same sequence.
+ */
+HAPI void random_seed(random_state* state, u64 seed);
+
+/**
+ * Advances the generator by 2^128 values. Calling it on copies of one state gives generators
+ * that won't overlap, e.g. one per job.
+ * @param state The generator to advance.
+ */
+HAPI void random_jump(random_state* state);
+
+/**
+ * Fills an array with values evenly distributed in [0, 1). Runs 4 generators side by side,
+ * with AVX2 or SSE2 when available, and gives the same values on every path.
+ * @param state The generator. Seeds the side generators, so it advances by 4 values per call.
+ * @param out_values The array to be filled.
+ * @param count The amount of values.
+ */
+HAPI void random_fill_f32(random_state* state, f32* out_values, u32 count);
+
+HINLINE u64 random_rotl(u64 x, u32 bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+// Obtains the next 64 random bits.
+HINLINE u64 random_u64(random_state* state) {
+    u64* s = state->s;
+    u64 result = random_rotl(s[1] * 5, 7) * 9;
+    u64 t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = random_rotl(s[3], 45);
+    return result;
+}
+
+// Obtains the next 32 random bits. These are the upper ones, wich are the best of the 64.
+HINLINE u32 random_u32(random_state* state) {
+    return (u32)(random_u64(state) >> 32);
+}
+
+/**
+ * Obtains a value in [0, bound) without the bias of a modulo. Multiplies instead of dividing
+ * and only retries for the few values that would make some results more likely (Lemire).
+ * @param state The generator.
+ * @param bound The amount of possible results. 0 gives 0.
+ * @returns A value evenly distributed in [0, bound).
+ */
+HINLINE u32 random_range(random_state* state, u32 bound) {
+    u64 product = (u64)random_u32(state) * bound;
+    u32 low = (u32)product;
+    if (low < bound) {
+        // Values below this threshold map to results that already got one extra value.
+        u32 threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = (u64)random_u32(state) * bound;
+            low = (u32)product;
+        }
+    }
+    return (u32)(product >> 32);
+}
+
+// Obtains a value in [min, max], both included. Evenly distributed.
+HINLINE i32 random_range_i32(random_state* state, i32 min, i32 max) {
+    // The difference is computed unsigned, so the full i32 range doesn't overflow.
+    u32 span = (u32)max - (u32)min + 1;
+    if (span == 0) {
+        return (i32)random_u32(state);
+    }
+    return (i32)((u32)min + random_range(state, span));
+}
+
+// Obtains a value in [0, 1). Uses 24 random bits, all a f32 can hold in that range.
+HINLINE f32 random_f32(random_state* state) {
+    return (f32)(random_u64(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Obtains a value in [min, max).
+HINLINE f32 random_f32_range(random_state* state, f32 min, f32 max) {
+    return min + random_f32(state) * (max - min);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,112 @@
+#include "math/keyframes.h"
+
+#include "core/asserts.h"
+
+// Keys checked after the cursor before falling back to a binary search.
+#define KEYFRAME_FORWARD_STEPS 4
+
+u32 keyframe_find(const f32* times, u32 key_count, f32 time, u32 cursor) {
+    if (cursor >= key_count) {
+        cursor = 0;
+    }
+
+    // The search keeps times[low] <= time < times[high], with key_count standing for a key at infinity.
+    u32 low = 0;
+    u32 high = cursor;
+    if (time >= times[cursor]) {
+        for (u32 step = 0; step < KEYFRAME_FORWARD_STEPS; ++step) {
+            if (cursor + 1 >= key_count || time < times[cursor + 1]) {
+                return cursor;
+            }
+            cursor++;
+        }
+        low = cursor;
+        high = key_count;
+    }
+    while (high - low > 1) {
+        u32 middle = low + (high - low) / 2;
+        if (times[middle] <= time) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// How far time is from key to the next one, from 0 to 1. The key must not be the last one.
+HINLINE f32 key_factor(const f32* times, u32 key, f32 time) {
+    f32 start = times[key];
+    f32 factor = (time - start) / (times[key + 1] - start);
+    return factor < 0.0f ? 0.0f : (factor > 1.0f ? 1.0f : factor);
+}
+
+HINLINE vec3 sample_vec3(const vec3_track* track, f32 time, u32* cursor) {
+    HASSERT(track->key_count > 0);
+    u32 key = keyframe_find(track->times, track->key_count, time, *cursor);
+    *cursor = key;
+    const vec3* values = track->values;
+    b8 cubic = track->interpolation == KEYFRAME_INTERPOLATION_CUBIC;
+    if (key + 1 >= track->key_count || track->interpolation == KEYFRAME_INTERPOLATION_STEP) {
+        return cubic ? values[key * 3 + 1] : values[key];
+    }
+
+    f32 t = key_factor(track->times, key, time);
+    if (!cubic) {
+        vec3 a = values[key];
+        vec3 b = values[key + 1];
+        return (vec3){a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+    }
+
+    // Hermite basis functions. The tangents are per unit of time, so they scale by the key's duration.
+    f32 duration = track->times[key + 1] - track->times[key];
+    f32 t2 = t * t;
+    f32 t3 = t2 * t;
+    f32 start_weight = 2.0f * t3 - 3.0f * t2 + 1.0f;
+    f32 end_weight = 3.0f * t2 - 2.0f * t3;
+    f32 out_tangent_weight = (t3 - 2.0f * t2 + t) * duration;
+    f32 in_tangent_weight = (t3 - t2) * duration;
+    vec3 start = values[key * 3 + 1];
+    vec3 out_tangent = values[key * 3 + 2];
+    vec3 in_tangent = values[key * 3 + 3];
+    vec3 end = values[key * 3 + 4];
+    return (vec3){
+        start.x * start_weight + out_tangent.x * out_tangent_weight + end.x * end_weight + in_tangent.x * in_tangent_weight,
+        start.y * start_weight + out_tangent.y * out_tangent_weight + end.y * end_weight + in_tangent.y * in_tangent_weight,
+        start.z * start_weight + out_tangent.z * out_tangent_weight + end.z * end_weight + in_tangent.z * in_tangent_weight};
+}
+
+HINLINE quat sample_quat(const quat_track* track, f32 time, u32* cursor) {
+    HASSERT(track->key_count > 0);
+    u32 key = keyframe_find(track->times, track->key_count, time, *cursor);
+    *cursor = key;
+    if (key + 1 >= track->key_count || track->interpolation == KEYFRAME_INTERPOLATION_STEP) {
+        return track->values[key];
+    }
+
+    f32 t = key_factor(track->times, key, time);
+    if (track->interpolation == KEYFRAME_INTERPOLATION_SLERP) {
+        return quat_slerp(track->values[key], track->values[key + 1], t);
+    }
+    return quat_nlerp(track->values[key], track->values[key + 1], t);
+}
+
+vec3 vec3_track_sample(const vec3_track* track, f32 time, u32* cursor) {
+    return sample_vec3(track, time, cursor);
+}
+
+quat quat_track_sample(const quat_track* track, f32 time, u32* cursor) {
+    return sample_quat(track, time, cursor);
+}
+
+void vec3_tracks_sample(const vec3_track* tracks, u32 count, f32 time, u32* cursors, vec3* out_values) {
+    for (u32 i = 0; i < count; ++i) {
+        out_values[i] = sample_vec3(&tracks[i], time, &cursors[i]);
+    }
+}
+
+void quat_tracks_sample(const quat_track* tracks, u32 count, f32 time, u32* cursors, quat* out_values) {
+    for (u32 i = 0; i < count; ++i) {
+        out_values[i] = sample_quat(&tracks[i], time, &cursors[i]);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "defines.h"
+#include "math/hmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Keyframed animation tracks. A track is a list of key times in ascending order and a value for
+ * each key, kept in separate arrays so that finding the keys around a time only reads the times.
+ * Tracks point into arrays owned by the caller, like the keys of a loaded clip.
+ * Each track has a cursor, the last key found for it. Playing forwards mostly stays on the same
+ * key or moves to the next one, so the cursor is checked first and searching only happens after
+ * a jump. Times before the first key or after the last one hold the value of that key.
+ */
+
+typedef enum keyframe_interpolation {
+    // Holds the value of a key until the next one.
+    KEYFRAME_INTERPOLATION_STEP,
+    // A straight line between keys for vec3 tracks, quat_nlerp for quat tracks.
+    KEYFRAME_INTERPOLATION_LINEAR,
+    // quat tracks only. quat_slerp, turning at a constant speed for several times the cost.
+    KEYFRAME_INTERPOLATION_SLERP,
+    // vec3 tracks only. A cubic Hermite spline, with 3 values per key: the incoming tangent,
+    // the value and the outgoing tangent (the layout of glTF's CUBICSPLINE).
+    KEYFRAME_INTERPOLATION_CUBIC
+} keyframe_interpolation;
+
+typedef struct vec3_track {
+    const f32* times;
+    // A value for each key, or 3 for KEYFRAME_INTERPOLATION_CUBIC.
+    const vec3* values;
+    u32 key_count;
+    keyframe_interpolation interpolation;
+} vec3_track;
+
+typedef struct quat_track {
+    const f32* times;
+    // A normalized rotation for each key.
+    const quat* values;
+    u32 key_count;
+    keyframe_interpolation interpolation;
+} quat_track;
+
+/**
+ * Finds the last key at or before a time, starting from a previous result.
+ * @param times The key times, in ascending order.
+ * @param key_count The amount of keys, at least 1.
+ * @param time The time to look for.
+ * @param cursor A previous result, 0 when there is none. Keys close after it are found without searching.
+ * @returns The key, 0 for times before the first key.
+ */
+HAPI u32 keyframe_find(const f32* times, u32 key_count, f32 time, u32 cursor);
+
+/**
+ * Samples a track.
+ * @param track A pointer to the track, with at least 1 key.
+ * @param time The time to sample at.
+ * @param cursor A pointer to the track's cursor. Start it at 0.
+ * @returns The interpolated value.
+ */
+HAPI vec3 vec3_track_sample(const vec3_track* track, f32 time, u32* cursor);
+
+// The same as vec3_track_sample for rotations.
+HAPI quat quat_track_sample(const quat_track* track, f32 time, u32* cursor);
+
+/**
+ * Samples many tracks at the same time, out_values[i] = vec3_track_sample(&tracks[i], time, &cursors[i]).
+ * @param tracks The tracks.
+ * @param count The amount of tracks.
+ * @param time The time to sample at.
+ * @param cursors The cursor of each track. Start them at 0.
+ * @param out_values Receives a value for each track.
+ */
+HAPI void vec3_tracks_sample(const vec3_track* tracks, u32 count, f32 time, u32* cursors, vec3* out_values);
+
+// The same as vec3_tracks_sample for rotations.
+HAPI void quat_tracks_sample(const quat_track* tracks, u32 count, f32 time, u32* cursors, quat* out_values);
+
+#ifdef __cplusplus
+}
+#endif
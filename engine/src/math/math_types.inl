@@ -1,6 +1,20 @@
 #pragma once
 
 #include "defines.h"
+#include "core/cpu.h"
+
+/*
+ * vec4, quat and mat4 are 16 byte aligned and use SSE on x86-64 (HUSE_SIMD). SSE4.1 and
+ * FMA instructions are picked at compile time when the build targets them (e.g. -msse4.1,
+ * -mfma). Define HNO_SIMD to build the scalar versions instead.
+ */
+#if HARCH_X64 && !defined(HNO_SIMD) && !defined(HUSE_SIMD)
+#define HUSE_SIMD
+#endif
+
+#if defined(HUSE_SIMD)
+#include <immintrin.h>
+#endif
 
 typedef union vec2_u {
     // An array of x, y.
@@ -36,10 +50,14 @@ typedef union vec3_u {
     };
 } vec3;
 
-typedef union vec4_u {
+typedef union HALIGN(16) vec4_u {
     // An array of x, y, z, w.
     f32 elements[4];
-    union {
+#if defined(HUSE_SIMD)
+    // The whole vector in a SIMD register.
+    __m128 data;
+#endif
+    struct {
         union {
             // First element.
             f32 x, r, s;
@@ -61,10 +79,52 @@ typedef union vec4_u {
 
 typedef vec4 quat;
 
-typedef union mat4_u {
+typedef union HALIGN(16) mat4_u {
     f32 data[16];
+#if defined(HUSE_SIMD)
+    // The rows, as in data[0..3], data[4..7] and so on.
+    __m128 rows[4];
+#endif
 } mat4;
 
+/*
+ * A 3x4 affine transform, a mat4 without the (0, 0, 0, 1) column. Row i holds what gives
+ * coordinate i of a transformed point, x' = dot(rows[0], (x, y, z, 1)), so it is the
+ * transpose of the first 3 columns of the equivalent mat4 and the translation is in
+ * data[3], data[7] and data[11].
+ */
+typedef union HALIGN(16) affine_u {
+    f32 data[12];
+#if defined(HUSE_SIMD)
+    __m128 rows[3];
+#endif
+} affine;
+
+// A rotation and a translation as a dual quaternion, real + e * dual.
+typedef struct dual_quat {
+    quat real;
+    quat dual;
+} dual_quat;
+
+// Axis aligned bounding box.
+typedef struct aabb {
+    vec3 min;
+    vec3 max;
+} aabb;
+
+typedef struct sphere {
+    vec3 center;
+    f32 radius;
+} sphere;
+
+/*
+ * The 6 planes bounding what a camera sees, as (normal.x, normal.y, normal.z, distance) with
+ * the normals pointing inside. A point p is inside a plane when dot(normal, p) + distance >= 0.
+ */
+typedef struct frustum {
+    vec4 planes[6];
+} frustum;
+
 typedef struct vertex_3d {
     vec3 position;
 } vertex_3d;
\ No newline at end of file
@@ -4,8 +4,6 @@
 #include "platform/platform.h"
 #include "utils/hstring.h"
 
-#include <stdio.h>
-
 struct memoryStats {
     u64 totalAllocated;
     u64 taggedAllocations[MEMORY_TAG_MAX_TAGS];
@@ -30,7 +28,8 @@ static const char* memoryTagStrings[MEMORY_TAG_MAX_TAGS] = {
     "ENTITY     ",
     "ENTITY_NODE",
     "SCENE      ",
-    "EVENT      "
+    "EVENT      ",
+    "FILE       "
 };
 
 typedef struct memory_system_state {
@@ -58,7 +57,7 @@ void shutdownMemory(void *state) {
 
 void* Hallocate(u64 size, memoryTag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
-        HWARNING("Hallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
+        HWARNING_LIMITED("Hallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
     }
 
     if (state_ptr) {
@@ -76,7 +75,7 @@ void* Hallocate(u64 size, memoryTag tag) {
 
 void Hfree(void* block, u64 size, memoryTag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
-        HWARNING("Hfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
+        HWARNING_LIMITED("Hfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
     }
 
     if (state_ptr) {
@@ -98,41 +97,19 @@ void* HsetMemory(void* dest, i32 value, u64 size) {
     return platformSetMemory(dest, value, size);
 }
 
-char* GetMemoryUsage_str() {
-    const u64 gib = 1024 * 1024 * 1024;
-    const u64 mib = 1024 * 1024;
-    const u64 kib = 1024;
-
-    char buffer[8000] = "System Memory Usage (tagged):\n";
-    u64 offset = string_length(buffer);
+void GetMemoryUsage_str(stringBuilder* builder) {
+    string_builder_append(builder, string_view("System Memory Usage (tagged):\n"));
+    if (!state_ptr) {
+        return;
+    }
 
     for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
-        char unit[4] = "KiB";
-        float amount = 1.0f;
-
-        if (state_ptr->stats.taggedAllocations[i] >= gib) {
-            unit[0] = 'G';
-            amount = state_ptr->stats.taggedAllocations[i] / (float)gib;
-        }
-        else if (state_ptr->stats.taggedAllocations[i] >= mib) {
-            unit[0] = 'M';
-            amount = state_ptr->stats.taggedAllocations[i] / (float)mib;
-        }
-        else if (state_ptr->stats.taggedAllocations[i] >= kib) {
-            unit[0] = 'K';
-            amount = state_ptr->stats.taggedAllocations[i] / (float)kib;
-        }
-        else {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = (float)state_ptr->stats.taggedAllocations[i];
-        }
-
-        i32 length = snprintf(buffer + offset, 8000, "  %s: %.2f%s\n", memoryTagStrings[i], amount, unit);
-        offset += length;
+        string_builder_append(builder, string_view("  "));
+        string_builder_append(builder, string_view(memoryTagStrings[i]));
+        string_builder_append(builder, string_view(": "));
+        string_builder_append_bytes(builder, state_ptr->stats.taggedAllocations[i]);
+        string_builder_append_char(builder, '\n');
     }
-    char* outString = string_duplicate(buffer);
-    return outString;
 }
 
 u64 GetMemoryAllocCount() {
@@ -5,6 +5,7 @@ extern "C" {
 #endif
 
 #include "defines.h"
+#include "utils/hstring.h"
 
 typedef enum memoryTag {
     // For temporary use. Should be assigned to one of the bellow or have a new tag created
@@ -27,6 +28,7 @@ typedef enum memoryTag {
     MEMORY_TAG_ENTITY_NODE,
     MEMORY_TAG_SCENE,
     MEMORY_TAG_EVENT,
+    MEMORY_TAG_FILE,
 
     MEMORY_TAG_MAX_TAGS
 } memoryTag;
@@ -44,7 +46,11 @@ HAPI void* HcopyMemory(void* dest, const void* source, u64 size);
 
 HAPI void* HsetMemory(void* dest, i32 value, u64 size);
 
-HAPI char* GetMemoryUsage_str();
+/**
+ * Appends a report of the memory currently allocated per tag to the builder.
+ * @param builder A pointer to the stringBuilder to be appended to.
+ */
+HAPI void GetMemoryUsage_str(stringBuilder* builder);
 
 HAPI u64 GetMemoryAllocCount();
 
@@ -47,6 +47,24 @@ void* allocate_linear_allocator(linear_allocator* allocator, u64 size) {
     return NULL;
 }
 
+void* allocate_linear_allocator_aligned(linear_allocator* allocator, u64 size, u64 alignment) {
+    if (allocator && allocator->memory) {
+        u64 address = (u64)allocator->memory + allocator->allocated;
+        u64 padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+        if (allocator->allocated + padding + size > allocator->total_size) {
+            u64 remaining = allocator->total_size - allocator->allocated;
+            HERROR("allocate_linear_allocator_aligned - Tried to allocate %lluB (+%lluB padding), only %lluB remaining", size, padding, remaining);
+            return NULL;
+        }
+
+        allocator->allocated += padding;
+        return allocate_linear_allocator(allocator, size);
+    }
+
+    HERROR("allocate_linear_allocator_aligned - Provided allocator was not initialized");
+    return NULL;
+}
+
 void linear_allocator_free_all(linear_allocator* allocator) {
     if (allocator && allocator->memory) {
         allocator->allocated = NULL;
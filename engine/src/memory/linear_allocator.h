@@ -17,6 +17,8 @@ HAPI void create_linear_allocator(u64 total_size, void* memory, linear_allocator
 HAPI void destroy_linear_allocator(linear_allocator* allocator);
 
 HAPI void* allocate_linear_allocator(linear_allocator* allocator, u64 size);
+// Like allocate_linear_allocator, but the block starts at a multiple of alignment (a power of 2), e.g. for SIMD types.
+HAPI void* allocate_linear_allocator_aligned(linear_allocator* allocator, u64 size, u64 alignment);
 HAPI void linear_allocator_free_all(linear_allocator* allocator);
 
 #ifdef __cplusplus
@@ -2,14 +2,25 @@
 
 #include "core/logger.h"
 #include "memory/hmemory.h"
+#include "platform/vfs.h"
+#include "resources/archive.h"
+#include "utils/hstring.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#if HPLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 b8 filesystem_exists(const char *path) {
-    struct stat buffer;
-    return (stat(path, &buffer) == 0);
+    vfsFile file;
+    return vfs_resolve(path, &file);
 }
 
 b8 filesystem_open(const char* path, fileModes mode, b8 binary, fileHandle* out_handle) {
@@ -31,8 +42,25 @@ b8 filesystem_open(const char* path, fileModes mode, b8 binary, fileHandle* out_
         return false;
     }
 
+    // Resolve the virtual path. Writes go to a directory mount, reads to wherever the file was found.
+    char disk_path[VFS_MAX_PATH];
+    if ((mode & FILE_MODE_WRITE) != 0) {
+        vfs_disk_path(path, disk_path);
+    } else {
+        vfsFile resolved;
+        if (!vfs_resolve(path, &resolved)) {
+            HERROR("Error opening file: '%s'", path);
+            return false;
+        }
+        if (resolved.source != VFS_SOURCE_DISK) {
+            HERROR("'%s' is inside an archive or memory mount, use filesystem_map or filesystem_read_async instead.", path);
+            return false;
+        }
+        string_format_n(disk_path, VFS_MAX_PATH, "%s", resolved.disk_path);
+    }
+
     // Attempt to open the file.
-    FILE* file = fopen(path, mode_str);
+    FILE* file = fopen(disk_path, mode_str);
     if (!file) {
         HERROR("Error opening file: '%s'", path);
         return false;
@@ -72,10 +100,6 @@ b8 filesystem_write_line(fileHandle* handle, const char* text) {
         if (result != EOF) {
             result = fputc('\n', (FILE*)handle->handle);
         }
-
-        // Make sure to flush the stream so it is written to the file immediately.
-        // This prevents data loss in the event of a crash.
-        fflush((FILE*)handle->handle);
         return result != EOF;
     }
     return false;
@@ -92,6 +116,24 @@ b8 filesystem_read(fileHandle* handle, u64 data_size, void* out_data, u64* out_b
     return false;
 }
 
+b8 filesystem_size(fileHandle* handle, u64* out_size) {
+    if (handle->handle) {
+        FILE* file = (FILE*)handle->handle;
+        i64 position = ftell(file);
+        if (position < 0 || fseek(file, 0, SEEK_END) != 0) {
+            return false;
+        }
+        i64 size = ftell(file);
+        fseek(file, position, SEEK_SET);
+        if (size < 0) {
+            return false;
+        }
+        *out_size = (u64)size;
+        return true;
+    }
+    return false;
+}
+
 b8 filesystem_read_all_bytes(fileHandle* handle, u8** out_bytes, u64* out_bytes_read) {
     if (handle->handle) {
         // File size
@@ -115,8 +157,212 @@ b8 filesystem_write(fileHandle* handle, u64 data_size, const void* data, u64* ou
         if (*out_bytes_written != data_size) {
             return false;
         }
-        fflush((FILE*)handle->handle);
         return true;
     }
     return false;
 }
+
+b8 filesystem_flush(fileHandle* handle) {
+    if (handle->handle) {
+        return fflush((FILE*)handle->handle) == 0;
+    }
+    return false;
+}
+
+#if HPLATFORM_WINDOWS
+static b8 filesystem_map_file(const char* path, fileView* out_view) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        HERROR("Error opening file for mapping: '%s'", path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        HERROR("Error reading size of file: '%s'", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    if (size.QuadPart == 0) {
+        // Empty files can't be mapped, but are valid.
+        CloseHandle(file);
+        return true;
+    }
+
+    // The mapping object keeps the file alive, so the file handle isn't needed anymore.
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (!mapping) {
+        HERROR("Error creating file mapping: '%s'", path);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        HERROR("Error mapping file: '%s'", path);
+        CloseHandle(mapping);
+        return false;
+    }
+
+    out_view->data = data;
+    out_view->size = size.QuadPart;
+    out_view->handle = mapping;
+    return true;
+}
+
+static void filesystem_unmap_file(fileView* view) {
+    if (view->data) {
+        UnmapViewOfFile(view->data);
+    }
+    if (view->handle) {
+        CloseHandle((HANDLE)view->handle);
+    }
+}
+#else
+static b8 filesystem_map_file(const char* path, fileView* out_view) {
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        HERROR("Error opening file for mapping: '%s'", path);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        HERROR("Error reading size of file: '%s'", path);
+        close(fd);
+        return false;
+    }
+
+    if (info.st_size == 0) {
+        // Empty files can't be mapped, but are valid.
+        close(fd);
+        return true;
+    }
+
+    // The mapping keeps its own reference to the file, so the descriptor can be closed.
+    void* data = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        HERROR("Error mapping file: '%s'", path);
+        return false;
+    }
+
+    // Assets are read front to back: start read-ahead now and let the kernel drop pages behind.
+    madvise(data, info.st_size, MADV_WILLNEED);
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    out_view->data = data;
+    out_view->size = info.st_size;
+    return true;
+}
+
+static void filesystem_unmap_file(fileView* view) {
+    if (view->data) {
+        munmap((void*)view->data, view->size);
+    }
+}
+#endif
+
+b8 filesystem_map(const char* path, fileView* out_view) {
+    out_view->data = 0;
+    out_view->size = 0;
+    out_view->handle = 0;
+    out_view->is_virtual = false;
+
+    vfsFile file;
+    if (!vfs_resolve(path, &file)) {
+        HERROR("Error opening file for mapping: '%s'", path);
+        return false;
+    }
+
+    if (file.source == VFS_SOURCE_MEMORY) {
+        out_view->data = file.memory;
+        out_view->size = file.size;
+        out_view->is_virtual = true;
+        return true;
+    }
+
+    if (file.source == VFS_SOURCE_ARCHIVE) {
+        const archiveEntry* entry = file.entry;
+        if (entry->flags & ARCHIVE_ENTRY_FLAG_COMPRESSED) {
+            // Decompressed into a buffer owned by the view, tracked through handle.
+            u8* data = entry->uncompressed_size ? Hallocate(entry->uncompressed_size, MEMORY_TAG_FILE) : 0;
+            if (!archive_read_entry(file.archive, entry, data)) {
+                if (data) {
+                    Hfree(data, entry->uncompressed_size, MEMORY_TAG_FILE);
+                }
+                return false;
+            }
+            out_view->data = data;
+            out_view->size = entry->uncompressed_size;
+            out_view->handle = data;
+            out_view->is_virtual = true;
+            return true;
+        }
+
+        // Point straight into the archive's mapping.
+        out_view->data = archive_entry_data(file.archive, entry);
+        out_view->size = entry->size;
+        out_view->is_virtual = true;
+        return true;
+    }
+
+    return filesystem_map_file(file.disk_path, out_view);
+}
+
+void filesystem_unmap(fileView* view) {
+    if (!view->is_virtual) {
+        filesystem_unmap_file(view);
+    } else if (view->handle) {
+        Hfree(view->handle, view->size, MEMORY_TAG_FILE);
+    }
+    view->data = 0;
+    view->size = 0;
+    view->handle = 0;
+    view->is_virtual = false;
+}
+
+b8 filesystem_line_reader_open(const char* path, fileLineReader* out_reader) {
+    fileView view;
+    if (!filesystem_map(path, &view)) {
+        return false;
+    }
+    filesystem_line_reader_from_memory(view.data, view.size, out_reader);
+    out_reader->view = view;
+    return true;
+}
+
+void filesystem_line_reader_from_memory(const void* data, u64 size, fileLineReader* out_reader) {
+    HzeroMemory(out_reader, sizeof(fileLineReader));
+    out_reader->data = (const char*)data;
+    out_reader->size = size;
+}
+
+b8 filesystem_line_reader_next(fileLineReader* reader, stringView* out_line) {
+    if (reader->position >= reader->size) {
+        return false;
+    }
+
+    const char* start = reader->data + reader->position;
+    u64 remaining = reader->size - reader->position;
+    // memchr is vectorized by the C runtime, no need to look at every character here.
+    const char* end = memchr(start, '\n', remaining);
+    u64 length = end ? (u64)(end - start) : remaining;
+    reader->position += end ? length + 1 : length;
+    reader->line_number++;
+
+    if (length > 0 && start[length - 1] == '\r') {
+        length--;
+    }
+    out_line->data = start;
+    out_line->length = length;
+    return true;
+}
+
+void filesystem_line_reader_close(fileLineReader* reader) {
+    filesystem_unmap(&reader->view);
+    reader->data = 0;
+    reader->size = 0;
+    reader->position = 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "utils/hstring.h"
 
 // Holds a handle to a file
 typedef struct fileHandle {
@@ -9,20 +10,87 @@ typedef struct fileHandle {
     b8 isValid;
 } fileHandle;
 
+// A read-only view of a whole file mapped into memory.
+typedef struct fileView {
+    // The file contents. NULL for empty files.
+    const u8* data;
+    // The size of the file in bytes.
+    u64 size;
+    // Opaque handle to the internal mapping object, if the platform needs one.
+    void* handle;
+    // The data comes from a VFS archive or memory mount. Either points into the mount,
+    // or to a decompressed copy owned by the view when handle is set.
+    b8 is_virtual;
+} fileView;
+
+// Handle to an asynchronous read request.
+typedef u32 fileAsyncHandle;
+
+#define INVALID_FILE_ASYNC_HANDLE 0xFFFFFFFF
+
+// Outcome of an asynchronous read, passed to the request's completion callback.
+typedef struct fileAsyncResult {
+    fileAsyncHandle handle;
+    b8 success;
+    // The file contents, allocated with MEMORY_TAG_FILE. Ownership passes to the callback,
+    // wich must Hfree it. NULL for empty files and failed reads.
+    u8* data;
+    // The size of data in bytes.
+    u64 size;
+} fileAsyncResult;
+
+// Called on the thread that runs filesystem_async_update once a read finishes.
+typedef void (*PFN_file_async_callback)(const fileAsyncResult* result, void* user_data);
+
+// When a fileWriter hands its buffered data to the OS, besides when the buffer is full.
+typedef struct fileWriterPolicy {
+    // Flush once this many bytes are buffered. 0 to only flush when the buffer is full.
+    u64 flush_size;
+    // Flush data that has been buffered for longer than this many seconds. 0 to disable.
+    f64 flush_interval;
+    // Flush right away when an error is reported through filesystem_writer_mark_error.
+    b8 flush_on_error;
+} fileWriterPolicy;
+
+// Buffers writes to a file and flushes them according to a policy.
+typedef struct fileWriter {
+    fileHandle file;
+    fileWriterPolicy policy;
+    u8* buffer;
+    u64 capacity;
+    // Bytes currently held in buffer.
+    u64 length;
+    // Time the oldest buffered byte was written at.
+    f64 oldest_write_time;
+} fileWriter;
+
+// Iterates over the lines of a file or buffer, handing out views into it instead of copies.
+typedef struct fileLineReader {
+    // The mapped file, when opened with filesystem_line_reader_open.
+    fileView view;
+    const char* data;
+    u64 size;
+    // Offset of the next line in data.
+    u64 position;
+    // Number of the line last returned, starting at 1.
+    u64 line_number;
+} fileLineReader;
+
 typedef enum fileModes {
     FILE_MODE_READ = 0x1,
     FILE_MODE_WRITE = 0x2
 } fileModes;
 
 /**
- * Checks if a file with the given path exists.
+ * Checks if a file with the given path exists. The path is resolved through the VFS.
  * @param path The path of the file to be checked.
  * @returns true if the file exists, otherwise false.
  */
 HAPI b8 filesystem_exists(const char *path);
 
 /**
- * Attempt to open file located at the given path.
+ * Attempt to open file located at the given path. The path is resolved through the VFS,
+ * files inside archive and memory mounts can only be read through filesystem_map and filesystem_read_async.
  * @param path The path of the file to be opened.
  * @param mode Mode flags for the file when opened.
  * @param binary Indicates if the file should opened in binary mode.
@@ -38,7 +106,8 @@ HAPI b8 filesystem_open(const char *path, fileModes mode, b8 binary, fileHandle
 HAPI void filesystem_close(fileHandle *handle);
 
 /**
- * Reads up to a newline or EOF from the provided handle.
+ * Reads up to a newline or EOF from the provided handle. Allocates a copy of every line,
+ * prefer a fileLineReader for scanning whole files.
  * @param handle A pointer to a fileHandle structure.
  * @param lineBuf A pointer to a character array wich will be allocated and populated by this method.
  * @returns true on success, false on failure.
@@ -46,7 +115,8 @@ HAPI void filesystem_close(fileHandle *handle);
 HAPI b8 filesystem_read_line(fileHandle *handle, char** lineBuf);
 
 /**
- * Writes text to the provided file, appending a '\n' afterward.S
+ * Writes text to the provided file, appending a '\n' afterward. The text is buffered by
+ * the C runtime, use filesystem_flush or a fileWriter when it has to reach the file right away.
  * @param handle A pointer to a fileHandle structure.
  * @param text The text to be writen.
  * @returns true on success, false on failure.
@@ -74,7 +144,8 @@ HAPI b8 filesystem_read(fileHandle *handle, u64 dataSize, void* out_data, u64* o
 HAPI b8 filesystem_read_all_bytes(fileHandle *handle, u8** out_bytes, u64* out_bytes_read);
 
 /**
- * Writes provided data to the file.
+ * Writes provided data to the file. The data is buffered by the C runtime, use
+ * filesystem_flush or a fileWriter when it has to reach the file right away.
  * @param handle A pointer to a fileHandle structure.
  * @param dataSize The size of the data in bytes.
  * @param data The data to be written.
@@ -82,3 +153,173 @@ HAPI b8 filesystem_read_all_bytes(fileHandle *handle, u8** out_bytes, u64* out_b
  * @returns true on success, false on failure.
  */
 HAPI b8 filesystem_write(fileHandle* handle, u64 dataSize, const void* data, u64* out_bytes_writen);
+
+/**
+ * Hands everything written to the provided file so far to the OS.
+ * @param handle A pointer to a fileHandle structure.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_flush(fileHandle* handle);
+
+/**
+ * Creates or wipes the file at the given path and opens a buffered writer for it. Data
+ * goes to the OS when a flush policy triggers or the buffer fills up, together with the
+ * write that didn't fit in a single vectored write. Open writers are also flushed by
+ * filesystem_writer_flush_all, wich the engine runs when the process crashes.
+ * A writer must only be used by one thread at a time.
+ * @param path The path of the file to be written.
+ * @param buffer_size The size of the write buffer in bytes.
+ * @param policy When to flush besides a full buffer. Pass NULL to only flush when full.
+ * @param out_writer A pointer to a fileWriter structure wich will be populated by this method.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_open(const char* path, u64 buffer_size, const fileWriterPolicy* policy, fileWriter* out_writer);
+
+// Flushes and closes the writer, releasing its buffer.
+HAPI void filesystem_writer_close(fileWriter* writer);
+
+/**
+ * Buffers the provided data. Data that doesn't fit anymore is written at once along with
+ * the buffer contents.
+ * @param writer A pointer to an open fileWriter.
+ * @param size The size of the data in bytes.
+ * @param data The data to be written.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_write(fileWriter* writer, u64 size, const void* data);
+
+/**
+ * Buffers text followed by a '\n'.
+ * @param writer A pointer to an open fileWriter.
+ * @param text The text to be written.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_write_line(fileWriter* writer, const char* text);
+
+/**
+ * Reports that an error was just written, flushing if the policy asks for it.
+ * @param writer A pointer to an open fileWriter.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_mark_error(fileWriter* writer);
+
+/**
+ * Applies the flush interval of the policy. Writes apply it by themselves, this is for
+ * writers that may sit idle with data in their buffer.
+ * @param writer A pointer to an open fileWriter.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_update(fileWriter* writer);
+
+/**
+ * Writes everything buffered so far to the file.
+ * @param writer A pointer to an open fileWriter.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_writer_flush(fileWriter* writer);
+
+/**
+ * Flushes every open writer using nothing but raw writes, so it can run from signal and
+ * crash handlers. Best effort: a writer in the middle of a write on another thread may
+ * lose or repeat data.
+ */
+HAPI void filesystem_writer_flush_all();
+
+/**
+ * Maps the whole file located at the given path into memory for reading. No copy is
+ * made; pages are loaded by the OS on access and shared through the page cache. The
+ * mapping is hinted for sequential access and read-ahead starts right away.
+ * The path is resolved through the VFS. Views of archive and memory mounts point into
+ * the mount and stay valid until the VFS shuts down.
+ * The view must be released with filesystem_unmap.
+ * @param path The path of the file to be mapped.
+ * @param out_view A pointer to a fileView structure wich will be populated by this method.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_map(const char* path, fileView* out_view);
+
+/**
+ * Releases a view created by filesystem_map. The view's data must not be used afterward.
+ * @param view A pointer to the fileView structure to be released.
+ */
+HAPI void filesystem_unmap(fileView* view);
+
+/**
+ * Maps the file located at the given path and starts reading its lines. No memory is
+ * allocated per line. The path is resolved through the VFS.
+ * The reader must be released with filesystem_line_reader_close.
+ * @param path The path of the file to be read.
+ * @param out_reader A pointer to a fileLineReader structure wich will be populated by this method.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_line_reader_open(const char* path, fileLineReader* out_reader);
+
+/**
+ * Starts reading the lines of a buffer already in memory, e.g. the result of an asynchronous read.
+ * The buffer isn't copied and must outlive the reader and the lines it returns.
+ * @param data The contents to be read.
+ * @param size The size of the contents in bytes.
+ * @param out_reader A pointer to a fileLineReader structure wich will be populated by this method.
+ */
+HAPI void filesystem_line_reader_from_memory(const void* data, u64 size, fileLineReader* out_reader);
+
+/**
+ * Obtains the next line, without its "\n" or "\r\n" terminator. The line points into the
+ * reader's file or buffer and stays valid until the reader is closed.
+ * @param reader A pointer to a fileLineReader structure.
+ * @param out_line A pointer to a view wich will be populated with the line.
+ * @returns true if a line was read, false once the end has been reached.
+ */
+HAPI b8 filesystem_line_reader_next(fileLineReader* reader, stringView* out_line);
+
+// Releases the reader, unmapping its file if it has one. Lines read from it must not be used afterward.
+HAPI void filesystem_line_reader_close(fileLineReader* reader);
+
+/**
+ * Initializes the asynchronous file read system.
+ * @param memory_requirement A pointer to a number wich will be populated with the size of the system state.
+ * @param state The memory block for the system state. Pass NULL to only obtain the memory requirement.
+ * @param use_worker_threads Skips io_uring and always reads on worker threads, e.g. to test them.
+ * @returns true on success, false on failure.
+ */
+b8 filesystem_async_initialize(u64* memory_requirement, void* state, b8 use_worker_threads);
+void filesystem_async_shutdown(void* state);
+
+/**
+ * Starts reading the whole file located at the given path in the background. The file is
+ * opened and its buffer allocated on the calling thread, the read itself goes through
+ * io_uring where available and a pool of worker threads otherwise.
+ * Must be called from the same thread as filesystem_async_update.
+ * @param path The path of the file to be read.
+ * @param callback The function to be called with the result once the read is done.
+ * @param user_data Passed unchanged to the callback.
+ * @param out_handle A pointer to a handle wich will be populated by this method. Optional.
+ * @returns true if the read was started, false on failure. The callback is not called on failure.
+ */
+HAPI b8 filesystem_read_async(const char* path, PFN_file_async_callback callback, void* user_data, fileAsyncHandle* out_handle);
+
+/**
+ * Dispatches the callbacks of all finished reads. Never blocks.
+ */
+HAPI void filesystem_async_update();
+
+/**
+ * Blocks until the given read finishes and dispatches its callback along with any other finished ones.
+ * @param handle The handle of the read to wait for.
+ */
+HAPI void filesystem_async_wait(fileAsyncHandle handle);
+
+/**
+ * Checks if a read hasn't had its callback dispatched yet.
+ * @param handle The handle of the read to be checked.
+ * @returns true if the read is still pending, otherwise false.
+ */
+HAPI b8 filesystem_async_is_pending(fileAsyncHandle handle);
+
+/**
+ * Obtains the size of the provided file in bytes.
+ * @param handle A pointer to a fileHandle structure.
+ * @param out_size A pointer to a number wich will be populated with the size of the file.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 filesystem_size(fileHandle* handle, u64* out_size);
@@ -0,0 +1,604 @@
+#include "platform/filesystem.h"
+
+#include "core/logger.h"
+#include "memory/hmemory.h"
+#include "platform/platform.h"
+#include "platform/vfs.h"
+
+#include <stdio.h>
+
+#if HPLATFORM_LINUX && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define FILE_ASYNC_IO_URING 1
+#endif
+#endif
+
+#if FILE_ASYNC_IO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Maximum amount of reads in flight at once. Must be smaller than 256, see file_async_make_handle.
+#define FILE_ASYNC_MAX_REQUESTS 64
+// Amount of worker threads used when io_uring isn't available.
+#define FILE_ASYNC_WORKER_COUNT 2
+// Time a worker waits for work before checking if it should exit.
+#define FILE_ASYNC_WORKER_TIMEOUT_MS 100
+// Largest single read submitted to the kernel, bigger files are read in several steps.
+#define FILE_ASYNC_MAX_READ_SIZE (1 << 30)
+
+STATIC_ASSERT(FILE_ASYNC_MAX_REQUESTS < 256, "FILE_ASYNC_MAX_REQUESTS must fit in the handle's index bits.");
+
+// Request slot states. Slots only move forward: FREE -> QUEUED -> READING -> DONE -> FREE.
+enum {
+    FILE_ASYNC_SLOT_FREE = 0,
+    // Waiting for a worker thread to pick it up.
+    FILE_ASYNC_SLOT_QUEUED = 1,
+    // Owned by a worker thread or by the kernel.
+    FILE_ASYNC_SLOT_READING = 2,
+    // Finished, waiting for its callback to be dispatched.
+    FILE_ASYNC_SLOT_DONE = 3
+};
+
+typedef struct file_async_request {
+    u32 state;
+    u32 generation;
+    b8 success;
+    PFN_file_async_callback callback;
+    void* user_data;
+    u8* data;
+    u64 size;
+    // Amount of bytes read so far.
+    u64 offset;
+    // Used by the worker threads.
+    fileHandle file;
+#if FILE_ASYNC_IO_URING
+    // Used by io_uring.
+    i32 fd;
+    struct iovec iov;
+#endif
+} file_async_request;
+
+#if FILE_ASYNC_IO_URING
+// The submission and completion queues shared with the kernel.
+typedef struct io_ring {
+    i32 fd;
+
+    u32* sq_head;
+    u32* sq_tail;
+    u32 sq_mask;
+    u32* sq_array;
+    struct io_uring_sqe* sqes;
+
+    u32* cq_head;
+    u32* cq_tail;
+    u32 cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* sq_ptr;
+    u64 sq_size;
+    void* cq_ptr;
+    u64 cq_size;
+    u64 sqes_size;
+} io_ring;
+#endif
+
+typedef struct file_async_state {
+    b8 use_io_uring;
+#if FILE_ASYNC_IO_URING
+    io_ring ring;
+#endif
+
+    b8 running;
+    // Signaled once per queued request.
+    platformSemaphore work_semaphore;
+    // Signaled once per finished request, lets filesystem_async_wait sleep.
+    platformSemaphore done_semaphore;
+    platformThread workers[FILE_ASYNC_WORKER_COUNT];
+
+    // Amount of slots not FREE. Only touched by the owning thread.
+    u32 pending_count;
+    file_async_request requests[FILE_ASYNC_MAX_REQUESTS];
+} file_async_state;
+
+static file_async_state* state_ptr;
+
+static fileAsyncHandle file_async_make_handle(u32 index, u32 generation) {
+    return ((generation & 0xFFFFFF) << 8) | index;
+}
+
+static file_async_request* file_async_get_request(fileAsyncHandle handle) {
+    if (!state_ptr || handle == INVALID_FILE_ASYNC_HANDLE) {
+        return 0;
+    }
+    u32 index = handle & 0xFF;
+    if (index >= FILE_ASYNC_MAX_REQUESTS) {
+        return 0;
+    }
+    file_async_request* request = &state_ptr->requests[index];
+    if ((request->generation & 0xFFFFFF) != (handle >> 8)) {
+        return 0;
+    }
+    return request;
+}
+
+static void file_async_finish(file_async_request* request, b8 success) {
+    request->success = success;
+    __atomic_store_n(&request->state, FILE_ASYNC_SLOT_DONE, __ATOMIC_RELEASE);
+}
+
+#if FILE_ASYNC_IO_URING
+static b8 io_ring_create(u32 entries, io_ring* ring) {
+    struct io_uring_params params;
+    HzeroMemory(&params, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+
+    i32 fd = (i32)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+
+    ring->fd = fd;
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    b8 single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        if (ring->cq_size > ring->sq_size) {
+            ring->sq_size = ring->cq_size;
+        }
+        ring->cq_size = ring->sq_size;
+    }
+
+    ring->sq_ptr = mmap(0, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    if (single_mmap) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(0, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            munmap(ring->sq_ptr, ring->sq_size);
+            close(fd);
+            return false;
+        }
+    }
+
+    ring->sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (!single_mmap) {
+            munmap(ring->cq_ptr, ring->cq_size);
+        }
+        munmap(ring->sq_ptr, ring->sq_size);
+        close(fd);
+        return false;
+    }
+
+    u8* sq = (u8*)ring->sq_ptr;
+    ring->sq_head = (u32*)(sq + params.sq_off.head);
+    ring->sq_tail = (u32*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(u32*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (u32*)(sq + params.sq_off.array);
+
+    u8* cq = (u8*)ring->cq_ptr;
+    ring->cq_head = (u32*)(cq + params.cq_off.head);
+    ring->cq_tail = (u32*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(u32*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+static void io_ring_destroy(io_ring* ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_size);
+    }
+    munmap(ring->sq_ptr, ring->sq_size);
+    close(ring->fd);
+}
+
+// Hands every queued entry the kernel hasn't consumed yet over to it, optionally waiting for a completion.
+static void io_ring_enter(io_ring* ring, b8 wait) {
+    for (;;) {
+        u32 to_submit = *ring->sq_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        u32 flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        if (to_submit == 0 && !wait) {
+            return;
+        }
+        i32 result = (i32)syscall(__NR_io_uring_enter, ring->fd, to_submit, wait ? 1 : 0, flags, 0, 0);
+        if (result >= 0) {
+            return;
+        }
+        if (errno != EINTR) {
+            // Entries left in the queue are submitted by the next call.
+            HERROR_LIMITED("io_uring_enter failed with errno %i.", errno);
+            return;
+        }
+    }
+}
+
+// Queues a read for the remaining part of the request. The slot index travels as user_data.
+static void io_ring_queue_read(io_ring* ring, u32 index, file_async_request* request) {
+    u64 remaining = request->size - request->offset;
+    request->iov.iov_base = request->data + request->offset;
+    request->iov.iov_len = remaining > FILE_ASYNC_MAX_READ_SIZE ? FILE_ASYNC_MAX_READ_SIZE : remaining;
+
+    u32 tail = *ring->sq_tail;
+    u32 slot = tail & ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[slot];
+    HzeroMemory(sqe, sizeof(*sqe));
+    // READV rather than READ so kernels older than 5.6 work as well.
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->off = request->offset;
+    sqe->addr = (u64)&request->iov;
+    sqe->len = 1;
+    sqe->user_data = index;
+    ring->sq_array[slot] = slot;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void io_ring_reap(io_ring* ring) {
+    u32 head = *ring->cq_head;
+    b8 resubmit = false;
+    while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+        u32 index = (u32)cqe->user_data;
+        i32 result = cqe->res;
+        head++;
+
+        file_async_request* request = &state_ptr->requests[index];
+        if (result == -EINTR || result == -EAGAIN) {
+            io_ring_queue_read(ring, index, request);
+            resubmit = true;
+            continue;
+        }
+
+        if (result < 0) {
+            HERROR("Asynchronous read failed with errno %i.", -result);
+            close(request->fd);
+            file_async_finish(request, false);
+            continue;
+        }
+
+        if (result == 0) {
+            HERROR("File shrunk during an asynchronous read.");
+            close(request->fd);
+            file_async_finish(request, false);
+            continue;
+        }
+
+        request->offset += result;
+        if (request->offset < request->size) {
+            io_ring_queue_read(ring, index, request);
+            resubmit = true;
+        } else {
+            close(request->fd);
+            file_async_finish(request, true);
+        }
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    if (resubmit) {
+        io_ring_enter(ring, false);
+    }
+}
+#endif
+
+static u32 file_async_worker(void* params) {
+    file_async_state* state = (file_async_state*)params;
+
+    while (__atomic_load_n(&state->running, __ATOMIC_ACQUIRE)) {
+        if (!platformSemaphoreWait(&state->work_semaphore, FILE_ASYNC_WORKER_TIMEOUT_MS)) {
+            continue;
+        }
+
+        // Each signal matches one queued request, claim the first one found.
+        for (u32 i = 0; i < FILE_ASYNC_MAX_REQUESTS; ++i) {
+            file_async_request* request = &state->requests[i];
+            u32 expected = FILE_ASYNC_SLOT_QUEUED;
+            if (!__atomic_compare_exchange_n(&request->state, &expected, FILE_ASYNC_SLOT_READING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                continue;
+            }
+
+            u64 bytes_read = 0;
+            b8 success = filesystem_read(&request->file, request->size, request->data, &bytes_read);
+            filesystem_close(&request->file);
+            // A short read means the file shrunk since it was opened.
+            file_async_finish(request, success && bytes_read == request->size);
+            platformSemaphoreSignal(&state->done_semaphore);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+b8 filesystem_async_initialize(u64* memory_requirement, void* state, b8 use_worker_threads) {
+    *memory_requirement = sizeof(file_async_state);
+    if (state == 0) {
+        return true;
+    }
+
+    HzeroMemory(state, sizeof(file_async_state));
+    file_async_state* async_state = (file_async_state*)state;
+
+#if FILE_ASYNC_IO_URING
+    if (!use_worker_threads && io_ring_create(FILE_ASYNC_MAX_REQUESTS, &async_state->ring)) {
+        async_state->use_io_uring = true;
+        state_ptr = async_state;
+        HDEBUG("Asynchronous file reads use io_uring.");
+        return true;
+    }
+    if (!use_worker_threads) {
+        HDEBUG("io_uring is unavailable (errno %i), falling back to worker threads.", errno);
+    }
+#endif
+
+    if (!platformSemaphoreCreate(0, &async_state->work_semaphore) || !platformSemaphoreCreate(0, &async_state->done_semaphore)) {
+        HERROR("Failed to create the asynchronous file read semaphores.");
+        return false;
+    }
+
+    async_state->running = true;
+    for (u32 i = 0; i < FILE_ASYNC_WORKER_COUNT; ++i) {
+        if (!platformThreadCreate(file_async_worker, async_state, &async_state->workers[i])) {
+            HERROR("Failed to create an asynchronous file read worker thread.");
+            return false;
+        }
+    }
+
+    state_ptr = async_state;
+    return true;
+}
+
+void filesystem_async_shutdown(void* state) {
+    if (!state_ptr) {
+        return;
+    }
+
+    // Reads still in flight write into their buffers, let them land before releasing anything.
+    for (u32 i = 0; i < FILE_ASYNC_MAX_REQUESTS; ++i) {
+        file_async_request* request = &state_ptr->requests[i];
+        while (__atomic_load_n(&request->state, __ATOMIC_ACQUIRE) == FILE_ASYNC_SLOT_QUEUED ||
+               __atomic_load_n(&request->state, __ATOMIC_ACQUIRE) == FILE_ASYNC_SLOT_READING) {
+#if FILE_ASYNC_IO_URING
+            if (state_ptr->use_io_uring) {
+                io_ring_enter(&state_ptr->ring, true);
+                io_ring_reap(&state_ptr->ring);
+                continue;
+            }
+#endif
+            platformSemaphoreWait(&state_ptr->done_semaphore, FILE_ASYNC_WORKER_TIMEOUT_MS);
+        }
+
+        // Results nobody picked up are dropped without calling their callbacks.
+        if (request->state == FILE_ASYNC_SLOT_DONE && request->data) {
+            Hfree(request->data, request->size, MEMORY_TAG_FILE);
+        }
+        request->state = FILE_ASYNC_SLOT_FREE;
+    }
+
+#if FILE_ASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        io_ring_destroy(&state_ptr->ring);
+        state_ptr = 0;
+        return;
+    }
+#endif
+
+    __atomic_store_n(&state_ptr->running, false, __ATOMIC_RELEASE);
+    for (u32 i = 0; i < FILE_ASYNC_WORKER_COUNT; ++i) {
+        platformThreadJoin(&state_ptr->workers[i]);
+    }
+    platformSemaphoreDestroy(&state_ptr->work_semaphore);
+    platformSemaphoreDestroy(&state_ptr->done_semaphore);
+    state_ptr = 0;
+}
+
+b8 filesystem_read_async(const char* path, PFN_file_async_callback callback, void* user_data, fileAsyncHandle* out_handle) {
+    if (out_handle) {
+        *out_handle = INVALID_FILE_ASYNC_HANDLE;
+    }
+    if (!state_ptr) {
+        HERROR("filesystem_read_async called before the asynchronous file system was initialized.");
+        return false;
+    }
+
+    u32 index = INVALID_FILE_ASYNC_HANDLE;
+    for (u32 i = 0; i < FILE_ASYNC_MAX_REQUESTS; ++i) {
+        if (state_ptr->requests[i].state == FILE_ASYNC_SLOT_FREE) {
+            index = i;
+            break;
+        }
+    }
+    if (index == INVALID_FILE_ASYNC_HANDLE) {
+        HWARNING_LIMITED("Too many asynchronous reads in flight, unable to read '%s'.", path);
+        return false;
+    }
+
+    file_async_request* request = &state_ptr->requests[index];
+    u64 size = 0;
+
+    vfsFile file;
+    if (!vfs_resolve(path, &file)) {
+        HERROR("Unable to open file for asynchronous read: '%s'", path);
+        return false;
+    }
+
+    // Archive and memory mounts are already in memory, copy or decompress them here and finish on the next update.
+    if (file.source != VFS_SOURCE_DISK) {
+        fileView view;
+        if (!filesystem_map(path, &view)) {
+            return false;
+        }
+        request->callback = callback;
+        request->user_data = user_data;
+        request->size = view.size;
+        request->offset = view.size;
+        if (view.handle) {
+            // Decompressed entries already live in their own buffer, take it over.
+            request->data = (u8*)view.data;
+        } else {
+            request->data = view.size ? Hallocate(view.size, MEMORY_TAG_FILE) : 0;
+            if (view.size) {
+                HcopyMemory(request->data, view.data, view.size);
+            }
+            filesystem_unmap(&view);
+        }
+        state_ptr->pending_count++;
+        if (out_handle) {
+            *out_handle = file_async_make_handle(index, request->generation);
+        }
+        file_async_finish(request, true);
+        return true;
+    }
+
+    // Open the file and size the buffer here, the memory system is only used from this thread.
+#if FILE_ASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        request->fd = open(file.disk_path, O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (request->fd < 0 || fstat(request->fd, &info) != 0) {
+            HERROR("Unable to open file for asynchronous read: '%s'", path);
+            if (request->fd >= 0) {
+                close(request->fd);
+            }
+            return false;
+        }
+        size = info.st_size;
+    } else
+#endif
+    {
+        // The path is already resolved, open it directly instead of resolving it again.
+        FILE* handle = fopen(file.disk_path, "rb");
+        if (!handle) {
+            HERROR("Unable to open file for asynchronous read: '%s'", path);
+            return false;
+        }
+        request->file.handle = handle;
+        request->file.isValid = true;
+        if (!filesystem_size(&request->file, &size)) {
+            HERROR("Unable to read size of file: '%s'", path);
+            filesystem_close(&request->file);
+            return false;
+        }
+    }
+
+    request->callback = callback;
+    request->user_data = user_data;
+    request->size = size;
+    request->offset = 0;
+    request->success = false;
+    request->data = size ? Hallocate(size, MEMORY_TAG_FILE) : 0;
+    state_ptr->pending_count++;
+
+    if (out_handle) {
+        *out_handle = file_async_make_handle(index, request->generation);
+    }
+
+    if (size == 0) {
+        // Nothing to read, the callback is dispatched on the next update.
+#if FILE_ASYNC_IO_URING
+        if (state_ptr->use_io_uring) {
+            close(request->fd);
+        } else
+#endif
+        {
+            filesystem_close(&request->file);
+        }
+        file_async_finish(request, true);
+        return true;
+    }
+
+#if FILE_ASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        request->state = FILE_ASYNC_SLOT_READING;
+        io_ring_queue_read(&state_ptr->ring, index, request);
+        io_ring_enter(&state_ptr->ring, false);
+        return true;
+    }
+#endif
+
+    __atomic_store_n(&request->state, FILE_ASYNC_SLOT_QUEUED, __ATOMIC_RELEASE);
+    platformSemaphoreSignal(&state_ptr->work_semaphore);
+    return true;
+}
+
+void filesystem_async_update() {
+    if (!state_ptr || state_ptr->pending_count == 0) {
+        return;
+    }
+
+#if FILE_ASYNC_IO_URING
+    if (state_ptr->use_io_uring) {
+        io_ring_enter(&state_ptr->ring, false);
+        io_ring_reap(&state_ptr->ring);
+    }
+#endif
+
+    for (u32 i = 0; i < FILE_ASYNC_MAX_REQUESTS; ++i) {
+        file_async_request* request = &state_ptr->requests[i];
+        if (__atomic_load_n(&request->state, __ATOMIC_ACQUIRE) != FILE_ASYNC_SLOT_DONE) {
+            continue;
+        }
+
+        fileAsyncResult result;
+        result.handle = file_async_make_handle(i, request->generation);
+        result.success = request->success;
+        result.data = request->success ? request->data : 0;
+        result.size = request->success ? request->size : 0;
+        if (!request->success && request->data) {
+            Hfree(request->data, request->size, MEMORY_TAG_FILE);
+        }
+        PFN_file_async_callback callback = request->callback;
+        void* user_data = request->user_data;
+
+        // Release the slot first so the callback can start new reads.
+        request->data = 0;
+        request->generation++;
+        request->state = FILE_ASYNC_SLOT_FREE;
+        state_ptr->pending_count--;
+
+        if (callback) {
+            callback(&result, user_data);
+        } else if (result.data) {
+            Hfree(result.data, result.size, MEMORY_TAG_FILE);
+        }
+    }
+}
+
+void filesystem_async_wait(fileAsyncHandle handle) {
+    while (filesystem_async_is_pending(handle)) {
+        file_async_request* request = file_async_get_request(handle);
+        if (__atomic_load_n(&request->state, __ATOMIC_ACQUIRE) != FILE_ASYNC_SLOT_DONE) {
+#if FILE_ASYNC_IO_URING
+            if (state_ptr->use_io_uring) {
+                io_ring_enter(&state_ptr->ring, true);
+            } else
+#endif
+            {
+                platformSemaphoreWait(&state_ptr->done_semaphore, FILE_ASYNC_WORKER_TIMEOUT_MS);
+            }
+        }
+        filesystem_async_update();
+    }
+}
+
+b8 filesystem_async_is_pending(fileAsyncHandle handle) {
+    file_async_request* request = file_async_get_request(handle);
+    return request && request->state != FILE_ASYNC_SLOT_FREE;
+}
@@ -0,0 +1,239 @@
+#include "platform/filesystem.h"
+
+#include "core/logger.h"
+#include "memory/hmemory.h"
+#include "platform/platform.h"
+#include "utils/hstring.h"
+
+#include <stdio.h>
+
+#if HPLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Maximum amount of writers flushed by filesystem_writer_flush_all. Writers beyond this still work.
+#define FILE_WRITER_MAX_TRACKED 16
+
+// A block of memory to be written as part of a single vectored write.
+typedef struct file_writer_part {
+    const void* data;
+    u64 size;
+} file_writer_part;
+
+// Open writers, for flushing from crash handlers. Slots are claimed and released atomically.
+static fileWriter* tracked_writers[FILE_WRITER_MAX_TRACKED];
+
+static i32 file_writer_descriptor(const fileWriter* writer) {
+#if HPLATFORM_WINDOWS
+    return _fileno((FILE*)writer->file.handle);
+#else
+    return fileno((FILE*)writer->file.handle);
+#endif
+}
+
+// Writes every part in order, as a single system call where possible. Doesn't log, crash handlers rely on it.
+static b8 file_writer_write_parts(i32 descriptor, file_writer_part* parts, u32 part_count) {
+#if HPLATFORM_WINDOWS
+    // No vectored writes for C runtime descriptors, the parts go out one by one.
+    for (u32 i = 0; i < part_count; ++i) {
+        const u8* data = parts[i].data;
+        u64 remaining = parts[i].size;
+        while (remaining > 0) {
+            u32 chunk = remaining > 0x40000000 ? 0x40000000 : (u32)remaining;
+            i32 written = _write(descriptor, data, chunk);
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            remaining -= written;
+        }
+    }
+    return true;
+#else
+    struct iovec vectors[4];
+    u32 count = 0;
+    for (u32 i = 0; i < part_count && count < 4; ++i) {
+        if (parts[i].size > 0) {
+            vectors[count].iov_base = (void*)parts[i].data;
+            vectors[count].iov_len = parts[i].size;
+            count++;
+        }
+    }
+
+    struct iovec* vector = vectors;
+    while (count > 0) {
+        ssize_t written = writev(descriptor, vector, (int)count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        // Skip what was written, a short write resumes in the middle of a part.
+        while (count > 0 && (u64)written >= vector->iov_len) {
+            written -= vector->iov_len;
+            vector++;
+            count--;
+        }
+        if (count > 0) {
+            vector->iov_base = (u8*)vector->iov_base + written;
+            vector->iov_len -= written;
+        }
+    }
+    return true;
+#endif
+}
+
+// Writes the buffer followed by the extra parts, leaving the buffer empty.
+static b8 file_writer_write_through(fileWriter* writer, const file_writer_part* extra, u32 extra_count) {
+    file_writer_part parts[4];
+    parts[0].data = writer->buffer;
+    parts[0].size = writer->length;
+    for (u32 i = 0; i < extra_count; ++i) {
+        parts[i + 1] = extra[i];
+    }
+
+    // Failures aren't logged here, the logger itself writes through a fileWriter.
+    b8 result = file_writer_write_parts(file_writer_descriptor(writer), parts, extra_count + 1);
+    writer->length = 0;
+    return result;
+}
+
+// Copies the parts into the buffer, or writes them out along with it if they don't fit.
+static b8 file_writer_append(fileWriter* writer, const file_writer_part* parts, u32 part_count) {
+    u64 size = 0;
+    for (u32 i = 0; i < part_count; ++i) {
+        size += parts[i].size;
+    }
+
+    if (writer->length == 0) {
+        writer->oldest_write_time = platformGetAbsoluteTime();
+    }
+
+    if (writer->length + size > writer->capacity) {
+        return file_writer_write_through(writer, parts, part_count);
+    }
+
+    for (u32 i = 0; i < part_count; ++i) {
+        HcopyMemory(writer->buffer + writer->length, parts[i].data, parts[i].size);
+        // Published part by part, a crash handler flushing concurrently sees whole parts only.
+        __atomic_store_n(&writer->length, writer->length + parts[i].size, __ATOMIC_RELEASE);
+    }
+
+    if (writer->policy.flush_size && writer->length >= writer->policy.flush_size) {
+        return filesystem_writer_flush(writer);
+    }
+    return filesystem_writer_update(writer);
+}
+
+b8 filesystem_writer_open(const char* path, u64 buffer_size, const fileWriterPolicy* policy, fileWriter* out_writer) {
+    HzeroMemory(out_writer, sizeof(fileWriter));
+    if (buffer_size == 0) {
+        HERROR("filesystem_writer_open requires a non-zero buffer size.");
+        return false;
+    }
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &out_writer->file)) {
+        return false;
+    }
+
+    // All writes go straight to the descriptor, the C runtime's buffer would only get in the way.
+    setvbuf((FILE*)out_writer->file.handle, 0, _IONBF, 0);
+
+    out_writer->buffer = Hallocate(buffer_size, MEMORY_TAG_FILE);
+    out_writer->capacity = buffer_size;
+    if (policy) {
+        out_writer->policy = *policy;
+    }
+
+    b8 tracked = false;
+    for (u32 i = 0; i < FILE_WRITER_MAX_TRACKED && !tracked; ++i) {
+        fileWriter* expected = 0;
+        tracked = __atomic_compare_exchange_n(&tracked_writers[i], &expected, out_writer, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+    }
+    if (!tracked) {
+        HWARNING("Too many open file writers, '%s' won't be flushed if the process crashes.", path);
+    }
+    return true;
+}
+
+void filesystem_writer_close(fileWriter* writer) {
+    if (!writer->buffer) {
+        return;
+    }
+
+    filesystem_writer_flush(writer);
+    for (u32 i = 0; i < FILE_WRITER_MAX_TRACKED; ++i) {
+        fileWriter* expected = writer;
+        if (__atomic_compare_exchange_n(&tracked_writers[i], &expected, 0, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    filesystem_close(&writer->file);
+    Hfree(writer->buffer, writer->capacity, MEMORY_TAG_FILE);
+    writer->buffer = 0;
+    writer->capacity = 0;
+    writer->length = 0;
+}
+
+b8 filesystem_writer_write(fileWriter* writer, u64 size, const void* data) {
+    if (!writer->buffer) {
+        return false;
+    }
+    file_writer_part part = {data, size};
+    return file_writer_append(writer, &part, 1);
+}
+
+b8 filesystem_writer_write_line(fileWriter* writer, const char* text) {
+    if (!writer->buffer) {
+        return false;
+    }
+    file_writer_part parts[2] = {{text, string_length(text)}, {"\n", 1}};
+    return file_writer_append(writer, parts, 2);
+}
+
+b8 filesystem_writer_mark_error(fileWriter* writer) {
+    if (!writer->buffer) {
+        return false;
+    }
+    return writer->policy.flush_on_error ? filesystem_writer_flush(writer) : true;
+}
+
+b8 filesystem_writer_update(fileWriter* writer) {
+    if (!writer->buffer) {
+        return false;
+    }
+    if (writer->policy.flush_interval > 0 && writer->length > 0 &&
+        platformGetAbsoluteTime() - writer->oldest_write_time >= writer->policy.flush_interval) {
+        return filesystem_writer_flush(writer);
+    }
+    return true;
+}
+
+b8 filesystem_writer_flush(fileWriter* writer) {
+    if (!writer->buffer) {
+        return false;
+    }
+    if (writer->length == 0) {
+        return true;
+    }
+    return file_writer_write_through(writer, 0, 0);
+}
+
+void filesystem_writer_flush_all() {
+    for (u32 i = 0; i < FILE_WRITER_MAX_TRACKED; ++i) {
+        fileWriter* writer = __atomic_load_n(&tracked_writers[i], __ATOMIC_ACQUIRE);
+        if (!writer) {
+            continue;
+        }
+        u64 length = __atomic_exchange_n(&writer->length, 0, __ATOMIC_ACQ_REL);
+        if (length > 0) {
+            file_writer_part part = {writer->buffer, length};
+            file_writer_write_parts(file_writer_descriptor(writer), &part, 1);
+        }
+    }
+}
@@ -24,6 +24,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
 
 // For surface creation
 #define VK_USE_PLATFORM_XCB_KHR
@@ -330,6 +334,124 @@ void platformSleep(u64 ms) {
 #endif
 }
 
+typedef struct linux_thread_start {
+    PFN_thread_start start_function;
+    void* params;
+} linux_thread_start;
+
+static void* linux_thread_entry(void* start_ptr) {
+    // Copy the start info out so it can be released before running the thread body.
+    linux_thread_start start = *(linux_thread_start*)start_ptr;
+    free(start_ptr);
+    return (void*)(u64)start.start_function(start.params);
+}
+
+b8 platformThreadCreate(PFN_thread_start start_function, void* params, platformThread* out_thread) {
+    if (!start_function || !out_thread) {
+        return false;
+    }
+
+    linux_thread_start* start = malloc(sizeof(linux_thread_start));
+    start->start_function = start_function;
+    start->params = params;
+
+    pthread_t thread;
+    i32 result = pthread_create(&thread, 0, linux_thread_entry, start);
+    if (result != 0) {
+        free(start);
+        HERROR("platformThreadCreate failed: pthread_create returned %i", result);
+        return false;
+    }
+
+    out_thread->thread_id = (u64)thread;
+    out_thread->internal_data = (void*)(u64)thread;
+    return true;
+}
+
+void platformThreadJoin(platformThread* thread) {
+    if (thread && thread->internal_data) {
+        pthread_join((pthread_t)thread->internal_data, 0);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+b8 platformSemaphoreCreate(u32 initial_count, platformSemaphore* out_semaphore) {
+    sem_t* semaphore = malloc(sizeof(sem_t));
+    if (sem_init(semaphore, 0, initial_count) != 0) {
+        free(semaphore);
+        HERROR("platformSemaphoreCreate failed: sem_init returned %i", errno);
+        return false;
+    }
+    out_semaphore->internal_data = semaphore;
+    return true;
+}
+
+void platformSemaphoreDestroy(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        sem_destroy((sem_t*)semaphore->internal_data);
+        free(semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platformSemaphoreSignal(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        sem_post((sem_t*)semaphore->internal_data);
+    }
+}
+
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeout_ms) {
+    if (!semaphore || !semaphore->internal_data) {
+        return false;
+    }
+
+    // sem_timedwait takes an absolute CLOCK_REALTIME deadline.
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+
+    i32 result;
+    do {
+        result = sem_timedwait((sem_t*)semaphore->internal_data, &deadline);
+    } while (result != 0 && errno == EINTR);
+    return result == 0;
+}
+
+u32 platformGetProcessorCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+static PFN_crash_handler crash_handler;
+
+static void linux_crash_signal(i32 signal_number) {
+    if (crash_handler) {
+        crash_handler();
+    }
+    // The handler was installed with SA_RESETHAND, so this runs the default action.
+    raise(signal_number);
+}
+
+void platformSetCrashHandler(PFN_crash_handler handler) {
+    crash_handler = handler;
+
+    const i32 signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTERM, SIGINT};
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = linux_crash_signal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (u32 i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+        sigaction(signals[i], &action, 0);
+    }
+}
+
 void platformGetRequiredExtensionNames(const char*** names_darray) {
     darray_push(*names_darray, &"VK_KHR_xcb_surface");  // VK_KHR_xlib_surface?
 }
@@ -38,6 +38,49 @@ f64 platformGetAbsoluteTime();
 //Therefore is not exported
 void platformSleep(u64 ms);
 
+// Threading
+// Function signature of a thread entry point. The return value is the thread exit code.
+typedef u32 (*PFN_thread_start)(void* params);
+
+// Holds a handle to a platform thread.
+typedef struct platformThread {
+    // Opaque handle to the internal thread object.
+    void* internal_data;
+    u64 thread_id;
+} platformThread;
+
+// Holds a handle to a platform counting semaphore.
+typedef struct platformSemaphore {
+    // Opaque handle to the internal semaphore object.
+    void* internal_data;
+} platformSemaphore;
+
+// Starts a new thread running start_function(params). Returns false if the thread couldn't be created.
+b8 platformThreadCreate(PFN_thread_start start_function, void* params, platformThread* out_thread);
+
+// Blocks until the provided thread has exited, then releases its resources.
+void platformThreadJoin(platformThread* thread);
+
+b8 platformSemaphoreCreate(u32 initial_count, platformSemaphore* out_semaphore);
+void platformSemaphoreDestroy(platformSemaphore* semaphore);
+
+// Increments the semaphore count, waking up a waiting thread if there is one.
+void platformSemaphoreSignal(platformSemaphore* semaphore);
+
+// Waits for the semaphore for up to timeout_ms milliseconds.
+// Returns true if the semaphore was acquired, false on timeout or error.
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeout_ms);
+
+// Returns the amount of logical processors available to the process, at least 1.
+u32 platformGetProcessorCount();
+
+// Called when the process crashes, right before it goes down. Must only do work that is
+// safe inside a signal handler: no allocations, locks or logging.
+typedef void (*PFN_crash_handler)();
+
+// Installs handlers for fatal signals/unhandled exceptions that call handler, then let the crash proceed.
+void platformSetCrashHandler(PFN_crash_handler handler);
+
 #ifdef __cplusplus
 } 
 #endif
\ No newline at end of file
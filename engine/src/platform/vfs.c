@@ -0,0 +1,343 @@
+#include "platform/vfs.h"
+
+#include "core/logger.h"
+#include "memory/hmemory.h"
+#include "utils/hstring.h"
+
+#include <sys/stat.h>
+
+// Maximum amount of mount points.
+#define VFS_MAX_MOUNTS 16
+// Maximum length of a mount prefix, including the null terminator.
+#define VFS_MAX_PREFIX 128
+// Slots in the resolve cache. Must be a power of 2. The cache is dropped once 3/4 full.
+#define VFS_CACHE_SIZE 4096
+// Mount index of paths that resolved to the disk without a mount point.
+#define VFS_NO_MOUNT 0xFF
+
+STATIC_ASSERT((VFS_CACHE_SIZE & (VFS_CACHE_SIZE - 1)) == 0, "VFS_CACHE_SIZE must be a power of 2.");
+STATIC_ASSERT(VFS_MAX_MOUNTS < VFS_NO_MOUNT, "Mount indices must fit in a u8.");
+
+typedef struct vfs_mount {
+    vfsSource source;
+    char prefix[VFS_MAX_PREFIX];
+    u32 prefix_length;
+    // VFS_SOURCE_DISK
+    char directory[VFS_MAX_PATH];
+    // VFS_SOURCE_ARCHIVE
+    archive archive;
+    // VFS_SOURCE_MEMORY
+    const void* memory;
+    u64 memory_size;
+} vfs_mount;
+
+typedef struct vfs_cache_entry {
+    // Hash of the virtual path, 0 marks an empty slot.
+    u64 hash;
+    u64 size;
+    const archiveEntry* entry;
+    u8 source;
+    u8 mount;
+} vfs_cache_entry;
+
+typedef struct vfs_state {
+    u32 mount_count;
+    vfs_mount mounts[VFS_MAX_MOUNTS];
+
+    u32 cache_count;
+    vfs_cache_entry cache[VFS_CACHE_SIZE];
+} vfs_state;
+
+static vfs_state* state_ptr;
+
+// Same normalization as archive names, so a path hashes the same everywhere.
+static u64 vfs_hash(const char* path) {
+    u64 hash = archive_hash_path(path);
+    return hash ? hash : 1;
+}
+
+static const char* vfs_skip_prefix(const char* path) {
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        path += 2;
+    }
+    return path;
+}
+
+// Returns the part of path after the mount's prefix, or NULL if it doesn't start with it.
+static const char* vfs_match_prefix(const vfs_mount* mount, const char* path) {
+    path = vfs_skip_prefix(path);
+    for (u32 i = 0; i < mount->prefix_length; ++i) {
+        char c = path[i] == '\\' ? '/' : path[i];
+        if (c != mount->prefix[i]) {
+            return 0;
+        }
+    }
+    return path + mount->prefix_length;
+}
+
+static b8 vfs_stat(const char* disk_path, u64* out_size) {
+    struct stat info;
+    if (stat(disk_path, &info) != 0) {
+        return false;
+    }
+    *out_size = info.st_size;
+    return true;
+}
+
+static void vfs_format_disk_path(const vfs_mount* mount, const char* relative, char* out_disk_path) {
+    string_format_n(out_disk_path, VFS_MAX_PATH, "%s/%s", mount->directory, relative);
+}
+
+// Fills out_file for a path resolved by the given mount (or VFS_NO_MOUNT).
+static void vfs_fill(const char* path, u8 mount_index, vfsSource source, u64 size, const archiveEntry* entry, vfsFile* out_file) {
+    out_file->source = source;
+    out_file->size = size;
+    out_file->disk_path[0] = 0;
+    out_file->archive = 0;
+    out_file->entry = entry;
+    out_file->memory = 0;
+
+    if (source == VFS_SOURCE_NONE) {
+        return;
+    }
+    if (mount_index == VFS_NO_MOUNT) {
+        string_format_n(out_file->disk_path, VFS_MAX_PATH, "%s", path);
+        return;
+    }
+
+    const vfs_mount* mount = &state_ptr->mounts[mount_index];
+    if (source == VFS_SOURCE_DISK) {
+        vfs_format_disk_path(mount, vfs_match_prefix(mount, path), out_file->disk_path);
+    } else if (source == VFS_SOURCE_ARCHIVE) {
+        out_file->archive = &mount->archive;
+    } else {
+        out_file->memory = mount->memory;
+    }
+}
+
+static vfs_cache_entry* vfs_cache_find(u64 hash) {
+    u32 index = (u32)hash & (VFS_CACHE_SIZE - 1);
+    for (;;) {
+        vfs_cache_entry* slot = &state_ptr->cache[index];
+        if (slot->hash == hash || slot->hash == 0) {
+            return slot;
+        }
+        index = (index + 1) & (VFS_CACHE_SIZE - 1);
+    }
+}
+
+// Asks the mount points, then the disk, where a path lives.
+static void vfs_lookup(const char* path, u8* out_mount, vfsSource* out_source, u64* out_size, const archiveEntry** out_entry) {
+    *out_entry = 0;
+    *out_size = 0;
+
+    u32 mount_count = state_ptr ? state_ptr->mount_count : 0;
+    for (u32 i = mount_count; i > 0; --i) {
+        const vfs_mount* mount = &state_ptr->mounts[i - 1];
+        const char* relative = vfs_match_prefix(mount, path);
+        if (!relative) {
+            continue;
+        }
+
+        if (mount->source == VFS_SOURCE_DISK) {
+            char disk_path[VFS_MAX_PATH];
+            vfs_format_disk_path(mount, relative, disk_path);
+            if (vfs_stat(disk_path, out_size)) {
+                *out_mount = (u8)(i - 1);
+                *out_source = VFS_SOURCE_DISK;
+                return;
+            }
+        } else if (mount->source == VFS_SOURCE_ARCHIVE) {
+            const archiveEntry* entry = archive_find(&mount->archive, relative);
+            if (entry) {
+                *out_mount = (u8)(i - 1);
+                *out_source = VFS_SOURCE_ARCHIVE;
+                *out_size = entry->uncompressed_size;
+                *out_entry = entry;
+                return;
+            }
+        } else if (relative[0] == 0) {
+            *out_mount = (u8)(i - 1);
+            *out_source = VFS_SOURCE_MEMORY;
+            *out_size = mount->memory_size;
+            return;
+        }
+    }
+
+    *out_mount = VFS_NO_MOUNT;
+    *out_source = vfs_stat(path, out_size) ? VFS_SOURCE_DISK : VFS_SOURCE_NONE;
+}
+
+static b8 vfs_add_mount(vfsSource source, const char* prefix, vfs_mount** out_mount) {
+    if (!state_ptr) {
+        HERROR("Mounting '%s' before the virtual file system was initialized.", prefix);
+        return false;
+    }
+    if (state_ptr->mount_count == VFS_MAX_MOUNTS) {
+        HERROR("Unable to mount '%s', too many mount points.", prefix);
+        return false;
+    }
+    u64 prefix_length = string_length(vfs_skip_prefix(prefix));
+    if (prefix_length >= VFS_MAX_PREFIX) {
+        HERROR("Mount prefix too long: '%s'", prefix);
+        return false;
+    }
+
+    vfs_mount* mount = &state_ptr->mounts[state_ptr->mount_count];
+    HzeroMemory(mount, sizeof(vfs_mount));
+    mount->source = source;
+    mount->prefix_length = (u32)prefix_length;
+    prefix = vfs_skip_prefix(prefix);
+    for (u64 i = 0; i < prefix_length; ++i) {
+        mount->prefix[i] = prefix[i] == '\\' ? '/' : prefix[i];
+    }
+
+    *out_mount = mount;
+    return true;
+}
+
+static void vfs_commit_mount() {
+    state_ptr->mount_count++;
+    // Earlier results may now be shadowed by the new mount.
+    vfs_invalidate(0);
+}
+
+b8 vfs_initialize(u64* memory_requirement, void* state) {
+    *memory_requirement = sizeof(vfs_state);
+    if (state == 0) {
+        return true;
+    }
+
+    HzeroMemory(state, sizeof(vfs_state));
+    state_ptr = (vfs_state*)state;
+    return true;
+}
+
+void vfs_shutdown(void* state) {
+    if (!state_ptr) {
+        return;
+    }
+    for (u32 i = 0; i < state_ptr->mount_count; ++i) {
+        if (state_ptr->mounts[i].source == VFS_SOURCE_ARCHIVE) {
+            archive_close(&state_ptr->mounts[i].archive);
+        }
+    }
+    state_ptr = 0;
+}
+
+b8 vfs_mount_directory(const char* prefix, const char* directory) {
+    vfs_mount* mount;
+    if (!vfs_add_mount(VFS_SOURCE_DISK, prefix, &mount)) {
+        return false;
+    }
+    if (string_length(directory) >= VFS_MAX_PATH) {
+        HERROR("Mount directory path too long: '%s'", directory);
+        return false;
+    }
+    string_format_n(mount->directory, VFS_MAX_PATH, "%s", directory);
+    vfs_commit_mount();
+    HDEBUG("Mounted directory '%s' at '%s'.", directory, mount->prefix);
+    return true;
+}
+
+b8 vfs_mount_archive(const char* prefix, const char* archive_path) {
+    vfs_mount* mount;
+    if (!vfs_add_mount(VFS_SOURCE_ARCHIVE, prefix, &mount)) {
+        return false;
+    }
+    if (!archive_open(archive_path, &mount->archive)) {
+        return false;
+    }
+    vfs_commit_mount();
+    HINFO("Mounted archive '%s' at '%s'.", archive_path, mount->prefix);
+    return true;
+}
+
+b8 vfs_mount_memory(const char* path, const void* data, u64 size) {
+    vfs_mount* mount;
+    if (!vfs_add_mount(VFS_SOURCE_MEMORY, path, &mount)) {
+        return false;
+    }
+    mount->memory = data;
+    mount->memory_size = size;
+    vfs_commit_mount();
+    return true;
+}
+
+b8 vfs_resolve(const char* path, vfsFile* out_file) {
+    u8 mount;
+    vfsSource source;
+    u64 size;
+    const archiveEntry* entry;
+
+    if (!state_ptr) {
+        vfs_lookup(path, &mount, &source, &size, &entry);
+        vfs_fill(path, mount, source, size, entry, out_file);
+        return source != VFS_SOURCE_NONE;
+    }
+
+    u64 hash = vfs_hash(path);
+    vfs_cache_entry* slot = vfs_cache_find(hash);
+    if (slot->hash == 0) {
+        if (state_ptr->cache_count >= VFS_CACHE_SIZE / 4 * 3) {
+            vfs_invalidate(0);
+            slot = vfs_cache_find(hash);
+        }
+        vfs_lookup(path, &mount, &source, &size, &entry);
+        slot->hash = hash;
+        slot->mount = mount;
+        slot->source = (u8)source;
+        slot->size = size;
+        slot->entry = entry;
+        state_ptr->cache_count++;
+    }
+
+    vfs_fill(path, slot->mount, (vfsSource)slot->source, slot->size, slot->entry, out_file);
+    return slot->source != VFS_SOURCE_NONE;
+}
+
+void vfs_disk_path(const char* path, char* out_disk_path) {
+    vfs_invalidate(path);
+
+    u32 mount_count = state_ptr ? state_ptr->mount_count : 0;
+    for (u32 i = mount_count; i > 0; --i) {
+        const vfs_mount* mount = &state_ptr->mounts[i - 1];
+        const char* relative = vfs_match_prefix(mount, path);
+        if (mount->source == VFS_SOURCE_DISK && relative) {
+            vfs_format_disk_path(mount, relative, out_disk_path);
+            return;
+        }
+    }
+    string_format_n(out_disk_path, VFS_MAX_PATH, "%s", path);
+}
+
+void vfs_invalidate(const char* path) {
+    if (!state_ptr) {
+        return;
+    }
+
+    if (!path) {
+        HzeroMemory(state_ptr->cache, sizeof(state_ptr->cache));
+        state_ptr->cache_count = 0;
+        return;
+    }
+
+    vfs_cache_entry* slot = vfs_cache_find(vfs_hash(path));
+    if (slot->hash == 0) {
+        return;
+    }
+
+    // Open addressing can't leave holes: empty the slot and reinsert what follows it in the probe run.
+    slot->hash = 0;
+    state_ptr->cache_count--;
+    u32 index = (u32)(slot - state_ptr->cache);
+    for (;;) {
+        index = (index + 1) & (VFS_CACHE_SIZE - 1);
+        vfs_cache_entry moved = state_ptr->cache[index];
+        if (moved.hash == 0) {
+            return;
+        }
+        state_ptr->cache[index].hash = 0;
+        *vfs_cache_find(moved.hash) = moved;
+    }
+}
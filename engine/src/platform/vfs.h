@@ -0,0 +1,103 @@
+#pragma once
+
+#include "defines.h"
+#include "resources/archive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum length of a resolved path on disk, including the null terminator.
+#define VFS_MAX_PATH 512
+
+// Where a virtual path resolved to.
+typedef enum vfsSource {
+    // Nothing exists at the path.
+    VFS_SOURCE_NONE = 0,
+    VFS_SOURCE_DISK = 1,
+    VFS_SOURCE_ARCHIVE = 2,
+    VFS_SOURCE_MEMORY = 3
+} vfsSource;
+
+// A resolved virtual path.
+typedef struct vfsFile {
+    vfsSource source;
+    // The size of the contents in bytes, uncompressed for archive entries.
+    u64 size;
+    // VFS_SOURCE_DISK: the path of the file on disk.
+    char disk_path[VFS_MAX_PATH];
+    // VFS_SOURCE_ARCHIVE: the archive and entry holding the file.
+    const archive* archive;
+    const archiveEntry* entry;
+    // VFS_SOURCE_MEMORY: the contents.
+    const void* memory;
+} vfsFile;
+
+/**
+ * Initializes the virtual file system. Until then, and after shutdown, paths resolve
+ * straight to the disk without caching. All VFS functions, and the filesystem
+ * functions built on them, must be called from the main thread.
+ * @param memory_requirement A pointer to a number wich will be populated with the size of the system state.
+ * @param state The memory block for the system state. Pass NULL to only obtain the memory requirement.
+ * @returns true on success, false on failure.
+ */
+b8 vfs_initialize(u64* memory_requirement, void* state);
+
+// Unmounts everything. Views into mounted archives must be released beforehand.
+void vfs_shutdown(void* state);
+
+/**
+ * Mounts a directory. Paths starting with prefix resolve to directory/<rest of the path>.
+ * Mount points are searched from the most recently mounted one, paths no mount point
+ * holds resolve to the disk as given.
+ * @param prefix The virtual path prefix, e.g. "assets/". Pass "" to match every path.
+ * @param directory The directory on disk.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 vfs_mount_directory(const char* prefix, const char* directory);
+
+/**
+ * Mounts a packed archive. Paths starting with prefix resolve to the entry named after the rest of the path.
+ * @param prefix The virtual path prefix. Pass "" to match every path.
+ * @param archive_path The path of the archive, itself resolved through the VFS.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 vfs_mount_archive(const char* prefix, const char* archive_path);
+
+/**
+ * Mounts a block of memory as a single read-only file. The memory is not copied and
+ * must stay valid until the VFS shuts down.
+ * @param path The virtual path of the file.
+ * @param data The contents of the file.
+ * @param size The size of the contents in bytes.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 vfs_mount_memory(const char* path, const void* data, u64 size);
+
+/**
+ * Resolves a virtual path. Results, including missing files, are cached by path hash so
+ * the OS is asked about a path at most once until it is invalidated.
+ * @param path The virtual path to be resolved.
+ * @param out_file A pointer to a vfsFile structure wich will be populated by this method.
+ * @returns true if the path exists, otherwise false.
+ */
+HAPI b8 vfs_resolve(const char* path, vfsFile* out_file);
+
+/**
+ * Obtains the path on disk a file at the given virtual path would be written to: the
+ * most recent directory mount matching it, or the path itself. Drops the cached result
+ * for the path, as writing is about to change it.
+ * @param path The virtual path.
+ * @param out_disk_path A buffer of VFS_MAX_PATH characters wich will be populated by this method.
+ */
+HAPI void vfs_disk_path(const char* path, char* out_disk_path);
+
+/**
+ * Drops cached results, for files changed behind the engine's back.
+ * @param path The virtual path to be dropped. Pass NULL to drop everything.
+ */
+HAPI void vfs_invalidate(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
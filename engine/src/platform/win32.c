@@ -10,6 +10,7 @@
 
 #include <windows.h>
 #include <windowsx.h> // param input extraction
+#include <signal.h>
 
 // For surface creation
 #include <vulkan/vulkan.h>
@@ -207,6 +208,111 @@ void platformSleep(u64 ms) {
     Sleep(ms);
 }
 
+typedef struct win32_thread_start {
+    PFN_thread_start start_function;
+    void* params;
+} win32_thread_start;
+
+static DWORD WINAPI win32_thread_entry(LPVOID start_ptr) {
+    // Copy the start info out so it can be released before running the thread body.
+    win32_thread_start start = *(win32_thread_start*)start_ptr;
+    free(start_ptr);
+    return (DWORD)start.start_function(start.params);
+}
+
+b8 platformThreadCreate(PFN_thread_start start_function, void* params, platformThread* out_thread) {
+    if (!start_function || !out_thread) {
+        return false;
+    }
+
+    win32_thread_start* start = malloc(sizeof(win32_thread_start));
+    start->start_function = start_function;
+    start->params = params;
+
+    DWORD thread_id = 0;
+    HANDLE thread = CreateThread(0, 0, win32_thread_entry, start, 0, &thread_id);
+    if (!thread) {
+        free(start);
+        HERROR("platformThreadCreate failed: CreateThread error %lu", GetLastError());
+        return false;
+    }
+
+    out_thread->thread_id = thread_id;
+    out_thread->internal_data = thread;
+    return true;
+}
+
+void platformThreadJoin(platformThread* thread) {
+    if (thread && thread->internal_data) {
+        WaitForSingleObject((HANDLE)thread->internal_data, INFINITE);
+        CloseHandle((HANDLE)thread->internal_data);
+        thread->internal_data = 0;
+        thread->thread_id = 0;
+    }
+}
+
+b8 platformSemaphoreCreate(u32 initial_count, platformSemaphore* out_semaphore) {
+    HANDLE semaphore = CreateSemaphoreA(0, initial_count, 0x7FFFFFFF, 0);
+    if (!semaphore) {
+        HERROR("platformSemaphoreCreate failed: CreateSemaphore error %lu", GetLastError());
+        return false;
+    }
+    out_semaphore->internal_data = semaphore;
+    return true;
+}
+
+void platformSemaphoreDestroy(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        CloseHandle((HANDLE)semaphore->internal_data);
+        semaphore->internal_data = 0;
+    }
+}
+
+void platformSemaphoreSignal(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internal_data) {
+        ReleaseSemaphore((HANDLE)semaphore->internal_data, 1, 0);
+    }
+}
+
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeout_ms) {
+    if (!semaphore || !semaphore->internal_data) {
+        return false;
+    }
+    return WaitForSingleObject((HANDLE)semaphore->internal_data, (DWORD)timeout_ms) == WAIT_OBJECT_0;
+}
+
+u32 platformGetProcessorCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (u32)info.dwNumberOfProcessors : 1;
+}
+
+static PFN_crash_handler crash_handler;
+
+static LONG WINAPI win32_crash_exception(EXCEPTION_POINTERS* exception) {
+    if (crash_handler) {
+        crash_handler();
+    }
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void win32_crash_signal(i32 signal_number) {
+    if (crash_handler) {
+        crash_handler();
+    }
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+}
+
+void platformSetCrashHandler(PFN_crash_handler handler) {
+    crash_handler = handler;
+    SetUnhandledExceptionFilter(win32_crash_exception);
+    // abort() and console interrupts don't go through structured exceptions.
+    signal(SIGABRT, win32_crash_signal);
+    signal(SIGTERM, win32_crash_signal);
+    signal(SIGINT, win32_crash_signal);
+}
+
 void platformGetRequiredExtensionNames(const char*** names_darray) {
     darray_push(*names_darray, &"VK_KHR_win32_surface");
 }
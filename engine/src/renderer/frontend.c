@@ -4,6 +4,7 @@
 #include "core/logger.h"
 #include "memory/hmemory.h"
 #include "math/hmath.h"
+#include "math/frustum.h"
 
 typedef struct rendererSystemState {
     // Backend render context
@@ -11,6 +12,8 @@ typedef struct rendererSystemState {
     
     mat4 projection;
     mat4 view;
+    // What the camera sees, kept in sync with projection and view.
+    frustum view_frustum;
 
     f32 near_clip;
     f32 far_clip;
@@ -18,6 +21,10 @@ typedef struct rendererSystemState {
 
 rendererSystemState* state_ptr;
 
+static void rendererUpdateFrustum() {
+    state_ptr->view_frustum = frustum_from_matrix(mat4_mul(state_ptr->view, state_ptr->projection));
+}
+
 b8 initRenderer(u64* memory_requirement, void* state, const char* appName) {
     *memory_requirement = sizeof(rendererSystemState);
     if (state == NULL) {
@@ -41,6 +48,7 @@ b8 initRenderer(u64* memory_requirement, void* state, const char* appName) {
     // TODO: configurable camera starting position.
     state_ptr->view = mat4_translation((vec3){0, 0, -30.0f});
     state_ptr->view = mat4_inverse(state_ptr->view);
+    rendererUpdateFrustum();
 
     return true;
 }
@@ -71,6 +79,7 @@ b8 rendererEndFrame(f32 delta_t) {
 void rendererOnResize(u16 width, u16 height) {
     if (state_ptr) {
         state_ptr->projection = mat4_perspective(deg_to_rad(45.0f), width / (f32)height, state_ptr->near_clip, state_ptr->far_clip);
+        rendererUpdateFrustum();
         state_ptr->backend.resized(&state_ptr->backend, width, height);
     }
     else {
@@ -104,4 +113,13 @@ b8 rendererDrawFrame(renderPacket* packet) {
 
 void rendererSetView(mat4 view) {
     state_ptr->view = view;
+    rendererUpdateFrustum();
+}
+
+u32 rendererCullSpheres(const sphere* bounds, u32 count, u32* out_visible) {
+    return frustum_cull_spheres(&state_ptr->view_frustum, bounds, count, out_visible);
+}
+
+u32 rendererCullAabbs(const aabb* bounds, u32 count, u32* out_visible) {
+    return frustum_cull_aabbs(&state_ptr->view_frustum, bounds, count, out_visible);
 }
\ No newline at end of file
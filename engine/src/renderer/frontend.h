@@ -10,4 +10,16 @@ void rendererOnResize(u16 width, u16 height);
 b8 rendererDrawFrame(renderPacket* packet);
 
 // HACK: This should not be exposed outside the engine
-HAPI void rendererSetView(mat4 view);
\ No newline at end of file
+HAPI void rendererSetView(mat4 view);
+
+/**
+ * Finds the objects the camera may see, so the rest can be skipped before building draw data.
+ * @param bounds World space bounds of the objects.
+ * @param count The amount of objects.
+ * @param out_visible Receives the indices of the visible objects. Needs room for count indices.
+ * @returns The amount of visible objects.
+ */
+HAPI u32 rendererCullSpheres(const sphere* bounds, u32 count, u32* out_visible);
+
+// The same as rendererCullSpheres for boxes.
+HAPI u32 rendererCullAabbs(const aabb* bounds, u32 count, u32* out_visible);
\ No newline at end of file
@@ -23,25 +23,14 @@ b8 create_shader_module(
     HzeroMemory(&shaderStages[stageIndex].createInfo, sizeof(VkShaderModuleCreateInfo));
     shaderStages[stageIndex].createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     
-    // Obtain file handle
-    fileHandle handle;
-    if (!filesystem_open(filename, FILE_MODE_READ, true, &handle)) {
+    // Map the file, the mapping is page aligned so the SPIR-V can be used in place.
+    fileView view;
+    if (!filesystem_map(filename, &view)) {
         HERROR("Unable to read shader module: %s.", filename);
         return false;
     }
-
-    // Read the entire file as binary
-    u64 size = 0;
-    u8* fileBuffer = NULL;
-    if (!filesystem_read_all_bytes(&handle, &fileBuffer, &size)) {
-        HERROR("Unable to binary read shader module: %s.", filename);
-        return false;
-    }
-    shaderStages[stageIndex].createInfo.codeSize = size;
-    shaderStages[stageIndex].createInfo.pCode = (u32*)fileBuffer;
-
-    // Close the file
-    filesystem_close(&handle);
+    shaderStages[stageIndex].createInfo.codeSize = view.size;
+    shaderStages[stageIndex].createInfo.pCode = (const u32*)view.data;
 
     VK_CHECK(vkCreateShaderModule(
         context->device.logical_device,
@@ -50,6 +39,10 @@ b8 create_shader_module(
         &shaderStages[stageIndex].handle
     ));
 
+    // The code is copied by the driver, the mapping isn't needed anymore.
+    filesystem_unmap(&view);
+    shaderStages[stageIndex].createInfo.pCode = NULL;
+
     // Shader stage info
     HzeroMemory(&shaderStages[stageIndex].shaderStageCreateInfo, sizeof(VkPipelineShaderStageCreateInfo));
     shaderStages[stageIndex].shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -57,10 +50,5 @@ b8 create_shader_module(
     shaderStages[stageIndex].shaderStageCreateInfo.module = shaderStages[stageIndex].handle;
     shaderStages[stageIndex].shaderStageCreateInfo.pName = "main";
 
-    if (fileBuffer) {
-        Hfree(fileBuffer, sizeof(u8) * size, MEMORY_TAG_STRING);
-        fileBuffer = NULL;
-    }
-
     return true;
 }
\ No newline at end of file
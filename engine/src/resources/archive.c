@@ -0,0 +1,251 @@
+#include "resources/archive.h"
+
+#include "core/job_system.h"
+#include "core/logger.h"
+#include "memory/hmemory.h"
+#include "utils/compression.h"
+
+#define ARCHIVE_FNV_OFFSET_BASIS 0xCBF29CE484222325ull
+#define ARCHIVE_FNV_PRIME 0x100000001B3ull
+
+static const char* archive_skip_prefix(const char* path) {
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        path += 2;
+    }
+    return path;
+}
+
+u64 archive_hash_path(const char* path) {
+    path = archive_skip_prefix(path);
+
+    u64 hash = ARCHIVE_FNV_OFFSET_BASIS;
+    for (; *path; ++path) {
+        char c = *path == '\\' ? '/' : *path;
+        hash ^= (u8)c;
+        hash *= ARCHIVE_FNV_PRIME;
+    }
+    return hash;
+}
+
+// Compares a stored (already normalized) name against a path, normalizing the path on the fly.
+static b8 archive_names_equal(const char* name, const char* path) {
+    path = archive_skip_prefix(path);
+    for (; *name && *path; ++name, ++path) {
+        char c = *path == '\\' ? '/' : *path;
+        if (*name != c) {
+            return false;
+        }
+    }
+    return *name == *path;
+}
+
+b8 archive_open(const char* path, archive* out_archive) {
+    HzeroMemory(out_archive, sizeof(archive));
+    if (!filesystem_map(path, &out_archive->view)) {
+        return false;
+    }
+
+    const u8* data = out_archive->view.data;
+    u64 size = out_archive->view.size;
+    const archiveHeader* header = (const archiveHeader*)data;
+    if (size < sizeof(archiveHeader) || header->magic != ARCHIVE_MAGIC) {
+        HERROR("'%s' is not an archive.", path);
+        archive_close(out_archive);
+        return false;
+    }
+    if (header->version != ARCHIVE_VERSION) {
+        HERROR("Archive '%s' has version %u, expected %u.", path, header->version, ARCHIVE_VERSION);
+        archive_close(out_archive);
+        return false;
+    }
+
+    // Validate everything once here so lookups can trust the table of contents.
+    // Sizes are compared against what is left after the offset, so huge values can't wrap around.
+    u64 toc_size = (u64)header->entry_count * sizeof(archiveEntry);
+    if (header->toc_offset % 8 != 0 || header->toc_offset > size || toc_size > size - header->toc_offset ||
+        header->names_offset > size || header->names_size > size - header->names_offset ||
+        (header->names_size && data[header->names_offset + header->names_size - 1] != 0)) {
+        HERROR("Archive '%s' is corrupted.", path);
+        archive_close(out_archive);
+        return false;
+    }
+
+    const archiveEntry* entries = (const archiveEntry*)(data + header->toc_offset);
+    for (u32 i = 0; i < header->entry_count; ++i) {
+        const archiveEntry* entry = &entries[i];
+        b8 compressed = (entry->flags & ARCHIVE_ENTRY_FLAG_COMPRESSED) != 0;
+        // Compressed entries must shrink and hold their whole chunk table. That bounds
+        // uncompressed_size by the archive size, so readers can allocate it up front.
+        u64 chunk_count = entry->uncompressed_size / ARCHIVE_COMPRESSION_CHUNK_SIZE + (entry->uncompressed_size % ARCHIVE_COMPRESSION_CHUNK_SIZE != 0);
+        b8 sizes_valid = compressed ? entry->size < entry->uncompressed_size && chunk_count * sizeof(u32) <= entry->size
+                                    : entry->size == entry->uncompressed_size;
+        if (entry->offset % ARCHIVE_DATA_ALIGNMENT != 0 || entry->offset > size || entry->size > size - entry->offset ||
+            !sizes_valid || entry->name_offset >= header->names_size ||
+            (i > 0 && entries[i - 1].name_hash >= entry->name_hash)) {
+            HERROR("Archive '%s' has a corrupted entry at index %u.", path, i);
+            archive_close(out_archive);
+            return false;
+        }
+    }
+
+    out_archive->header = header;
+    out_archive->entries = entries;
+    out_archive->names = (const char*)(data + header->names_offset);
+    HDEBUG("Opened archive '%s' with %u entries.", path, header->entry_count);
+    return true;
+}
+
+void archive_close(archive* archive) {
+    filesystem_unmap(&archive->view);
+    archive->header = 0;
+    archive->entries = 0;
+    archive->names = 0;
+}
+
+const archiveEntry* archive_find(const archive* archive, const char* path) {
+    if (!archive->header) {
+        return 0;
+    }
+
+    u64 hash = archive_hash_path(path);
+    u32 low = 0;
+    u32 high = archive->header->entry_count;
+    while (low < high) {
+        u32 middle = low + (high - low) / 2;
+        u64 middle_hash = archive->entries[middle].name_hash;
+        if (middle_hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == archive->header->entry_count || archive->entries[low].name_hash != hash) {
+        return 0;
+    }
+
+    // The packer refuses colliding hashes, so the name check only guards against foreign paths.
+    const archiveEntry* entry = &archive->entries[low];
+    if (!archive_names_equal(archive->names + entry->name_offset, path)) {
+        return 0;
+    }
+    return entry;
+}
+
+const u8* archive_entry_data(const archive* archive, const archiveEntry* entry) {
+    return archive->view.data + entry->offset;
+}
+
+const char* archive_entry_name(const archive* archive, const archiveEntry* entry) {
+    return archive->names + entry->name_offset;
+}
+
+// Decompression job shared by all chunks of an entry.
+typedef struct archive_decompress_job {
+    const u32* chunk_ends;
+    const u8* chunks;
+    u8* dest;
+    u64 dest_size;
+    u32 failed;
+} archive_decompress_job;
+
+static void archive_decompress_chunk(u32 index, void* params) {
+    archive_decompress_job* job = (archive_decompress_job*)params;
+
+    u64 start = index ? job->chunk_ends[index - 1] : 0;
+    u64 end = job->chunk_ends[index];
+    u64 offset = (u64)index * ARCHIVE_COMPRESSION_CHUNK_SIZE;
+    u64 size = job->dest_size - offset < ARCHIVE_COMPRESSION_CHUNK_SIZE ? job->dest_size - offset : ARCHIVE_COMPRESSION_CHUNK_SIZE;
+
+    // The chunk table was validated by archive_decompress, so the ranges can be trusted here.
+    b8 success;
+    if (end - start == size) {
+        HcopyMemory(job->dest + offset, job->chunks + start, size);
+        success = true;
+    } else {
+        success = compression_decompress_block(job->chunks + start, end - start, job->dest + offset, size);
+    }
+
+    if (!success) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+u64 archive_compress_bound(u64 size) {
+    u64 chunk_count = (size + ARCHIVE_COMPRESSION_CHUNK_SIZE - 1) / ARCHIVE_COMPRESSION_CHUNK_SIZE;
+    return chunk_count * sizeof(u32) + chunk_count * compression_block_bound(ARCHIVE_COMPRESSION_CHUNK_SIZE);
+}
+
+u64 archive_compress(const u8* source, u64 source_size, u8* dest) {
+    u64 chunk_count = (source_size + ARCHIVE_COMPRESSION_CHUNK_SIZE - 1) / ARCHIVE_COMPRESSION_CHUNK_SIZE;
+    u32* chunk_ends = (u32*)dest;
+    u8* chunks = dest + chunk_count * sizeof(u32);
+    u64 chunk_bound = compression_block_bound(ARCHIVE_COMPRESSION_CHUNK_SIZE);
+
+    u64 written = 0;
+    for (u64 i = 0; i < chunk_count; ++i) {
+        u64 offset = i * ARCHIVE_COMPRESSION_CHUNK_SIZE;
+        u64 size = source_size - offset < ARCHIVE_COMPRESSION_CHUNK_SIZE ? source_size - offset : ARCHIVE_COMPRESSION_CHUNK_SIZE;
+
+        u64 compressed_size = compression_compress_block(source + offset, size, chunks + written, chunk_bound);
+        if (compressed_size == 0 || compressed_size >= size) {
+            // Stored as is, the size tells the decompressor.
+            HcopyMemory(chunks + written, source + offset, size);
+            compressed_size = size;
+        }
+        written += compressed_size;
+        if (written > 0xFFFFFFFF) {
+            return 0;
+        }
+        chunk_ends[i] = (u32)written;
+    }
+
+    u64 total = chunk_count * sizeof(u32) + written;
+    return total < source_size ? total : 0;
+}
+
+b8 archive_decompress(const u8* source, u64 source_size, u8* dest, u64 dest_size) {
+    u64 chunk_count = (dest_size + ARCHIVE_COMPRESSION_CHUNK_SIZE - 1) / ARCHIVE_COMPRESSION_CHUNK_SIZE;
+    u64 table_size = chunk_count * sizeof(u32);
+    if (table_size > source_size) {
+        return false;
+    }
+
+    archive_decompress_job job;
+    job.chunk_ends = (const u32*)source;
+    job.chunks = source + table_size;
+    job.dest = dest;
+    job.dest_size = dest_size;
+    job.failed = 0;
+
+    // Walk the whole table before any job runs. Each chunk must be non-empty, end inside the
+    // source and be no bigger than its output, stored chunks being exactly as big.
+    u64 chunks_size = source_size - table_size;
+    u64 previous_end = 0;
+    for (u64 i = 0; i < chunk_count; ++i) {
+        u64 end = job.chunk_ends[i];
+        u64 offset = i * ARCHIVE_COMPRESSION_CHUNK_SIZE;
+        u64 size = dest_size - offset < ARCHIVE_COMPRESSION_CHUNK_SIZE ? dest_size - offset : ARCHIVE_COMPRESSION_CHUNK_SIZE;
+        if (end <= previous_end || end > chunks_size || end - previous_end > size) {
+            return false;
+        }
+        previous_end = end;
+    }
+
+    job_system_parallel_for((u32)chunk_count, archive_decompress_chunk, &job);
+    return !job.failed;
+}
+
+b8 archive_read_entry(const archive* archive, const archiveEntry* entry, void* dest) {
+    const u8* data = archive_entry_data(archive, entry);
+    if (!(entry->flags & ARCHIVE_ENTRY_FLAG_COMPRESSED)) {
+        HcopyMemory(dest, data, entry->size);
+        return true;
+    }
+
+    if (!archive_decompress(data, entry->size, dest, entry->uncompressed_size)) {
+        HERROR("Archive entry '%s' is corrupted.", archive_entry_name(archive, entry));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/filesystem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// "HPAK" read as a little endian u32.
+#define ARCHIVE_MAGIC 0x4B415048
+#define ARCHIVE_VERSION 1
+// Entry data starts at multiples of this, so mapped assets can be used in place (SPIR-V, SIMD loads...).
+#define ARCHIVE_DATA_ALIGNMENT 64
+// Compressed entries are split in independent chunks of this size, so they can be decompressed in parallel.
+#define ARCHIVE_COMPRESSION_CHUNK_SIZE (64 * 1024)
+
+typedef enum archiveEntryFlags {
+    ARCHIVE_ENTRY_FLAG_NONE = 0x0,
+    /**
+     * The stored data is compressed and has to be expanded to uncompressed_size bytes.
+     * Layout: u32 chunk_ends[chunk_count] | chunk data. Each end is relative to the end of
+     * the table. Chunks are compressed with compression_compress_block, except the ones
+     * that didn't shrink, wich are stored as is (stored size == uncompressed chunk size).
+     */
+    ARCHIVE_ENTRY_FLAG_COMPRESSED = 0x1
+} archiveEntryFlags;
+
+/**
+ * On-disk layout, all values little endian:
+ * archiveHeader | archiveEntry[entry_count] sorted by name_hash | names | padded entry data
+ */
+typedef struct archiveHeader {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 flags;
+    // Offset of the table of contents from the start of the file.
+    u64 toc_offset;
+    // Offset and size of the block of null terminated entry names.
+    u64 names_offset;
+    u64 names_size;
+    u64 reserved;
+} archiveHeader;
+
+typedef struct archiveEntry {
+    // archive_hash_path of the entry's name, the table of contents is sorted by it.
+    u64 name_hash;
+    // Offset of the data from the start of the file, aligned to ARCHIVE_DATA_ALIGNMENT.
+    u64 offset;
+    // Size of the stored data in bytes.
+    u64 size;
+    // Size of the data once uncompressed. Equals size for uncompressed entries.
+    u64 uncompressed_size;
+    // Offset of the entry's name in the names block.
+    u32 name_offset;
+    // archiveEntryFlags
+    u32 flags;
+} archiveEntry;
+
+STATIC_ASSERT(sizeof(archiveHeader) == 48, "archiveHeader must stay 48 bytes.");
+STATIC_ASSERT(sizeof(archiveEntry) == 40, "archiveEntry must stay 40 bytes.");
+
+// A mapped archive.
+typedef struct archive {
+    fileView view;
+    const archiveHeader* header;
+    const archiveEntry* entries;
+    const char* names;
+} archive;
+
+/**
+ * Hashes an asset path the way archive entries are named. Backslashes are
+ * treated as forward slashes and a leading "./" is ignored.
+ * @param path The path to be hashed.
+ * @returns The 64 bit FNV-1a hash of the normalized path.
+ */
+HAPI u64 archive_hash_path(const char* path);
+
+/**
+ * Maps the archive located at the given path and validates its table of contents.
+ * @param path The path of the archive.
+ * @param out_archive A pointer to an archive structure wich will be populated by this method.
+ * @returns true on success, false on failure.
+ */
+HAPI b8 archive_open(const char* path, archive* out_archive);
+
+/**
+ * Unmaps the provided archive. Pointers into it must not be used afterward.
+ * @param archive A pointer to the archive to be closed.
+ */
+HAPI void archive_close(archive* archive);
+
+/**
+ * Looks up an entry by path using a binary search over the table of contents.
+ * @param archive A pointer to the archive to be searched.
+ * @param path The path of the entry.
+ * @returns A pointer to the entry if found, otherwise NULL.
+ */
+HAPI const archiveEntry* archive_find(const archive* archive, const char* path);
+
+/**
+ * Obtains the stored data of an entry.
+ * @param archive A pointer to the archive holding the entry.
+ * @param entry A pointer to the entry.
+ * @returns A pointer to the data inside the mapping.
+ */
+HAPI const u8* archive_entry_data(const archive* archive, const archiveEntry* entry);
+
+/**
+ * Obtains the name of an entry.
+ * @param archive A pointer to the archive holding the entry.
+ * @param entry A pointer to the entry.
+ * @returns The null terminated name of the entry.
+ */
+HAPI const char* archive_entry_name(const archive* archive, const archiveEntry* entry);
+
+/**
+ * Reads an entry into dest, decompressing it if needed. Compressed chunks are
+ * decompressed in parallel on the job system, straight into dest.
+ * @param archive A pointer to the archive holding the entry.
+ * @param entry A pointer to the entry.
+ * @param dest The destination, at least entry->uncompressed_size bytes.
+ * @returns true on success, false if the entry is corrupted.
+ */
+HAPI b8 archive_read_entry(const archive* archive, const archiveEntry* entry, void* dest);
+
+/**
+ * @param size The size of the data to be compressed.
+ * @returns The size archive_compress needs for its destination.
+ */
+HAPI u64 archive_compress_bound(u64 size);
+
+/**
+ * Compresses data into the chunked layout of ARCHIVE_ENTRY_FLAG_COMPRESSED entries.
+ * @param source The data to be compressed.
+ * @param source_size The size of the data in bytes.
+ * @param dest The destination, at least archive_compress_bound(source_size) bytes.
+ * @returns The compressed size, or 0 if compression doesn't make the data smaller.
+ */
+HAPI u64 archive_compress(const u8* source, u64 source_size, u8* dest);
+
+/**
+ * Decompresses data in the chunked layout of ARCHIVE_ENTRY_FLAG_COMPRESSED entries.
+ * Chunks are decompressed in parallel on the job system, straight into dest.
+ * @param source The compressed data.
+ * @param source_size The size of the compressed data in bytes.
+ * @param dest The destination for the decompressed data.
+ * @param dest_size The exact size of the decompressed data in bytes.
+ * @returns true on success, false if the data is corrupted.
+ */
+HAPI b8 archive_decompress(const u8* source, u64 source_size, u8* dest, u64 dest_size);
+
+#ifdef __cplusplus
+}
+#endif
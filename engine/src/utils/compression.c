@@ -0,0 +1,209 @@
+#include "utils/compression.h"
+
+#include <string.h>
+
+#define COMPRESSION_MIN_MATCH 4
+// Matches can't reach further back than a 16 bit offset.
+#define COMPRESSION_MAX_OFFSET 65535
+// The block format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end.
+#define COMPRESSION_LAST_LITERALS 5
+#define COMPRESSION_MATCH_LIMIT 12
+// Size of the match finder's hash table, as a power of 2. 4096 entries keep it in L1.
+#define COMPRESSION_HASH_BITS 12
+// Amount of failed match attempts before the search starts skipping ahead faster.
+#define COMPRESSION_SKIP_TRIGGER 6
+
+static u32 read_u32(const u8* data) {
+    u32 value;
+    memcpy(&value, data, sizeof(u32));
+    return value;
+}
+
+static u32 hash_sequence(u32 sequence) {
+    return (sequence * 2654435761u) >> (32 - COMPRESSION_HASH_BITS);
+}
+
+// Writes the bytes following a token nibble of 15: runs of 255 and a final remainder.
+static u8* write_length(u8* out, u64 length) {
+    length -= 15;
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (u8)length;
+    return out;
+}
+
+// Reads the bytes following a token nibble of 15. Returns false if the input ends first.
+static b8 read_length(const u8* source, u64 source_size, u64* position, u64* length) {
+    u8 byte;
+    do {
+        if (*position >= source_size) {
+            return false;
+        }
+        byte = source[(*position)++];
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+u64 compression_block_bound(u64 size) {
+    return size + size / 255 + 16;
+}
+
+u64 compression_compress_block(const u8* source, u64 source_size, u8* dest, u64 dest_capacity) {
+    u8* out = dest;
+    u8* out_end = dest + dest_capacity;
+    u64 anchor = 0;
+
+    if (source_size >= COMPRESSION_MATCH_LIMIT) {
+        u32 table[1 << COMPRESSION_HASH_BITS];
+        memset(table, 0, sizeof(table));
+
+        u64 position = 0;
+        u64 search_limit = source_size - COMPRESSION_MATCH_LIMIT;
+        u64 match_limit = source_size - COMPRESSION_LAST_LITERALS;
+        u32 misses = 0;
+
+        while (position <= search_limit) {
+            u32 sequence = read_u32(source + position);
+            u32 hash = hash_sequence(sequence);
+            u64 candidate = table[hash];
+            table[hash] = (u32)position;
+
+            if (candidate >= position || position - candidate > COMPRESSION_MAX_OFFSET || read_u32(source + candidate) != sequence) {
+                // Incompressible data is skipped over faster the longer nothing matches.
+                position += 1 + (misses++ >> COMPRESSION_SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+
+            // Grow the match backwards into the pending literals, then forwards.
+            while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1]) {
+                position--;
+                candidate--;
+            }
+            u64 match_length = COMPRESSION_MIN_MATCH;
+            while (position + match_length < match_limit && source[position + match_length] == source[candidate + match_length]) {
+                match_length++;
+            }
+
+            u64 literal_length = position - anchor;
+            u64 extra_length = match_length - COMPRESSION_MIN_MATCH;
+            if ((u64)(out_end - out) < 1 + literal_length + literal_length / 255 + 1 + 2 + extra_length / 255 + 1) {
+                return 0;
+            }
+
+            u8* token = out++;
+            *token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+            if (literal_length >= 15) {
+                out = write_length(out, literal_length);
+            }
+            memcpy(out, source + anchor, literal_length);
+            out += literal_length;
+
+            u64 offset = position - candidate;
+            *out++ = (u8)(offset & 0xFF);
+            *out++ = (u8)(offset >> 8);
+
+            *token |= (u8)(extra_length >= 15 ? 15 : extra_length);
+            if (extra_length >= 15) {
+                out = write_length(out, extra_length);
+            }
+
+            position += match_length;
+            anchor = position;
+        }
+    }
+
+    // The remaining bytes go out as a final literal run without a match.
+    u64 literal_length = source_size - anchor;
+    if ((u64)(out_end - out) < 1 + literal_length + literal_length / 255 + 1) {
+        return 0;
+    }
+    u8* token = out++;
+    *token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15) {
+        out = write_length(out, literal_length);
+    }
+    memcpy(out, source + anchor, literal_length);
+    out += literal_length;
+
+    return out - dest;
+}
+
+b8 compression_decompress_block(const u8* source, u64 source_size, u8* dest, u64 dest_size) {
+    u64 in = 0;
+    u64 out = 0;
+
+    while (in < source_size) {
+        u8 token = source[in++];
+
+        u64 literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(source, source_size, &in, &literal_length)) {
+            return false;
+        }
+        if (literal_length > source_size - in || literal_length > dest_size - out) {
+            return false;
+        }
+        if (literal_length <= 16 && source_size - in >= 16 && dest_size - out >= 16) {
+            // Short runs are the common case, a fixed size copy past the end is cheaper than an exact one.
+            memcpy(dest + out, source + in, 16);
+        } else {
+            memcpy(dest + out, source + in, literal_length);
+        }
+        in += literal_length;
+        out += literal_length;
+
+        // The last sequence has no match.
+        if (in == source_size) {
+            break;
+        }
+
+        if (source_size - in < 2) {
+            return false;
+        }
+        u64 offset = source[in] | ((u64)source[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+
+        u64 match_length = token & 0xF;
+        if (match_length == 15 && !read_length(source, source_size, &in, &match_length)) {
+            return false;
+        }
+        match_length += COMPRESSION_MIN_MATCH;
+        if (match_length > dest_size - out) {
+            return false;
+        }
+
+        u8* match_out = dest + out;
+        const u8* match = match_out - offset;
+        if (offset >= 8 && dest_size - out >= match_length + 8) {
+            // 8 byte steps may write past the match, it gets overwritten by what follows.
+            for (u64 i = 0; i < match_length; i += 8) {
+                memcpy(match_out + i, match + i, 8);
+            }
+        } else if (offset >= match_length) {
+            memcpy(match_out, match, match_length);
+        } else if (offset >= 8) {
+            // Overlapping, but far enough apart for 8 byte steps.
+            u64 i = 0;
+            for (; i + 8 <= match_length; i += 8) {
+                memcpy(match_out + i, match + i, 8);
+            }
+            for (; i < match_length; ++i) {
+                match_out[i] = match[i];
+            }
+        } else {
+            // Short repeating patterns (runs of the same byte...) copy byte by byte.
+            for (u64 i = 0; i < match_length; ++i) {
+                match_out[i] = match[i];
+            }
+        }
+        out += match_length;
+    }
+
+    return out == dest_size;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Byte oriented LZ77 block compression using the LZ4 block format: sequences of a
+ * token byte, literals and a 16 bit match offset. Built for decompression speed,
+ * not ratio. Blocks are independent, so large data should be split into chunks
+ * that can be decompressed in parallel.
+ */
+
+/**
+ * @param size The size of the data to be compressed.
+ * @returns The worst case compressed size of size bytes of data.
+ */
+HAPI u64 compression_block_bound(u64 size);
+
+/**
+ * Compresses a block of data.
+ * @param source The data to be compressed.
+ * @param source_size The size of the data in bytes.
+ * @param dest The destination for the compressed data.
+ * @param dest_capacity The size of dest in bytes.
+ * @returns The compressed size, or 0 if the result doesn't fit in dest_capacity.
+ */
+HAPI u64 compression_compress_block(const u8* source, u64 source_size, u8* dest, u64 dest_capacity);
+
+/**
+ * Decompresses a block of data. Corrupted input is detected and never read or written out of bounds.
+ * @param source The compressed data.
+ * @param source_size The size of the compressed data in bytes.
+ * @param dest The destination for the decompressed data.
+ * @param dest_size The exact size of the decompressed data in bytes.
+ * @returns true on success, false if the data is corrupted.
+ */
+HAPI b8 compression_decompress_block(const u8* source, u64 source_size, u8* dest, u64 dest_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,10 +1,22 @@
 #include "utils/hstring.h"
+#include "core/cpu.h"
 #include "memory/hmemory.h"
+#include "memory/linear_allocator.h"
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if HARCH_X64
+#include <immintrin.h>
+#endif
+
+// Most characters string_find_any compares against in vector registers, larger sets use a lookup table.
+#define STRING_SIMD_MAX_SET 8
+// Longest number string_parse_f64 hands to the C runtime when its exact path can't convert it.
+#define STRING_MAX_NUMBER_LENGTH 128
+
 char* string_duplicate(const char* str) {
     u64 len = string_length(str);
     char* copy = Hallocate(len + 1, MEMORY_TAG_STRING);
@@ -32,14 +44,879 @@ i32 string_format(char* dest, const char* format, ...) {
 }
 
 i32 string_format_v(char* dest, const char* format, void* va_listp) {
+    // Same limit as the stack buffer this used to go through.
+    return string_format_nv(dest, 32000, format, va_listp);
+}
+
+i32 string_format_n(char* dest, u64 dest_size, const char* format, ...) {
     if (dest) {
-        // Big, but can fit on the stack.
-        char buffer[32000];
-        i32 written = vsnprintf(buffer, 32000, format, va_listp);
-        buffer[written] = 0;
-        HcopyMemory(dest, buffer, written + 1);
+        __builtin_va_list arg_ptr;
+        va_start(arg_ptr, format);
+        i32 written = string_format_nv(dest, dest_size, format, arg_ptr);
+        va_end(arg_ptr);
+        return written;
+    }
+    return -1;
+}
 
+i32 string_format_nv(char* dest, u64 dest_size, const char* format, void* va_listp) {
+    if (dest && dest_size > 0) {
+        i32 written = vsnprintf(dest, dest_size, format, va_listp);
+        if (written < 0) {
+            dest[0] = 0;
+            return -1;
+        }
+        // vsnprintf reports the untruncated length.
+        if ((u64)written >= dest_size) {
+            written = (i32)(dest_size - 1);
+        }
         return written;
     }
     return -1;
-}
\ No newline at end of file
+}
+
+stringView string_view(const char* str) {
+    stringView view = {str, string_length(str)};
+    return view;
+}
+
+b8 string_views_equal(stringView view1, stringView view2) {
+    return view1.length == view2.length && memcmp(view1.data, view2.data, view1.length) == 0;
+}
+
+u64 string_view_copy(char* dest, u64 dest_size, stringView view) {
+    if (!dest || dest_size == 0) {
+        return 0;
+    }
+    u64 length = view.length < dest_size - 1 ? view.length : dest_size - 1;
+    HcopyMemory(dest, view.data, length);
+    dest[length] = 0;
+    return length;
+}
+
+// Smallest block a builder allocates.
+#define STRING_BUILDER_MIN_CAPACITY 64
+
+// Makes room for at least extra more characters plus the null terminator.
+static b8 string_builder_reserve(stringBuilder* builder, u64 extra) {
+    u64 required = builder->length + extra + 1;
+    if (required <= builder->capacity) {
+        return true;
+    }
+    u64 capacity = builder->capacity ? builder->capacity : STRING_BUILDER_MIN_CAPACITY;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    if (!builder->allocator) {
+        char* data = Hallocate(capacity, MEMORY_TAG_STRING);
+        if (builder->data) {
+            HcopyMemory(data, builder->data, builder->length + 1);
+            Hfree(builder->data, builder->capacity, MEMORY_TAG_STRING);
+        }
+        builder->data = data;
+        builder->capacity = capacity;
+        return true;
+    }
+
+    linear_allocator* allocator = builder->allocator;
+    u8* top = (u8*)allocator->memory + allocator->allocated;
+    if (builder->data && (u8*)builder->data + builder->capacity == top) {
+        // Nothing was allocated after the text, so it can simply grow.
+        if (!allocate_linear_allocator(allocator, capacity - builder->capacity)) {
+            return false;
+        }
+    } else {
+        char* data = allocate_linear_allocator(allocator, capacity);
+        if (!data) {
+            return false;
+        }
+        if (builder->data) {
+            HcopyMemory(data, builder->data, builder->length + 1);
+        }
+        builder->data = data;
+    }
+    builder->capacity = capacity;
+    return true;
+}
+
+void string_builder_create(u64 initial_capacity, linear_allocator* allocator, stringBuilder* out_builder) {
+    out_builder->data = 0;
+    out_builder->length = 0;
+    out_builder->capacity = 0;
+    out_builder->allocator = allocator;
+    if (string_builder_reserve(out_builder, initial_capacity)) {
+        out_builder->data[0] = 0;
+    }
+}
+
+void string_builder_destroy(stringBuilder* builder) {
+    if (!builder->allocator && builder->data) {
+        Hfree(builder->data, builder->capacity, MEMORY_TAG_STRING);
+    }
+    builder->data = 0;
+    builder->length = 0;
+    builder->capacity = 0;
+}
+
+void string_builder_clear(stringBuilder* builder) {
+    builder->length = 0;
+    if (builder->data) {
+        builder->data[0] = 0;
+    }
+}
+
+b8 string_builder_append(stringBuilder* builder, stringView text) {
+    if (!string_builder_reserve(builder, text.length)) {
+        return false;
+    }
+    HcopyMemory(builder->data + builder->length, text.data, text.length);
+    builder->length += text.length;
+    builder->data[builder->length] = 0;
+    return true;
+}
+
+b8 string_builder_append_char(stringBuilder* builder, char c) {
+    stringView text = {&c, 1};
+    return string_builder_append(builder, text);
+}
+
+b8 string_builder_append_format(stringBuilder* builder, const char* format, ...) {
+    if (!string_builder_reserve(builder, 0)) {
+        return false;
+    }
+
+    // Try with the room there is, and only grow when the result didn't fit.
+    va_list arg_ptr;
+    va_start(arg_ptr, format);
+    va_list retry_ptr;
+    va_copy(retry_ptr, arg_ptr);
+    u64 available = builder->capacity - builder->length;
+    i32 written = vsnprintf(builder->data + builder->length, available, format, arg_ptr);
+    va_end(arg_ptr);
+
+    b8 result = written >= 0;
+    if (result && (u64)written >= available) {
+        result = string_builder_reserve(builder, written);
+        if (result) {
+            vsnprintf(builder->data + builder->length, written + 1, format, retry_ptr);
+        }
+    }
+    va_end(retry_ptr);
+
+    if (result) {
+        builder->length += written;
+    } else {
+        builder->data[builder->length] = 0;
+    }
+    return result;
+}
+
+stringView string_builder_view(const stringBuilder* builder) {
+    stringView view = {builder->data ? builder->data : "", builder->length};
+    return view;
+}
+
+static b8 char_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static char char_to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c | 0x20) : c;
+}
+
+// Scalar versions. Used for short strings, the tails of vectorized loops and other architectures.
+
+static i64 find_char_scalar(const char* data, u64 length, char c) {
+    for (u64 i = 0; i < length; ++i) {
+        if (data[i] == c) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+static i64 find_any_scalar(const char* data, u64 length, const char* set, u64 set_length) {
+    u64 table[4] = {0};
+    for (u64 i = 0; i < set_length; ++i) {
+        u8 c = (u8)set[i];
+        table[c >> 6] |= 1ull << (c & 63);
+    }
+    for (u64 i = 0; i < length; ++i) {
+        u8 c = (u8)data[i];
+        if (table[c >> 6] & (1ull << (c & 63))) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+// Needle of at least 2 characters.
+static i64 find_scalar(const char* data, u64 length, const char* needle, u64 needle_length) {
+    for (u64 i = 0; i + needle_length <= length; ++i) {
+        if (data[i] == needle[0] && data[i + needle_length - 1] == needle[needle_length - 1] &&
+            memcmp(data + i + 1, needle + 1, needle_length - 2) == 0) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+static b8 equali_scalar(const char* data1, const char* data2, u64 length) {
+    for (u64 i = 0; i < length; ++i) {
+        if (char_to_lower(data1[i]) != char_to_lower(data2[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adds the offset of a result found in the tail of a vectorized loop.
+static i64 offset_result(i64 result, u64 offset) {
+    return result < 0 ? -1 : result + (i64)offset;
+}
+
+#if HARCH_X64
+// SSE2 versions, 16 characters at a time. SSE2 is part of x86-64, so these need no target attribute.
+
+static i64 find_char_sse2(const char* data, u64 length, char c) {
+    __m128i target = _mm_set1_epi8(c);
+    u64 i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, target));
+        if (mask) {
+            return (i64)(i + __builtin_ctz(mask));
+        }
+    }
+    return offset_result(find_char_scalar(data + i, length - i, c), i);
+}
+
+static i64 find_any_sse2(const char* data, u64 length, const char* set, u64 set_length) {
+    __m128i targets[STRING_SIMD_MAX_SET];
+    for (u64 j = 0; j < set_length; ++j) {
+        targets[j] = _mm_set1_epi8(set[j]);
+    }
+    u64 i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i matches = _mm_cmpeq_epi8(block, targets[0]);
+        for (u64 j = 1; j < set_length; ++j) {
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, targets[j]));
+        }
+        u32 mask = (u32)_mm_movemask_epi8(matches);
+        if (mask) {
+            return (i64)(i + __builtin_ctz(mask));
+        }
+    }
+    return offset_result(find_any_scalar(data + i, length - i, set, set_length), i);
+}
+
+// Compares the first and last characters of the needle 16 positions at a time, only candidates matching both get a memcmp.
+static i64 find_sse2(const char* data, u64 length, const char* needle, u64 needle_length) {
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+    u64 i = 0;
+    for (; i + needle_length - 1 + 16 <= length; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(data + i + needle_length - 1));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            u32 bit = __builtin_ctz(mask);
+            if (memcmp(data + i + bit + 1, needle + 1, needle_length - 2) == 0) {
+                return (i64)(i + bit);
+            }
+            mask &= mask - 1;
+        }
+    }
+    return offset_result(find_scalar(data + i, length - i, needle, needle_length), i);
+}
+
+// Lowercases 'A'-'Z'. Characters from 0x80 up compare as negative, so they're left alone.
+static __m128i fold_case_sse2(__m128i block) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), block));
+    return _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static b8 equali_sse2(const char* data1, const char* data2, u64 length) {
+    u64 i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block1 = fold_case_sse2(_mm_loadu_si128((const __m128i*)(data1 + i)));
+        __m128i block2 = fold_case_sse2(_mm_loadu_si128((const __m128i*)(data2 + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return equali_scalar(data1 + i, data2 + i, length - i);
+}
+
+// AVX2 versions, 32 characters at a time. What's left is handed to the SSE2 versions.
+
+HTARGET_AVX2 static i64 find_char_avx2(const char* data, u64 length, char c) {
+    __m256i target = _mm256_set1_epi8(c);
+    u64 i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, target));
+        if (mask) {
+            return (i64)(i + __builtin_ctz(mask));
+        }
+    }
+    return offset_result(find_char_sse2(data + i, length - i, c), i);
+}
+
+HTARGET_AVX2 static i64 find_any_avx2(const char* data, u64 length, const char* set, u64 set_length) {
+    __m256i targets[STRING_SIMD_MAX_SET];
+    for (u64 j = 0; j < set_length; ++j) {
+        targets[j] = _mm256_set1_epi8(set[j]);
+    }
+    u64 i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i matches = _mm256_cmpeq_epi8(block, targets[0]);
+        for (u64 j = 1; j < set_length; ++j) {
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, targets[j]));
+        }
+        u32 mask = (u32)_mm256_movemask_epi8(matches);
+        if (mask) {
+            return (i64)(i + __builtin_ctz(mask));
+        }
+    }
+    return offset_result(find_any_sse2(data + i, length - i, set, set_length), i);
+}
+
+HTARGET_AVX2 static i64 find_avx2(const char* data, u64 length, const char* needle, u64 needle_length) {
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last = _mm256_set1_epi8(needle[needle_length - 1]);
+    u64 i = 0;
+    for (; i + needle_length - 1 + 32 <= length; i += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i*)(data + i + needle_length - 1));
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            u32 bit = __builtin_ctz(mask);
+            if (memcmp(data + i + bit + 1, needle + 1, needle_length - 2) == 0) {
+                return (i64)(i + bit);
+            }
+            mask &= mask - 1;
+        }
+    }
+    return offset_result(find_sse2(data + i, length - i, needle, needle_length), i);
+}
+
+HTARGET_AVX2 static b8 equali_avx2(const char* data1, const char* data2, u64 length) {
+    __m256i below = _mm256_set1_epi8('A' - 1);
+    __m256i above = _mm256_set1_epi8('Z' + 1);
+    __m256i bit = _mm256_set1_epi8(0x20);
+    u64 i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i block1 = _mm256_loadu_si256((const __m256i*)(data1 + i));
+        __m256i block2 = _mm256_loadu_si256((const __m256i*)(data2 + i));
+        __m256i upper1 = _mm256_and_si256(_mm256_cmpgt_epi8(block1, below), _mm256_cmpgt_epi8(above, block1));
+        __m256i upper2 = _mm256_and_si256(_mm256_cmpgt_epi8(block2, below), _mm256_cmpgt_epi8(above, block2));
+        block1 = _mm256_or_si256(block1, _mm256_and_si256(upper1, bit));
+        block2 = _mm256_or_si256(block2, _mm256_and_si256(upper2, bit));
+        if ((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2)) != 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    return equali_sse2(data1 + i, data2 + i, length - i);
+}
+#endif
+
+b8 strings_equali(const char* str1, const char* str2) {
+    return string_views_equali(string_view(str1), string_view(str2));
+}
+
+b8 string_views_equali(stringView view1, stringView view2) {
+    if (view1.length != view2.length) {
+        return false;
+    }
+#if HARCH_X64
+    u32 features = cpu_get_features();
+    if ((features & CPU_FEATURE_AVX2) && view1.length >= 32) {
+        return equali_avx2(view1.data, view2.data, view1.length);
+    }
+    if ((features & CPU_FEATURE_SSE2) && view1.length >= 16) {
+        return equali_sse2(view1.data, view2.data, view1.length);
+    }
+#endif
+    return equali_scalar(view1.data, view2.data, view1.length);
+}
+
+i64 string_find_char(stringView str, char c) {
+#if HARCH_X64
+    u32 features = cpu_get_features();
+    if ((features & CPU_FEATURE_AVX2) && str.length >= 32) {
+        return find_char_avx2(str.data, str.length, c);
+    }
+    if ((features & CPU_FEATURE_SSE2) && str.length >= 16) {
+        return find_char_sse2(str.data, str.length, c);
+    }
+#endif
+    return find_char_scalar(str.data, str.length, c);
+}
+
+i64 string_find(stringView str, stringView needle) {
+    if (needle.length == 0) {
+        return 0;
+    }
+    if (needle.length > str.length) {
+        return -1;
+    }
+    if (needle.length == 1) {
+        return string_find_char(str, needle.data[0]);
+    }
+#if HARCH_X64
+    u32 features = cpu_get_features();
+    if ((features & CPU_FEATURE_AVX2) && str.length >= 32 + needle.length) {
+        return find_avx2(str.data, str.length, needle.data, needle.length);
+    }
+    if ((features & CPU_FEATURE_SSE2) && str.length >= 16 + needle.length) {
+        return find_sse2(str.data, str.length, needle.data, needle.length);
+    }
+#endif
+    return find_scalar(str.data, str.length, needle.data, needle.length);
+}
+
+i64 string_find_any(stringView str, stringView set) {
+    if (set.length == 1) {
+        return string_find_char(str, set.data[0]);
+    }
+#if HARCH_X64
+    if (set.length > 0 && set.length <= STRING_SIMD_MAX_SET) {
+        u32 features = cpu_get_features();
+        if ((features & CPU_FEATURE_AVX2) && str.length >= 32) {
+            return find_any_avx2(str.data, str.length, set.data, set.length);
+        }
+        if ((features & CPU_FEATURE_SSE2) && str.length >= 16) {
+            return find_any_sse2(str.data, str.length, set.data, set.length);
+        }
+    }
+#endif
+    return find_any_scalar(str.data, str.length, set.data, set.length);
+}
+
+b8 string_split_next(stringView* remaining, stringView delimiters, b8 skip_empty, stringView* out_token) {
+    // A null data pointer marks the end, an empty remaining string still holds one (empty) token.
+    while (remaining->data) {
+        i64 index = string_find_any(*remaining, delimiters);
+        stringView token = {remaining->data, index < 0 ? remaining->length : (u64)index};
+        if (index < 0) {
+            remaining->data = 0;
+            remaining->length = 0;
+        } else {
+            remaining->data += index + 1;
+            remaining->length -= index + 1;
+        }
+
+        if (token.length > 0 || !skip_empty) {
+            *out_token = token;
+            return true;
+        }
+    }
+    return false;
+}
+
+stringView string_trim(stringView str) {
+    while (str.length > 0 && char_is_space(str.data[0])) {
+        str.data++;
+        str.length--;
+    }
+    while (str.length > 0 && char_is_space(str.data[str.length - 1])) {
+        str.length--;
+    }
+    return str;
+}
+
+// Checks if 8 characters are all digits. From "Parsing series of integers with SIMD" (Muła/Lemire), done in a u64.
+static b8 are_eight_digits(u64 chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+// Converts 8 digit characters (little-endian) to their value with 3 multiplications instead of 8.
+static u32 parse_eight_digits(u64 chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return (u32)chunk;
+}
+
+// Accumulates up to max_digits digits from *cursor into value, advancing past them. Returns the amount read.
+static u32 read_digits(const char** cursor, const char* end, u64* value, u32 max_digits) {
+    const char* p = *cursor;
+    u32 count = 0;
+    while (end - p >= 8 && max_digits - count >= 8) {
+        u64 chunk;
+        memcpy(&chunk, p, sizeof(u64));
+        if (!are_eight_digits(chunk)) {
+            break;
+        }
+        *value = *value * 100000000ull + parse_eight_digits(chunk);
+        p += 8;
+        count += 8;
+    }
+    while (p < end && count < max_digits && *p >= '0' && *p <= '9') {
+        *value = *value * 10 + (u64)(*p - '0');
+        p++;
+        count++;
+    }
+    *cursor = p;
+    return count;
+}
+
+static const char* skip_zeros(const char* p, const char* end) {
+    while (p < end && *p == '0') {
+        p++;
+    }
+    return p;
+}
+
+static b8 is_digit_at(const char* p, const char* end) {
+    return p < end && *p >= '0' && *p <= '9';
+}
+
+b8 string_parse_i64(stringView str, i64* out_value) {
+    const char* p = str.data;
+    const char* end = str.data + str.length;
+    b8 negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    if (!is_digit_at(p, end)) {
+        return false;
+    }
+
+    // 19 digits always fit in a u64, leading zeros don't count.
+    p = skip_zeros(p, end);
+    u64 value = 0;
+    read_digits(&p, end, &value, 19);
+    if (p != end) {
+        return false;
+    }
+
+    u64 limit = negative ? 0x8000000000000000ull : 0x7FFFFFFFFFFFFFFFull;
+    if (value > limit) {
+        return false;
+    }
+    *out_value = negative ? (i64)(0 - value) : (i64)value;
+    return true;
+}
+
+// Powers of 10 wich are exactly representable as doubles.
+static const f64 powers_of_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Lets the C runtime convert what the exact path can't. str has already been checked to be a number.
+static b8 parse_f64_fallback(stringView str, f64* out_value) {
+    if (str.length >= STRING_MAX_NUMBER_LENGTH) {
+        return false;
+    }
+    char buffer[STRING_MAX_NUMBER_LENGTH];
+    string_view_copy(buffer, sizeof(buffer), str);
+    char* parsed_end;
+    f64 value = strtod(buffer, &parsed_end);
+    if (parsed_end != buffer + str.length) {
+        return false;
+    }
+    *out_value = value;
+    return true;
+}
+
+b8 string_parse_f64(stringView str, f64* out_value) {
+    const char* p = str.data;
+    const char* end = str.data + str.length;
+    b8 negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    // Infinity, NaN and such are rare, the C runtime handles them.
+    if (p < end && (*p == 'i' || *p == 'I' || *p == 'n' || *p == 'N')) {
+        return parse_f64_fallback(str, out_value);
+    }
+
+    // Significant digits go into mantissa, at most 19 of them so it can't overflow.
+    u64 mantissa = 0;
+    i64 exponent = 0;
+    u32 significant = 0;
+    b8 truncated = false;
+    b8 has_digits = is_digit_at(p, end);
+
+    p = skip_zeros(p, end);
+    significant = read_digits(&p, end, &mantissa, 19);
+    if (is_digit_at(p, end)) {
+        truncated = true;
+        while (is_digit_at(p, end)) {
+            p++;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        has_digits = has_digits || is_digit_at(p, end);
+        if (significant == 0) {
+            // Zeros right after the point only move the exponent.
+            const char* start = p;
+            p = skip_zeros(p, end);
+            exponent -= p - start;
+        }
+        u32 fraction = read_digits(&p, end, &mantissa, 19 - significant);
+        significant += fraction;
+        exponent -= fraction;
+        if (is_digit_at(p, end)) {
+            truncated = true;
+            while (is_digit_at(p, end)) {
+                p++;
+            }
+        }
+    }
+
+    if (!has_digits) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        b8 negative_exponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            p++;
+        }
+        if (!is_digit_at(p, end)) {
+            return false;
+        }
+        p = skip_zeros(p, end);
+        u64 exponent_value = 0;
+        read_digits(&p, end, &exponent_value, 8);
+        if (is_digit_at(p, end)) {
+            // Out of range for any double either way.
+            truncated = true;
+            while (is_digit_at(p, end)) {
+                p++;
+            }
+        }
+        exponent += negative_exponent ? -(i64)exponent_value : (i64)exponent_value;
+    }
+
+    if (p != end) {
+        return false;
+    }
+
+    // Exact when both the mantissa and the power of 10 are exact doubles (Clinger's fast path).
+    if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+        f64 value = (f64)mantissa;
+        value = exponent < 0 ? value / powers_of_10[-exponent] : value * powers_of_10[exponent];
+        *out_value = negative ? -value : value;
+        return true;
+    }
+    return parse_f64_fallback(str, out_value);
+}
+
+b8 string_parse_f32(stringView str, f32* out_value) {
+    f64 value;
+    if (!string_parse_f64(str, &value)) {
+        return false;
+    }
+    *out_value = (f32)value;
+    return true;
+}
+
+// "00" to "99", so numbers are written two digits per division.
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static u32 count_digits(u64 value) {
+    u32 digits = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        digits += 4;
+    }
+    if (value >= 1000) return digits + 3;
+    if (value >= 100) return digits + 2;
+    if (value >= 10) return digits + 1;
+    return digits;
+}
+
+// Writes exactly digits characters, padding with leading zeros. Not null terminated.
+static void write_digits(char* dest, u64 value, u32 digits) {
+    char* p = dest + digits;
+    while (value >= 100) {
+        u32 pair = (u32)(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        p[0] = digit_pairs[pair];
+        p[1] = digit_pairs[pair + 1];
+    }
+    if (value >= 10) {
+        p -= 2;
+        p[0] = digit_pairs[value * 2];
+        p[1] = digit_pairs[value * 2 + 1];
+    } else if (p > dest) {
+        *--p = (char)('0' + value);
+    }
+    while (p > dest) {
+        *--p = '0';
+    }
+}
+
+u32 string_write_u64(char* dest, u64 value) {
+    u32 length = count_digits(value);
+    write_digits(dest, value, length);
+    dest[length] = 0;
+    return length;
+}
+
+u32 string_write_i64(char* dest, i64 value) {
+    if (value < 0) {
+        dest[0] = '-';
+        return string_write_u64(dest + 1, 0 - (u64)value) + 1;
+    }
+    return string_write_u64(dest, (u64)value);
+}
+
+// Rounding error of product = a * b, exactly (Dekker's product). Needs multiplies and adds not to be fused.
+static f64 product_error(f64 a, f64 b, f64 product) {
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+    const f64 split = 134217729.0;
+    f64 t = a * split;
+    f64 a_high = t - (t - a);
+    f64 a_low = a - a_high;
+    t = b * split;
+    f64 b_high = t - (t - b);
+    f64 b_low = b - b_high;
+    return ((a_high * b_high - product) + a_high * b_low + a_low * b_high) + a_low * b_low;
+}
+
+/*
+ * Fixed notation without the C runtime, rounded exactly like printf: value is scaled by
+ * 10^precision and rounded to an integer. Only the scaled values below 2^53 are handled,
+ * where that integer and the rounding are exact. Returns 0 otherwise.
+ */
+static u32 write_fixed_f64(char* dest, u64 dest_size, f64 value, u32 precision) {
+    // 10^precision has to fit in a u64 as well.
+    if (precision > 19) {
+        return 0;
+    }
+    u64 bits;
+    HcopyMemory(&bits, &value, sizeof(f64));
+    b8 negative = (bits >> 63) != 0;
+    f64 magnitude = negative ? -value : value;
+
+    f64 scale = powers_of_10[precision];
+    f64 scaled = magnitude * scale;
+    // Also rules out infinity and NaN.
+    if (!(scaled < 9007199254740992.0)) {
+        return 0;
+    }
+
+    u64 rounded = (u64)scaled;
+    f64 remainder = scaled - (f64)rounded;
+    if (remainder > 0.5) {
+        rounded++;
+    } else if (remainder == 0.5) {
+        // The product can have been rounded onto the tie, its rounding error tells wich way the exact value lies.
+        f64 error = product_error(magnitude, scale, scaled);
+        if (error > 0.0 || (error == 0.0 && (rounded & 1))) {
+            rounded++;
+        }
+    }
+
+    u64 divisor = (u64)scale;
+    u64 whole = rounded / divisor;
+    u64 fraction = rounded % divisor;
+    u32 whole_digits = count_digits(whole);
+    u32 length = negative + whole_digits + (precision ? precision + 1 : 0);
+    if (length >= dest_size) {
+        return 0;
+    }
+
+    char* p = dest;
+    if (negative) {
+        *p++ = '-';
+    }
+    write_digits(p, whole, whole_digits);
+    p += whole_digits;
+    if (precision) {
+        *p++ = '.';
+        write_digits(p, fraction, precision);
+        p += precision;
+    }
+    *p = 0;
+    return length;
+}
+
+u32 string_write_f64(char* dest, u64 dest_size, f64 value, u32 precision) {
+    u32 length = write_fixed_f64(dest, dest_size, value, precision);
+    if (length || !dest_size) {
+        return length;
+    }
+    // Huge values, infinity and NaN.
+    i32 written = snprintf(dest, dest_size, "%.*f", (int)precision, value);
+    if (written < 0 || (u64)written >= dest_size) {
+        dest[0] = 0;
+        return 0;
+    }
+    return (u32)written;
+}
+
+u32 string_write_bytes(char* dest, u64 bytes) {
+    const u64 gib = 1024 * 1024 * 1024;
+    const u64 mib = 1024 * 1024;
+    const u64 kib = 1024;
+
+    const char* unit;
+    f64 amount;
+    if (bytes >= gib) {
+        unit = "GiB";
+        amount = bytes / (f64)gib;
+    } else if (bytes >= mib) {
+        unit = "MiB";
+        amount = bytes / (f64)mib;
+    } else if (bytes >= kib) {
+        unit = "KiB";
+        amount = bytes / (f64)kib;
+    } else {
+        unit = "B";
+        amount = (f64)bytes;
+    }
+
+    // At most 2^64 / 2^30 GiB, wich has 11 whole digits.
+    u32 length = write_fixed_f64(dest, STRING_NUMBER_BUFFER_SIZE, amount, 2);
+    u32 unit_length = unit[1] ? 3 : 1;
+    HcopyMemory(dest + length, unit, unit_length + 1);
+    return length + unit_length;
+}
+
+b8 string_builder_append_u64(stringBuilder* builder, u64 value) {
+    char number[STRING_NUMBER_BUFFER_SIZE];
+    stringView text = {number, string_write_u64(number, value)};
+    return string_builder_append(builder, text);
+}
+
+b8 string_builder_append_i64(stringBuilder* builder, i64 value) {
+    char number[STRING_NUMBER_BUFFER_SIZE];
+    stringView text = {number, string_write_i64(number, value)};
+    return string_builder_append(builder, text);
+}
+
+b8 string_builder_append_f64(stringBuilder* builder, f64 value, u32 precision) {
+    char number[STRING_NUMBER_BUFFER_SIZE];
+    u32 length = write_fixed_f64(number, sizeof(number), value, precision);
+    if (!length) {
+        return string_builder_append_format(builder, "%.*f", (int)precision, value);
+    }
+    stringView text = {number, length};
+    return string_builder_append(builder, text);
+}
+
+b8 string_builder_append_bytes(stringBuilder* builder, u64 bytes) {
+    char number[STRING_NUMBER_BUFFER_SIZE];
+    stringView text = {number, string_write_bytes(number, bytes)};
+    return string_builder_append(builder, text);
+}
@@ -6,9 +6,33 @@
 extern "C" { 
 #endif
 
+// A borrowed range of characters, not null terminated. Only valid as long as the memory it points into.
+typedef struct stringView {
+    const char* data;
+    u64 length;
+} stringView;
+
+// Enough room for any number written by string_write_u64, string_write_i64 or string_write_bytes.
+#define STRING_NUMBER_BUFFER_SIZE 32
+
+struct linear_allocator;
+
+// A growable, null terminated string.
+typedef struct stringBuilder {
+    char* data;
+    // Length of the text, excluding the null terminator.
+    u64 length;
+    // Size of data in bytes.
+    u64 capacity;
+    // Where data comes from, NULL for the heap (MEMORY_TAG_STRING).
+    struct linear_allocator* allocator;
+} stringBuilder;
+
 // Returns the length of the given string
 HAPI u64 string_length(const char* str);
 
+// Allocates a copy of the string (MEMORY_TAG_STRING) wich must be freed by the caller.
+// Prefer a stringView to refer to existing text, or a stringBuilder to put text together.
 HAPI char* string_duplicate(const char* str);
 
 // Case-sensitive string comparison. true if the same, otherwise false.
@@ -19,6 +43,7 @@ HAPI i32 string_format(char* dest, const char* format, ...);
 
 /**
  * Performs variadic string formatting to dest given format string and va_list.
+ * Formats straight into dest, which is assumed to hold at least 32000 characters.
  * @param dest The destination for the formatted string.
  * @param format The string to be formatted.
  * @param va_list The variadic argument list.
@@ -26,6 +51,170 @@ HAPI i32 string_format(char* dest, const char* format, ...);
  */
 HAPI i32 string_format_v(char* dest, const char* format, void* va_list);
 
+/**
+ * Performs string formatting to dest, writing at most dest_size characters
+ * including the null terminator. Output that doesn't fit is truncated.
+ * @param dest The destination for the formatted string.
+ * @param dest_size The size of dest in bytes.
+ * @param format The string to be formatted.
+ * @returns The amount of characters written, excluding the null terminator; -1 on error.
+ */
+HAPI i32 string_format_n(char* dest, u64 dest_size, const char* format, ...);
+
+/**
+ * Variadic version of string_format_n.
+ * @param dest The destination for the formatted string.
+ * @param dest_size The size of dest in bytes.
+ * @param format The string to be formatted.
+ * @param va_list The variadic argument list.
+ * @returns The amount of characters written, excluding the null terminator; -1 on error.
+ */
+HAPI i32 string_format_nv(char* dest, u64 dest_size, const char* format, void* va_list);
+
+// Returns a view of the whole null terminated string.
+HAPI stringView string_view(const char* str);
+
+// Case-sensitive comparison of two views. true if the same, otherwise false.
+HAPI b8 string_views_equal(stringView view1, stringView view2);
+
+/**
+ * Copies the characters of a view into dest as a null terminated string.
+ * Characters that don't fit are truncated.
+ * @param dest The destination for the string.
+ * @param dest_size The size of dest in bytes.
+ * @param view The view to be copied.
+ * @returns The amount of characters copied, excluding the null terminator.
+ */
+HAPI u64 string_view_copy(char* dest, u64 dest_size, stringView view);
+
+/**
+ * Creates an empty string builder. With an allocator, e.g. one reset every frame, growing
+ * extends the text in place while it is the allocator's latest allocation and otherwise
+ * moves it, leaving the old block to be released along with the allocator.
+ * @param initial_capacity The amount of characters to make room for up front.
+ * @param allocator The linear allocator to take memory from. Pass NULL to use the heap.
+ * @param out_builder A pointer to a stringBuilder structure wich will be populated by this method.
+ */
+HAPI void string_builder_create(u64 initial_capacity, struct linear_allocator* allocator, stringBuilder* out_builder);
+
+// Releases the builder's memory, if it owns heap memory. Its text must not be used afterward.
+HAPI void string_builder_destroy(stringBuilder* builder);
+
+// Empties the builder, keeping its memory.
+HAPI void string_builder_clear(stringBuilder* builder);
+
+/**
+ * Appends text to the builder.
+ * @param builder A pointer to a stringBuilder structure.
+ * @param text The text to be appended.
+ * @returns true on success, false if the builder's allocator ran out of memory. The text is left unchanged then.
+ */
+HAPI b8 string_builder_append(stringBuilder* builder, stringView text);
+
+// Appends a single character. Returns false if the builder's allocator ran out of memory.
+HAPI b8 string_builder_append_char(stringBuilder* builder, char c);
+
+/**
+ * Appends formatted text to the builder, growing it as needed instead of truncating.
+ * @param builder A pointer to a stringBuilder structure.
+ * @param format The string to be formatted.
+ * @returns true on success, false if the builder's allocator ran out of memory or the format failed. The text is left unchanged then.
+ */
+HAPI b8 string_builder_append_format(stringBuilder* builder, const char* format, ...);
+
+// Returns a view of the builder's text, valid until the builder changes.
+HAPI stringView string_builder_view(const stringBuilder* builder);
+
+// Case-insensitive (ASCII) string comparison. true if the same, otherwise false.
+HAPI b8 strings_equali(const char* str1, const char* str2);
+
+// Case-insensitive (ASCII) comparison of two views. true if the same, otherwise false.
+HAPI b8 string_views_equali(stringView view1, stringView view2);
+
+/*
+ * Searching and parsing. Long inputs are scanned 16 or 32 characters at a time with
+ * SSE2/AVX2, picked at runtime from cpu_get_features, with scalar fallbacks elsewhere.
+ */
+
+// Returns the index of the first c in str, -1 if there is none.
+HAPI i64 string_find_char(stringView str, char c);
+
+// Returns the index of the first occurrence of needle in str, -1 if there is none. An empty needle is found at 0.
+HAPI i64 string_find(stringView str, stringView needle);
+
+// Returns the index of the first character of str that is any of the characters in set, -1 if there is none.
+HAPI i64 string_find_any(stringView str, stringView set);
+
+/**
+ * Splits off the next token of a string. Tokens are separated by any of the delimiter characters.
+ * @param remaining The string left to split. Advanced past the token and its delimiter.
+ * @param delimiters The characters separating tokens.
+ * @param skip_empty Skip the empty tokens between consecutive delimiters, e.g. for runs of whitespace.
+ * @param out_token A pointer to a view wich will be populated with the token.
+ * @returns true if a token was split off, false once remaining is used up.
+ */
+HAPI b8 string_split_next(stringView* remaining, stringView delimiters, b8 skip_empty, stringView* out_token);
+
+// Returns str without leading and trailing whitespace (spaces, tabs, '\r', '\n', '\v' and '\f').
+HAPI stringView string_trim(stringView str);
+
+/**
+ * Parses a whole string as a decimal integer with an optional sign.
+ * @param str The string to be parsed.
+ * @param out_value A pointer to a number wich will be populated by this method.
+ * @returns true on success, false if str isn't an integer or it doesn't fit.
+ */
+HAPI b8 string_parse_i64(stringView str, i64* out_value);
+
+/**
+ * Parses a whole string as a floating point number, e.g. "-1.5", "2e-3" or "inf".
+ * Common inputs are converted exactly without going through the C runtime.
+ * @param str The string to be parsed.
+ * @param out_value A pointer to a number wich will be populated by this method.
+ * @returns true on success, false if str isn't a number.
+ */
+HAPI b8 string_parse_f64(stringView str, f64* out_value);
+
+// 32 bit version of string_parse_f64.
+HAPI b8 string_parse_f32(stringView str, f32* out_value);
+
+/*
+ * Number output without going through printf. Integers are written two digits at a time,
+ * fixed notation floats are rounded exactly like printf's "%.*f" would.
+ */
+
+// Writes value in decimal to dest (at least STRING_NUMBER_BUFFER_SIZE characters). Returns the length written.
+HAPI u32 string_write_u64(char* dest, u64 value);
+
+// Signed version of string_write_u64.
+HAPI u32 string_write_i64(char* dest, i64 value);
+
+/**
+ * Writes a floating point number in fixed notation, e.g. "-12.50" for a precision of 2.
+ * Values too big for the fast path, infinity and NaN go through the C runtime.
+ * @param dest The buffer to write to.
+ * @param dest_size The size of dest, including the null terminator.
+ * @param value The number to be written.
+ * @param precision The number of digits after the decimal point.
+ * @returns The length written, 0 if it didn't fit in dest.
+ */
+HAPI u32 string_write_f64(char* dest, u64 dest_size, f64 value, u32 precision);
+
+// Writes a byte count with a binary unit and 2 decimals, e.g. "1.50MiB", to dest (at least STRING_NUMBER_BUFFER_SIZE characters). Returns the length written.
+HAPI u32 string_write_bytes(char* dest, u64 bytes);
+
+// Appends value in decimal. Returns false if the builder's allocator ran out of memory.
+HAPI b8 string_builder_append_u64(stringBuilder* builder, u64 value);
+
+// Appends value in decimal. Returns false if the builder's allocator ran out of memory.
+HAPI b8 string_builder_append_i64(stringBuilder* builder, i64 value);
+
+// Appends value in fixed notation with precision decimals. Returns false if the builder's allocator ran out of memory.
+HAPI b8 string_builder_append_f64(stringBuilder* builder, f64 value, u32 precision);
+
+// Appends a byte count as written by string_write_bytes. Returns false if the builder's allocator ran out of memory.
+HAPI b8 string_builder_append_bytes(stringBuilder* builder, u64 bytes);
+
 #ifdef __cplusplus
 } 
 #endif
\ No newline at end of file
@@ -0,0 +1,10 @@
+@ECHO OFF
+REM Build script for packer
+
+ECHO "Building Packer..."
+
+cd ..
+make -f "Makefile.packer.windows.mak" all 
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit)
+
+ECHO "Packer built successfully."
\ No newline at end of file
@@ -0,0 +1,16 @@
+#!/bin/bash
+# Build script for packer
+set echo on
+
+echo "Building Packer..."
+
+cd ..
+
+mkdir -p bin
+make -f "Makefile.packer.linux.mak" all 
+if [ $? -ne 0 ]; then
+    echo "Error: $?"
+    exit 1
+fi
+
+echo "Packer built successfully."
\ No newline at end of file
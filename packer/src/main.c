@@ -0,0 +1,179 @@
+// main.c
+// Packs asset files into an archive the engine can mount.
+// Usage: packer [-c] <output archive> <root directory> <asset path>...
+// Entries are named after the asset paths as given and read from <root directory>/<asset path>.
+// With -c, entries are compressed unless that doesn't make them smaller.
+
+#include <core/logger.h>
+#include <platform/filesystem.h>
+#include <resources/archive.h>
+#include <utils/hstring.h>
+
+#include <stdlib.h>
+
+#define PACKER_MAX_PATH 512
+
+typedef struct packerEntry {
+    char name[PACKER_MAX_PATH];
+    u64 hash;
+    fileView view;
+    // The bytes to be stored, either the view or the compressed copy.
+    const u8* stored;
+    u8* compressed;
+    archiveEntry toc;
+} packerEntry;
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Stores the path the way archive_hash_path sees it.
+static void normalize_name(const char* path, char* out_name) {
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        path += 2;
+    }
+    u64 i = 0;
+    for (; path[i] && i < PACKER_MAX_PATH - 1; ++i) {
+        out_name[i] = path[i] == '\\' ? '/' : path[i];
+    }
+    out_name[i] = 0;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    u64 hash_a = ((const packerEntry*)a)->hash;
+    u64 hash_b = ((const packerEntry*)b)->hash;
+    return hash_a < hash_b ? -1 : (hash_a > hash_b ? 1 : 0);
+}
+
+static b8 write_bytes(fileHandle* file, const void* data, u64 size) {
+    u64 written = 0;
+    return filesystem_write(file, size, data, &written) && written == size;
+}
+
+int main(int argc, char** argv) {
+    b8 compress = argc > 1 && strings_equal(argv[1], "-c");
+    if (compress) {
+        argv++;
+        argc--;
+    }
+    if (argc < 4) {
+        HERROR("Usage: packer [-c] <output archive> <root directory> <asset path>...");
+        return 1;
+    }
+
+    const char* output_path = argv[1];
+    const char* root = argv[2];
+    u32 entry_count = (u32)(argc - 3);
+    packerEntry* entries = calloc(entry_count, sizeof(packerEntry));
+
+    // Map every input so the data is only touched once, while writing.
+    for (u32 i = 0; i < entry_count; ++i) {
+        packerEntry* entry = &entries[i];
+        if (string_length(argv[i + 3]) >= PACKER_MAX_PATH) {
+            HERROR("Asset path too long: '%s'", argv[i + 3]);
+            return 1;
+        }
+        normalize_name(argv[i + 3], entry->name);
+        entry->hash = archive_hash_path(entry->name);
+
+        char source[PACKER_MAX_PATH * 2];
+        string_format_n(source, sizeof(source), "%s/%s", root, entry->name);
+        if (!filesystem_map(source, &entry->view)) {
+            return 1;
+        }
+    }
+
+    // The engine binary searches the table of contents by hash.
+    qsort(entries, entry_count, sizeof(packerEntry), compare_entries);
+    for (u32 i = 1; i < entry_count; ++i) {
+        if (entries[i - 1].hash == entries[i].hash) {
+            if (strings_equal(entries[i - 1].name, entries[i].name)) {
+                HERROR("'%s' was given more than once.", entries[i].name);
+            } else {
+                HERROR("'%s' and '%s' have the same hash, rename one of them.", entries[i - 1].name, entries[i].name);
+            }
+            return 1;
+        }
+    }
+
+    // Lay out the archive.
+    archiveHeader header = {0};
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.entry_count = entry_count;
+    header.toc_offset = sizeof(archiveHeader);
+    header.names_offset = header.toc_offset + (u64)entry_count * sizeof(archiveEntry);
+
+    u64 names_size = 0;
+    for (u32 i = 0; i < entry_count; ++i) {
+        entries[i].toc.name_offset = (u32)names_size;
+        names_size += string_length(entries[i].name) + 1;
+    }
+    header.names_size = names_size;
+
+    u64 cursor = align_up(header.names_offset + names_size, ARCHIVE_DATA_ALIGNMENT);
+    u64 total_size = 0;
+    u64 total_stored = 0;
+    for (u32 i = 0; i < entry_count; ++i) {
+        packerEntry* entry = &entries[i];
+        archiveEntry* toc = &entry->toc;
+        toc->name_hash = entry->hash;
+        toc->offset = cursor;
+        toc->size = entry->view.size;
+        toc->uncompressed_size = entry->view.size;
+        toc->flags = ARCHIVE_ENTRY_FLAG_NONE;
+        entry->stored = entry->view.data;
+
+        if (compress && entry->view.size) {
+            entry->compressed = malloc(archive_compress_bound(entry->view.size));
+            u64 compressed_size = archive_compress(entry->view.data, entry->view.size, entry->compressed);
+            if (compressed_size) {
+                toc->size = compressed_size;
+                toc->flags |= ARCHIVE_ENTRY_FLAG_COMPRESSED;
+                entry->stored = entry->compressed;
+            }
+        }
+
+        total_size += toc->uncompressed_size;
+        total_stored += toc->size;
+        cursor = align_up(cursor + toc->size, ARCHIVE_DATA_ALIGNMENT);
+    }
+
+    // Write it out.
+    fileHandle output;
+    if (!filesystem_open(output_path, FILE_MODE_WRITE, true, &output)) {
+        return 1;
+    }
+
+    static const u8 padding[ARCHIVE_DATA_ALIGNMENT] = {0};
+    b8 success = write_bytes(&output, &header, sizeof(header));
+    for (u32 i = 0; success && i < entry_count; ++i) {
+        success = write_bytes(&output, &entries[i].toc, sizeof(archiveEntry));
+    }
+    for (u32 i = 0; success && i < entry_count; ++i) {
+        success = write_bytes(&output, entries[i].name, string_length(entries[i].name) + 1);
+    }
+
+    u64 position = header.names_offset + names_size;
+    for (u32 i = 0; success && i < entry_count; ++i) {
+        archiveEntry* toc = &entries[i].toc;
+        success = write_bytes(&output, padding, toc->offset - position) &&
+                  write_bytes(&output, entries[i].stored, toc->size);
+        position = toc->offset + toc->size;
+    }
+    filesystem_close(&output);
+
+    for (u32 i = 0; i < entry_count; ++i) {
+        filesystem_unmap(&entries[i].view);
+        free(entries[i].compressed);
+    }
+    free(entries);
+
+    if (!success) {
+        HERROR("Failed to write archive '%s'.", output_path);
+        return 1;
+    }
+
+    HINFO("Packed %u entries into '%s' (%llu bytes, entry data %llu -> %llu bytes).", entry_count, output_path, position, total_size, total_stored);
+    return 0;
+}
@@ -19,4 +19,9 @@ echo "Copying assets..."
 echo xcopy "assets" "bin\assets" /h /i /c /k /e /r /y
 xcopy "assets" "bin\assets" /h /i /c /k /e /r /y
 
+echo "Packing assets..."
+echo "bin/assets/shaders/*.spv -> bin/assets.hpak"
+bin\packer.exe -c bin\assets.hpak bin assets/shaders/Builtin.ObjectShader.vert.spv assets/shaders/Builtin.ObjectShader.frag.spv
+IF %ERRORLEVEL% NEQ 0 (echo Error: %ERRORLEVEL% && exit)
+
 echo "Done."
\ No newline at end of file
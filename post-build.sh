@@ -26,4 +26,13 @@ echo "Copying assets..."
 echo cp -R "assets" "bin"
 cp -R "assets" "bin"
 
+echo "Packing assets..."
+echo "bin/assets/shaders/*.spv -> bin/assets.hpak"
+bin/packer -c bin/assets.hpak bin assets/shaders/Builtin.ObjectShader.vert.spv assets/shaders/Builtin.ObjectShader.frag.spv
+ERRORLEVEL=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+echo "Error:"$ERRORLEVEL && exit
+fi
+
 echo "Done."
\ No newline at end of file
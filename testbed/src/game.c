@@ -4,8 +4,10 @@
 #include <stdio.h>
 
 #include <core/input.h>
+#include <core/events.h>
 #include <core/logger.h>
 #include <memory/hmemory.h>
+#include <utils/hstring.h>
 
 // HACK: This should not be available outside the engine
 #include <renderer/frontend.h>
@@ -70,6 +72,14 @@ b8 game_update(game* gameInst, f32 deltaTime) {
     if (keyJustPressed(KEY_M)) {
         HDEBUG("Allocations: %llu (%llu this frame)", allocCount, allocCount - prevAllocCount);
     }
+    if (keyJustPressed(KEY_P)) {
+        stringBuilder report;
+        string_builder_create(4096, NULL, &report);
+        GetMemoryUsage_str(&report);
+        eventGetProfile_str(&report);
+        HINFO("%s", report.data);
+        string_builder_destroy(&report);
+    }
 
     // HACK: temp hack to move camera around
     if (keyPressed(KEY_LEFT))  camera_yaw(1.0f * deltaTime);
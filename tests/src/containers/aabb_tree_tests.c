@@ -0,0 +1,321 @@
+#include "aabb_tree_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <containers/aabb_tree.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/frustum.h>
+#include <math/hmath.h>
+#include <math/hrandom.h>
+#include <memory/hmemory.h>
+
+#define TEST_OBJECT_COUNT 2000
+#define BENCHMARK_OBJECT_COUNT 100000
+#define BENCHMARK_QUERY_COUNT 10000
+// Queries checking every object are slow, so those only run this many times.
+#define BENCHMARK_BRUTE_FORCE_COUNT 100
+
+// Objects of a few units scattered over a wide, flat world, like props in a level.
+static aabb random_object(random_state* state, f32 world_size) {
+    vec3 center = vec3_create(random_f32_range(state, -world_size, world_size), random_f32_range(state, -world_size * 0.1f, world_size * 0.1f), random_f32_range(state, -world_size, world_size));
+    vec3 extents = vec3_create(random_f32_range(state, 0.25f, 2.0f), random_f32_range(state, 0.25f, 2.0f), random_f32_range(state, 0.25f, 2.0f));
+    return aabb_create(vec3_sub(center, extents), vec3_add(center, extents));
+}
+
+static vec3 random_direction(random_state* state) {
+    return vec3_normalized(vec3_create(random_f32_range(state, -1.0f, 1.0f), random_f32_range(state, -0.2f, 0.2f), random_f32_range(state, -1.0f, 1.0f)));
+}
+
+static frustum camera_frustum(vec3 position, vec3 target, f32 far_clip) {
+    mat4 projection = mat4_perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, far_clip);
+    return frustum_from_matrix(mat4_mul(mat4_look_at(position, target, vec3_up()), projection));
+}
+
+// Indicates if found holds exactly the objects marked in expected, each once.
+static b8 results_match(const aabb_tree* tree, const u32* found, u32 found_count, const b8* expected, u32 object_count, b8* seen) {
+    u32 expected_count = 0;
+    for (u32 i = 0; i < object_count; ++i) {
+        expected_count += expected[i];
+        seen[i] = false;
+    }
+    if (found_count != expected_count) {
+        return false;
+    }
+    for (u32 i = 0; i < found_count; ++i) {
+        u64 object = aabb_tree_user_data(tree, found[i]);
+        if (object >= object_count || !expected[object] || seen[object]) {
+            return false;
+        }
+        seen[object] = true;
+    }
+    return true;
+}
+
+u8 aabb_tree_should_match_brute_force() {
+    random_state random;
+    random_seed(&random, 61);
+    aabb* boxes = Hallocate(sizeof(aabb) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* proxies = Hallocate(sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* live = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* expected = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* seen = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* found = Hallocate(sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+
+    // No margin, so the queries are exact and can be compared.
+    aabb_tree tree;
+    aabb_tree_create(0, 0.0f, &tree);
+    for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+        boxes[i] = random_object(&random, 100.0f);
+        proxies[i] = aabb_tree_insert(&tree, boxes[i], i);
+        live[i] = true;
+    }
+    expect_should_be(TEST_OBJECT_COUNT, tree.leaf_count);
+    expect_should_be(TEST_OBJECT_COUNT * 2 - 1, tree.node_count);
+
+    // Remove a third, move another third.
+    for (u32 i = 0; i < TEST_OBJECT_COUNT; i += 3) {
+        aabb_tree_remove(&tree, proxies[i]);
+        live[i] = false;
+    }
+    for (u32 i = 1; i < TEST_OBJECT_COUNT; i += 3) {
+        vec3 offset = vec3_create(random_f32_range(&random, -20.0f, 20.0f), 0.0f, random_f32_range(&random, -20.0f, 20.0f));
+        boxes[i] = aabb_create(vec3_add(boxes[i].min, offset), vec3_add(boxes[i].max, offset));
+        expect_to_be_true(aabb_tree_move(&tree, proxies[i], boxes[i]));
+    }
+    u32 live_count = TEST_OBJECT_COUNT - (TEST_OBJECT_COUNT + 2) / 3;
+    expect_should_be(live_count, tree.leaf_count);
+    expect_should_be(live_count * 2 - 1, tree.node_count);
+    // Balanced: a perfect tree of these leaves would be 11 levels.
+    u32 height = aabb_tree_height(&tree);
+    expect_to_be_true(height <= 20);
+
+    for (u32 query = 0; query < 200; ++query) {
+        aabb bounds = random_object(&random, 100.0f);
+        bounds = aabb_expand(bounds, random_f32_range(&random, 0.0f, 15.0f));
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            expected[i] = live[i] && aabb_overlaps(boxes[i], bounds);
+        }
+        u32 found_count = aabb_tree_query_aabb(&tree, bounds, found, TEST_OBJECT_COUNT);
+        expect_to_be_true(results_match(&tree, found, found_count, expected, TEST_OBJECT_COUNT, seen));
+
+        vec3 position = vec3_create(random_f32_range(&random, -100.0f, 100.0f), 0.0f, random_f32_range(&random, -100.0f, 100.0f));
+        frustum f = camera_frustum(position, vec3_add(position, random_direction(&random)), 60.0f);
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            expected[i] = live[i] && frustum_intersects_aabb(&f, boxes[i]);
+        }
+        found_count = aabb_tree_query_frustum(&tree, &f, found, TEST_OBJECT_COUNT);
+        expect_to_be_true(results_match(&tree, found, found_count, expected, TEST_OBJECT_COUNT, seen));
+
+        // The closest box along the ray.
+        vec3 direction = random_direction(&random);
+        vec3 inverse_direction = vec3_create(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        f32 closest_distance = 150.0f;
+        b8 any_hit = false;
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            f32 distance;
+            if (live[i] && aabb_intersects_ray(boxes[i], position, inverse_direction, closest_distance, &distance)) {
+                closest_distance = distance;
+                any_hit = true;
+            }
+        }
+        f32 hit_distance = -1.0f;
+        u32 hit = aabb_tree_raycast(&tree, position, direction, 150.0f, 0, 0, &hit_distance);
+        expect_to_be_true(any_hit == (hit != AABB_TREE_NULL));
+        if (any_hit) {
+            expect_float_to_be(closest_distance, hit_distance);
+        }
+    }
+
+    // Small moves stay within the margin and leave the tree alone.
+    aabb_tree padded;
+    aabb_tree_create(16, 1.0f, &padded);
+    u32 proxy = aabb_tree_insert(&padded, boxes[1], 1);
+    aabb_tree_insert(&padded, boxes[2], 2);
+    aabb nudged = aabb_create(vec3_add(boxes[1].min, vec3_create(0.5f, 0.0f, 0.0f)), vec3_add(boxes[1].max, vec3_create(0.5f, 0.0f, 0.0f)));
+    expect_to_be_false(aabb_tree_move(&padded, proxy, nudged));
+    nudged = aabb_create(vec3_add(boxes[1].min, vec3_create(1.5f, 0.0f, 0.0f)), vec3_add(boxes[1].max, vec3_create(1.5f, 0.0f, 0.0f)));
+    expect_to_be_true(aabb_tree_move(&padded, proxy, nudged));
+    expect_to_be_true(aabb_contains(aabb_tree_bounds(&padded, proxy), nudged));
+    aabb_tree_destroy(&padded);
+
+    aabb_tree_destroy(&tree);
+    expect_should_be(AABB_TREE_NULL, aabb_tree_raycast(&tree, vec3_zero(), vec3_forward(), 10.0f, 0, 0, 0));
+    Hfree(boxes, sizeof(aabb) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(proxies, sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(live, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(expected, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(seen, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(found, sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+typedef struct sphere_scene {
+    const sphere* spheres;
+    u32 tests;
+} sphere_scene;
+
+// Hits the sphere inside the box, so the search has to go on past boxes the ray only grazes.
+static f32 ray_sphere_callback(void* context, u32 proxy, u64 user_data) {
+    sphere_scene* scene = context;
+    scene->tests++;
+    const sphere* s = &scene->spheres[user_data];
+    // The ray of the test runs along +x through y = z = 0.
+    f32 offset_squared = s->center.y * s->center.y + s->center.z * s->center.z;
+    f32 radius_squared = s->radius * s->radius;
+    if (offset_squared > radius_squared) {
+        return -1.0f;
+    }
+    return s->center.x - hsqrt(radius_squared - offset_squared);
+}
+
+u8 aabb_tree_raycast_should_find_the_closest_object() {
+    // A row of spheres along x, with the ones off the ray closer than the one on it.
+    sphere spheres[4] = {
+        {{{5.0f, 1.2f, 0.0f}}, 1.0f},
+        {{{8.0f, 0.0f, 1.2f}}, 1.0f},
+        {{{12.0f, 0.0f, 0.0f}}, 1.0f},
+        {{{20.0f, 0.0f, 0.0f}}, 1.0f},
+    };
+    aabb_tree tree;
+    aabb_tree_create(0, 0.5f, &tree);
+    for (u32 i = 0; i < 4; ++i) {
+        vec3 extents = vec3_create(spheres[i].radius, spheres[i].radius, spheres[i].radius);
+        aabb_tree_insert(&tree, aabb_create(vec3_sub(spheres[i].center, extents), vec3_add(spheres[i].center, extents)), i);
+    }
+
+    sphere_scene scene = {spheres, 0};
+    f32 distance = 0.0f;
+    u32 hit = aabb_tree_raycast(&tree, vec3_zero(), vec3_right(), 100.0f, ray_sphere_callback, &scene, &distance);
+    expect_to_be_true(hit != AABB_TREE_NULL);
+    expect_should_be(2, aabb_tree_user_data(&tree, hit));
+    expect_float_to_be(11.0f, distance);
+    // The sphere at 20 is behind the hit and never tested.
+    expect_should_be(3, scene.tests);
+
+    // Too short to reach it, and pointing away.
+    expect_should_be(AABB_TREE_NULL, aabb_tree_raycast(&tree, vec3_zero(), vec3_right(), 10.0f, ray_sphere_callback, &scene, 0));
+    expect_should_be(AABB_TREE_NULL, aabb_tree_raycast(&tree, vec3_zero(), vec3_left(), 100.0f, ray_sphere_callback, &scene, 0));
+    aabb_tree_destroy(&tree);
+    return true;
+}
+
+u8 aabb_tree_benchmark() {
+    random_state random;
+    random_seed(&random, 67);
+    aabb* boxes = Hallocate(sizeof(aabb) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* proxies = Hallocate(sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* found = Hallocate(sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        boxes[i] = random_object(&random, 1000.0f);
+    }
+    hclock clock;
+
+    aabb_tree tree;
+    startClock(&clock);
+    aabb_tree_create(BENCHMARK_OBJECT_COUNT * 2, 0.5f, &tree);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        proxies[i] = aabb_tree_insert(&tree, boxes[i], i);
+    }
+    updateClock(&clock);
+    HINFO("AABB tree of %u objects: built in %.2f ms, %u levels.", BENCHMARK_OBJECT_COUNT, clock.elapsed * 1000.0, aabb_tree_height(&tree));
+
+    // Every object moves a little, like a frame of simulation.
+    u32 reinserted = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        vec3 offset = vec3_create(random_f32_range(&random, -0.3f, 0.3f), 0.0f, random_f32_range(&random, -0.3f, 0.3f));
+        boxes[i] = aabb_create(vec3_add(boxes[i].min, offset), vec3_add(boxes[i].max, offset));
+        reinserted += aabb_tree_move(&tree, proxies[i], boxes[i]);
+    }
+    updateClock(&clock);
+    HINFO("  moving all of them %.2f ms, %u reinserted.", clock.elapsed * 1000.0, reinserted);
+
+    aabb* query_boxes = Hallocate(sizeof(aabb) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    vec3* origins = Hallocate(sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    vec3* directions = Hallocate(sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        query_boxes[i] = aabb_expand(random_object(&random, 1000.0f), 10.0f);
+        origins[i] = vec3_create(random_f32_range(&random, -1000.0f, 1000.0f), 0.0f, random_f32_range(&random, -1000.0f, 1000.0f));
+        directions[i] = random_direction(&random);
+    }
+
+    u64 total_found = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        total_found += aabb_tree_query_aabb(&tree, query_boxes[i], found, BENCHMARK_OBJECT_COUNT);
+    }
+    updateClock(&clock);
+    f64 tree_time = clock.elapsed / BENCHMARK_QUERY_COUNT;
+    u64 brute_found = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        for (u32 j = 0; j < BENCHMARK_OBJECT_COUNT; ++j) {
+            brute_found += aabb_overlaps(boxes[j], query_boxes[i]);
+        }
+    }
+    updateClock(&clock);
+    f64 brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  box query: %.2f us, %.1f objects found. Testing every object %.2f us (%.0fx).",
+          tree_time * 1e6, (f64)total_found / BENCHMARK_QUERY_COUNT, brute_time * 1e6, brute_time / tree_time);
+    expect_to_be_true(brute_found <= total_found);
+
+    u32 hits = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        hits += aabb_tree_raycast(&tree, origins[i], directions[i], 500.0f, 0, 0, 0) != AABB_TREE_NULL;
+    }
+    updateClock(&clock);
+    tree_time = clock.elapsed / BENCHMARK_QUERY_COUNT;
+    u32 brute_hits = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        vec3 inverse_direction = vec3_create(1.0f / directions[i].x, 1.0f / directions[i].y, 1.0f / directions[i].z);
+        f32 closest = 500.0f;
+        for (u32 j = 0; j < BENCHMARK_OBJECT_COUNT; ++j) {
+            f32 distance;
+            if (aabb_intersects_ray(boxes[j], origins[i], inverse_direction, closest, &distance)) {
+                closest = distance;
+            }
+        }
+        brute_hits += closest < 500.0f;
+    }
+    updateClock(&clock);
+    brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  ray cast: %.2f us, %.0f%% hit. Testing every object %.2f us (%.0fx), %.0f%% hit.",
+          tree_time * 1e6, hits * 100.0 / BENCHMARK_QUERY_COUNT, brute_time * 1e6, brute_time / tree_time, brute_hits * 100.0 / BENCHMARK_BRUTE_FORCE_COUNT);
+
+    frustum f = camera_frustum(vec3_create(0.0f, 20.0f, 0.0f), vec3_create(100.0f, 0.0f, 100.0f), 300.0f);
+    u32 visible = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        visible = aabb_tree_query_frustum(&tree, &f, found, BENCHMARK_OBJECT_COUNT);
+    }
+    updateClock(&clock);
+    tree_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        frustum_cull_aabbs(&f, boxes, BENCHMARK_OBJECT_COUNT, found);
+    }
+    updateClock(&clock);
+    brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  frustum query: %.2f us, %u visible. frustum_cull_aabbs over every object %.2f us (%.1fx).",
+          tree_time * 1e6, visible, brute_time * 1e6, brute_time / tree_time);
+
+    aabb_tree_destroy(&tree);
+    Hfree(boxes, sizeof(aabb) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(proxies, sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(found, sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(query_boxes, sizeof(aabb) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(origins, sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(directions, sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void aabb_tree_register_tests() {
+    test_manager_register_test(aabb_tree_should_match_brute_force, "aabb tree should match brute force");
+    test_manager_register_test(aabb_tree_raycast_should_find_the_closest_object, "aabb tree raycast should find the closest object");
+    test_manager_register_benchmark(aabb_tree_benchmark, "aabb tree benchmark");
+}
@@ -0,0 +1,283 @@
+#include "spatial_grid_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <containers/spatial_grid.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/frustum.h>
+#include <math/hmath.h>
+#include <math/hrandom.h>
+#include <memory/hmemory.h>
+
+#define TEST_OBJECT_COUNT 2000
+#define BENCHMARK_OBJECT_COUNT 100000
+#define BENCHMARK_QUERY_COUNT 10000
+// Queries checking every object are slow, so those only run this many times.
+#define BENCHMARK_BRUTE_FORCE_COUNT 100
+#define BENCHMARK_CELL_SIZE 8.0f
+
+// Objects of a few units scattered over a wide, flat world, like props in a level.
+static aabb random_object(random_state* state, f32 world_size) {
+    vec3 center = vec3_create(random_f32_range(state, -world_size, world_size), random_f32_range(state, -world_size * 0.1f, world_size * 0.1f), random_f32_range(state, -world_size, world_size));
+    vec3 extents = vec3_create(random_f32_range(state, 0.25f, 2.0f), random_f32_range(state, 0.25f, 2.0f), random_f32_range(state, 0.25f, 2.0f));
+    return aabb_create(vec3_sub(center, extents), vec3_add(center, extents));
+}
+
+static vec3 random_direction(random_state* state) {
+    return vec3_normalized(vec3_create(random_f32_range(state, -1.0f, 1.0f), random_f32_range(state, -0.2f, 0.2f), random_f32_range(state, -1.0f, 1.0f)));
+}
+
+static frustum camera_frustum(vec3 position, vec3 target, f32 far_clip) {
+    mat4 projection = mat4_perspective(deg_to_rad(60.0f), 16.0f / 9.0f, 0.1f, far_clip);
+    return frustum_from_matrix(mat4_mul(mat4_look_at(position, target, vec3_up()), projection));
+}
+
+// Indicates if found holds exactly the objects marked in expected, each once.
+static b8 results_match(const spatial_grid* grid, const u32* found, u32 found_count, const b8* expected, u32 object_count, b8* seen) {
+    u32 expected_count = 0;
+    for (u32 i = 0; i < object_count; ++i) {
+        expected_count += expected[i];
+        seen[i] = false;
+    }
+    if (found_count != expected_count) {
+        return false;
+    }
+    for (u32 i = 0; i < found_count; ++i) {
+        u64 object = spatial_grid_user_data(grid, found[i]);
+        if (object >= object_count || !expected[object] || seen[object]) {
+            return false;
+        }
+        seen[object] = true;
+    }
+    return true;
+}
+
+// Frustum queries may leave out boxes just outside a corner, so found has to be among expected, and hold every box with its center inside.
+static b8 frustum_results_match(const spatial_grid* grid, const frustum* f, const u32* found, u32 found_count, const b8* expected, const aabb* boxes, u32 object_count, b8* seen) {
+    for (u32 i = 0; i < object_count; ++i) {
+        seen[i] = false;
+    }
+    for (u32 i = 0; i < found_count; ++i) {
+        u64 object = spatial_grid_user_data(grid, found[i]);
+        if (object >= object_count || !expected[object] || seen[object]) {
+            return false;
+        }
+        seen[object] = true;
+    }
+    for (u32 i = 0; i < object_count; ++i) {
+        vec3 center = vec3_mul_scalar(vec3_add(boxes[i].min, boxes[i].max), 0.5f);
+        if (expected[i] && !seen[i] && frustum_intersects_aabb(f, aabb_create(center, center))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+u8 spatial_grid_should_match_brute_force() {
+    random_state random;
+    random_seed(&random, 71);
+    aabb* boxes = Hallocate(sizeof(aabb) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* objects = Hallocate(sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* live = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* expected = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    b8* seen = Hallocate(sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* found = Hallocate(sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+
+    // Starts small, so the objects, entries and cells all have to grow.
+    spatial_grid grid;
+    spatial_grid_create(3.0f, 0, &grid);
+    for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+        boxes[i] = random_object(&random, 100.0f);
+        // A few objects much larger than the cells.
+        if (i % 100 == 0) {
+            boxes[i] = aabb_expand(boxes[i], 10.0f);
+        }
+        objects[i] = spatial_grid_insert(&grid, boxes[i], i);
+        live[i] = true;
+    }
+    expect_should_be(TEST_OBJECT_COUNT, grid.object_count);
+
+    // Remove a third, move another third, some across cells and some within theirs.
+    for (u32 i = 0; i < TEST_OBJECT_COUNT; i += 3) {
+        spatial_grid_remove(&grid, objects[i]);
+        live[i] = false;
+    }
+    for (u32 i = 1; i < TEST_OBJECT_COUNT; i += 3) {
+        f32 reach = i % 2 ? 0.2f : 20.0f;
+        vec3 offset = vec3_create(random_f32_range(&random, -reach, reach), random_f32_range(&random, -reach, reach), random_f32_range(&random, -reach, reach));
+        boxes[i] = aabb_create(vec3_add(boxes[i].min, offset), vec3_add(boxes[i].max, offset));
+        spatial_grid_move(&grid, objects[i], boxes[i]);
+    }
+    expect_should_be(TEST_OBJECT_COUNT - (TEST_OBJECT_COUNT + 2) / 3, grid.object_count);
+
+    for (u32 query = 0; query < 200; ++query) {
+        aabb bounds = random_object(&random, 100.0f);
+        // Every so often a box covering everything, wich goes through the occupied cells instead.
+        bounds = aabb_expand(bounds, query % 50 ? random_f32_range(&random, 0.0f, 15.0f) : 500.0f);
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            expected[i] = live[i] && aabb_overlaps(boxes[i], bounds);
+        }
+        u32 found_count = spatial_grid_query_aabb(&grid, bounds, found, TEST_OBJECT_COUNT);
+        expect_to_be_true(results_match(&grid, found, found_count, expected, TEST_OBJECT_COUNT, seen));
+
+        vec3 position = vec3_create(random_f32_range(&random, -100.0f, 100.0f), 0.0f, random_f32_range(&random, -100.0f, 100.0f));
+        frustum f = camera_frustum(position, vec3_add(position, random_direction(&random)), 60.0f);
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            expected[i] = live[i] && frustum_intersects_aabb(&f, boxes[i]);
+        }
+        found_count = spatial_grid_query_frustum(&grid, &f, found, TEST_OBJECT_COUNT);
+        expect_to_be_true(frustum_results_match(&grid, &f, found, found_count, expected, boxes, TEST_OBJECT_COUNT, seen));
+
+        // The closest box along the ray.
+        vec3 direction = random_direction(&random);
+        vec3 inverse_direction = vec3_create(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        f32 closest_distance = 150.0f;
+        b8 any_hit = false;
+        for (u32 i = 0; i < TEST_OBJECT_COUNT; ++i) {
+            f32 distance;
+            if (live[i] && aabb_intersects_ray(boxes[i], position, inverse_direction, closest_distance, &distance)) {
+                closest_distance = distance;
+                any_hit = true;
+            }
+        }
+        f32 hit_distance = -1.0f;
+        u32 hit = spatial_grid_raycast(&grid, position, direction, 150.0f, 0, 0, &hit_distance);
+        expect_to_be_true(any_hit == (hit != SPATIAL_GRID_NULL));
+        if (any_hit) {
+            expect_float_to_be(closest_distance, hit_distance);
+        }
+    }
+
+    // Queries can be asked for fewer results than there are.
+    aabb everything = aabb_create(vec3_create(-500.0f, -500.0f, -500.0f), vec3_create(500.0f, 500.0f, 500.0f));
+    expect_should_be(grid.object_count, spatial_grid_query_aabb(&grid, everything, found, 10));
+
+    spatial_grid_destroy(&grid);
+    Hfree(boxes, sizeof(aabb) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(objects, sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(live, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(expected, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(seen, sizeof(b8) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(found, sizeof(u32) * TEST_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 spatial_grid_benchmark() {
+    random_state random;
+    random_seed(&random, 73);
+    aabb* boxes = Hallocate(sizeof(aabb) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* objects = Hallocate(sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32* found = Hallocate(sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        boxes[i] = random_object(&random, 1000.0f);
+    }
+    hclock clock;
+
+    spatial_grid grid;
+    startClock(&clock);
+    spatial_grid_create(BENCHMARK_CELL_SIZE, BENCHMARK_OBJECT_COUNT, &grid);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        objects[i] = spatial_grid_insert(&grid, boxes[i], i);
+    }
+    updateClock(&clock);
+    HINFO("Spatial grid of %u objects: built in %.2f ms, %u cells of %.0f units.",
+          BENCHMARK_OBJECT_COUNT, clock.elapsed * 1000.0, grid.cell_count, BENCHMARK_CELL_SIZE);
+
+    // Every object moves a little, like a frame of simulation.
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_OBJECT_COUNT; ++i) {
+        vec3 offset = vec3_create(random_f32_range(&random, -0.3f, 0.3f), 0.0f, random_f32_range(&random, -0.3f, 0.3f));
+        boxes[i] = aabb_create(vec3_add(boxes[i].min, offset), vec3_add(boxes[i].max, offset));
+        spatial_grid_move(&grid, objects[i], boxes[i]);
+    }
+    updateClock(&clock);
+    HINFO("  moving all of them %.2f ms.", clock.elapsed * 1000.0);
+
+    aabb* query_boxes = Hallocate(sizeof(aabb) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    vec3* origins = Hallocate(sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    vec3* directions = Hallocate(sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        query_boxes[i] = aabb_expand(random_object(&random, 1000.0f), 10.0f);
+        origins[i] = vec3_create(random_f32_range(&random, -1000.0f, 1000.0f), 0.0f, random_f32_range(&random, -1000.0f, 1000.0f));
+        directions[i] = random_direction(&random);
+    }
+
+    u64 total_found = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        total_found += spatial_grid_query_aabb(&grid, query_boxes[i], found, BENCHMARK_OBJECT_COUNT);
+    }
+    updateClock(&clock);
+    f64 grid_time = clock.elapsed / BENCHMARK_QUERY_COUNT;
+    u64 brute_found = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        for (u32 j = 0; j < BENCHMARK_OBJECT_COUNT; ++j) {
+            brute_found += aabb_overlaps(boxes[j], query_boxes[i]);
+        }
+    }
+    updateClock(&clock);
+    f64 brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  box query: %.2f us, %.1f objects found. Testing every object %.2f us (%.0fx).",
+          grid_time * 1e6, (f64)total_found / BENCHMARK_QUERY_COUNT, brute_time * 1e6, brute_time / grid_time);
+    expect_to_be_true(brute_found <= total_found);
+
+    u32 hits = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_QUERY_COUNT; ++i) {
+        hits += spatial_grid_raycast(&grid, origins[i], directions[i], 500.0f, 0, 0, 0) != SPATIAL_GRID_NULL;
+    }
+    updateClock(&clock);
+    grid_time = clock.elapsed / BENCHMARK_QUERY_COUNT;
+    u32 brute_hits = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        vec3 inverse_direction = vec3_create(1.0f / directions[i].x, 1.0f / directions[i].y, 1.0f / directions[i].z);
+        f32 closest = 500.0f;
+        for (u32 j = 0; j < BENCHMARK_OBJECT_COUNT; ++j) {
+            f32 distance;
+            if (aabb_intersects_ray(boxes[j], origins[i], inverse_direction, closest, &distance)) {
+                closest = distance;
+            }
+        }
+        brute_hits += closest < 500.0f;
+    }
+    updateClock(&clock);
+    brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  ray cast: %.2f us, %.0f%% hit. Testing every object %.2f us (%.0fx), %.0f%% hit.",
+          grid_time * 1e6, hits * 100.0 / BENCHMARK_QUERY_COUNT, brute_time * 1e6, brute_time / grid_time, brute_hits * 100.0 / BENCHMARK_BRUTE_FORCE_COUNT);
+
+    frustum f = camera_frustum(vec3_create(0.0f, 20.0f, 0.0f), vec3_create(100.0f, 0.0f, 100.0f), 300.0f);
+    u32 visible = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        visible = spatial_grid_query_frustum(&grid, &f, found, BENCHMARK_OBJECT_COUNT);
+    }
+    updateClock(&clock);
+    grid_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_BRUTE_FORCE_COUNT; ++i) {
+        frustum_cull_aabbs(&f, boxes, BENCHMARK_OBJECT_COUNT, found);
+    }
+    updateClock(&clock);
+    brute_time = clock.elapsed / BENCHMARK_BRUTE_FORCE_COUNT;
+    HINFO("  frustum query: %.2f us, %u visible. frustum_cull_aabbs over every object %.2f us (%.1fx).",
+          grid_time * 1e6, visible, brute_time * 1e6, brute_time / grid_time);
+
+    spatial_grid_destroy(&grid);
+    Hfree(boxes, sizeof(aabb) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(objects, sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(found, sizeof(u32) * BENCHMARK_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(query_boxes, sizeof(aabb) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(origins, sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(directions, sizeof(vec3) * BENCHMARK_QUERY_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void spatial_grid_register_tests() {
+    test_manager_register_test(spatial_grid_should_match_brute_force, "spatial grid should match brute force");
+    test_manager_register_benchmark(spatial_grid_benchmark, "spatial grid benchmark");
+}
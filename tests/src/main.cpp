@@ -1,19 +1,64 @@
 #include "test_manager.h"
+#include "containers/aabb_tree_tests.h"
+#include "containers/spatial_grid_tests.h"
+#include "math/frustum_tests.h"
+#include "math/hmath_batch_tests.h"
+#include "math/hmath_benchmarks.h"
+#include "math/hmath_tests.h"
+#include "math/hpack_tests.h"
+#include "math/hrandom_tests.h"
+#include "math/keyframes_tests.h"
 #include "memory/linear_allocator_tests.h"
+#include "platform/filesystem_async_tests.h"
+#include "platform/filesystem_writer_tests.h"
+#include "platform/line_reader_tests.h"
+#include "platform/vfs_tests.h"
+#include "resources/archive_tests.h"
+#include "utils/hstring_tests.h"
 
 #include <core/logger.h>
 
-int main() {
+#include <string.h>
+
+int main(int argc, char** argv) {
     // Always initialize the test manager at first.
     test_manager_init();
 
     // TODO: add test registrations here.
     linear_allocator_register_tests();
+    filesystem_writer_register_tests();
+    filesystem_async_register_tests();
+    line_reader_register_tests();
+    vfs_register_tests();
+    archive_register_tests();
+    hstring_register_tests();
+    hmath_register_tests();
+    hmath_batch_register_tests();
+    hmath_benchmarks_register_tests();
+    hrandom_register_tests();
+    frustum_register_tests();
+    hpack_register_tests();
+    keyframes_register_tests();
+    aabb_tree_register_tests();
+    spatial_grid_register_tests();
+
+    // Benchmarks take a while, so they only run when asked for with --benchmarks.
+    bool benchmarks = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--benchmarks") == 0) {
+            benchmarks = true;
+        }
+    }
 
-    HDEBUG("Starting tests...");
+    if (benchmarks) {
+        HDEBUG("Starting benchmarks...");
+        test_manager_run_benchmarks();
+    } else {
+        HDEBUG("Starting tests...");
 
-    // Execute tests
-    test_manager_run_tests();
+        // Execute tests
+        test_manager_run_tests();
+    }
 
     return 0;
 }
\ No newline at end of file
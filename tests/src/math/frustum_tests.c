@@ -0,0 +1,187 @@
+#include "frustum_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/frustum.h>
+#include <math/hmath.h>
+#include <math/hrandom.h>
+#include <memory/hmemory.h>
+
+#define BENCHMARK_BOUNDS_COUNT 100000
+#define BENCHMARK_ROUNDS 20
+
+// Camera at (0, 0, 10) looking down -z, like the renderer's.
+static frustum test_frustum() {
+    mat4 projection = mat4_perspective(deg_to_rad(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    mat4 view = mat4_inverse(mat4_translation(vec3_create(0.0f, 0.0f, 10.0f)));
+    return frustum_from_matrix(mat4_mul(view, projection));
+}
+
+// Bounds spread around the camera, a good part of them visible.
+static void random_bounds(random_state* state, sphere* spheres, aabb* boxes, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        vec3 center = vec3_create(random_f32_range(state, -80.0f, 80.0f), random_f32_range(state, -80.0f, 80.0f), random_f32_range(state, -120.0f, 30.0f));
+        f32 size = random_f32_range(state, 0.1f, 5.0f);
+        spheres[i] = (sphere){center, size};
+        boxes[i].min = vec3_sub(center, vec3_create(size, size * 0.5f, size * 2.0f));
+        boxes[i].max = vec3_add(center, vec3_create(size, size * 0.5f, size * 2.0f));
+    }
+}
+
+u8 frustum_should_classify_bounds() {
+    frustum f = test_frustum();
+
+    // In front, behind, beyond the far plane, off to the side, and straddling the near plane.
+    expect_to_be_true(frustum_intersects_sphere(&f, (sphere){vec3_zero(), 1.0f}));
+    expect_to_be_false(frustum_intersects_sphere(&f, (sphere){vec3_create(0.0f, 0.0f, 20.0f), 1.0f}));
+    expect_to_be_false(frustum_intersects_sphere(&f, (sphere){vec3_create(0.0f, 0.0f, -200.0f), 1.0f}));
+    expect_to_be_false(frustum_intersects_sphere(&f, (sphere){vec3_create(50.0f, 0.0f, 0.0f), 1.0f}));
+    expect_to_be_true(frustum_intersects_sphere(&f, (sphere){vec3_create(0.0f, 0.0f, 10.5f), 1.0f}));
+    // Big enough to reach in from the side.
+    expect_to_be_true(frustum_intersects_sphere(&f, (sphere){vec3_create(50.0f, 0.0f, 0.0f), 46.0f}));
+
+    expect_to_be_true(frustum_intersects_aabb(&f, (aabb){vec3_create(-1.0f, -1.0f, -1.0f), vec3_one()}));
+    expect_to_be_false(frustum_intersects_aabb(&f, (aabb){vec3_create(-1.0f, 10.0f, -1.0f), vec3_create(1.0f, 12.0f, 1.0f)}));
+    expect_to_be_false(frustum_intersects_aabb(&f, (aabb){vec3_create(-1.0f, -1.0f, 11.0f), vec3_create(1.0f, 1.0f, 12.0f)}));
+    // A long wall across the view, whose corners are all outside.
+    expect_to_be_true(frustum_intersects_aabb(&f, (aabb){vec3_create(-500.0f, -500.0f, -1.0f), vec3_create(500.0f, 500.0f, 1.0f)}));
+
+    // Boxes inside every plane are told apart from those crossing one.
+    b8 inside = false;
+    expect_to_be_true(frustum_classify_aabb(&f, (aabb){vec3_create(-1.0f, -1.0f, -1.0f), vec3_one()}, &inside));
+    expect_to_be_true(inside);
+    expect_to_be_true(frustum_classify_aabb(&f, (aabb){vec3_create(-1.0f, -1.0f, 9.0f), vec3_create(1.0f, 1.0f, 11.0f)}, &inside));
+    expect_to_be_false(inside);
+    expect_to_be_false(frustum_classify_aabb(&f, (aabb){vec3_create(-1.0f, 10.0f, -1.0f), vec3_create(1.0f, 12.0f, 1.0f)}, &inside));
+
+    // The far corners are 100 units ahead of the camera, 45 degrees apart vertically.
+    aabb bounds = frustum_bounds(&f);
+    f32 far_height = 100.0f * htan(deg_to_rad(22.5f));
+    expect_float_to_be(-90.0f, bounds.min.z);
+    expect_float_to_be(9.9f, bounds.max.z);
+    expect_float_to_be(-far_height, bounds.min.y);
+    expect_float_to_be(far_height, bounds.max.y);
+    expect_float_to_be(far_height * 16.0f / 9.0f, bounds.max.x);
+
+    // Planes come out normalized.
+    for (u32 i = 0; i < 6; ++i) {
+        vec4 plane = f.planes[i];
+        f32 length_squared = plane.x * plane.x + plane.y * plane.y + plane.z * plane.z;
+        expect_float_to_be(1.0f, length_squared);
+    }
+    return true;
+}
+
+u8 frustum_cull_should_match_single_tests() {
+    // Not a multiple of 8, for the tails.
+    const u32 count = 1021;
+    sphere* spheres = Hallocate(sizeof(sphere) * count, MEMORY_TAG_ARRAY);
+    aabb* boxes = Hallocate(sizeof(aabb) * count, MEMORY_TAG_ARRAY);
+    u32* visible = Hallocate(sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    random_state state;
+    random_seed(&state, 45);
+    random_bounds(&state, spheres, boxes, count);
+    frustum f = test_frustum();
+
+    const u32 masks[2] = {0xFFFFFFFF, 0};
+    for (u32 m = 0; m < 2; ++m) {
+        cpu_set_feature_mask(masks[m]);
+
+        u32 visible_count = frustum_cull_spheres(&f, spheres, count, visible);
+        u32 expected_count = 0;
+        for (u32 i = 0; i < count; ++i) {
+            if (frustum_intersects_sphere(&f, spheres[i])) {
+                expect_should_be(i, visible[expected_count]);
+                expected_count++;
+            }
+        }
+        expect_should_be(expected_count, visible_count);
+        // Some of each, or the test proves little.
+        expect_to_be_true(visible_count > count / 10 && visible_count < count - count / 10);
+
+        visible_count = frustum_cull_aabbs(&f, boxes, count, visible);
+        expected_count = 0;
+        for (u32 i = 0; i < count; ++i) {
+            if (frustum_intersects_aabb(&f, boxes[i])) {
+                expect_should_be(i, visible[expected_count]);
+                expected_count++;
+            }
+        }
+        expect_should_be(expected_count, visible_count);
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+
+    Hfree(spheres, sizeof(sphere) * count, MEMORY_TAG_ARRAY);
+    Hfree(boxes, sizeof(aabb) * count, MEMORY_TAG_ARRAY);
+    Hfree(visible, sizeof(u32) * count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 frustum_cull_benchmark() {
+    sphere* spheres = Hallocate(sizeof(sphere) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    aabb* boxes = Hallocate(sizeof(aabb) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    u32* visible = Hallocate(sizeof(u32) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    random_state state;
+    random_seed(&state, 46);
+    random_bounds(&state, spheres, boxes, BENCHMARK_BOUNDS_COUNT);
+    frustum f = test_frustum();
+    hclock clock;
+
+    // One at a time, the way a loop over objects would do it.
+    startClock(&clock);
+    u32 visible_count = 0;
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        visible_count = 0;
+        for (u32 i = 0; i < BENCHMARK_BOUNDS_COUNT; ++i) {
+            if (frustum_intersects_sphere(&f, spheres[i])) {
+                visible[visible_count++] = i;
+            }
+        }
+    }
+    updateClock(&clock);
+    f64 single_time = clock.elapsed / BENCHMARK_ROUNDS;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        expect_should_be(visible_count, frustum_cull_spheres(&f, spheres, BENCHMARK_BOUNDS_COUNT, visible));
+    }
+    updateClock(&clock);
+    f64 batch_time = clock.elapsed / BENCHMARK_ROUNDS;
+    HINFO("%u spheres, %u visible: one at a time %.3f ms, batch %.3f ms (%.1fx).",
+          BENCHMARK_BOUNDS_COUNT, visible_count, single_time * 1000.0, batch_time * 1000.0, single_time / batch_time);
+
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        visible_count = 0;
+        for (u32 i = 0; i < BENCHMARK_BOUNDS_COUNT; ++i) {
+            if (frustum_intersects_aabb(&f, boxes[i])) {
+                visible[visible_count++] = i;
+            }
+        }
+    }
+    updateClock(&clock);
+    single_time = clock.elapsed / BENCHMARK_ROUNDS;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        expect_should_be(visible_count, frustum_cull_aabbs(&f, boxes, BENCHMARK_BOUNDS_COUNT, visible));
+    }
+    updateClock(&clock);
+    batch_time = clock.elapsed / BENCHMARK_ROUNDS;
+    HINFO("%u boxes, %u visible: one at a time %.3f ms, batch %.3f ms (%.1fx).",
+          BENCHMARK_BOUNDS_COUNT, visible_count, single_time * 1000.0, batch_time * 1000.0, single_time / batch_time);
+
+    Hfree(spheres, sizeof(sphere) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(boxes, sizeof(aabb) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(visible, sizeof(u32) * BENCHMARK_BOUNDS_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void frustum_register_tests() {
+    test_manager_register_test(frustum_should_classify_bounds, "frustum should classify bounds");
+    test_manager_register_test(frustum_cull_should_match_single_tests, "frustum cull should match single tests");
+    test_manager_register_benchmark(frustum_cull_benchmark, "frustum cull benchmark");
+}
@@ -0,0 +1,239 @@
+#include "hmath_batch_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/job_system.h>
+#include <core/logger.h>
+#include <math/hmath.h>
+#include <math/hmath_batch.h>
+#include <memory/hmemory.h>
+
+#define BATCH_TOLERANCE 0.0005f
+#define BENCHMARK_POINT_COUNT (1024 * 1024)
+#define BENCHMARK_MATRIX_COUNT (256 * 1024)
+
+// Scalar and AVX2 paths are both checked.
+static const u32 feature_masks[2] = {0, 0xFFFFFFFF};
+
+// Small deterministic generator, test data must not depend on rand().
+static u32 next_random(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Returns a number in [-1, 1].
+static f32 random_unit(u32* state) {
+    return (f32)(next_random(state) & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+static vec3 random_vec3(u32* state) {
+    return vec3_create(random_unit(state) * 100.0f, random_unit(state) * 100.0f, random_unit(state) * 100.0f + 150.0f);
+}
+
+static quat random_quat(u32* state) {
+    return vec4_create(random_unit(state), random_unit(state), random_unit(state), random_unit(state) + 2.0f);
+}
+
+static mat4 random_transform(u32* state) {
+    mat4 rotation = quat_to_mat4(random_quat(state));
+    return mat4_mul(rotation, mat4_translation(random_vec3(state)));
+}
+
+static b8 near(f32 a, f32 b) {
+    // Relative for big values, points go up to a few hundred.
+    f32 scale = habs(a) > 1.0f ? habs(a) : 1.0f;
+    return habs(a - b) <= BATCH_TOLERANCE * scale;
+}
+
+static b8 vec3_near(vec3 a, vec3 b) {
+    return near(a.x, b.x) && near(a.y, b.y) && near(a.z, b.z);
+}
+
+static b8 mat4_near(const mat4* a, const mat4* b) {
+    for (u32 i = 0; i < 16; ++i) {
+        if (!near(a->data[i], b->data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The per point version the batches are checked against.
+static vec3 reference_transform(const mat4* matrix, vec3 point) {
+    vec4 result = vec4_zero();
+    for (u32 column = 0; column < 4; ++column) {
+        f32 sum = matrix->data[12 + column];
+        for (u32 row = 0; row < 3; ++row) {
+            sum += point.elements[row] * matrix->data[row * 4 + column];
+        }
+        result.elements[column] = sum;
+    }
+    return vec4_to_vec3(result);
+}
+
+u8 math_batch_should_match_single_value_math() {
+    // Counts around the vector width and one big enough to be split into jobs.
+    const u32 counts[] = {0, 1, 7, 8, 9, 23, 100, MATH_BATCH_JOB_THRESHOLD + 13};
+    const u32 max_count = MATH_BATCH_JOB_THRESHOLD + 13;
+    // One extra point for the sentinel past the end.
+    vec3* points = Hallocate(sizeof(vec3) * (max_count + 1), MEMORY_TAG_ARRAY);
+    vec3* out_points = Hallocate(sizeof(vec3) * (max_count + 1), MEMORY_TAG_ARRAY);
+    f32* soa = Hallocate(sizeof(f32) * max_count * 3, MEMORY_TAG_ARRAY);
+    mat4* matrices = Hallocate(sizeof(mat4) * max_count * 3, MEMORY_TAG_ARRAY);
+    quat* quats = Hallocate(sizeof(quat) * max_count, MEMORY_TAG_ARRAY);
+    vec3_soa soa_points = {soa, soa + max_count, soa + max_count * 2};
+    mat4* matrices_b = matrices + max_count;
+    mat4* out_matrices = matrices + max_count * 2;
+
+    u32 random = 5;
+    for (u32 m = 0; m < 2; ++m) {
+        cpu_set_feature_mask(feature_masks[m]);
+        for (u32 c = 0; c < sizeof(counts) / sizeof(u32); ++c) {
+            u32 count = counts[c];
+            mat4 transform = random_transform(&random);
+            for (u32 i = 0; i < count; ++i) {
+                points[i] = random_vec3(&random);
+                soa_points.x[i] = points[i].x;
+                soa_points.y[i] = points[i].y;
+                soa_points.z[i] = points[i].z;
+                matrices[i] = random_transform(&random);
+                matrices_b[i] = random_transform(&random);
+                quats[i] = random_quat(&random);
+            }
+            // Past the end, must be left alone.
+            points[count].x = 12345.0f;
+            out_points[count].x = 12345.0f;
+
+            mat4_transform_points(&transform, points, out_points, count);
+            mat4_transform_points_soa(&transform, soa_points, soa_points, count);
+            for (u32 i = 0; i < count; ++i) {
+                vec3 expected = reference_transform(&transform, points[i]);
+                expect_to_be_true(vec3_near(expected, out_points[i]));
+                expect_to_be_true(vec3_near(expected, vec3_create(soa_points.x[i], soa_points.y[i], soa_points.z[i])));
+            }
+            expect_float_to_be(12345.0f, out_points[count].x);
+
+            vec3_normalize_batch_soa(soa_points, count);
+            HcopyMemory(out_points, points, sizeof(vec3) * count);
+            vec3_normalize_batch(out_points, count);
+            for (u32 i = 0; i < count; ++i) {
+                expect_to_be_true(vec3_near(vec3_normalized(points[i]), out_points[i]));
+                vec3 expected = vec3_normalized(reference_transform(&transform, points[i]));
+                expect_to_be_true(vec3_near(expected, vec3_create(soa_points.x[i], soa_points.y[i], soa_points.z[i])));
+            }
+            expect_float_to_be(12345.0f, out_points[count].x);
+
+            mat4_mul_batch(matrices, matrices_b, out_matrices, count);
+            for (u32 i = 0; i < count; ++i) {
+                mat4 expected = mat4_mul(matrices[i], matrices_b[i]);
+                expect_to_be_true(mat4_near(&expected, &out_matrices[i]));
+            }
+            // In place.
+            mat4_mul_batch(matrices, matrices_b, matrices, count);
+            for (u32 i = 0; i < count; ++i) {
+                expect_to_be_true(mat4_near(&out_matrices[i], &matrices[i]));
+            }
+
+            quat_to_mat4_batch(quats, out_matrices, count);
+            for (u32 i = 0; i < count; ++i) {
+                mat4 expected = quat_to_mat4(quats[i]);
+                expect_to_be_true(mat4_near(&expected, &out_matrices[i]));
+            }
+        }
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+
+    Hfree(points, sizeof(vec3) * (max_count + 1), MEMORY_TAG_ARRAY);
+    Hfree(out_points, sizeof(vec3) * (max_count + 1), MEMORY_TAG_ARRAY);
+    Hfree(soa, sizeof(f32) * max_count * 3, MEMORY_TAG_ARRAY);
+    Hfree(matrices, sizeof(mat4) * max_count * 3, MEMORY_TAG_ARRAY);
+    Hfree(quats, sizeof(quat) * max_count, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+// Times a batch run: one value at a time with hmath.h, then the batch call without and with the job system.
+#define BENCHMARK_BATCH(name, single_loop, batch_call)                                                           \
+    {                                                                                                            \
+        hclock clock;                                                                                            \
+        startClock(&clock);                                                                                      \
+        single_loop;                                                                                             \
+        updateClock(&clock);                                                                                     \
+        f64 single_time = clock.elapsed;                                                                         \
+        startClock(&clock);                                                                                      \
+        batch_call;                                                                                              \
+        updateClock(&clock);                                                                                     \
+        f64 batch_time = clock.elapsed;                                                                          \
+        expect_to_be_true(job_system_initialize(&job_memory, job_state, 0));                                     \
+        startClock(&clock);                                                                                      \
+        batch_call;                                                                                              \
+        updateClock(&clock);                                                                                     \
+        u32 thread_count = job_system_thread_count();                                                            \
+        job_system_shutdown(job_state);                                                                          \
+        HINFO("%s: one at a time %.2f ms, batch %.2f ms (%.1fx), batch on %u threads %.2f ms (%.1fx).",          \
+              name, single_time * 1000.0, batch_time * 1000.0, single_time / batch_time,                         \
+              thread_count, clock.elapsed * 1000.0, single_time / clock.elapsed);                                \
+    }
+
+u8 math_batch_benchmark() {
+    vec3* points = Hallocate(sizeof(vec3) * BENCHMARK_POINT_COUNT, MEMORY_TAG_ARRAY);
+    vec3* out_points = Hallocate(sizeof(vec3) * BENCHMARK_POINT_COUNT, MEMORY_TAG_ARRAY);
+    f32* soa = Hallocate(sizeof(f32) * BENCHMARK_POINT_COUNT * 3, MEMORY_TAG_ARRAY);
+    mat4* matrices = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT * 3, MEMORY_TAG_ARRAY);
+    quat* quats = Hallocate(sizeof(quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    vec3_soa soa_points = {soa, soa + BENCHMARK_POINT_COUNT, soa + BENCHMARK_POINT_COUNT * 2};
+    mat4* matrices_b = matrices + BENCHMARK_MATRIX_COUNT;
+    mat4* out_matrices = matrices + BENCHMARK_MATRIX_COUNT * 2;
+
+    u32 random = 11;
+    mat4 transform = random_transform(&random);
+    for (u32 i = 0; i < BENCHMARK_POINT_COUNT; ++i) {
+        points[i] = random_vec3(&random);
+        soa_points.x[i] = points[i].x;
+        soa_points.y[i] = points[i].y;
+        soa_points.z[i] = points[i].z;
+    }
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        matrices[i] = random_transform(&random);
+        matrices_b[i] = random_transform(&random);
+        quats[i] = random_quat(&random);
+    }
+
+    u64 job_memory = 0;
+    job_system_initialize(&job_memory, 0, 0);
+    void* job_state = Hallocate(job_memory, MEMORY_TAG_JOB);
+
+    BENCHMARK_BATCH("1M points transformed",
+                    for (u32 i = 0; i < BENCHMARK_POINT_COUNT; ++i) out_points[i] = reference_transform(&transform, points[i]),
+                    mat4_transform_points(&transform, points, out_points, BENCHMARK_POINT_COUNT));
+    BENCHMARK_BATCH("1M points transformed (soa)",
+                    for (u32 i = 0; i < BENCHMARK_POINT_COUNT; ++i) out_points[i] = reference_transform(&transform, points[i]),
+                    mat4_transform_points_soa(&transform, soa_points, soa_points, BENCHMARK_POINT_COUNT));
+    BENCHMARK_BATCH("1M vectors normalized",
+                    for (u32 i = 0; i < BENCHMARK_POINT_COUNT; ++i) out_points[i] = vec3_normalized(points[i]),
+                    vec3_normalize_batch(out_points, BENCHMARK_POINT_COUNT));
+    BENCHMARK_BATCH("256K matrices multiplied",
+                    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) out_matrices[i] = mat4_mul(matrices[i], matrices_b[i]),
+                    mat4_mul_batch(matrices, matrices_b, out_matrices, BENCHMARK_MATRIX_COUNT));
+    BENCHMARK_BATCH("256K quaternions to matrices",
+                    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) out_matrices[i] = quat_to_mat4(quats[i]),
+                    quat_to_mat4_batch(quats, out_matrices, BENCHMARK_MATRIX_COUNT));
+
+    Hfree(job_state, job_memory, MEMORY_TAG_JOB);
+    Hfree(points, sizeof(vec3) * BENCHMARK_POINT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(out_points, sizeof(vec3) * BENCHMARK_POINT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(soa, sizeof(f32) * BENCHMARK_POINT_COUNT * 3, MEMORY_TAG_ARRAY);
+    Hfree(matrices, sizeof(mat4) * BENCHMARK_MATRIX_COUNT * 3, MEMORY_TAG_ARRAY);
+    Hfree(quats, sizeof(quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void hmath_batch_register_tests() {
+    test_manager_register_test(math_batch_should_match_single_value_math, "math batch should match single value math");
+    test_manager_register_benchmark(math_batch_benchmark, "math batch benchmark");
+}
@@ -0,0 +1,233 @@
+#include "hmath_benchmarks.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/hmath.h>
+#include <memory/hmemory.h>
+
+#if HARCH_X64
+#include <x86intrin.h>
+#endif
+
+/*
+ * Time per call of each hmath.h function, to compare SIMD and approximation changes
+ * against. Every call reads a different input from a small array that stays in cache and
+ * writes its own output, so these are throughput numbers rather than latency.
+ */
+
+// Must be a power of 2.
+#define MICRO_BENCHMARK_COUNT 1024
+#define MICRO_BENCHMARK_ROUNDS 2000
+
+typedef struct benchmark_data {
+    f32* floats;
+    vec2* vec2s;
+    vec3* vec3s;
+    vec4* vec4s;
+    mat4* mat4s;
+    affine* affines;
+    dual_quat* dual_quats;
+
+    f32* out_floats;
+    vec2* out_vec2s;
+    vec3* out_vec3s;
+    vec4* out_vec4s;
+    mat4* out_mat4s;
+    affine* out_affines;
+    dual_quat* out_dual_quats;
+} benchmark_data;
+
+// Small deterministic generator, test data must not depend on rand().
+static u32 next_random(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Returns a number in [-1, 1].
+static f32 random_unit(u32* state) {
+    return (f32)(next_random(state) & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+// Time stamp counter ticks. They run at a constant rate, wich is close to but not the same as core cycles.
+static u64 read_cycles() {
+#if HARCH_X64
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void benchmark_data_create(benchmark_data* data) {
+    data->floats = Hallocate(sizeof(f32) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->vec2s = Hallocate(sizeof(vec2) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->vec3s = Hallocate(sizeof(vec3) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->vec4s = Hallocate(sizeof(vec4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->mat4s = Hallocate(sizeof(mat4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->affines = Hallocate(sizeof(affine) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->dual_quats = Hallocate(sizeof(dual_quat) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_floats = Hallocate(sizeof(f32) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_vec2s = Hallocate(sizeof(vec2) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_vec3s = Hallocate(sizeof(vec3) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_vec4s = Hallocate(sizeof(vec4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_mat4s = Hallocate(sizeof(mat4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_affines = Hallocate(sizeof(affine) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    data->out_dual_quats = Hallocate(sizeof(dual_quat) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+
+    u32 random = 47;
+    for (u32 i = 0; i < MICRO_BENCHMARK_COUNT; ++i) {
+        // Positive and away from 0, so every function accepts them.
+        data->floats[i] = random_unit(&random) * 0.4f + 0.5f;
+        data->vec2s[i] = vec2_create(random_unit(&random) + 2.0f, random_unit(&random) - 2.0f);
+        data->vec3s[i] = vec3_create(random_unit(&random) + 2.0f, random_unit(&random) - 2.0f, random_unit(&random) + 2.0f);
+        data->vec4s[i] = vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f);
+        quat rotation = quat_normalize(data->vec4s[i]);
+        data->mat4s[i] = mat4_mul(quat_to_mat4(rotation), mat4_translation(data->vec3s[i]));
+        data->dual_quats[i] = dual_quat_from_rotation_translation(rotation, data->vec3s[i]);
+        data->affines[i] = dual_quat_to_affine(data->dual_quats[i]);
+    }
+}
+
+static void benchmark_data_destroy(benchmark_data* data) {
+    Hfree(data->floats, sizeof(f32) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->vec2s, sizeof(vec2) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->vec3s, sizeof(vec3) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->vec4s, sizeof(vec4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->mat4s, sizeof(mat4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->affines, sizeof(affine) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->dual_quats, sizeof(dual_quat) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_floats, sizeof(f32) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_vec2s, sizeof(vec2) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_vec3s, sizeof(vec3) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_vec4s, sizeof(vec4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_mat4s, sizeof(mat4) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_affines, sizeof(affine) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(data->out_dual_quats, sizeof(dual_quat) * MICRO_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+}
+
+/*
+ * Runs out[i] = expression over the inputs, where i is the call's own input and j another
+ * one for functions with two arguments, and logs the time per call.
+ */
+#define MICRO_BENCHMARK(name, out, expression)                                                      \
+    {                                                                                               \
+        hclock clock;                                                                               \
+        startClock(&clock);                                                                         \
+        u64 start_cycles = read_cycles();                                                           \
+        for (u32 round = 0; round < MICRO_BENCHMARK_ROUNDS; ++round) {                              \
+            for (u32 i = 0; i < MICRO_BENCHMARK_COUNT; ++i) {                                       \
+                u32 j = (i + round + 1) & (MICRO_BENCHMARK_COUNT - 1);                              \
+                (void)j;                                                                            \
+                d->out[i] = expression;                                                             \
+            }                                                                                       \
+        }                                                                                           \
+        u64 cycles = read_cycles() - start_cycles;                                                  \
+        updateClock(&clock);                                                                        \
+        f64 calls = (f64)MICRO_BENCHMARK_COUNT * MICRO_BENCHMARK_ROUNDS;                            \
+        HINFO("  %-30s %7.2f ns %7.1f cycles", name, clock.elapsed * 1e9 / calls, (f64)cycles / calls); \
+    }
+
+u8 hmath_scalar_benchmark() {
+    benchmark_data data;
+    benchmark_data_create(&data);
+    benchmark_data* d = &data;
+
+    HINFO("Time per call, %u calls each:", MICRO_BENCHMARK_COUNT * MICRO_BENCHMARK_ROUNDS);
+    MICRO_BENCHMARK("hsin", out_floats, hsin(d->floats[i]));
+    MICRO_BENCHMARK("hsin_fast low", out_floats, hsin_fast(d->floats[i], HMATH_PRECISION_LOW));
+    MICRO_BENCHMARK("hsin_fast high", out_floats, hsin_fast(d->floats[i], HMATH_PRECISION_HIGH));
+    MICRO_BENCHMARK("hcos", out_floats, hcos(d->floats[i]));
+    MICRO_BENCHMARK("hcos_fast high", out_floats, hcos_fast(d->floats[i], HMATH_PRECISION_HIGH));
+    MICRO_BENCHMARK("htan", out_floats, htan(d->floats[i]));
+    MICRO_BENCHMARK("hacos", out_floats, hacos(d->floats[i]));
+    MICRO_BENCHMARK("hsqrt", out_floats, hsqrt(d->floats[i]));
+    MICRO_BENCHMARK("hsqrt_inline", out_floats, hsqrt_inline(d->floats[i]));
+    MICRO_BENCHMARK("hrsqrt", out_floats, hrsqrt(d->floats[i]));
+    MICRO_BENCHMARK("hpow", out_floats, hpow(d->floats[i], d->floats[j]));
+    MICRO_BENCHMARK("habs", out_floats, habs(d->floats[i] - d->floats[j]));
+
+    benchmark_data_destroy(&data);
+    return true;
+}
+
+u8 hmath_vector_benchmark() {
+    benchmark_data data;
+    benchmark_data_create(&data);
+    benchmark_data* d = &data;
+
+    HINFO("Time per call, %u calls each:", MICRO_BENCHMARK_COUNT * MICRO_BENCHMARK_ROUNDS);
+    MICRO_BENCHMARK("vec2_add", out_vec2s, vec2_add(d->vec2s[i], d->vec2s[j]));
+    MICRO_BENCHMARK("vec2_sub", out_vec2s, vec2_sub(d->vec2s[i], d->vec2s[j]));
+    MICRO_BENCHMARK("vec2_mul", out_vec2s, vec2_mul(d->vec2s[i], d->vec2s[j]));
+    MICRO_BENCHMARK("vec2_div", out_vec2s, vec2_div(d->vec2s[i], d->vec2s[j]));
+    MICRO_BENCHMARK("vec2_length", out_floats, vec2_length(d->vec2s[i]));
+    MICRO_BENCHMARK("vec2_normalized", out_vec2s, vec2_normalized(d->vec2s[i]));
+    MICRO_BENCHMARK("vec2_distance", out_floats, vec2_distance(d->vec2s[i], d->vec2s[j]));
+
+    MICRO_BENCHMARK("vec3_add", out_vec3s, vec3_add(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_sub", out_vec3s, vec3_sub(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_mul", out_vec3s, vec3_mul(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_mul_scalar", out_vec3s, vec3_mul_scalar(d->vec3s[i], d->floats[j]));
+    MICRO_BENCHMARK("vec3_div", out_vec3s, vec3_div(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_dot", out_floats, vec3_dot(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_cross", out_vec3s, vec3_cross(d->vec3s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("vec3_length", out_floats, vec3_length(d->vec3s[i]));
+    MICRO_BENCHMARK("vec3_normalized", out_vec3s, vec3_normalized(d->vec3s[i]));
+    MICRO_BENCHMARK("vec3_distance", out_floats, vec3_distance(d->vec3s[i], d->vec3s[j]));
+
+    MICRO_BENCHMARK("vec4_add", out_vec4s, vec4_add(d->vec4s[i], d->vec4s[j]));
+    MICRO_BENCHMARK("vec4_sub", out_vec4s, vec4_sub(d->vec4s[i], d->vec4s[j]));
+    MICRO_BENCHMARK("vec4_mul", out_vec4s, vec4_mul(d->vec4s[i], d->vec4s[j]));
+    MICRO_BENCHMARK("vec4_div", out_vec4s, vec4_div(d->vec4s[i], d->vec4s[j]));
+    MICRO_BENCHMARK("vec4_length", out_floats, vec4_length(d->vec4s[i]));
+    MICRO_BENCHMARK("vec4_normalized", out_vec4s, vec4_normalized(d->vec4s[i]));
+
+    benchmark_data_destroy(&data);
+    return true;
+}
+
+u8 hmath_matrix_benchmark() {
+    benchmark_data data;
+    benchmark_data_create(&data);
+    benchmark_data* d = &data;
+
+    HINFO("Time per call, %u calls each:", MICRO_BENCHMARK_COUNT * MICRO_BENCHMARK_ROUNDS);
+    MICRO_BENCHMARK("mat4_mul", out_mat4s, mat4_mul(d->mat4s[i], d->mat4s[j]));
+    MICRO_BENCHMARK("mat4_inverse", out_mat4s, mat4_inverse(d->mat4s[i]));
+    MICRO_BENCHMARK("mat4_transposed", out_mat4s, mat4_transposed(d->mat4s[i]));
+    MICRO_BENCHMARK("mat4_translation", out_mat4s, mat4_translation(d->vec3s[i]));
+    MICRO_BENCHMARK("mat4_scale", out_mat4s, mat4_scale(d->vec3s[i]));
+    MICRO_BENCHMARK("mat4_euler_xyz", out_mat4s, mat4_euler_xyz(d->vec3s[i].x, d->vec3s[i].y, d->vec3s[i].z));
+    MICRO_BENCHMARK("mat4_look_at", out_mat4s, mat4_look_at(d->vec3s[i], d->vec3s[j], vec3_up()));
+    MICRO_BENCHMARK("mat4_perspective", out_mat4s, mat4_perspective(d->floats[i], 1.5f, 0.1f, 1000.0f));
+    MICRO_BENCHMARK("mat4_forward", out_vec3s, mat4_forward(d->mat4s[i]));
+
+    MICRO_BENCHMARK("quat_mul", out_vec4s, quat_mul(d->vec4s[i], d->vec4s[j]));
+    MICRO_BENCHMARK("quat_normalize", out_vec4s, quat_normalize(d->vec4s[i]));
+    MICRO_BENCHMARK("quat_to_mat4", out_mat4s, quat_to_mat4(d->vec4s[i]));
+    MICRO_BENCHMARK("quat_to_rotaion_matrix", out_mat4s, quat_to_rotaion_matrix(d->vec4s[i], d->vec3s[j]));
+    MICRO_BENCHMARK("quat_from_axis_angle", out_vec4s, quat_from_axis_angle(d->vec3s[i], d->floats[j], true));
+    MICRO_BENCHMARK("quat_slerp", out_vec4s, quat_slerp(d->vec4s[i], d->vec4s[j], d->floats[i]));
+
+    MICRO_BENCHMARK("affine_mul", out_affines, affine_mul(d->affines[i], d->affines[j]));
+    MICRO_BENCHMARK("affine_inverse", out_affines, affine_inverse(d->affines[i]));
+    MICRO_BENCHMARK("affine_transform_point", out_vec3s, affine_transform_point(d->affines[i], d->vec3s[j]));
+    MICRO_BENCHMARK("dual_quat_mul", out_dual_quats, dual_quat_mul(d->dual_quats[i], d->dual_quats[j]));
+    MICRO_BENCHMARK("dual_quat_normalize", out_dual_quats, dual_quat_normalize(d->dual_quats[i]));
+    MICRO_BENCHMARK("dual_quat_transform_point", out_vec3s, dual_quat_transform_point(d->dual_quats[i], d->vec3s[j]));
+
+    benchmark_data_destroy(&data);
+    return true;
+}
+
+void hmath_benchmarks_register_tests() {
+    test_manager_register_benchmark(hmath_scalar_benchmark, "hmath scalar benchmark");
+    test_manager_register_benchmark(hmath_vector_benchmark, "hmath vector benchmark");
+    test_manager_register_benchmark(hmath_matrix_benchmark, "hmath matrix benchmark");
+}
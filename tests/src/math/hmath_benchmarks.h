@@ -0,0 +1,11 @@
+#pragma once
+
+#ifdef __cplusplus 
+extern "C" { 
+#endif
+
+void hmath_benchmarks_register_tests();
+
+#ifdef __cplusplus
+} 
+#endif
@@ -0,0 +1,30 @@
+#define HNO_SIMD
+#include "hmath_scalar.h"
+
+void scalar_mat4_mul(const mat4* matrix_a, const mat4* matrix_b, mat4* out_matrix) {
+    *out_matrix = mat4_mul(*matrix_a, *matrix_b);
+}
+
+void scalar_mat4_inverse(const mat4* matrix, mat4* out_matrix) {
+    *out_matrix = mat4_inverse(*matrix);
+}
+
+void scalar_mat4_transposed(const mat4* matrix, mat4* out_matrix) {
+    *out_matrix = mat4_transposed(*matrix);
+}
+
+void scalar_quat_mul(const quat* q_a, const quat* q_b, quat* out_quat) {
+    *out_quat = quat_mul(*q_a, *q_b);
+}
+
+void scalar_quat_normalize(const quat* q, quat* out_quat) {
+    *out_quat = quat_normalize(*q);
+}
+
+void scalar_affine_mul(const affine* transform_a, const affine* transform_b, affine* out_transform) {
+    *out_transform = affine_mul(*transform_a, *transform_b);
+}
+
+void scalar_dual_quat_normalize(const dual_quat* dq, dual_quat* out_dual_quat) {
+    *out_dual_quat = dual_quat_normalize(*dq);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <math/hmath.h>
+
+#ifdef __cplusplus 
+extern "C" { 
+#endif
+
+/*
+ * The scalar (HNO_SIMD) versions of hmath.h functions, built in their own translation unit
+ * so the SIMD paths can be checked and benchmarked against them. Values go by pointer since
+ * vec4 is passed differently with and without its SIMD member.
+ */
+void scalar_mat4_mul(const mat4* matrix_a, const mat4* matrix_b, mat4* out_matrix);
+void scalar_mat4_inverse(const mat4* matrix, mat4* out_matrix);
+void scalar_mat4_transposed(const mat4* matrix, mat4* out_matrix);
+void scalar_quat_mul(const quat* q_a, const quat* q_b, quat* out_quat);
+void scalar_quat_normalize(const quat* q, quat* out_quat);
+void scalar_affine_mul(const affine* transform_a, const affine* transform_b, affine* out_transform);
+void scalar_dual_quat_normalize(const dual_quat* dq, dual_quat* out_dual_quat);
+
+#ifdef __cplusplus
+} 
+#endif
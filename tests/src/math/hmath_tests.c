@@ -0,0 +1,863 @@
+#include "hmath_tests.h"
+#include "hmath_scalar.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <memory/hmemory.h>
+
+#include <math.h>
+
+// Must be a power of 2.
+#define BENCHMARK_MATRIX_COUNT 1024
+#define BENCHMARK_ROUNDS 5000
+#define MATH_TOLERANCE 0.0005f
+// Must be a multiple of 8.
+#define BENCHMARK_VALUE_COUNT (1024 * 1024)
+
+// Small deterministic generator, test data must not depend on rand().
+static u32 next_random(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Returns a number in [-1, 1].
+static f32 random_unit(u32* state) {
+    return (f32)(next_random(state) & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+// Rotation, scale and translation, so the matrix is comfortably invertible.
+static mat4 random_transform(u32* state) {
+    vec3 axis = vec3_normalized(vec3_create(random_unit(state), random_unit(state), random_unit(state) + 2.0f));
+    quat rotation = quat_from_axis_angle(axis, random_unit(state) * H_PI, true);
+    mat4 matrix = mat4_mul(mat4_scale(vec3_create(1.5f + random_unit(state), 1.5f + random_unit(state), 1.5f + random_unit(state))), quat_to_mat4(rotation));
+    return mat4_mul(matrix, mat4_translation(vec3_create(random_unit(state) * 10.0f, random_unit(state) * 10.0f, random_unit(state) * 10.0f)));
+}
+
+// Written out independently of hmath.h, so both paths are checked against something.
+static quat reference_quat_mul(quat a, quat b) {
+    quat result;
+    result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+    result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+    result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+    result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+    return result;
+}
+
+static b8 mat4_near(const mat4* a, const mat4* b, f32 tolerance) {
+    for (u32 i = 0; i < 16; ++i) {
+        if (habs(a->data[i] - b->data[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 vec4_near(vec4 a, vec4 b, f32 tolerance) {
+    for (u32 i = 0; i < 4; ++i) {
+        if (habs(a.elements[i] - b.elements[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 affine_near(const affine* a, const affine* b, f32 tolerance) {
+    for (u32 i = 0; i < 12; ++i) {
+        if (habs(a->data[i] - b->data[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static b8 vec3_near(vec3 a, vec3 b, f32 tolerance) {
+    return habs(a.x - b.x) <= tolerance && habs(a.y - b.y) <= tolerance && habs(a.z - b.z) <= tolerance;
+}
+
+// The point as a row vector with w = 1, times the matrix.
+static vec3 reference_transform_point(const mat4* m, vec3 p) {
+    const f32* d = m->data;
+    return vec3_create(
+        p.x * d[0] + p.y * d[4] + p.z * d[8] + d[12],
+        p.x * d[1] + p.y * d[5] + p.z * d[9] + d[13],
+        p.x * d[2] + p.y * d[6] + p.z * d[10] + d[14]);
+}
+
+static dual_quat random_rigid_transform(u32* state) {
+    quat rotation = vec4_create(random_unit(state), random_unit(state), random_unit(state), random_unit(state) + 2.0f);
+    vec3 translation = vec3_create(random_unit(state) * 10.0f, random_unit(state) * 10.0f, random_unit(state) * 10.0f);
+    return dual_quat_from_rotation_translation(rotation, translation);
+}
+
+u8 vec4_should_keep_components_apart() {
+    vec4 v = vec4_create(1.0f, 2.0f, 3.0f, 4.0f);
+    expect_float_to_be(1.0f, v.x);
+    expect_float_to_be(2.0f, v.y);
+    expect_float_to_be(3.0f, v.z);
+    expect_float_to_be(4.0f, v.w);
+    expect_should_be(16, sizeof(vec4));
+    expect_should_be(64, sizeof(mat4));
+
+    vec4 sum = vec4_add(v, vec4_one());
+    expect_to_be_true(vec4_near(vec4_create(2.0f, 3.0f, 4.0f, 5.0f), sum, 0.0f));
+    expect_to_be_true(vec4_near(vec4_create(0.0f, 1.0f, 2.0f, 3.0f), vec4_sub(v, vec4_one()), 0.0f));
+    expect_to_be_true(vec4_near(vec4_create(1.0f, 4.0f, 9.0f, 16.0f), vec4_mul(v, v), 0.0f));
+    expect_to_be_true(vec4_near(vec4_one(), vec4_div(v, v), 0.0f));
+    expect_float_to_be(30.0f, vec4_length_squared(v));
+    expect_float_to_be(1.0f, vec4_length(vec4_normalized(v)));
+    expect_to_be_true(vec4_near(vec4_create(1.0f, 2.0f, 3.0f, 7.0f), vec4_from_vec3(vec3_create(1.0f, 2.0f, 3.0f), 7.0f), 0.0f));
+    return true;
+}
+
+u8 mat4_should_match_reference() {
+    u32 random = 7;
+    for (u32 i = 0; i < 1000; ++i) {
+        mat4 a = random_transform(&random);
+        mat4 b = random_transform(&random);
+
+        mat4 product = mat4_mul(a, b);
+        mat4 expected;
+        scalar_mat4_mul(&a, &b, &expected);
+        expect_to_be_true(mat4_near(&expected, &product, MATH_TOLERANCE));
+
+        mat4 inverse = mat4_inverse(a);
+        scalar_mat4_inverse(&a, &expected);
+        expect_to_be_true(mat4_near(&expected, &inverse, MATH_TOLERANCE));
+        mat4 identity = mat4_identity();
+        mat4 round_trip = mat4_mul(a, inverse);
+        expect_to_be_true(mat4_near(&identity, &round_trip, MATH_TOLERANCE));
+
+        mat4 transposed = mat4_transposed(a);
+        scalar_mat4_transposed(&a, &expected);
+        expect_to_be_true(mat4_near(&expected, &transposed, 0.0f));
+        for (u32 j = 0; j < 16; ++j) {
+            expect_float_to_be(a.data[j], transposed.data[(j % 4) * 4 + j / 4]);
+        }
+    }
+    return true;
+}
+
+u8 quat_should_match_reference() {
+    u32 random = 11;
+    for (u32 i = 0; i < 1000; ++i) {
+        quat a = quat_normalize(vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f));
+        quat b = quat_normalize(vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f));
+        expect_float_to_be(1.0f, quat_normal(a));
+        quat product = quat_mul(a, b);
+        quat scalar;
+        scalar_quat_mul(&a, &b, &scalar);
+        expect_to_be_true(vec4_near(reference_quat_mul(a, b), product, MATH_TOLERANCE));
+        expect_to_be_true(vec4_near(reference_quat_mul(a, b), scalar, MATH_TOLERANCE));
+        quat unnormalized = vec4_mul(a, vec4_create(3.0f, 3.0f, 3.0f, 3.0f));
+        scalar_quat_normalize(&unnormalized, &scalar);
+        expect_to_be_true(vec4_near(scalar, quat_normalize(unnormalized), MATH_TOLERANCE));
+
+        // A rotation followed by its inverse is no rotation at all.
+        expect_to_be_true(vec4_near(quat_identify(), quat_mul(a, quat_inverse(a)), MATH_TOLERANCE));
+        expect_float_to_be(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w, quat_dot(a, b));
+    }
+
+    // Composing two quarter turns about z makes a half turn.
+    quat quarter = quat_from_axis_angle(vec3_create(0.0f, 0.0f, 1.0f), H_HALF_PI, true);
+    quat half = quat_from_axis_angle(vec3_create(0.0f, 0.0f, 1.0f), H_PI, true);
+    expect_to_be_true(vec4_near(half, quat_mul(quarter, quarter), MATH_TOLERANCE));
+    return true;
+}
+
+u8 math_constants_should_group() {
+    // Used inside other expressions, the constants must keep their own value.
+    f32 pi = H_PI;
+    f32 half = pi / H_PI_2;
+    expect_float_to_be(0.5f, half);
+    f32 two = pi / H_HALF_PI;
+    expect_float_to_be(2.0f, two);
+    f32 four_over_pi = 1.0f / H_QUARTER_PI;
+    expect_float_to_be(4.0f / pi, four_over_pi);
+    f32 one_over_two_pi = H_ONE_OVER_TWO_PI;
+    expect_float_to_be(1.0f / (2.0f * pi), one_over_two_pi);
+    f32 pi_again = 1.0f / H_ONE_OVER_PI;
+    expect_float_to_be(pi, pi_again);
+    f32 degrees_per_radian = 1.0f / H_DEG2RAD_MULTIPLIER;
+    expect_float_to_be(180.0f / pi, degrees_per_radian);
+    f32 radians_per_degree = 1.0f / H_RAD2DEG_MULTIPLIER;
+    expect_float_to_be(pi / 180.0f, radians_per_degree);
+    f32 radians = deg_to_rad(180.0f);
+    expect_float_to_be(pi, radians);
+    f32 degrees = red_to_deg(H_HALF_PI);
+    expect_float_to_be(90.0f, degrees);
+
+    expect_to_be_false(isPowerOf2(0));
+    expect_to_be_true(isPowerOf2(1));
+    expect_to_be_true(isPowerOf2(64));
+    expect_to_be_false(isPowerOf2(96));
+    expect_to_be_true(isPowerOf2(1ull << 63));
+
+    expect_float_to_be(2.5f, habs(-2.5f));
+    expect_float_to_be(2.5f, habs(2.5f));
+    // The sign goes away from -0 as well.
+    expect_to_be_true(1.0f / habs(-0.0f) > 0.0f);
+
+    u32 random = 23;
+    for (u32 i = 0; i < 1000; ++i) {
+        f32 x = random_unit(&random);
+        expect_float_to_be(sinf(x * 10.0f), hsin(x * 10.0f));
+        expect_float_to_be(cosf(x * 10.0f), hcos(x * 10.0f));
+        expect_float_to_be(tanf(x), htan(x));
+        expect_float_to_be(acosf(x), hacos(x));
+        expect_float_to_be(sqrtf(x + 1.0f), hsqrt(x + 1.0f));
+        expect_float_to_be(sqrtf(x + 1.0f), hsqrt_inline(x + 1.0f));
+        expect_float_to_be(powf(x + 1.0f, 2.5f), hpow(x + 1.0f, 2.5f));
+    }
+    return true;
+}
+
+u8 vec2_should_match_reference() {
+    u32 random = 29;
+    for (u32 i = 0; i < 1000; ++i) {
+        vec2 a = vec2_create(random_unit(&random) * 10.0f, random_unit(&random) * 10.0f);
+        // Away from 0, so it can be divided by.
+        vec2 b = vec2_create(random_unit(&random) + 2.0f, random_unit(&random) - 2.0f);
+        expect_float_to_be(a.x, a.elements[0]);
+        expect_float_to_be(a.y, a.elements[1]);
+
+        expect_to_be_true(vec2_compare(vec2_create(a.x + b.x, a.y + b.y), vec2_add(a, b), 0.0f));
+        expect_to_be_true(vec2_compare(vec2_create(a.x - b.x, a.y - b.y), vec2_sub(a, b), 0.0f));
+        expect_to_be_true(vec2_compare(vec2_create(a.x * b.x, a.y * b.y), vec2_mul(a, b), 0.0f));
+        expect_to_be_true(vec2_compare(vec2_create(a.x / b.x, a.y / b.y), vec2_div(a, b), 0.0f));
+
+        f32 length = sqrtf(a.x * a.x + a.y * a.y);
+        expect_float_to_be(a.x * a.x + a.y * a.y, vec2_length_squared(a));
+        expect_float_to_be(length, vec2_length(a));
+        vec2 normalized = vec2_normalized(a);
+        expect_to_be_true(vec2_compare(vec2_create(a.x / length, a.y / length), normalized, MATH_TOLERANCE));
+        vec2_normalize(&a);
+        expect_to_be_true(vec2_compare(normalized, a, 0.0f));
+
+        vec2 difference = vec2_sub(a, b);
+        expect_float_to_be(sqrtf(difference.x * difference.x + difference.y * difference.y), vec2_distance(a, b));
+    }
+
+    expect_to_be_true(vec2_compare(vec2_zero(), vec2_add(vec2_up(), vec2_down()), 0.0f));
+    expect_to_be_true(vec2_compare(vec2_zero(), vec2_add(vec2_left(), vec2_right()), 0.0f));
+    expect_to_be_true(vec2_compare(vec2_one(), vec2_sub(vec2_up(), vec2_left()), 0.0f));
+    expect_to_be_false(vec2_compare(vec2_zero(), vec2_create(0.0f, 0.01f), 0.001f));
+    expect_to_be_true(vec2_compare(vec2_zero(), vec2_create(0.0f, 0.01f), 0.1f));
+    return true;
+}
+
+u8 vec3_should_match_reference() {
+    u32 random = 31;
+    for (u32 i = 0; i < 1000; ++i) {
+        vec3 a = vec3_create(random_unit(&random) * 10.0f, random_unit(&random) * 10.0f, random_unit(&random) * 10.0f);
+        vec3 b = vec3_create(random_unit(&random) + 2.0f, random_unit(&random) - 2.0f, random_unit(&random) + 2.0f);
+        f32 s = random_unit(&random);
+
+        expect_to_be_true(vec3_compare(vec3_create(a.x + b.x, a.y + b.y, a.z + b.z), vec3_add(a, b), 0.0f));
+        expect_to_be_true(vec3_compare(vec3_create(a.x - b.x, a.y - b.y, a.z - b.z), vec3_sub(a, b), 0.0f));
+        expect_to_be_true(vec3_compare(vec3_create(a.x * b.x, a.y * b.y, a.z * b.z), vec3_mul(a, b), 0.0f));
+        expect_to_be_true(vec3_compare(vec3_create(a.x * s, a.y * s, a.z * s), vec3_mul_scalar(a, s), 0.0f));
+        expect_to_be_true(vec3_compare(vec3_create(a.x / b.x, a.y / b.y, a.z / b.z), vec3_div(a, b), 0.0f));
+
+        expect_float_to_be(a.x * b.x + a.y * b.y + a.z * b.z, vec3_dot(a, b));
+        vec3 cross = vec3_create(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+        expect_to_be_true(vec3_compare(cross, vec3_cross(a, b), MATH_TOLERANCE));
+        // The cross product is perpendicular to both.
+        expect_float_to_be(0.0f, vec3_dot(vec3_cross(a, b), b) * 0.01f);
+
+        f32 length_squared = a.x * a.x + a.y * a.y + a.z * a.z;
+        f32 length = sqrtf(length_squared);
+        expect_float_to_be(length_squared, vec3_length_squared(a));
+        expect_float_to_be(length, vec3_length(a));
+        vec3 normalized = vec3_normalized(a);
+        expect_to_be_true(vec3_compare(vec3_create(a.x / length, a.y / length, a.z / length), normalized, MATH_TOLERANCE));
+        vec3_normalize(&a);
+        expect_to_be_true(vec3_compare(normalized, a, 0.0f));
+
+        vec3 difference = vec3_sub(a, b);
+        expect_float_to_be(sqrtf(vec3_dot(difference, difference)), vec3_distance(a, b));
+
+        vec4 extended = vec3_to_vec4(b, s);
+        expect_to_be_true(vec4_near(vec4_create(b.x, b.y, b.z, s), extended, 0.0f));
+        expect_to_be_true(vec4_near(extended, vec4_from_vec3(b, s), 0.0f));
+        expect_to_be_true(vec3_compare(b, vec3_from_vec4(extended), 0.0f));
+        expect_to_be_true(vec3_compare(b, vec4_to_vec3(extended), 0.0f));
+    }
+
+    // Right handed, with -z forward.
+    expect_to_be_true(vec3_compare(vec3_back(), vec3_cross(vec3_right(), vec3_up()), 0.0f));
+    expect_to_be_true(vec3_compare(vec3_zero(), vec3_add(vec3_forward(), vec3_back()), 0.0f));
+    expect_to_be_true(vec3_compare(vec3_zero(), vec3_add(vec3_up(), vec3_down()), 0.0f));
+    expect_to_be_true(vec3_compare(vec3_zero(), vec3_add(vec3_left(), vec3_right()), 0.0f));
+    expect_to_be_true(vec3_compare(vec3_one(), vec3_add(vec3_add(vec3_right(), vec3_up()), vec3_back()), 0.0f));
+    expect_to_be_false(vec3_compare(vec3_zero(), vec3_create(0.0f, 0.0f, 0.01f), 0.001f));
+
+    vec4 zero = vec4_zero();
+    expect_float_to_be(0.0f, vec4_length(zero));
+    vec4 v = vec4_create(1.0f, 2.0f, 2.0f, 4.0f);
+    expect_float_to_be(5.0f, vec4_length(v));
+    vec4_normalize(&v);
+    expect_to_be_true(vec4_near(vec4_create(0.2f, 0.4f, 0.4f, 0.8f), v, MATH_TOLERANCE));
+    expect_float_to_be(70.0f, vec4_dot_f32(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f));
+    return true;
+}
+
+// The point as a row vector with w = 1, times the matrix and divided by the resulting w.
+static vec3 reference_project_point(const mat4* m, vec3 p) {
+    const f32* d = m->data;
+    f32 w = p.x * d[3] + p.y * d[7] + p.z * d[11] + d[15];
+    vec3 clip = reference_transform_point(m, p);
+    return vec3_create(clip.x / w, clip.y / w, clip.z / w);
+}
+
+u8 mat4_builders_should_transform_points() {
+    vec3 point = vec3_create(1.0f, 2.0f, 3.0f);
+    mat4 matrix = mat4_translation(vec3_create(4.0f, 5.0f, 6.0f));
+    expect_to_be_true(vec3_near(vec3_create(5.0f, 7.0f, 9.0f), reference_transform_point(&matrix, point), 0.0f));
+    matrix = mat4_scale(vec3_create(2.0f, 3.0f, 4.0f));
+    expect_to_be_true(vec3_near(vec3_create(2.0f, 6.0f, 12.0f), reference_transform_point(&matrix, point), 0.0f));
+
+    // Quarter turns counter clockwise, looking down the axis.
+    matrix = mat4_euler_x(H_HALF_PI);
+    expect_to_be_true(vec3_near(vec3_back(), reference_transform_point(&matrix, vec3_up()), MATH_TOLERANCE));
+    matrix = mat4_euler_y(H_HALF_PI);
+    expect_to_be_true(vec3_near(vec3_right(), reference_transform_point(&matrix, vec3_back()), MATH_TOLERANCE));
+    matrix = mat4_euler_z(H_HALF_PI);
+    expect_to_be_true(vec3_near(vec3_up(), reference_transform_point(&matrix, vec3_right()), MATH_TOLERANCE));
+
+    u32 random = 37;
+    for (u32 i = 0; i < 100; ++i) {
+        f32 x = random_unit(&random) * H_PI;
+        f32 y = random_unit(&random) * H_PI;
+        f32 z = random_unit(&random) * H_PI;
+        matrix = mat4_euler_xyz(x, y, z);
+        mat4 expected = mat4_mul(mat4_mul(mat4_euler_x(x), mat4_euler_y(y)), mat4_euler_z(z));
+        expect_to_be_true(mat4_near(&expected, &matrix, MATH_TOLERANCE));
+
+        const f32* d = matrix.data;
+        vec3 right = vec3_create(d[0], d[4], d[8]);
+        vec3 up = vec3_create(d[1], d[5], d[9]);
+        vec3 backward = vec3_create(d[2], d[6], d[10]);
+        expect_to_be_true(vec3_near(right, mat4_right(matrix), MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(vec3_mul_scalar(right, -1.0f), mat4_left(matrix), MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(up, mat4_up(matrix), MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(vec3_mul_scalar(up, -1.0f), mat4_down(matrix), MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(backward, mat4_backward(matrix), MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(vec3_mul_scalar(backward, -1.0f), mat4_forward(matrix), MATH_TOLERANCE));
+    }
+    mat4 identity = mat4_identity();
+    expect_to_be_true(vec3_near(vec3_forward(), mat4_forward(identity), MATH_TOLERANCE));
+    expect_to_be_true(vec3_near(vec3_up(), mat4_up(identity), MATH_TOLERANCE));
+    expect_to_be_true(vec3_near(vec3_right(), mat4_right(identity), MATH_TOLERANCE));
+
+    // The view puts the camera at the origin, looking down -z.
+    vec3 position = vec3_create(1.0f, 2.0f, 3.0f);
+    vec3 target = vec3_create(4.0f, 6.0f, 3.0f);
+    matrix = mat4_look_at(position, target, vec3_up());
+    expect_to_be_true(vec3_near(vec3_zero(), reference_transform_point(&matrix, position), MATH_TOLERANCE));
+    expect_to_be_true(vec3_near(vec3_create(0.0f, 0.0f, -5.0f), reference_transform_point(&matrix, target), MATH_TOLERANCE));
+
+    // Projections map the view volume to [-1, 1].
+    f32 near_clip = 0.1f;
+    f32 far_clip = 100.0f;
+    matrix = mat4_perspective(H_HALF_PI, 2.0f, near_clip, far_clip);
+    vec3 projected = reference_project_point(&matrix, vec3_create(2.0f * near_clip, near_clip, -near_clip));
+    expect_to_be_true(vec3_near(vec3_create(1.0f, 1.0f, -1.0f), projected, MATH_TOLERANCE));
+    projected = reference_project_point(&matrix, vec3_create(-2.0f * far_clip, -far_clip, -far_clip));
+    expect_to_be_true(vec3_near(vec3_create(-1.0f, -1.0f, 1.0f), projected, MATH_TOLERANCE));
+
+    matrix = mat4_ortographic(-2.0f, 2.0f, -1.0f, 1.0f, near_clip, far_clip);
+    projected = reference_project_point(&matrix, vec3_create(2.0f, -1.0f, -near_clip));
+    expect_to_be_true(vec3_near(vec3_create(1.0f, -1.0f, -1.0f), projected, MATH_TOLERANCE));
+    projected = reference_project_point(&matrix, vec3_create(-2.0f, 1.0f, -far_clip));
+    expect_to_be_true(vec3_near(vec3_create(-1.0f, 1.0f, 1.0f), projected, MATH_TOLERANCE));
+    return true;
+}
+
+u8 quat_rotations_should_match_matrices() {
+    vec3 axis_z = vec3_create(0.0f, 0.0f, 1.0f);
+    quat q = quat_from_axis_angle(axis_z, H_HALF_PI, true);
+    expect_to_be_true(vec4_near(vec4_create(0.0f, 0.0f, H_SQRT_ONE_OVER_TWO, H_SQRT_ONE_OVER_TWO), q, MATH_TOLERANCE));
+    quat unnormalized = quat_from_axis_angle(vec3_create(0.0f, 0.0f, 2.0f), H_HALF_PI, false);
+    expect_float_to_be(2.0f * H_SQRT_ONE_OVER_TWO, unnormalized.z);
+
+    u32 random = 41;
+    for (u32 i = 0; i < 1000; ++i) {
+        f32 angle = random_unit(&random) * H_PI;
+        q = quat_from_axis_angle(axis_z, angle, true);
+        // With row vectors, quat_to_mat4 turns the opposite way of the euler matrices.
+        mat4 rotation = quat_to_mat4(q);
+        mat4 expected = mat4_euler_z(-angle);
+        expect_to_be_true(mat4_near(&expected, &rotation, MATH_TOLERANCE));
+
+        q = quat_normalize(vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f));
+        expect_to_be_true(vec4_near(vec4_create(-q.x, -q.y, -q.z, q.w), quat_conjugate(q), 0.0f));
+        unnormalized = vec4_mul(q, vec4_create(3.0f, 3.0f, 3.0f, 3.0f));
+        expect_to_be_true(vec4_near(quat_conjugate(q), quat_inverse(unnormalized), MATH_TOLERANCE));
+        rotation = quat_to_mat4(unnormalized);
+        expected = quat_to_mat4(q);
+        expect_to_be_true(mat4_near(&expected, &rotation, MATH_TOLERANCE));
+
+        // Rotating around a center: move it to the origin, rotate, move it back. The center stays in place.
+        vec3 center = vec3_create(random_unit(&random) * 10.0f, random_unit(&random) * 10.0f, random_unit(&random) * 10.0f);
+        mat4 around = quat_to_rotaion_matrix(q, center);
+        expected = mat4_mul(mat4_mul(mat4_translation(vec3_mul_scalar(center, -1.0f)), quat_to_mat4(q)), mat4_translation(center));
+        expect_to_be_true(mat4_near(&expected, &around, MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(center, reference_transform_point(&around, center), MATH_TOLERANCE * 10.0f));
+        around = quat_to_rotaion_matrix(q, vec3_zero());
+        expected = quat_to_mat4(q);
+        expect_to_be_true(mat4_near(&expected, &around, 0.0f));
+    }
+    return true;
+}
+
+u8 quat_slerp_should_follow_the_shortest_arc() {
+    vec3 axis = vec3_normalized(vec3_create(1.0f, 2.0f, 3.0f));
+    quat identity = quat_identify();
+    u32 random = 43;
+    for (u32 i = 0; i < 1000; ++i) {
+        f32 angle = random_unit(&random) * H_PI * 0.99f;
+        f32 percentage = (random_unit(&random) + 1.0f) * 0.5f;
+        quat target = quat_from_axis_angle(axis, angle, true);
+        quat expected = quat_from_axis_angle(axis, angle * percentage, true);
+        expect_to_be_true(vec4_near(expected, quat_slerp(identity, target, percentage), MATH_TOLERANCE));
+
+        // -target is the same rotation, so it must give the same path instead of the long way around.
+        quat negated = vec4_mul(target, vec4_create(-1.0f, -1.0f, -1.0f, -1.0f));
+        expect_to_be_true(vec4_near(expected, quat_slerp(identity, negated, percentage), MATH_TOLERANCE));
+
+        quat start = quat_normalize(vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f));
+        quat end = quat_mul(start, target);
+        expect_to_be_true(vec4_near(start, quat_slerp(start, end, 0.0f), MATH_TOLERANCE));
+        expect_to_be_true(vec4_near(end, quat_slerp(start, end, 1.0f), MATH_TOLERANCE));
+        quat middle = quat_slerp(start, end, percentage);
+        expect_float_to_be(1.0f, quat_normal(middle));
+    }
+
+    // Close enough rotations are interpolated linearly instead.
+    quat close = quat_from_axis_angle(axis, 0.01f, true);
+    quat expected = quat_from_axis_angle(axis, 0.005f, true);
+    expect_to_be_true(vec4_near(expected, quat_slerp(identity, close, 0.5f), MATH_TOLERANCE));
+    return true;
+}
+
+// Runs the matrix functions over a set of transforms, then the scalar versions over the same set.
+u8 mat4_benchmark_vs_scalar() {
+    mat4* inputs = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    mat4* simd = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    mat4* scalar = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    u32 random = 3;
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        inputs[i] = random_transform(&random);
+    }
+    u32 mask = BENCHMARK_MATRIX_COUNT - 1;
+    hclock clock;
+
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            simd[i] = mat4_mul(inputs[i], inputs[(i + round) & mask]);
+        }
+    }
+    updateClock(&clock);
+    f64 simd_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            scalar_mat4_mul(&inputs[i], &inputs[(i + round) & mask], &scalar[i]);
+        }
+    }
+    updateClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        expect_to_be_true(mat4_near(&scalar[i], &simd[i], MATH_TOLERANCE * 100.0f));
+    }
+    HINFO("%u mat4_mul: scalar %.2f ms, SIMD %.2f ms (%.1fx).",
+          BENCHMARK_MATRIX_COUNT * BENCHMARK_ROUNDS, clock.elapsed * 1000.0, simd_time * 1000.0, clock.elapsed / simd_time);
+
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            simd[i] = mat4_inverse(inputs[(i + round) & mask]);
+        }
+    }
+    updateClock(&clock);
+    simd_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            scalar_mat4_inverse(&inputs[(i + round) & mask], &scalar[i]);
+        }
+    }
+    updateClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        expect_to_be_true(mat4_near(&scalar[i], &simd[i], MATH_TOLERANCE));
+    }
+    HINFO("%u mat4_inverse: scalar %.2f ms, SIMD %.2f ms (%.1fx).",
+          BENCHMARK_MATRIX_COUNT * BENCHMARK_ROUNDS, clock.elapsed * 1000.0, simd_time * 1000.0, clock.elapsed / simd_time);
+
+    Hfree(inputs, sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(simd, sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(scalar, sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+// Largest difference between the approximations and libm, kept per function.
+typedef struct fast_math_errors {
+    f64 sin_low;
+    f64 sin_high;
+    f64 cos_low;
+    f64 cos_high;
+    f64 rsqrt;
+} fast_math_errors;
+
+static void track_error(f64* max_error, f64 error) {
+    error = error < 0.0 ? -error : error;
+    if (error > *max_error) {
+        *max_error = error;
+    }
+}
+
+// Scalar, 4 and 8 lane versions over the same 8 values.
+static void fast_math_measure(const f32* values, fast_math_errors* errors) {
+    f32 results[5][8];
+    for (u32 i = 0; i < 8; ++i) {
+        results[0][i] = hsin_fast(values[i], HMATH_PRECISION_LOW);
+        results[1][i] = hsin_fast(values[i], HMATH_PRECISION_HIGH);
+        results[2][i] = hcos_fast(values[i], HMATH_PRECISION_LOW);
+        results[3][i] = hcos_fast(values[i], HMATH_PRECISION_HIGH);
+        results[4][i] = hrsqrt(habs(values[i]));
+    }
+#if defined(HUSE_SIMD)
+    // The lane versions have to agree with the scalar ones up to rounding.
+    f32 lanes[8];
+    for (u32 i = 0; i < 8; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        _mm_storeu_ps(lanes, hsimd_sin4(x, HMATH_PRECISION_HIGH));
+        _mm_storeu_ps(lanes + 4, hsimd_cos4(x, HMATH_PRECISION_LOW));
+        for (u32 j = 0; j < 4; ++j) {
+            track_error(&errors->sin_high, lanes[j] - sinf(values[i + j]));
+            track_error(&errors->cos_low, lanes[4 + j] - cosf(values[i + j]));
+        }
+        _mm_storeu_ps(lanes, hsimd_rsqrt4(_mm_andnot_ps(_mm_set1_ps(-0.0f), x)));
+        for (u32 j = 0; j < 4; ++j) {
+            track_error(&errors->rsqrt, (lanes[j] - results[4][i + j]) / results[4][i + j]);
+        }
+    }
+#endif
+    for (u32 i = 0; i < 8; ++i) {
+        f64 x = values[i];
+        track_error(&errors->sin_low, results[0][i] - sin(x));
+        track_error(&errors->sin_high, results[1][i] - sin(x));
+        track_error(&errors->cos_low, results[2][i] - cos(x));
+        track_error(&errors->cos_high, results[3][i] - cos(x));
+        f64 rsqrt = 1.0 / sqrt(fabs(x));
+        track_error(&errors->rsqrt, (results[4][i] - rsqrt) / rsqrt);
+    }
+}
+
+#if defined(HUSE_SIMD)
+HTARGET_AVX2 static void fast_math_measure_avx2(const f32* values, fast_math_errors* errors) {
+    f32 lanes[8];
+    __m256 x = _mm256_loadu_ps(values);
+    _mm256_storeu_ps(lanes, hsimd_sin8(x, HMATH_PRECISION_LOW));
+    for (u32 i = 0; i < 8; ++i) {
+        track_error(&errors->sin_low, lanes[i] - sin(values[i]));
+    }
+    _mm256_storeu_ps(lanes, hsimd_cos8(x, HMATH_PRECISION_HIGH));
+    for (u32 i = 0; i < 8; ++i) {
+        track_error(&errors->cos_high, lanes[i] - cos(values[i]));
+    }
+    _mm256_storeu_ps(lanes, hsimd_rsqrt8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)));
+    for (u32 i = 0; i < 8; ++i) {
+        f64 rsqrt = 1.0 / sqrt(fabs(values[i]));
+        track_error(&errors->rsqrt, (lanes[i] - rsqrt) / rsqrt);
+    }
+}
+#endif
+
+u8 affine_should_match_mat4() {
+    expect_should_be(48, sizeof(affine));
+    expect_should_be(32, sizeof(dual_quat));
+    mat4 identity = mat4_identity();
+    affine affine_identity_matrix = affine_from_mat4(identity);
+    affine expected_identity = affine_identity();
+    expect_to_be_true(affine_near(&expected_identity, &affine_identity_matrix, 0.0f));
+
+    u32 random = 13;
+    for (u32 i = 0; i < 1000; ++i) {
+        mat4 a = random_transform(&random);
+        mat4 b = random_transform(&random);
+        affine affine_a = affine_from_mat4(a);
+        affine affine_b = affine_from_mat4(b);
+        mat4 round_trip = affine_to_mat4(affine_a);
+        expect_to_be_true(mat4_near(&a, &round_trip, 0.0f));
+
+        affine expected = affine_from_mat4(mat4_mul(a, b));
+        affine product = affine_mul(affine_a, affine_b);
+        expect_to_be_true(affine_near(&expected, &product, MATH_TOLERANCE));
+        scalar_affine_mul(&affine_a, &affine_b, &product);
+        expect_to_be_true(affine_near(&expected, &product, MATH_TOLERANCE));
+
+        expected = affine_from_mat4(mat4_inverse(a));
+        affine inverse = affine_inverse(affine_a);
+        expect_to_be_true(affine_near(&expected, &inverse, MATH_TOLERANCE));
+        affine undone = affine_mul(affine_a, inverse);
+        expect_to_be_true(affine_near(&expected_identity, &undone, MATH_TOLERANCE));
+
+        vec3 point = vec3_create(random_unit(&random) * 5.0f, random_unit(&random) * 5.0f, random_unit(&random) * 5.0f);
+        expect_to_be_true(vec3_near(reference_transform_point(&a, point), affine_transform_point(affine_a, point), MATH_TOLERANCE));
+        vec3 origin = reference_transform_point(&a, vec3_zero());
+        vec3 direction = vec3_sub(reference_transform_point(&a, point), origin);
+        expect_to_be_true(vec3_near(direction, affine_transform_direction(affine_a, point), MATH_TOLERANCE));
+    }
+    return true;
+}
+
+u8 dual_quat_should_match_mat4() {
+    u32 random = 17;
+    dual_quat identity = dual_quat_identity();
+    for (u32 i = 0; i < 1000; ++i) {
+        quat rotation = quat_normalize(vec4_create(random_unit(&random), random_unit(&random), random_unit(&random), random_unit(&random) + 2.0f));
+        vec3 translation = vec3_create(random_unit(&random) * 10.0f, random_unit(&random) * 10.0f, random_unit(&random) * 10.0f);
+        dual_quat a = dual_quat_from_rotation_translation(rotation, translation);
+        dual_quat b = random_rigid_transform(&random);
+
+        mat4 matrix_a = mat4_mul(quat_to_mat4(rotation), mat4_translation(translation));
+        affine expected = affine_from_mat4(matrix_a);
+        affine converted = dual_quat_to_affine(a);
+        expect_to_be_true(affine_near(&expected, &converted, MATH_TOLERANCE));
+        expect_to_be_true(vec3_near(translation, dual_quat_get_translation(a), MATH_TOLERANCE));
+
+        vec3 point = vec3_create(random_unit(&random) * 5.0f, random_unit(&random) * 5.0f, random_unit(&random) * 5.0f);
+        expect_to_be_true(vec3_near(reference_transform_point(&matrix_a, point), dual_quat_transform_point(a, point), MATH_TOLERANCE * 10.0f));
+
+        // Composition follows mat4_mul, a is applied first.
+        expected = affine_mul(dual_quat_to_affine(a), dual_quat_to_affine(b));
+        converted = dual_quat_to_affine(dual_quat_mul(a, b));
+        expect_to_be_true(affine_near(&expected, &converted, MATH_TOLERANCE * 10.0f));
+
+        dual_quat undone = dual_quat_mul(a, dual_quat_inverse(a));
+        expect_to_be_true(vec4_near(identity.real, undone.real, MATH_TOLERANCE));
+        expect_to_be_true(vec4_near(identity.dual, undone.dual, MATH_TOLERANCE));
+
+        // Blending by weights, as skinning does, gives a rigid transform once normalized.
+        f32 weight = (random_unit(&random) + 1.0f) * 0.5f;
+        f32 weight_b = quat_dot(a.real, b.real) < 0.0f ? weight - 1.0f : 1.0f - weight;
+        vec4 weights_a = vec4_create(weight, weight, weight, weight);
+        vec4 weights_b = vec4_create(weight_b, weight_b, weight_b, weight_b);
+        dual_quat blend;
+        blend.real = vec4_add(vec4_mul(a.real, weights_a), vec4_mul(b.real, weights_b));
+        blend.dual = vec4_add(vec4_mul(a.dual, weights_a), vec4_mul(b.dual, weights_b));
+        dual_quat normalized = dual_quat_normalize(blend);
+        dual_quat scalar;
+        scalar_dual_quat_normalize(&blend, &scalar);
+        expect_to_be_true(vec4_near(scalar.real, normalized.real, MATH_TOLERANCE));
+        expect_to_be_true(vec4_near(scalar.dual, normalized.dual, MATH_TOLERANCE));
+        f32 length = quat_normal(normalized.real);
+        f32 along = quat_dot(normalized.real, normalized.dual);
+        expect_to_be_true(habs(length - 1.0f) < MATH_TOLERANCE);
+        expect_to_be_true(habs(along) < MATH_TOLERANCE);
+        vec3 origin = dual_quat_transform_point(normalized, vec3_zero());
+        f32 distance = vec3_length(vec3_sub(dual_quat_transform_point(normalized, point), origin));
+        expect_to_be_true(habs(distance - vec3_length(point)) < MATH_TOLERANCE * 10.0f);
+    }
+    return true;
+}
+
+// Builds world transforms down a hierarchy where every node's parent comes before it, as mat4, affine and dual_quat.
+u8 transform_hierarchy_benchmark() {
+    mat4* local_matrices = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    mat4* world_matrices = Hallocate(sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    affine* local_affines = Hallocate(sizeof(affine) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    affine* world_affines = Hallocate(sizeof(affine) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    dual_quat* local_dual_quats = Hallocate(sizeof(dual_quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    dual_quat* world_dual_quats = Hallocate(sizeof(dual_quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    u32* parents = Hallocate(sizeof(u32) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    u32 random = 5;
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        local_dual_quats[i] = random_rigid_transform(&random);
+        local_affines[i] = dual_quat_to_affine(local_dual_quats[i]);
+        local_matrices[i] = affine_to_mat4(local_affines[i]);
+        parents[i] = i ? next_random(&random) % i : 0;
+    }
+    world_matrices[0] = local_matrices[0];
+    world_affines[0] = local_affines[0];
+    world_dual_quats[0] = local_dual_quats[0];
+    hclock clock;
+
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 1; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            world_matrices[i] = mat4_mul(local_matrices[i], world_matrices[parents[i]]);
+        }
+    }
+    updateClock(&clock);
+    f64 mat4_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 1; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            world_affines[i] = affine_mul(local_affines[i], world_affines[parents[i]]);
+        }
+    }
+    updateClock(&clock);
+    f64 affine_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 round = 0; round < BENCHMARK_ROUNDS; ++round) {
+        for (u32 i = 1; i < BENCHMARK_MATRIX_COUNT; ++i) {
+            world_dual_quats[i] = dual_quat_mul(local_dual_quats[i], world_dual_quats[parents[i]]);
+        }
+    }
+    updateClock(&clock);
+
+    for (u32 i = 0; i < BENCHMARK_MATRIX_COUNT; ++i) {
+        affine expected = affine_from_mat4(world_matrices[i]);
+        expect_to_be_true(affine_near(&expected, &world_affines[i], MATH_TOLERANCE * 100.0f));
+        affine converted = dual_quat_to_affine(dual_quat_normalize(world_dual_quats[i]));
+        expect_to_be_true(affine_near(&expected, &converted, MATH_TOLERANCE * 100.0f));
+    }
+    HINFO("%u hierarchy nodes: mat4_mul %.2f ms, affine_mul %.2f ms (%.1fx), dual_quat_mul %.2f ms (%.1fx).",
+          BENCHMARK_MATRIX_COUNT * BENCHMARK_ROUNDS, mat4_time * 1000.0, affine_time * 1000.0, mat4_time / affine_time,
+          clock.elapsed * 1000.0, mat4_time / clock.elapsed);
+
+    Hfree(local_matrices, sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(world_matrices, sizeof(mat4) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(local_affines, sizeof(affine) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(world_affines, sizeof(affine) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(local_dual_quats, sizeof(dual_quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(world_dual_quats, sizeof(dual_quat) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(parents, sizeof(u32) * BENCHMARK_MATRIX_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 fast_math_should_stay_within_error() {
+    fast_math_errors errors = {0};
+    f32 values[8];
+    // Dense over a few turns, where most angles are, then sparse up to the documented range.
+    const f32 ranges[2] = {4.0f * H_PI, 2000.0f};
+    for (u32 r = 0; r < 2; ++r) {
+        for (u32 i = 0; i < 100000; i += 8) {
+            for (u32 j = 0; j < 8; ++j) {
+                values[j] = ranges[r] * ((f32)(i + j) / 50000.0f - 1.0f);
+            }
+            // No 0 for rsqrt.
+            values[0] = values[0] ? values[0] : 1.0f;
+            fast_math_measure(values, &errors);
+#if defined(HUSE_SIMD)
+            if (cpu_get_features() & CPU_FEATURE_AVX2) {
+                fast_math_measure_avx2(values, &errors);
+            }
+#endif
+        }
+    }
+    HINFO("Fast math max error: sin %.2e / %.2e, cos %.2e / %.2e (low / high), rsqrt %.2e relative.",
+          errors.sin_low, errors.sin_high, errors.cos_low, errors.cos_high, errors.rsqrt);
+    expect_to_be_true(errors.sin_low < 1e-4);
+    expect_to_be_true(errors.cos_low < 1e-4);
+    expect_to_be_true(errors.sin_high < 1e-6);
+    expect_to_be_true(errors.cos_high < 1e-6);
+    expect_to_be_true(errors.rsqrt < 1e-6);
+
+    // Exact points callers tend to rely on.
+    expect_float_to_be(0.0f, hsin_fast(0.0f, HMATH_PRECISION_HIGH));
+    expect_float_to_be(1.0f, hcos_fast(0.0f, HMATH_PRECISION_HIGH));
+    expect_float_to_be(0.5f, hrsqrt(4.0f));
+    expect_float_to_be(3.0f, hsqrt_inline(9.0f));
+    return true;
+}
+
+#if defined(HUSE_SIMD)
+HTARGET_AVX2 static void sin8_loop(const f32* values, f32* results, hmathPrecision precision) {
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; i += 8) {
+        _mm256_storeu_ps(results + i, hsimd_sin8(_mm256_loadu_ps(values + i), precision));
+    }
+}
+
+HTARGET_AVX2 static void rsqrt8_loop(const f32* values, f32* results) {
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; i += 8) {
+        _mm256_storeu_ps(results + i, hsimd_rsqrt8(_mm256_loadu_ps(values + i)));
+    }
+}
+#endif
+
+// Times one loop over the benchmark values and logs it against the libm one.
+#define BENCHMARK_FAST_MATH(name, loop)                                                     \
+    {                                                                                       \
+        startClock(&clock);                                                                 \
+        loop;                                                                               \
+        updateClock(&clock);                                                                \
+        HINFO("  %-22s %6.2f ms (%.1fx)", name, clock.elapsed * 1000.0, libm_time / clock.elapsed); \
+    }
+
+u8 fast_math_benchmark_vs_libm() {
+    f32* values = Hallocate(sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    f32* results = Hallocate(sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    u32 random = 3;
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        // Angles within a few turns, as they come out of rotations.
+        values[i] = random_unit(&random) * 10.0f;
+    }
+    hclock clock;
+
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        results[i] = sinf(values[i]);
+    }
+    updateClock(&clock);
+    f64 libm_time = clock.elapsed;
+    HINFO("%u sines: sinf %.2f ms", BENCHMARK_VALUE_COUNT, libm_time * 1000.0);
+    BENCHMARK_FAST_MATH("hsin_fast low", for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) results[i] = hsin_fast(values[i], HMATH_PRECISION_LOW));
+    BENCHMARK_FAST_MATH("hsin_fast high", for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) results[i] = hsin_fast(values[i], HMATH_PRECISION_HIGH));
+#if defined(HUSE_SIMD)
+    BENCHMARK_FAST_MATH("hsimd_sin4 high", for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; i += 4) _mm_storeu_ps(results + i, hsimd_sin4(_mm_loadu_ps(values + i), HMATH_PRECISION_HIGH)));
+    if (cpu_get_features() & CPU_FEATURE_AVX2) {
+        BENCHMARK_FAST_MATH("hsimd_sin8 low", sin8_loop(values, results, HMATH_PRECISION_LOW));
+        BENCHMARK_FAST_MATH("hsimd_sin8 high", sin8_loop(values, results, HMATH_PRECISION_HIGH));
+    }
+#endif
+
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        values[i] = habs(values[i]) + 0.001f;
+    }
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        results[i] = 1.0f / sqrtf(values[i]);
+    }
+    updateClock(&clock);
+    libm_time = clock.elapsed;
+    HINFO("%u reciprocal square roots: 1 / sqrtf %.2f ms", BENCHMARK_VALUE_COUNT, libm_time * 1000.0);
+    BENCHMARK_FAST_MATH("hrsqrt", for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) results[i] = hrsqrt(values[i]));
+#if defined(HUSE_SIMD)
+    BENCHMARK_FAST_MATH("hsimd_rsqrt4", for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; i += 4) _mm_storeu_ps(results + i, hsimd_rsqrt4(_mm_loadu_ps(values + i))));
+    if (cpu_get_features() & CPU_FEATURE_AVX2) {
+        BENCHMARK_FAST_MATH("hsimd_rsqrt8", rsqrt8_loop(values, results));
+    }
+#endif
+
+    Hfree(values, sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(results, sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void hmath_register_tests() {
+    test_manager_register_test(vec4_should_keep_components_apart, "vec4 should keep components apart");
+    test_manager_register_test(mat4_should_match_reference, "mat4 should match reference");
+    test_manager_register_test(quat_should_match_reference, "quat should match reference");
+    test_manager_register_test(math_constants_should_group, "math constants should group");
+    test_manager_register_test(vec2_should_match_reference, "vec2 should match reference");
+    test_manager_register_test(vec3_should_match_reference, "vec3 should match reference");
+    test_manager_register_test(mat4_builders_should_transform_points, "mat4 builders should transform points");
+    test_manager_register_test(quat_rotations_should_match_matrices, "quat rotations should match matrices");
+    test_manager_register_test(quat_slerp_should_follow_the_shortest_arc, "quat slerp should follow the shortest arc");
+    test_manager_register_benchmark(mat4_benchmark_vs_scalar, "mat4 benchmark vs scalar");
+    test_manager_register_test(affine_should_match_mat4, "affine should match mat4");
+    test_manager_register_test(dual_quat_should_match_mat4, "dual quat should match mat4");
+    test_manager_register_benchmark(transform_hierarchy_benchmark, "transform hierarchy benchmark");
+    test_manager_register_test(fast_math_should_stay_within_error, "fast math should stay within error");
+    test_manager_register_benchmark(fast_math_benchmark_vs_libm, "fast math benchmark vs libm");
+}
@@ -0,0 +1,191 @@
+#include "hpack_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/hmath.h>
+#include <math/hpack.h>
+#include <math/hrandom.h>
+#include <memory/hmemory.h>
+
+#include <math.h>
+
+#define HALF_COUNT 65536
+#define RANDOM_FLOAT_COUNT (1024 * 1024)
+#define NORMAL_COUNT 100000
+
+// Software and F16C conversions.
+static const u32 feature_masks[2] = {~(u32)CPU_FEATURE_F16C, 0xFFFFFFFF};
+
+static b8 f16_is_nan(f16 value) {
+    return (value & 0x7C00) == 0x7C00 && (value & 0x03FF) != 0;
+}
+
+static b8 f32_is_nan(f32 value) {
+    return value != value;
+}
+
+u8 f16_should_convert_exactly() {
+    expect_should_be(0x3C00, f32_to_f16(1.0f));
+    expect_should_be(0xC000, f32_to_f16(-2.0f));
+    expect_should_be(0x3555, f32_to_f16(1.0f / 3.0f));
+    expect_should_be(0x7BFF, f32_to_f16(65504.0f));
+    // Past the halfway point to the next exponent, so it rounds to infinity.
+    expect_should_be(0x7C00, f32_to_f16(65520.0f));
+    // Smallest denormal, and half of it rounding to even (0).
+    expect_should_be(0x0001, f32_to_f16(5.9604645e-8f));
+    expect_should_be(0x0000, f32_to_f16(2.9802322e-8f));
+    expect_to_be_true(f16_is_nan(f32_to_f16(NAN)));
+    expect_float_to_be(0.5f, f16_to_f32(0x3800));
+
+    f16* halves = Hallocate(sizeof(f16) * HALF_COUNT * 2, MEMORY_TAG_ARRAY);
+    f32* floats = Hallocate(sizeof(f32) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < HALF_COUNT; ++i) {
+        halves[i] = (f16)i;
+    }
+
+    for (u32 m = 0; m < 2; ++m) {
+        cpu_set_feature_mask(feature_masks[m]);
+
+        // Every half survives the trip through f32 and back.
+        f16_to_f32_array(halves, floats, HALF_COUNT);
+        f32_to_f16_array(floats, halves + HALF_COUNT, HALF_COUNT);
+        for (u32 i = 0; i < HALF_COUNT; ++i) {
+            f16 half = (f16)i;
+            expect_to_be_true(f32_is_nan(floats[i]) == f16_is_nan(half));
+            if (!f16_is_nan(half)) {
+                expect_should_be(half, halves[HALF_COUNT + i]);
+                expect_to_be_true(floats[i] == f16_to_f32(half));
+            }
+        }
+    }
+
+    // Random bit patterns, so rounding, overflow and denormals get covered.
+    random_state state;
+    random_seed(&state, 46);
+    for (u32 i = 0; i < RANDOM_FLOAT_COUNT; ++i) {
+        u32 bits = random_u32(&state);
+        HcopyMemory(&floats[i], &bits, sizeof(f32));
+    }
+    f16* hardware = Hallocate(sizeof(f16) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    f32_to_f16_array(floats, hardware, RANDOM_FLOAT_COUNT);
+    for (u32 i = 0; i < RANDOM_FLOAT_COUNT; ++i) {
+        f16 software = f32_to_f16(floats[i]);
+        if (f32_is_nan(floats[i])) {
+            expect_to_be_true(f16_is_nan(software) && f16_is_nan(hardware[i]));
+        } else {
+            expect_should_be(hardware[i], software);
+        }
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+
+    Hfree(hardware, sizeof(f16) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(halves, sizeof(f16) * HALF_COUNT * 2, MEMORY_TAG_ARRAY);
+    Hfree(floats, sizeof(f32) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 norm_packing_should_match_vulkan_formats() {
+    expect_should_be(0, pack_unorm16(0.0f));
+    expect_should_be(65535, pack_unorm16(1.0f));
+    expect_should_be(65535, pack_unorm16(3.0f));
+    expect_should_be(0, pack_unorm16(-1.0f));
+    expect_should_be(128, pack_unorm8(0.5f));
+    expect_should_be(-32767, pack_snorm16(-1.0f));
+    expect_should_be(32767, pack_snorm16(2.0f));
+    expect_should_be(-127, pack_snorm8(-1.0f));
+    expect_should_be(0, pack_snorm8(0.0f));
+    expect_float_to_be(-1.0f, unpack_snorm16(-32768));
+    expect_float_to_be(-1.0f, unpack_snorm8(-128));
+
+    // Round trips are off by half a step at most.
+    for (u32 i = 0; i <= 1000; ++i) {
+        f32 value = (f32)i / 1000.0f;
+        expect_to_be_true(habs(unpack_unorm16(pack_unorm16(value)) - value) <= 0.5f / 65535.0f + 1e-7f);
+        expect_to_be_true(habs(unpack_unorm8(pack_unorm8(value)) - value) <= 0.5f / 255.0f + 1e-7f);
+        f32 signed_value = value * 2.0f - 1.0f;
+        expect_to_be_true(habs(unpack_snorm16(pack_snorm16(signed_value)) - signed_value) <= 0.5f / 32767.0f + 1e-7f);
+        expect_to_be_true(habs(unpack_snorm8(pack_snorm8(signed_value)) - signed_value) <= 0.5f / 127.0f + 1e-7f);
+    }
+
+    vec2 uv = unpack_unorm16x2(pack_unorm16x2(vec2_create(0.25f, 1.0f)));
+    expect_float_to_be(0.25f, uv.x);
+    expect_float_to_be(1.0f, uv.y);
+    vec4 tangent = unpack_snorm8x4(pack_snorm8x4(vec4_create(1.0f, -0.5f, 0.0f, -1.0f)));
+    expect_float_to_be(1.0f, tangent.x);
+    expect_to_be_true(habs(tangent.y + 0.5f) < 0.5f / 127.0f);
+    expect_float_to_be(0.0f, tangent.z);
+    expect_float_to_be(-1.0f, tangent.w);
+    return true;
+}
+
+u8 octahedral_normals_should_keep_direction() {
+    // The axes come back exactly.
+    const vec3 axes[6] = {{{1, 0, 0}}, {{-1, 0, 0}}, {{0, 1, 0}}, {{0, -1, 0}}, {{0, 0, 1}}, {{0, 0, -1}}};
+    for (u32 i = 0; i < 6; ++i) {
+        vec3 decoded = unpack_normal(pack_normal(axes[i]));
+        expect_to_be_true(vec3_compare(axes[i], decoded, 1e-6f));
+    }
+
+    random_state state;
+    random_seed(&state, 47);
+    f64 worst_angle = 0.0;
+    for (u32 i = 0; i < NORMAL_COUNT; ++i) {
+        vec3 normal = vec3_normalized(vec3_create(random_f32_range(&state, -1.0f, 1.0f), random_f32_range(&state, -1.0f, 1.0f), random_f32_range(&state, -1.0f, 1.0f)));
+        vec3 decoded = unpack_normal(pack_normal(normal));
+        // atan2 of the cross and dot products, acos loses too much close to 1.
+        f64 cross_x = (f64)normal.y * decoded.z - (f64)normal.z * decoded.y;
+        f64 cross_y = (f64)normal.z * decoded.x - (f64)normal.x * decoded.z;
+        f64 cross_z = (f64)normal.x * decoded.y - (f64)normal.y * decoded.x;
+        f64 dot = (f64)normal.x * decoded.x + (f64)normal.y * decoded.y + (f64)normal.z * decoded.z;
+        f64 angle = atan2(sqrt(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z), dot);
+        worst_angle = angle > worst_angle ? angle : worst_angle;
+        expect_float_to_be(1.0f, vec3_length(decoded));
+    }
+    f64 worst_degrees = worst_angle * 180.0 / 3.14159265358979;
+    HINFO("Octahedral normals in 32 bits: worst direction error %.4f degrees.", worst_degrees);
+    expect_to_be_true(worst_degrees < 0.01);
+    return true;
+}
+
+u8 f16_conversion_benchmark() {
+    f32* floats = Hallocate(sizeof(f32) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    f16* halves = Hallocate(sizeof(f16) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    random_state state;
+    random_seed(&state, 48);
+    random_fill_f32(&state, floats, RANDOM_FLOAT_COUNT);
+    hclock clock;
+
+    f64 to_half[2];
+    f64 from_half[2];
+    for (u32 m = 0; m < 2; ++m) {
+        cpu_set_feature_mask(feature_masks[m]);
+        startClock(&clock);
+        f32_to_f16_array(floats, halves, RANDOM_FLOAT_COUNT);
+        updateClock(&clock);
+        to_half[m] = clock.elapsed;
+        startClock(&clock);
+        f16_to_f32_array(halves, floats, RANDOM_FLOAT_COUNT);
+        updateClock(&clock);
+        from_half[m] = clock.elapsed;
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+    HINFO("%u values to f16: software %.2f ms, F16C %.2f ms (%.1fx). Back to f32: software %.2f ms, F16C %.2f ms (%.1fx).",
+          RANDOM_FLOAT_COUNT, to_half[0] * 1000.0, to_half[1] * 1000.0, to_half[0] / to_half[1],
+          from_half[0] * 1000.0, from_half[1] * 1000.0, from_half[0] / from_half[1]);
+
+    Hfree(floats, sizeof(f32) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(halves, sizeof(f16) * RANDOM_FLOAT_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void hpack_register_tests() {
+    test_manager_register_test(f16_should_convert_exactly, "f16 should convert exactly");
+    test_manager_register_test(norm_packing_should_match_vulkan_formats, "norm packing should match vulkan formats");
+    test_manager_register_test(octahedral_normals_should_keep_direction, "octahedral normals should keep direction");
+    test_manager_register_benchmark(f16_conversion_benchmark, "f16 conversion benchmark");
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#ifdef __cplusplus 
+extern "C" { 
+#endif
+
+void hpack_register_tests();
+
+#ifdef __cplusplus
+} 
+#endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "hrandom_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/hmath.h>
+#include <math/hrandom.h>
+#include <memory/hmemory.h>
+
+#include <stdlib.h>
+
+// Not a multiple of 8, so the tail of random_fill_f32 is covered too.
+#define FILL_COUNT 1003
+#define BENCHMARK_VALUE_COUNT (4 * 1024 * 1024)
+
+u8 random_should_match_reference_sequence() {
+    // Published xoshiro256** and splitmix64 outputs.
+    random_state state = {{1, 2, 3, 4}};
+    expect_should_be(11520, random_u64(&state));
+    expect_should_be(0, random_u64(&state));
+    expect_should_be(1509978240, random_u64(&state));
+    expect_should_be(1215971899390074240ull, random_u64(&state));
+
+    random_seed(&state, 0);
+    expect_should_be(0xE220A8397B1DCDAFull, state.s[0]);
+
+    // Same seed, same sequence. The basis for replays.
+    random_state a, b;
+    random_seed(&a, 1234);
+    random_seed(&b, 1234);
+    for (u32 i = 0; i < 100; ++i) {
+        expect_should_be(random_u64(&a), random_u64(&b));
+    }
+
+    // Jumped copies start somewhere else.
+    random_seed(&b, 1234);
+    random_jump(&b);
+    expect_should_not_be(random_u64(&a), random_u64(&b));
+
+    // The thread's generator repeats after seeding it.
+    hrandom_seed(99);
+    i32 first = hrandom();
+    f32 second = fhrandom();
+    hrandom_seed(99);
+    expect_should_be(first, hrandom());
+    expect_to_be_true(second == fhrandom());
+    return true;
+}
+
+u8 random_ranges_should_be_bounded_and_even() {
+    random_state state;
+    random_seed(&state, 7);
+
+    // A bound just over a third of 2^32, where a modulo would make the low third twice as likely.
+    const u32 bound = 0x55555556;
+    u32 low_third = 0;
+    const u32 draws = 300000;
+    for (u32 i = 0; i < draws; ++i) {
+        u32 value = random_range(&state, bound);
+        expect_to_be_true(value < bound);
+        low_third += value < bound / 3;
+    }
+    // A third give or take a few standard deviations, the biased version lands near half.
+    expect_to_be_true(low_third > draws / 3 - 1500 && low_third < draws / 3 + 1500);
+
+    // Every value of a small range shows up about as often.
+    u32 counts[7] = {0};
+    for (u32 i = 0; i < 70000; ++i) {
+        i32 value = random_range_i32(&state, -3, 3);
+        expect_to_be_true(value >= -3 && value <= 3);
+        counts[value + 3]++;
+    }
+    for (u32 i = 0; i < 7; ++i) {
+        expect_to_be_true(counts[i] > 9500 && counts[i] < 10500);
+    }
+
+    expect_should_be(5, random_range_i32(&state, 5, 5));
+    expect_should_be(0, random_range(&state, 0));
+    // The full range doesn't overflow.
+    random_range_i32(&state, -2147483647 - 1, 2147483647);
+
+    for (u32 i = 0; i < 10000; ++i) {
+        f32 value = random_f32(&state);
+        expect_to_be_true(value >= 0.0f && value < 1.0f);
+        value = fhrandomInRange(-2.0f, 2.0f);
+        expect_to_be_true(value >= -2.0f && value < 2.0f);
+        i32 integer = hrandomInRange(10, 20);
+        expect_to_be_true(integer >= 10 && integer <= 20);
+    }
+    return true;
+}
+
+u8 random_fill_should_match_on_every_path() {
+    f32* values = Hallocate(sizeof(f32) * FILL_COUNT * 3, MEMORY_TAG_ARRAY);
+    // AVX2, SSE2 and plain C.
+    const u32 masks[3] = {0xFFFFFFFF, ~(u32)CPU_FEATURE_AVX2, 0};
+    for (u32 m = 0; m < 3; ++m) {
+        cpu_set_feature_mask(masks[m]);
+        random_state state;
+        random_seed(&state, 2024);
+        random_fill_f32(&state, values + FILL_COUNT * m, FILL_COUNT);
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+    // HNO_SIMD builds only have the plain C path, so the other two are compared to it.
+
+    f64 sum = 0.0;
+    for (u32 i = 0; i < FILL_COUNT; ++i) {
+        // Exactly the same, not just close.
+        expect_to_be_true(values[FILL_COUNT * 2 + i] == values[i]);
+        expect_to_be_true(values[FILL_COUNT * 2 + i] == values[FILL_COUNT + i]);
+        expect_to_be_true(values[i] >= 0.0f && values[i] < 1.0f);
+        sum += values[i];
+    }
+    f64 mean = sum / FILL_COUNT;
+    expect_to_be_true(mean > 0.45 && mean < 0.55);
+
+    Hfree(values, sizeof(f32) * FILL_COUNT * 3, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+u8 random_benchmark_vs_rand() {
+    f32* values = Hallocate(sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    random_state state;
+    random_seed(&state, 1);
+    hclock clock;
+
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        values[i] = (f32)rand() / (f32)RAND_MAX;
+    }
+    updateClock(&clock);
+    f64 rand_time = clock.elapsed;
+
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_VALUE_COUNT; ++i) {
+        values[i] = random_f32(&state);
+    }
+    updateClock(&clock);
+    f64 single_time = clock.elapsed;
+
+    startClock(&clock);
+    random_fill_f32(&state, values, BENCHMARK_VALUE_COUNT);
+    updateClock(&clock);
+    HINFO("%u floats: rand %.2f ms, random_f32 %.2f ms (%.1fx), random_fill_f32 %.2f ms (%.1fx).",
+          BENCHMARK_VALUE_COUNT, rand_time * 1000.0, single_time * 1000.0, rand_time / single_time,
+          clock.elapsed * 1000.0, rand_time / clock.elapsed);
+
+    Hfree(values, sizeof(f32) * BENCHMARK_VALUE_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void hrandom_register_tests() {
+    test_manager_register_test(random_should_match_reference_sequence, "random should match reference sequence");
+    test_manager_register_test(random_ranges_should_be_bounded_and_even, "random ranges should be bounded and even");
+    test_manager_register_test(random_fill_should_match_on_every_path, "random fill should match on every path");
+    test_manager_register_benchmark(random_benchmark_vs_rand, "random benchmark vs rand");
+}
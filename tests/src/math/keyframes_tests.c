@@ -0,0 +1,296 @@
+#include "keyframes_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <math/hmath.h>
+#include <math/hrandom.h>
+#include <math/keyframes.h>
+#include <memory/hmemory.h>
+
+#define MATH_TOLERANCE 0.0005f
+#define SEARCH_KEY_COUNT 100
+#define BENCHMARK_TRACK_COUNT 10000
+#define BENCHMARK_KEY_COUNT 32
+#define BENCHMARK_FRAME_COUNT 240
+#define BENCHMARK_FRAME_TIME (1.0f / 60.0f)
+
+// Times with random gaps, the way a clip keeps only the keys it needs.
+static void random_times(random_state* state, f32* times, u32 count, f32 duration) {
+    f32 time = 0.0f;
+    for (u32 i = 0; i < count; ++i) {
+        times[i] = time;
+        time += random_f32_range(state, 0.2f, 1.8f) * duration / (count - 1);
+    }
+}
+
+static quat random_rotation(random_state* state) {
+    vec3 axis = vec3_normalized(vec3_create(random_f32_range(state, -1.0f, 1.0f), random_f32_range(state, -1.0f, 1.0f), random_f32_range(state, -1.0f, 1.0f)));
+    return quat_from_axis_angle(axis, random_f32_range(state, -H_PI, H_PI), true);
+}
+
+static b8 vec3_near(vec3 a, vec3 b, f32 tolerance) {
+    return habs(a.x - b.x) <= tolerance && habs(a.y - b.y) <= tolerance && habs(a.z - b.z) <= tolerance;
+}
+
+// q and -q are the same rotation.
+static b8 quat_near(quat a, quat b) {
+    f32 dot = quat_dot(a, b);
+    return dot > 0.99999f || dot < -0.99999f;
+}
+
+u8 keyframe_find_should_match_linear_search() {
+    random_state random;
+    random_seed(&random, 50);
+    f32 times[SEARCH_KEY_COUNT];
+    random_times(&random, times, SEARCH_KEY_COUNT, 10.0f);
+    f32 end = times[SEARCH_KEY_COUNT - 1];
+
+    for (u32 i = 0; i < 2000; ++i) {
+        f32 time = random_f32_range(&random, -1.0f, end + 1.0f);
+        // Exactly on a key now and then.
+        if (i % 10 == 0) {
+            time = times[i % SEARCH_KEY_COUNT];
+        }
+        u32 expected = 0;
+        while (expected + 1 < SEARCH_KEY_COUNT && times[expected + 1] <= time) {
+            expected++;
+        }
+        // Any cursor gives the same key, even out of range ones.
+        u32 cursor = i % 7 == 0 ? SEARCH_KEY_COUNT + 5 : (u32)random_f32_range(&random, 0.0f, SEARCH_KEY_COUNT - 0.01f);
+        expect_should_be(expected, keyframe_find(times, SEARCH_KEY_COUNT, time, cursor));
+    }
+
+    // Playing forwards, then jumping back to the start.
+    u32 cursor = 0;
+    for (f32 time = 0.0f; time < end + 0.5f; time += BENCHMARK_FRAME_TIME) {
+        cursor = keyframe_find(times, SEARCH_KEY_COUNT, time, cursor);
+        expect_to_be_true(times[cursor] <= time);
+        expect_to_be_true(cursor + 1 == SEARCH_KEY_COUNT || time < times[cursor + 1]);
+    }
+    expect_should_be(SEARCH_KEY_COUNT - 1, cursor);
+    expect_should_be(0, keyframe_find(times, SEARCH_KEY_COUNT, 0.0f, cursor));
+
+    // A single key.
+    expect_should_be(0, keyframe_find(times, 1, 5.0f, 0));
+    return true;
+}
+
+u8 vec3_track_should_interpolate() {
+    const f32 times[3] = {0.0f, 1.0f, 3.0f};
+    const vec3 values[3] = {{{0.0f, 0.0f, 0.0f}}, {{2.0f, 4.0f, 6.0f}}, {{2.0f, 0.0f, -2.0f}}};
+    vec3_track track = {times, values, 3, KEYFRAME_INTERPOLATION_STEP};
+    u32 cursor = 0;
+
+    vec3 value = vec3_track_sample(&track, 0.5f, &cursor);
+    expect_to_be_true(vec3_near(values[0], value, MATH_TOLERANCE));
+    value = vec3_track_sample(&track, 2.9f, &cursor);
+    expect_to_be_true(vec3_near(values[1], value, MATH_TOLERANCE));
+    expect_should_be(1, cursor);
+
+    track.interpolation = KEYFRAME_INTERPOLATION_LINEAR;
+    value = vec3_track_sample(&track, 0.5f, &cursor);
+    expect_to_be_true(vec3_near(vec3_create(1.0f, 2.0f, 3.0f), value, MATH_TOLERANCE));
+    value = vec3_track_sample(&track, 2.0f, &cursor);
+    expect_to_be_true(vec3_near(vec3_create(2.0f, 2.0f, 2.0f), value, MATH_TOLERANCE));
+    // Before the first and after the last key.
+    value = vec3_track_sample(&track, -1.0f, &cursor);
+    expect_to_be_true(vec3_near(values[0], value, MATH_TOLERANCE));
+    value = vec3_track_sample(&track, 5.0f, &cursor);
+    expect_to_be_true(vec3_near(values[2], value, MATH_TOLERANCE));
+
+    // Tangents along a line give back the line, however far apart the keys are.
+    const vec3 slope = {{1.0f, 2.0f, 3.0f}};
+    const vec3 line[9] = {
+        slope, {{0.0f, 0.0f, 0.0f}}, slope,
+        slope, {{1.0f, 2.0f, 3.0f}}, slope,
+        slope, {{3.0f, 6.0f, 9.0f}}, slope};
+    vec3_track cubic = {times, line, 3, KEYFRAME_INTERPOLATION_CUBIC};
+    for (f32 time = 0.0f; time <= 3.0f; time += 0.125f) {
+        value = vec3_track_sample(&cubic, time, &cursor);
+        expect_to_be_true(vec3_near(vec3_mul_scalar(slope, time), value, MATH_TOLERANCE));
+    }
+
+    // Flat tangents ease in and out, a quarter of the way is 3t^2 - 2t^3 = 0.15625 of the change.
+    const vec3 eased[9] = {
+        {{0.0f, 0.0f, 0.0f}}, {{0.0f, 0.0f, 0.0f}}, {{0.0f, 0.0f, 0.0f}},
+        {{0.0f, 0.0f, 0.0f}}, {{4.0f, 8.0f, -4.0f}}, {{0.0f, 0.0f, 0.0f}},
+        {{0.0f, 0.0f, 0.0f}}, {{0.0f, 0.0f, 0.0f}}, {{0.0f, 0.0f, 0.0f}}};
+    cubic.values = eased;
+    value = vec3_track_sample(&cubic, 0.25f, &cursor);
+    expect_to_be_true(vec3_near(vec3_create(0.625f, 1.25f, -0.625f), value, MATH_TOLERANCE));
+    value = vec3_track_sample(&cubic, 1.0f, &cursor);
+    expect_to_be_true(vec3_near(eased[4], value, MATH_TOLERANCE));
+    value = vec3_track_sample(&cubic, 2.0f, &cursor);
+    expect_to_be_true(vec3_near(vec3_create(2.0f, 4.0f, -2.0f), value, MATH_TOLERANCE));
+    return true;
+}
+
+u8 quat_track_should_interpolate() {
+    const f32 times[2] = {0.0f, 2.0f};
+    quat values[2] = {quat_identify(), quat_from_axis_angle(vec3_up(), H_HALF_PI, true)};
+    quat_track track = {times, values, 2, KEYFRAME_INTERPOLATION_SLERP};
+    u32 cursor = 0;
+
+    // Halfway is the same for both.
+    quat halfway = quat_from_axis_angle(vec3_up(), H_QUARTER_PI, true);
+    expect_to_be_true(quat_near(halfway, quat_track_sample(&track, 1.0f, &cursor)));
+    track.interpolation = KEYFRAME_INTERPOLATION_LINEAR;
+    expect_to_be_true(quat_near(halfway, quat_track_sample(&track, 1.0f, &cursor)));
+    track.interpolation = KEYFRAME_INTERPOLATION_STEP;
+    expect_to_be_true(quat_near(values[0], quat_track_sample(&track, 1.9f, &cursor)));
+    expect_to_be_true(quat_near(values[1], quat_track_sample(&track, 2.0f, &cursor)));
+
+    // Slerp turns at a constant speed, nlerp stays close to it between keys this close.
+    track.interpolation = KEYFRAME_INTERPOLATION_SLERP;
+    quat quarter = quat_from_axis_angle(vec3_up(), H_HALF_PI * 0.25f, true);
+    expect_to_be_true(quat_near(quarter, quat_track_sample(&track, 0.5f, &cursor)));
+    track.interpolation = KEYFRAME_INTERPOLATION_LINEAR;
+    quat nlerped = quat_track_sample(&track, 0.5f, &cursor);
+    expect_float_to_be(1.0f, quat_dot(nlerped, nlerped));
+    expect_to_be_true(quat_dot(quarter, nlerped) > 0.9995f);
+
+    // A key stored with the opposite sign still takes the short way.
+    values[1] = (quat){-values[1].x, -values[1].y, -values[1].z, -values[1].w};
+    expect_to_be_true(quat_near(halfway, quat_track_sample(&track, 1.0f, &cursor)));
+    track.interpolation = KEYFRAME_INTERPOLATION_SLERP;
+    expect_to_be_true(quat_near(halfway, quat_track_sample(&track, 1.0f, &cursor)));
+
+    // nlerp against slerp over random pairs, at the angles neighbouring keys have.
+    random_state random;
+    random_seed(&random, 51);
+    for (u32 i = 0; i < 1000; ++i) {
+        quat a = random_rotation(&random);
+        quat step = quat_from_axis_angle(vec3_normalized(vec3_create(1.0f, 2.0f, 3.0f)), random_f32_range(&random, -0.3f, 0.3f), true);
+        quat b = quat_mul(a, step);
+        f32 t = random_f32_range(&random, 0.0f, 1.0f);
+        expect_to_be_true(quat_dot(quat_slerp(a, b, t), quat_nlerp(a, b, t)) > 0.99999f);
+    }
+    return true;
+}
+
+typedef struct benchmark_clip {
+    f32* times;
+    vec3* positions;
+    vec3* curves;
+    quat* rotations;
+    vec3_track* linear_tracks;
+    vec3_track* cubic_tracks;
+    quat_track* nlerp_tracks;
+    quat_track* slerp_tracks;
+} benchmark_clip;
+
+// Plays one kind of track through the whole clip, returning the time per frame.
+static f64 play_tracks(const benchmark_clip* clip, u32 kind, b8 keep_cursors, u32* cursors, vec3* positions, quat* rotations) {
+    hclock clock;
+    HzeroMemory(cursors, sizeof(u32) * BENCHMARK_TRACK_COUNT);
+    startClock(&clock);
+    for (u32 frame = 0; frame < BENCHMARK_FRAME_COUNT; ++frame) {
+        f32 time = frame * BENCHMARK_FRAME_TIME;
+        if (!keep_cursors) {
+            HzeroMemory(cursors, sizeof(u32) * BENCHMARK_TRACK_COUNT);
+        }
+        switch (kind) {
+            case 0:
+                vec3_tracks_sample(clip->linear_tracks, BENCHMARK_TRACK_COUNT, time, cursors, positions);
+                break;
+            case 1:
+                vec3_tracks_sample(clip->cubic_tracks, BENCHMARK_TRACK_COUNT, time, cursors, positions);
+                break;
+            case 2:
+                quat_tracks_sample(clip->nlerp_tracks, BENCHMARK_TRACK_COUNT, time, cursors, rotations);
+                break;
+            default:
+                quat_tracks_sample(clip->slerp_tracks, BENCHMARK_TRACK_COUNT, time, cursors, rotations);
+                break;
+        }
+    }
+    updateClock(&clock);
+    return clock.elapsed / BENCHMARK_FRAME_COUNT;
+}
+
+u8 keyframes_benchmark() {
+    random_state random;
+    random_seed(&random, 52);
+    u32 key_total = BENCHMARK_TRACK_COUNT * BENCHMARK_KEY_COUNT;
+    benchmark_clip clip;
+    clip.times = Hallocate(sizeof(f32) * key_total, MEMORY_TAG_ARRAY);
+    clip.positions = Hallocate(sizeof(vec3) * key_total, MEMORY_TAG_ARRAY);
+    clip.curves = Hallocate(sizeof(vec3) * key_total * 3, MEMORY_TAG_ARRAY);
+    clip.rotations = Hallocate(sizeof(quat) * key_total, MEMORY_TAG_ARRAY);
+    clip.linear_tracks = Hallocate(sizeof(vec3_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    clip.cubic_tracks = Hallocate(sizeof(vec3_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    clip.nlerp_tracks = Hallocate(sizeof(quat_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    clip.slerp_tracks = Hallocate(sizeof(quat_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    u32* cursors = Hallocate(sizeof(u32) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    vec3* positions = Hallocate(sizeof(vec3) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    quat* rotations = Hallocate(sizeof(quat) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+
+    // Tracks of 4 seconds, like the bones of a few hundred characters.
+    f32 duration = BENCHMARK_FRAME_COUNT * BENCHMARK_FRAME_TIME;
+    for (u32 i = 0; i < BENCHMARK_TRACK_COUNT; ++i) {
+        u32 first = i * BENCHMARK_KEY_COUNT;
+        random_times(&random, clip.times + first, BENCHMARK_KEY_COUNT, duration);
+        for (u32 k = first; k < first + BENCHMARK_KEY_COUNT; ++k) {
+            clip.positions[k] = vec3_create(random_f32_range(&random, -1.0f, 1.0f), random_f32_range(&random, -1.0f, 1.0f), random_f32_range(&random, -1.0f, 1.0f));
+            clip.curves[k * 3] = vec3_create(random_f32_range(&random, -1.0f, 1.0f), 0.0f, 0.0f);
+            clip.curves[k * 3 + 1] = clip.positions[k];
+            clip.curves[k * 3 + 2] = clip.curves[k * 3];
+            clip.rotations[k] = random_rotation(&random);
+        }
+        clip.linear_tracks[i] = (vec3_track){clip.times + first, clip.positions + first, BENCHMARK_KEY_COUNT, KEYFRAME_INTERPOLATION_LINEAR};
+        clip.cubic_tracks[i] = (vec3_track){clip.times + first, clip.curves + first * 3, BENCHMARK_KEY_COUNT, KEYFRAME_INTERPOLATION_CUBIC};
+        clip.nlerp_tracks[i] = (quat_track){clip.times + first, clip.rotations + first, BENCHMARK_KEY_COUNT, KEYFRAME_INTERPOLATION_LINEAR};
+        clip.slerp_tracks[i] = (quat_track){clip.times + first, clip.rotations + first, BENCHMARK_KEY_COUNT, KEYFRAME_INTERPOLATION_SLERP};
+    }
+
+    // Sampling many at once gives the same as one at a time.
+    HzeroMemory(cursors, sizeof(u32) * BENCHMARK_TRACK_COUNT);
+    vec3_tracks_sample(clip.cubic_tracks, BENCHMARK_TRACK_COUNT, 4.2f, cursors, positions);
+    quat_tracks_sample(clip.nlerp_tracks, BENCHMARK_TRACK_COUNT, 4.2f, cursors, rotations);
+    for (u32 i = 0; i < BENCHMARK_TRACK_COUNT; i += 97) {
+        u32 cursor = 0;
+        vec3 position = vec3_track_sample(&clip.cubic_tracks[i], 4.2f, &cursor);
+        expect_to_be_true(vec3_near(position, positions[i], 0.0f));
+        expect_should_be(cursor, cursors[i]);
+        quat rotation = quat_track_sample(&clip.nlerp_tracks[i], 4.2f, &cursor);
+        expect_to_be_true(rotation.x == rotations[i].x && rotation.y == rotations[i].y && rotation.z == rotations[i].z && rotation.w == rotations[i].w);
+    }
+
+    // Each kind plays through the whole clip, keeping its cursors from frame to frame or not.
+    const char* names[4] = {"vec3 linear", "vec3 cubic", "quat nlerp", "quat slerp"};
+    f64 kept[4];
+    f64 searched[4];
+    for (u32 kind = 0; kind < 4; ++kind) {
+        kept[kind] = play_tracks(&clip, kind, true, cursors, positions, rotations);
+        searched[kind] = play_tracks(&clip, kind, false, cursors, positions, rotations);
+    }
+    HINFO("Sampling %u tracks of %u keys, per frame:", BENCHMARK_TRACK_COUNT, BENCHMARK_KEY_COUNT);
+    for (u32 kind = 0; kind < 4; ++kind) {
+        HINFO("  %-12s %7.1f us (%4.1f ns a track), searching from the first key every frame %7.1f us (%.1fx).",
+              names[kind], kept[kind] * 1e6, kept[kind] * 1e9 / BENCHMARK_TRACK_COUNT, searched[kind] * 1e6, searched[kind] / kept[kind]);
+    }
+
+    Hfree(clip.times, sizeof(f32) * key_total, MEMORY_TAG_ARRAY);
+    Hfree(clip.positions, sizeof(vec3) * key_total, MEMORY_TAG_ARRAY);
+    Hfree(clip.curves, sizeof(vec3) * key_total * 3, MEMORY_TAG_ARRAY);
+    Hfree(clip.rotations, sizeof(quat) * key_total, MEMORY_TAG_ARRAY);
+    Hfree(clip.linear_tracks, sizeof(vec3_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(clip.cubic_tracks, sizeof(vec3_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(clip.nlerp_tracks, sizeof(quat_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(clip.slerp_tracks, sizeof(quat_track) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(cursors, sizeof(u32) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(positions, sizeof(vec3) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(rotations, sizeof(quat) * BENCHMARK_TRACK_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void keyframes_register_tests() {
+    test_manager_register_test(keyframe_find_should_match_linear_search, "keyframe find should match linear search");
+    test_manager_register_test(vec3_track_should_interpolate, "vec3 track should interpolate");
+    test_manager_register_test(quat_track_should_interpolate, "quat track should interpolate");
+    test_manager_register_benchmark(keyframes_benchmark, "keyframes benchmark");
+}
@@ -107,10 +107,34 @@ u8 linear_allocator_multi_allocation_all_space_then_free() {
     return true;
 }
 
+u8 linear_allocator_aligned_allocation() {
+    linear_allocator alloc;
+    create_linear_allocator(64, 0, &alloc);
+
+    // Misalign the top, then ask for a 16 byte aligned block.
+    void* block = allocate_linear_allocator(&alloc, 3);
+    expect_should_not_be(0, block);
+    block = allocate_linear_allocator_aligned(&alloc, 32, 16);
+    expect_should_not_be(0, block);
+    expect_should_be(0, (u64)block % 16);
+    expect_should_be((u64)block + 32, (u64)alloc.memory + alloc.allocated);
+
+    // Padding counts towards the size.
+    allocate_linear_allocator(&alloc, 1);
+    HDEBUG("Note: The following error is intentionally caused by this test.");
+    block = allocate_linear_allocator_aligned(&alloc, 16, 16);
+    expect_should_be(0, block);
+
+    destroy_linear_allocator(&alloc);
+
+    return true;
+}
+
 void linear_allocator_register_tests() {
     test_manager_register_test(linear_allocator_should_create_and_destroy, "Linear allocator should create and destroy");
     test_manager_register_test(linear_allocator_single_allocation_all_space, "Linear allocator single alloc for all space");
     test_manager_register_test(linear_allocator_multi_allocation_all_space, "Linear allocator multi alloc for all space");
     test_manager_register_test(linear_allocator_multi_allocation_over_allocate, "Linear allocator try over allocate");
     test_manager_register_test(linear_allocator_multi_allocation_all_space_then_free, "Linear allocator allocated should be 0 after free_all");
+    test_manager_register_test(linear_allocator_aligned_allocation, "Linear allocator aligned allocation");
 }
\ No newline at end of file
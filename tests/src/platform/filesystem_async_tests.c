@@ -0,0 +1,213 @@
+#include "filesystem_async_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <memory/hmemory.h>
+#include <platform/filesystem.h>
+#include <platform/vfs.h>
+
+#include <stdio.h>
+
+// Big enough to take a while on the workers, while still fitting in a single read.
+#define ASYNC_TEST_FILE_SIZE (1024 * 1024 + 17)
+
+static void* vfs_state;
+static u64 vfs_memory_requirement;
+static void* async_state;
+static u64 async_memory_requirement;
+
+// What the completion callback was given.
+typedef struct read_result {
+    u32 calls;
+    fileAsyncResult result;
+} read_result;
+
+static void on_read(const fileAsyncResult* result, void* user_data) {
+    read_result* out = (read_result*)user_data;
+    out->calls++;
+    out->result = *result;
+}
+
+static void release_result(read_result* result) {
+    if (result->result.data) {
+        Hfree(result->result.data, result->result.size, MEMORY_TAG_FILE);
+    }
+    HzeroMemory(result, sizeof(read_result));
+}
+
+static b8 start_async(b8 use_worker_threads) {
+    vfs_initialize(&vfs_memory_requirement, 0);
+    vfs_state = Hallocate(vfs_memory_requirement, MEMORY_TAG_APPLICATION);
+    vfs_initialize(&vfs_memory_requirement, vfs_state);
+
+    filesystem_async_initialize(&async_memory_requirement, 0, use_worker_threads);
+    async_state = Hallocate(async_memory_requirement, MEMORY_TAG_APPLICATION);
+    return filesystem_async_initialize(&async_memory_requirement, async_state, use_worker_threads);
+}
+
+static void stop_async() {
+    filesystem_async_shutdown(async_state);
+    Hfree(async_state, async_memory_requirement, MEMORY_TAG_APPLICATION);
+    vfs_shutdown(vfs_state);
+    Hfree(vfs_state, vfs_memory_requirement, MEMORY_TAG_APPLICATION);
+}
+
+static b8 write_bytes(const char* path, const u8* data, u64 size) {
+    fileHandle file;
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &file)) {
+        return false;
+    }
+    u64 written = 0;
+    b8 result = size == 0 || filesystem_write(&file, size, data, &written);
+    filesystem_close(&file);
+    return result && written == size;
+}
+
+// Reads a disk file, an empty file and a missing one. The files are written by the caller.
+static u8 read_disk_files(const u8* contents) {
+    read_result read = {0};
+    fileAsyncHandle handle;
+    expect_to_be_true(filesystem_read_async("async_test.bin", on_read, &read, &handle));
+    expect_should_not_be(INVALID_FILE_ASYNC_HANDLE, handle);
+    expect_to_be_true(filesystem_async_is_pending(handle));
+    filesystem_async_wait(handle);
+    expect_to_be_false(filesystem_async_is_pending(handle));
+    expect_should_be(1, read.calls);
+    expect_to_be_true(read.result.success);
+    expect_should_be(handle, read.result.handle);
+    expect_should_be(ASYNC_TEST_FILE_SIZE, read.result.size);
+    b8 matches = true;
+    for (u64 i = 0; i < ASYNC_TEST_FILE_SIZE; ++i) {
+        matches = matches && read.result.data[i] == contents[i];
+    }
+    release_result(&read);
+    expect_to_be_true(matches);
+
+    // Empty files succeed without a buffer, on the next update.
+    expect_to_be_true(filesystem_read_async("async_test_empty.bin", on_read, &read, &handle));
+    filesystem_async_wait(handle);
+    expect_should_be(1, read.calls);
+    expect_to_be_true(read.result.success);
+    expect_should_be(0, read.result.size);
+    expect_to_be_true(read.result.data == 0);
+    release_result(&read);
+
+    // Missing files fail right away and never call back.
+    HDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_to_be_false(filesystem_read_async("async_test_missing.bin", on_read, &read, &handle));
+    expect_should_be(INVALID_FILE_ASYNC_HANDLE, handle);
+    expect_to_be_false(filesystem_async_is_pending(handle));
+    filesystem_async_update();
+    expect_should_be(0, read.calls);
+    return true;
+}
+
+static u8 read_files(b8 use_worker_threads) {
+    u8* contents = Hallocate(ASYNC_TEST_FILE_SIZE, MEMORY_TAG_FILE);
+    for (u64 i = 0; i < ASYNC_TEST_FILE_SIZE; ++i) {
+        contents[i] = (u8)(i * 31 + (i >> 11));
+    }
+    b8 written = write_bytes("async_test.bin", contents, ASYNC_TEST_FILE_SIZE) && write_bytes("async_test_empty.bin", 0, 0);
+
+    // Cleaned up whether the reads work out or not.
+    b8 started = written && start_async(use_worker_threads);
+    u8 result = started && read_disk_files(contents);
+    if (started) {
+        stop_async();
+    }
+
+    remove("async_test.bin");
+    remove("async_test_empty.bin");
+    Hfree(contents, ASYNC_TEST_FILE_SIZE, MEMORY_TAG_FILE);
+    expect_to_be_true(written);
+    expect_to_be_true(started);
+    return result;
+}
+
+u8 filesystem_async_should_read_files() {
+    return read_files(false);
+}
+
+u8 filesystem_async_should_read_files_on_worker_threads() {
+    return read_files(true);
+}
+
+static u8 read_memory_mount() {
+    static const char contents[] = "memory mounted";
+    expect_to_be_true(vfs_mount_memory("async/memory.txt", contents, sizeof(contents)));
+
+    // Already in memory, so copied right away and dispatched on the next update.
+    read_result read = {0};
+    fileAsyncHandle handle;
+    expect_to_be_true(filesystem_read_async("async/memory.txt", on_read, &read, &handle));
+    expect_to_be_true(filesystem_async_is_pending(handle));
+    expect_should_be(0, read.calls);
+    filesystem_async_update();
+    expect_to_be_false(filesystem_async_is_pending(handle));
+    expect_should_be(1, read.calls);
+    expect_to_be_true(read.result.success);
+    expect_should_be(sizeof(contents), read.result.size);
+    expect_to_be_true(read.result.data != (const u8*)contents);
+    b8 matches = true;
+    for (u64 i = 0; i < sizeof(contents); ++i) {
+        matches = matches && read.result.data[i] == (u8)contents[i];
+    }
+    release_result(&read);
+    expect_to_be_true(matches);
+    return true;
+}
+
+u8 filesystem_async_should_read_memory_mounts() {
+    expect_to_be_true(start_async(false));
+    u8 result = read_memory_mount();
+    stop_async();
+    return result;
+}
+
+static u8 wait_on_stale_handle() {
+    static const char contents[] = "stale";
+    expect_to_be_true(vfs_mount_memory("async/stale.txt", contents, sizeof(contents)));
+
+    read_result first = {0};
+    fileAsyncHandle stale;
+    expect_to_be_true(filesystem_read_async("async/stale.txt", on_read, &first, &stale));
+    filesystem_async_wait(stale);
+    expect_should_be(1, first.calls);
+    release_result(&first);
+
+    // The slot is reused with a new generation, the old handle must not match the new read.
+    read_result second = {0};
+    fileAsyncHandle handle;
+    expect_to_be_true(filesystem_read_async("async/stale.txt", on_read, &second, &handle));
+    expect_should_not_be(stale, handle);
+    expect_to_be_false(filesystem_async_is_pending(stale));
+    expect_to_be_true(filesystem_async_is_pending(handle));
+
+    // Waiting on the stale handle returns right away without dispatching the new read.
+    filesystem_async_wait(stale);
+    expect_should_be(0, second.calls);
+    expect_to_be_true(filesystem_async_is_pending(handle));
+    expect_should_be(0, first.calls);
+
+    filesystem_async_wait(handle);
+    expect_should_be(1, second.calls);
+    expect_to_be_true(second.result.success);
+    release_result(&second);
+    return true;
+}
+
+u8 filesystem_async_should_ignore_stale_handles() {
+    expect_to_be_true(start_async(false));
+    u8 result = wait_on_stale_handle();
+    stop_async();
+    return result;
+}
+
+void filesystem_async_register_tests() {
+    test_manager_register_test(filesystem_async_should_read_files, "Filesystem async should read files");
+    test_manager_register_test(filesystem_async_should_read_files_on_worker_threads, "Filesystem async should read files on worker threads");
+    test_manager_register_test(filesystem_async_should_read_memory_mounts, "Filesystem async should read memory mounts");
+    test_manager_register_test(filesystem_async_should_ignore_stale_handles, "Filesystem async should ignore stale handles");
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#ifdef __cplusplus 
+extern "C" { 
+#endif
+
+void filesystem_async_register_tests();
+
+#ifdef __cplusplus
+} 
+#endif
\ No newline at end of file
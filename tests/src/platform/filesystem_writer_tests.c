@@ -0,0 +1,184 @@
+#include "filesystem_writer_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <platform/filesystem.h>
+#include <platform/platform.h>
+
+#include <stdio.h>
+
+#define BENCHMARK_LINE_COUNT 100000
+
+// Size of the file on disk, as far as the OS knows.
+static u64 file_size(const char* path) {
+    fileHandle file;
+    u64 size = 0;
+    if (filesystem_open(path, FILE_MODE_READ, true, &file)) {
+        filesystem_size(&file, &size);
+        filesystem_close(&file);
+    }
+    return size;
+}
+
+// Checks each flush rule of the policy the writer was opened with.
+static u8 write_by_policy(const char* path, fileWriter* writer) {
+    // Size threshold.
+    expect_to_be_true(filesystem_writer_write(writer, 10, "0123456789"));
+    expect_should_be(0, file_size(path));
+    u8 block[60];
+    for (u32 i = 0; i < sizeof(block); ++i) {
+        block[i] = 'a' + i % 26;
+    }
+    expect_to_be_true(filesystem_writer_write(writer, sizeof(block), block));
+    expect_should_be(70, file_size(path));
+
+    // On error.
+    expect_to_be_true(filesystem_writer_write_line(writer, "error"));
+    expect_should_be(70, file_size(path));
+    expect_to_be_true(filesystem_writer_mark_error(writer));
+    expect_should_be(76, file_size(path));
+
+    // Time threshold.
+    expect_to_be_true(filesystem_writer_write(writer, 4, "late"));
+    expect_to_be_true(filesystem_writer_update(writer));
+    expect_should_be(76, file_size(path));
+    f64 start = platformGetAbsoluteTime();
+    while (platformGetAbsoluteTime() - start < 0.02) {
+    }
+    expect_to_be_true(filesystem_writer_update(writer));
+    expect_should_be(80, file_size(path));
+
+    // Writes bigger than the buffer go out along with what is buffered, in order.
+    u8 big[1000];
+    for (u32 i = 0; i < sizeof(big); ++i) {
+        big[i] = '0' + i % 10;
+    }
+    expect_to_be_true(filesystem_writer_write(writer, 3, "abc"));
+    expect_to_be_true(filesystem_writer_write(writer, sizeof(big), big));
+    expect_should_be(1083, file_size(path));
+    return true;
+}
+
+u8 writer_should_flush_by_policy() {
+    const char* path = "writer_test_policy.txt";
+    fileWriterPolicy policy = {0};
+    policy.flush_size = 64;
+    policy.flush_interval = 0.01;
+    policy.flush_on_error = true;
+
+    fileWriter writer;
+    expect_to_be_true(filesystem_writer_open(path, 256, &policy, &writer));
+    // The writer is tracked globally, so it is closed even when a check failed.
+    u8 result = write_by_policy(path, &writer);
+    filesystem_writer_close(&writer);
+    if (!result) {
+        remove(path);
+        return false;
+    }
+
+    fileView view;
+    expect_to_be_true(filesystem_map(path, &view));
+    expect_should_be(1083, view.size);
+    expect_should_be('0', view.data[0]);
+    expect_should_be('a', view.data[10]);
+    expect_should_be('e', view.data[70]);
+    expect_should_be('\n', view.data[75]);
+    expect_should_be('l', view.data[76]);
+    expect_should_be('a', view.data[80]);
+    expect_should_be('0', view.data[83]);
+    expect_should_be('9', view.data[1082]);
+    filesystem_unmap(&view);
+
+    remove(path);
+    return true;
+}
+
+// Checks flushing every tracked writer. Writers it opens are marked in is_open.
+static u8 flush_open_writers(const char** paths, fileWriter* writers, b8* is_open) {
+    for (u32 i = 0; i < 2; ++i) {
+        is_open[i] = filesystem_writer_open(paths[i], 1024, 0, &writers[i]);
+        expect_to_be_true(is_open[i]);
+        expect_to_be_true(filesystem_writer_write_line(&writers[i], "buffered"));
+        expect_should_be(0, file_size(paths[i]));
+    }
+
+    filesystem_writer_flush_all();
+    for (u32 i = 0; i < 2; ++i) {
+        expect_should_be(9, file_size(paths[i]));
+        expect_should_be(0, writers[i].length);
+    }
+
+    // Closed writers are no longer tracked.
+    filesystem_writer_close(&writers[0]);
+    is_open[0] = false;
+    expect_to_be_true(filesystem_writer_write_line(&writers[1], "more"));
+    filesystem_writer_flush_all();
+    expect_should_be(14, file_size(paths[1]));
+    return true;
+}
+
+u8 writer_should_flush_all_open_writers() {
+    const char* paths[2] = {"writer_test_flush_a.txt", "writer_test_flush_b.txt"};
+    fileWriter writers[2];
+    b8 is_open[2] = {false, false};
+    u8 result = flush_open_writers(paths, writers, is_open);
+
+    // The writers live on this stack but are tracked globally, so they are closed even when a check failed.
+    for (u32 i = 0; i < 2; ++i) {
+        if (is_open[i]) {
+            filesystem_writer_close(&writers[i]);
+        }
+    }
+    remove(paths[0]);
+    remove(paths[1]);
+    return result;
+}
+
+// Writes log-like lines with a flush after each one, like filesystem_write_line used to, then through a writer.
+u8 writer_benchmark_flush_per_line_vs_buffered() {
+    const char* path = "writer_benchmark.txt";
+    const char* line = "[INFO]: Frame 1234 took 16.6ms, 2048 draw calls, 512 MB in use";
+    hclock clock;
+
+    fileHandle file;
+    expect_to_be_true(filesystem_open(path, FILE_MODE_WRITE, false, &file));
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_LINE_COUNT; ++i) {
+        filesystem_write_line(&file, line);
+        filesystem_flush(&file);
+    }
+    updateClock(&clock);
+    filesystem_close(&file);
+    f64 flushed_time = clock.elapsed;
+
+    fileWriterPolicy policy = {0};
+    policy.flush_interval = 0.1;
+    fileWriter writer;
+    expect_to_be_true(filesystem_writer_open(path, 64 * 1024, &policy, &writer));
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_LINE_COUNT; ++i) {
+        filesystem_writer_write_line(&writer, line);
+    }
+    filesystem_writer_flush(&writer);
+    updateClock(&clock);
+    filesystem_writer_close(&writer);
+    f64 buffered_time = clock.elapsed;
+
+    u64 size = file_size(path);
+    remove(path);
+    expect_should_be((u64)BENCHMARK_LINE_COUNT * 63, size);
+
+    HINFO("%u lines: flush per line %.2f ms, buffered writer %.2f ms (%.1fx).",
+          BENCHMARK_LINE_COUNT, flushed_time * 1000.0, buffered_time * 1000.0, flushed_time / buffered_time);
+    return true;
+}
+
+void filesystem_writer_register_tests() {
+    test_manager_register_test(writer_should_flush_by_policy, "Writer should flush by policy");
+    test_manager_register_test(writer_should_flush_all_open_writers, "Writer should flush all open writers");
+    test_manager_register_benchmark(writer_benchmark_flush_per_line_vs_buffered, "Writer benchmark flush per line vs buffered");
+}
@@ -0,0 +1,117 @@
+#include "line_reader_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <memory/hmemory.h>
+#include <platform/filesystem.h>
+#include <utils/hstring.h>
+
+#include <stdio.h>
+
+#define BENCHMARK_LINE_COUNT 1000000
+
+static b8 line_is(stringView line, const char* expected) {
+    return string_views_equal(line, string_view(expected));
+}
+
+u8 line_reader_should_split_lines() {
+    const char text[] = "first\r\n\nthird line\r\n\r\nlast";
+    fileLineReader reader;
+    filesystem_line_reader_from_memory(text, sizeof(text) - 1, &reader);
+
+    stringView line;
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_to_be_true(line_is(line, "first"));
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_should_be(0, line.length);
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_to_be_true(line_is(line, "third line"));
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_should_be(0, line.length);
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_to_be_true(line_is(line, "last"));
+    expect_should_be(5, reader.line_number);
+    expect_to_be_false(filesystem_line_reader_next(&reader, &line));
+
+    // Lines point into the buffer.
+    expect_to_be_true(line.data == text + 22);
+
+    // A trailing newline doesn't start another line.
+    filesystem_line_reader_from_memory("one\n", 4, &reader);
+    expect_to_be_true(filesystem_line_reader_next(&reader, &line));
+    expect_to_be_false(filesystem_line_reader_next(&reader, &line));
+
+    filesystem_line_reader_from_memory(0, 0, &reader);
+    expect_to_be_false(filesystem_line_reader_next(&reader, &line));
+    filesystem_line_reader_close(&reader);
+
+    char copy[6];
+    expect_should_be(5, string_view_copy(copy, sizeof(copy), string_view("truncated")));
+    expect_to_be_true(strings_equal("trunc", copy));
+
+    return true;
+}
+
+// Scans a file of config-like lines with filesystem_read_line, then with a line reader.
+u8 line_reader_benchmark_vs_read_line() {
+    const char* path = "line_reader_benchmark.txt";
+    fileWriter writer;
+    expect_to_be_true(filesystem_writer_open(path, 64 * 1024, 0, &writer));
+    char text[64];
+    for (u32 i = 0; i < BENCHMARK_LINE_COUNT; ++i) {
+        i32 length = string_format_n(text, sizeof(text), "setting_%u = %u", i, i * 7);
+        filesystem_writer_write(&writer, length, text);
+        filesystem_writer_write(&writer, 1, "\n");
+    }
+    filesystem_writer_close(&writer);
+
+    hclock clock;
+    u64 copied_lines = 0;
+    u64 copied_characters = 0;
+    fileHandle file;
+    expect_to_be_true(filesystem_open(path, FILE_MODE_READ, false, &file));
+    startClock(&clock);
+    char* line_buffer;
+    while (filesystem_read_line(&file, &line_buffer)) {
+        u64 length = string_length(line_buffer);
+        copied_lines++;
+        // Without the '\n'.
+        copied_characters += length - 1;
+        Hfree(line_buffer, length + 1, MEMORY_TAG_STRING);
+    }
+    updateClock(&clock);
+    filesystem_close(&file);
+    f64 copied_time = clock.elapsed;
+
+    u64 lines = 0;
+    u64 characters = 0;
+    fileLineReader reader;
+    expect_to_be_true(filesystem_line_reader_open(path, &reader));
+    startClock(&clock);
+    stringView line;
+    while (filesystem_line_reader_next(&reader, &line)) {
+        lines++;
+        characters += line.length;
+    }
+    updateClock(&clock);
+    filesystem_line_reader_close(&reader);
+    f64 reader_time = clock.elapsed;
+
+    remove(path);
+    expect_should_be(BENCHMARK_LINE_COUNT, lines);
+    expect_should_be(copied_lines, lines);
+    expect_should_be(copied_characters, characters);
+
+    HINFO("%u lines: filesystem_read_line %.2f ms, line reader %.2f ms (%.1fx).",
+          BENCHMARK_LINE_COUNT, copied_time * 1000.0, reader_time * 1000.0, copied_time / reader_time);
+    return true;
+}
+
+void line_reader_register_tests() {
+    test_manager_register_test(line_reader_should_split_lines, "Line reader should split lines");
+    test_manager_register_benchmark(line_reader_benchmark_vs_read_line, "Line reader benchmark vs read line");
+}
@@ -0,0 +1,127 @@
+#include "vfs_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <memory/hmemory.h>
+#include <platform/filesystem.h>
+#include <platform/vfs.h>
+#include <utils/hstring.h>
+
+#include <stdio.h>
+
+static void* vfs_state;
+static u64 vfs_memory_requirement;
+
+static void start_vfs() {
+    vfs_initialize(&vfs_memory_requirement, 0);
+    vfs_state = Hallocate(vfs_memory_requirement, MEMORY_TAG_APPLICATION);
+    vfs_initialize(&vfs_memory_requirement, vfs_state);
+}
+
+static void stop_vfs() {
+    vfs_shutdown(vfs_state);
+    Hfree(vfs_state, vfs_memory_requirement, MEMORY_TAG_APPLICATION);
+}
+
+static b8 write_text(const char* path, const char* text) {
+    fileHandle file;
+    if (!filesystem_open(path, FILE_MODE_WRITE, false, &file)) {
+        return false;
+    }
+    u64 written = 0;
+    b8 result = filesystem_write(&file, string_length(text), text, &written);
+    filesystem_close(&file);
+    return result;
+}
+
+u8 vfs_should_resolve_memory_mounts() {
+    static const char contents[] = "memory mounted";
+    start_vfs();
+
+    expect_to_be_true(vfs_mount_memory("config/engine.cfg", contents, sizeof(contents)));
+
+    vfsFile file;
+    expect_to_be_true(vfs_resolve("./config/engine.cfg", &file));
+    expect_should_be(VFS_SOURCE_MEMORY, file.source);
+    expect_should_be(sizeof(contents), file.size);
+    expect_to_be_true(filesystem_exists("config\\engine.cfg"));
+    expect_to_be_false(filesystem_exists("config/engine.cfg2"));
+
+    // Views point straight at the mounted memory.
+    fileView view;
+    expect_to_be_true(filesystem_map("config/engine.cfg", &view));
+    expect_to_be_true(view.data == (const u8*)contents);
+    filesystem_unmap(&view);
+
+    // There is no stdio handle to give out for memory.
+    fileHandle handle;
+    expect_to_be_false(filesystem_open("config/engine.cfg", FILE_MODE_READ, true, &handle));
+
+    stop_vfs();
+    return true;
+}
+
+u8 vfs_should_resolve_directory_mounts_by_precedence() {
+    start_vfs();
+    expect_to_be_true(write_text("vfs_test_base.txt", "base"));
+    expect_to_be_true(write_text("vfs_test_mod.txt", "mod"));
+
+    // The working directory mounted under a prefix.
+    expect_to_be_true(vfs_mount_directory("data/", "."));
+
+    vfsFile file;
+    expect_to_be_true(vfs_resolve("data/vfs_test_base.txt", &file));
+    expect_should_be(VFS_SOURCE_DISK, file.source);
+    expect_should_be(4, file.size);
+    expect_to_be_true(strings_equal("./vfs_test_base.txt", file.disk_path));
+
+    // A later mount shadows earlier ones.
+    expect_to_be_true(vfs_mount_memory("data/vfs_test_base.txt", "override", 8));
+    expect_to_be_true(vfs_resolve("data/vfs_test_base.txt", &file));
+    expect_should_be(VFS_SOURCE_MEMORY, file.source);
+
+    // Unmounted paths still go straight to the disk.
+    expect_to_be_true(vfs_resolve("vfs_test_mod.txt", &file));
+    expect_should_be(VFS_SOURCE_DISK, file.source);
+    expect_should_be(3, file.size);
+
+    remove("vfs_test_base.txt");
+    remove("vfs_test_mod.txt");
+    stop_vfs();
+    return true;
+}
+
+u8 vfs_should_cache_until_invalidated() {
+    start_vfs();
+    const char* path = "vfs_test_cached.txt";
+    remove(path);
+
+    vfsFile file;
+    expect_to_be_false(vfs_resolve(path, &file));
+
+    // Created behind the VFS' back: the cached miss stands until invalidated.
+    FILE* external = fopen(path, "w");
+    fputs("late", external);
+    fclose(external);
+    expect_to_be_false(vfs_resolve(path, &file));
+    vfs_invalidate(path);
+    expect_to_be_true(vfs_resolve(path, &file));
+    expect_should_be(4, file.size);
+
+    // Writing through the filesystem drops the cached result by itself.
+    expect_to_be_true(write_text(path, "longer text"));
+    expect_to_be_true(vfs_resolve(path, &file));
+    expect_should_be(11, file.size);
+
+    remove(path);
+    stop_vfs();
+    return true;
+}
+
+void vfs_register_tests() {
+    test_manager_register_test(vfs_should_resolve_memory_mounts, "VFS should resolve memory mounts");
+    test_manager_register_test(vfs_should_resolve_directory_mounts_by_precedence, "VFS should resolve directory mounts by precedence");
+    test_manager_register_test(vfs_should_cache_until_invalidated, "VFS should cache until invalidated");
+}
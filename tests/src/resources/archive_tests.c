@@ -0,0 +1,337 @@
+#include "archive_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/hclock.h>
+#include <core/job_system.h>
+#include <memory/hmemory.h>
+#include <platform/filesystem.h>
+#include <platform/platform.h>
+#include <resources/archive.h>
+#include <utils/compression.h>
+
+#include <stdio.h>
+
+// Size of the generated data used by the benchmark.
+#define BENCHMARK_DATA_SIZE (16 * 1024 * 1024)
+#define BENCHMARK_ITERATIONS 8
+
+// Small deterministic generator, test data must not depend on rand().
+static u32 next_random(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Fills data with a SPIR-V like stream: opcode words followed by ids and literals from small ranges.
+static void generate_shader_data(u8* data, u64 size) {
+    u32* words = (u32*)data;
+    u64 count = size / sizeof(u32);
+    u32 random = 0x12345678;
+    for (u64 i = 0; i < count;) {
+        u32 operand_count = 1 + next_random(&random) % 4;
+        u32 opcode = 20 + next_random(&random) % 40;
+        words[i++] = ((operand_count + 1) << 16) | opcode;
+        for (u32 j = 0; j < operand_count && i < count; ++j) {
+            words[i++] = next_random(&random) % 256;
+        }
+    }
+}
+
+// Fills data with mesh vertices: a position on a grid, a mostly constant normal and a texture coordinate.
+static void generate_mesh_data(u8* data, u64 size) {
+    f32* floats = (f32*)data;
+    u64 vertex_count = size / (8 * sizeof(f32));
+    u32 side = 1024;
+    for (u64 i = 0; i < vertex_count; ++i) {
+        f32* vertex = floats + i * 8;
+        f32 x = (f32)(i % side);
+        f32 z = (f32)(i / side);
+        vertex[0] = x * 0.25f;
+        vertex[1] = 0.0f;
+        vertex[2] = z * 0.25f;
+        vertex[3] = 0.0f;
+        vertex[4] = 1.0f;
+        vertex[5] = 0.0f;
+        vertex[6] = x / side;
+        vertex[7] = z / side;
+    }
+}
+
+static b8 write_file(const char* path, const u8* data, u64 size) {
+    fileHandle file;
+    if (!filesystem_open(path, FILE_MODE_WRITE, true, &file)) {
+        return false;
+    }
+    u64 written = 0;
+    b8 result = filesystem_write(&file, size, data, &written);
+    filesystem_close(&file);
+    return result && written == size;
+}
+
+u8 compression_should_round_trip_blocks() {
+    u8 source[4096];
+    u8 compressed[4096 + 4096 / 255 + 16];
+    u8 result[4096];
+
+    // Every small size, to hit the end of block rules.
+    for (u64 size = 0; size < 64; ++size) {
+        for (u64 i = 0; i < size; ++i) {
+            source[i] = (u8)(i % 3);
+        }
+        u64 compressed_size = compression_compress_block(source, size, compressed, sizeof(compressed));
+        expect_to_be_true(compressed_size > 0);
+        expect_to_be_true(compression_decompress_block(compressed, compressed_size, result, size));
+        for (u64 i = 0; i < size; ++i) {
+            expect_should_be(source[i], result[i]);
+        }
+    }
+
+    // Repetitive, random and long runs.
+    u32 random = 42;
+    for (u32 kind = 0; kind < 3; ++kind) {
+        for (u64 i = 0; i < sizeof(source); ++i) {
+            source[i] = kind == 0 ? (u8)"Hazker engine "[i % 14] : (kind == 1 ? (u8)next_random(&random) : 7);
+        }
+        u64 compressed_size = compression_compress_block(source, sizeof(source), compressed, sizeof(compressed));
+        expect_to_be_true(compressed_size > 0);
+        expect_to_be_true(compression_decompress_block(compressed, compressed_size, result, sizeof(result)));
+        for (u64 i = 0; i < sizeof(source); ++i) {
+            expect_should_be(source[i], result[i]);
+        }
+
+        // Truncated input must be rejected, not read past.
+        expect_to_be_false(compression_decompress_block(compressed, compressed_size - 1, result, sizeof(result)));
+    }
+
+    // Too little room to compress into.
+    expect_should_be(0, compression_compress_block(source, sizeof(source), compressed, 16));
+
+    return true;
+}
+
+u8 archive_should_round_trip_chunked_data() {
+    u64 size = ARCHIVE_COMPRESSION_CHUNK_SIZE * 5 + 123;
+    u8* source = Hallocate(size, MEMORY_TAG_FILE);
+    u8* compressed = Hallocate(archive_compress_bound(size), MEMORY_TAG_FILE);
+    u8* result = Hallocate(size, MEMORY_TAG_FILE);
+
+    // Compressible except for one random chunk, wich has to be stored as is.
+    generate_shader_data(source, size);
+    u32 random = 7;
+    for (u64 i = ARCHIVE_COMPRESSION_CHUNK_SIZE * 2; i < ARCHIVE_COMPRESSION_CHUNK_SIZE * 3; ++i) {
+        source[i] = (u8)next_random(&random);
+    }
+
+    u64 compressed_size = archive_compress(source, size, compressed);
+    expect_to_be_true(compressed_size > 0 && compressed_size < size);
+    expect_to_be_true(archive_decompress(compressed, compressed_size, result, size));
+    for (u64 i = 0; i < size; ++i) {
+        expect_should_be(source[i], result[i]);
+    }
+
+    // Chunk tables going backwards or pointing past the data must be rejected.
+    u32* chunk_ends = (u32*)compressed;
+    u32 end = chunk_ends[2];
+    chunk_ends[2] = chunk_ends[1];
+    expect_to_be_false(archive_decompress(compressed, compressed_size, result, size));
+    chunk_ends[2] = end;
+    chunk_ends[5] = 0xFFFFFFFF;
+    expect_to_be_false(archive_decompress(compressed, compressed_size, result, size));
+
+    // Random data doesn't shrink.
+    for (u64 i = 0; i < size; ++i) {
+        source[i] = (u8)next_random(&random);
+    }
+    expect_should_be(0, archive_compress(source, size, compressed));
+
+    Hfree(source, size, MEMORY_TAG_FILE);
+    Hfree(compressed, archive_compress_bound(size), MEMORY_TAG_FILE);
+    Hfree(result, size, MEMORY_TAG_FILE);
+    return true;
+}
+
+// Writes a one entry archive with the given entry and tries to open it.
+static b8 open_single_entry_archive(const char* path, archiveEntry entry) {
+    u8 data[256] = {0};
+    archiveHeader header = {ARCHIVE_MAGIC, ARCHIVE_VERSION, 1, 0, sizeof(archiveHeader), sizeof(archiveHeader) + sizeof(archiveEntry), 2, 0};
+    HcopyMemory(data, &header, sizeof(header));
+    HcopyMemory(data + header.toc_offset, &entry, sizeof(entry));
+    data[header.names_offset] = 'a';
+    if (!write_file(path, data, sizeof(data))) {
+        return false;
+    }
+
+    archive archive;
+    b8 opened = archive_open(path, &archive);
+    if (opened) {
+        archive_close(&archive);
+    }
+    return opened;
+}
+
+u8 archive_should_reject_corrupted_entries() {
+    const char* path = "archive_corrupted.hpak";
+    u64 hash = archive_hash_path("a");
+
+    archiveEntry stored = {hash, 128, 128, 128, 0, ARCHIVE_ENTRY_FLAG_NONE};
+    expect_to_be_true(open_single_entry_archive(path, stored));
+    archiveEntry compressed = {hash, 128, 128, ARCHIVE_COMPRESSION_CHUNK_SIZE * 2, 0, ARCHIVE_ENTRY_FLAG_COMPRESSED};
+    expect_to_be_true(open_single_entry_archive(path, compressed));
+
+    // Misaligned, wrapping around, stored with a different uncompressed size, compressed without
+    // shrinking and compressed to more than the chunk table could describe.
+    archiveEntry corrupted[] = {
+        {hash, 130, 64, 64, 0, ARCHIVE_ENTRY_FLAG_NONE},
+        {hash, 128, 0xFFFFFFFFFFFFFFC0ull, 0xFFFFFFFFFFFFFFC0ull, 0, ARCHIVE_ENTRY_FLAG_NONE},
+        {hash, 128, 128, 256, 0, ARCHIVE_ENTRY_FLAG_NONE},
+        {hash, 128, 128, 128, 0, ARCHIVE_ENTRY_FLAG_COMPRESSED},
+        {hash, 128, 128, 0x10000000000ull, 0, ARCHIVE_ENTRY_FLAG_COMPRESSED}};
+    for (u32 i = 0; i < sizeof(corrupted) / sizeof(archiveEntry); ++i) {
+        HDEBUG("Note: The following error is intentionally caused by this test.");
+        expect_to_be_false(open_single_entry_archive(path, corrupted[i]));
+    }
+
+    remove(path);
+    return true;
+}
+
+// Decompression run by a second thread while the test thread decompresses as well.
+typedef struct concurrent_decompress {
+    const u8* compressed;
+    u64 compressed_size;
+    u8* result;
+    u64 size;
+    b8 success;
+} concurrent_decompress;
+
+static u32 concurrent_decompress_thread(void* params) {
+    concurrent_decompress* work = (concurrent_decompress*)params;
+    work->success = true;
+    for (u32 i = 0; i < 32 && work->success; ++i) {
+        work->success = archive_decompress(work->compressed, work->compressed_size, work->result, work->size);
+    }
+    return 0;
+}
+
+u8 archive_should_decompress_from_several_threads() {
+    u64 memory_requirement = 0;
+    job_system_initialize(&memory_requirement, 0, 0);
+    void* job_state = Hallocate(memory_requirement, MEMORY_TAG_JOB);
+    expect_to_be_true(job_system_initialize(&memory_requirement, job_state, 3));
+
+    u64 size = ARCHIVE_COMPRESSION_CHUNK_SIZE * 8 + 77;
+    u8* source = Hallocate(size, MEMORY_TAG_FILE);
+    u8* compressed = Hallocate(archive_compress_bound(size), MEMORY_TAG_FILE);
+    u8* results = Hallocate(size * 2, MEMORY_TAG_FILE);
+    generate_shader_data(source, size);
+    u64 compressed_size = archive_compress(source, size, compressed);
+    expect_to_be_true(compressed_size > 0);
+
+    // Both threads hand ranges to the job system at the same time.
+    concurrent_decompress work = {compressed, compressed_size, results + size, size, false};
+    platformThread thread;
+    expect_to_be_true(platformThreadCreate(concurrent_decompress_thread, &work, &thread));
+    b8 success = true;
+    for (u32 i = 0; i < 32 && success; ++i) {
+        success = archive_decompress(compressed, compressed_size, results, size);
+    }
+    platformThreadJoin(&thread);
+    expect_to_be_true(success);
+    expect_to_be_true(work.success);
+    for (u64 i = 0; i < size; ++i) {
+        expect_should_be(source[i], results[i]);
+        expect_should_be(source[i], results[size + i]);
+    }
+
+    job_system_shutdown(job_state);
+    Hfree(job_state, memory_requirement, MEMORY_TAG_JOB);
+    Hfree(source, size, MEMORY_TAG_FILE);
+    Hfree(compressed, archive_compress_bound(size), MEMORY_TAG_FILE);
+    Hfree(results, size * 2, MEMORY_TAG_FILE);
+    return true;
+}
+
+// Loads the same data from a raw and a compressed file and logs the throughput of both.
+static b8 benchmark_load(const char* name, void (*generate)(u8*, u64)) {
+    u64 size = BENCHMARK_DATA_SIZE;
+    u8* source = Hallocate(size, MEMORY_TAG_FILE);
+    u8* compressed = Hallocate(archive_compress_bound(size), MEMORY_TAG_FILE);
+    u8* dest = Hallocate(size, MEMORY_TAG_FILE);
+    generate(source, size);
+    u64 compressed_size = archive_compress(source, size, compressed);
+
+    const char* raw_path = "archive_benchmark_raw.bin";
+    const char* compressed_path = "archive_benchmark_compressed.bin";
+    b8 written = write_file(raw_path, source, size) && compressed_size && write_file(compressed_path, compressed, compressed_size);
+
+    f64 raw_time = 0;
+    f64 compressed_time = 0;
+    b8 success = written;
+    // The first iteration warms the page cache and isn't counted, so this compares CPU cost of a cached load.
+    for (u32 i = 0; success && i <= BENCHMARK_ITERATIONS; ++i) {
+        hclock clock;
+        fileView view;
+
+        startClock(&clock);
+        success = filesystem_map(raw_path, &view);
+        if (success) {
+            HcopyMemory(dest, view.data, view.size);
+            filesystem_unmap(&view);
+        }
+        updateClock(&clock);
+        raw_time += i ? clock.elapsed : 0;
+
+        startClock(&clock);
+        success = success && filesystem_map(compressed_path, &view);
+        if (success) {
+            success = archive_decompress(view.data, view.size, dest, size);
+            filesystem_unmap(&view);
+        }
+        updateClock(&clock);
+        compressed_time += i ? clock.elapsed : 0;
+    }
+
+    for (u64 i = 0; success && i < size; ++i) {
+        success = source[i] == dest[i];
+    }
+
+    if (success) {
+        f64 megabytes = (f64)size * BENCHMARK_ITERATIONS / (1024.0 * 1024.0);
+        HINFO("%s data, %llu -> %llu bytes (%.1f%%): raw load %.0f MB/s, compressed load %.0f MB/s on %u threads.",
+              name, size, compressed_size, 100.0 * compressed_size / size,
+              megabytes / raw_time, megabytes / compressed_time, job_system_thread_count());
+    }
+
+    remove(raw_path);
+    remove(compressed_path);
+    Hfree(source, size, MEMORY_TAG_FILE);
+    Hfree(compressed, archive_compress_bound(size), MEMORY_TAG_FILE);
+    Hfree(dest, size, MEMORY_TAG_FILE);
+    return success;
+}
+
+u8 archive_benchmark_raw_vs_compressed_load() {
+    u64 memory_requirement = 0;
+    job_system_initialize(&memory_requirement, 0, 0);
+    void* job_state = Hallocate(memory_requirement, MEMORY_TAG_JOB);
+    expect_to_be_true(job_system_initialize(&memory_requirement, job_state, 0));
+
+    b8 success = benchmark_load("Shader", generate_shader_data) && benchmark_load("Mesh", generate_mesh_data);
+
+    job_system_shutdown(job_state);
+    Hfree(job_state, memory_requirement, MEMORY_TAG_JOB);
+    expect_to_be_true(success);
+    return true;
+}
+
+void archive_register_tests() {
+    test_manager_register_test(compression_should_round_trip_blocks, "Compression should round trip blocks");
+    test_manager_register_test(archive_should_round_trip_chunked_data, "Archive should round trip chunked data");
+    test_manager_register_test(archive_should_reject_corrupted_entries, "Archive should reject corrupted entries");
+    test_manager_register_test(archive_should_decompress_from_several_threads, "Archive should decompress from several threads");
+    test_manager_register_benchmark(archive_benchmark_raw_vs_compressed_load, "Archive benchmark raw vs compressed load");
+}
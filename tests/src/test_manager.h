@@ -14,8 +14,13 @@ void test_manager_init();
 
 void test_manager_register_test(PFN_test, char* desc);
 
+// Benchmarks only run when asked for, see test_manager_run_benchmarks.
+void test_manager_register_benchmark(PFN_test, char* desc);
+
 void test_manager_run_tests();
 
+void test_manager_run_benchmarks();
+
 #ifdef __cplusplus
 } 
 #endif
\ No newline at end of file
@@ -0,0 +1,466 @@
+#include "hstring_tests.h"
+
+#include "../test_manager.h"
+#include "../expects.h"
+
+#include <defines.h>
+#include <core/cpu.h>
+#include <core/hclock.h>
+#include <core/logger.h>
+#include <memory/hmemory.h>
+#include <memory/linear_allocator.h>
+#include <utils/hstring.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_TEXT_SIZE (64 * 1024 * 1024)
+#define BENCHMARK_NUMBER_COUNT 1000000
+
+// Feature masks every vectorized path is checked and benchmarked with.
+static const u32 feature_masks[3] = {0, CPU_FEATURE_SSE2, 0xFFFFFFFF};
+static const char* feature_names[3] = {"scalar", "SSE2", "AVX2"};
+
+// Small deterministic generator, test data must not depend on rand().
+static u32 next_random(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// Reference implementations the vectorized paths are checked against.
+static i64 reference_find(const char* data, u64 length, const char* needle, u64 needle_length) {
+    for (u64 i = 0; i + needle_length <= length; ++i) {
+        if (memcmp(data + i, needle, needle_length) == 0) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+static i64 reference_find_any(const char* data, u64 length, const char* set, u64 set_length) {
+    for (u64 i = 0; i < length; ++i) {
+        if (memchr(set, data[i], set_length)) {
+            return (i64)i;
+        }
+    }
+    return -1;
+}
+
+u8 string_search_should_match_reference() {
+    char text[300];
+    char upper[300];
+    u32 random = 99;
+    for (u32 m = 0; m < 3; ++m) {
+        cpu_set_feature_mask(feature_masks[m]);
+        for (u64 length = 0; length < sizeof(text); length += 1 + length / 8) {
+            // A small alphabet, so needles of a few characters have partial matches all over the place.
+            for (u64 i = 0; i < length; ++i) {
+                text[i] = "abcdA\xE1 ,"[next_random(&random) % 8];
+            }
+            stringView str = {text, length};
+
+            for (u32 round = 0; round < 8; ++round) {
+                char c = "abcdxA\xE1,"[round];
+                expect_should_be(reference_find(text, length, &c, 1), string_find_char(str, c));
+
+                // Needles taken from the text, and made up ones.
+                u64 needle_length = 2 + next_random(&random) % 5;
+                char needle[8];
+                if (length >= needle_length && round % 2 == 0) {
+                    memcpy(needle, text + next_random(&random) % (length - needle_length + 1), needle_length);
+                } else {
+                    for (u64 i = 0; i < needle_length; ++i) {
+                        needle[i] = "abcd"[next_random(&random) % 4];
+                    }
+                }
+                stringView needle_view = {needle, needle_length};
+                expect_should_be(reference_find(text, length, needle, needle_length), string_find(str, needle_view));
+
+                // Small sets go through vector compares, big ones through a lookup table.
+                const char* sets[3] = {" ,", "xyz,\xE1", "0123456789xyzA"};
+                stringView set = string_view(sets[round % 3]);
+                expect_should_be(reference_find_any(text, length, set.data, set.length), string_find_any(str, set));
+            }
+
+            // Case-insensitive compare against an uppercased copy, then with one character changed.
+            for (u64 i = 0; i < length; ++i) {
+                upper[i] = (text[i] >= 'a' && text[i] <= 'z') ? text[i] - 32 : text[i];
+            }
+            stringView upper_view = {upper, length};
+            expect_to_be_true(string_views_equali(str, upper_view));
+            if (length > 0) {
+                u64 changed = next_random(&random) % length;
+                upper[changed] = upper[changed] == 'Z' ? 'Y' : 'Z';
+                expect_to_be_false(string_views_equali(str, upper_view));
+            }
+        }
+    }
+    cpu_set_feature_mask(0xFFFFFFFF);
+
+    expect_should_be(0, string_find(string_view("abc"), string_view("")));
+    expect_should_be(-1, string_find(string_view("ab"), string_view("abc")));
+    expect_to_be_true(strings_equali("Hazker Engine", "hAZKER eNGINE"));
+    expect_to_be_false(strings_equali("Hazker", "Hazker "));
+    // Only ASCII letters fold, '@' and '`' sit right next to them.
+    expect_to_be_false(strings_equali("@", "`"));
+    return true;
+}
+
+u8 string_should_split_and_trim() {
+    stringView remaining = string_view("v  1.0 -2.5\t3\n");
+    stringView whitespace = string_view(" \t\n");
+    stringView token;
+    const char* expected[4] = {"v", "1.0", "-2.5", "3"};
+    for (u32 i = 0; i < 4; ++i) {
+        expect_to_be_true(string_split_next(&remaining, whitespace, true, &token));
+        expect_to_be_true(string_views_equal(string_view(expected[i]), token));
+    }
+    expect_to_be_false(string_split_next(&remaining, whitespace, true, &token));
+
+    // Without skipping, every delimiter ends a token.
+    remaining = string_view("a,,b,");
+    const char* fields[4] = {"a", "", "b", ""};
+    for (u32 i = 0; i < 4; ++i) {
+        expect_to_be_true(string_split_next(&remaining, string_view(","), false, &token));
+        expect_to_be_true(string_views_equal(string_view(fields[i]), token));
+    }
+    expect_to_be_false(string_split_next(&remaining, string_view(","), false, &token));
+
+    expect_to_be_true(string_views_equal(string_view("key = value"), string_trim(string_view(" \t key = value\r\n"))));
+    expect_should_be(0, string_trim(string_view(" \t\r\n")).length);
+    return true;
+}
+
+u8 string_should_parse_numbers() {
+    i64 integer = 0;
+    expect_to_be_true(string_parse_i64(string_view("0"), &integer));
+    expect_should_be(0, integer);
+    expect_to_be_true(string_parse_i64(string_view("+1234567890123"), &integer));
+    expect_should_be(1234567890123ll, integer);
+    expect_to_be_true(string_parse_i64(string_view("-9223372036854775808"), &integer));
+    expect_to_be_true(integer == (-9223372036854775807ll - 1));
+    expect_to_be_true(string_parse_i64(string_view("00000000000000000000042"), &integer));
+    expect_should_be(42, integer);
+    expect_to_be_false(string_parse_i64(string_view("9223372036854775808"), &integer));
+    expect_to_be_false(string_parse_i64(string_view("99999999999999999999"), &integer));
+    expect_to_be_false(string_parse_i64(string_view(""), &integer));
+    expect_to_be_false(string_parse_i64(string_view("-"), &integer));
+    expect_to_be_false(string_parse_i64(string_view("12a"), &integer));
+    expect_to_be_false(string_parse_i64(string_view(" 12"), &integer));
+
+    // Results must be bit for bit what the C runtime produces.
+    const char* numbers[] = {
+        "0", "-0", "1", "1.5", "-2.25", ".5", "5.", "3.14159265358979", "1e10", "1E-5", "+7e+2",
+        "0.1", "0.000001234", "123456789012345678", "12345678901234567890123", "1e-30", "1.7976931348623157e308",
+        "4.9e-324", "1e400", "0.30000000000000004", "1234.5678e-3", "00012.50", "inf", "-Infinity", "nan"};
+    for (u32 i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+        f64 value;
+        expect_to_be_true(string_parse_f64(string_view(numbers[i]), &value));
+        f64 reference = strtod(numbers[i], 0);
+        if (reference == reference) {
+            expect_to_be_true(memcmp(&value, &reference, sizeof(f64)) == 0);
+        } else {
+            expect_to_be_true(value != value);
+        }
+    }
+
+    u32 random = 5;
+    char text[64];
+    for (u32 i = 0; i < 100000; ++i) {
+        i32 exponent = (i32)(next_random(&random) % 40) - 20;
+        string_format_n(text, sizeof(text), "%u.%ue%d", next_random(&random) % 100000, next_random(&random), exponent);
+        f64 value;
+        expect_to_be_true(string_parse_f64(string_view(text), &value));
+        f64 reference = strtod(text, 0);
+        expect_to_be_true(memcmp(&value, &reference, sizeof(f64)) == 0);
+    }
+
+    const char* invalid[] = {"", "-", ".", "e5", "1e", "1e+", "1.2.3", "1,5", " 1", "0x10", "--1"};
+    for (u32 i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        f64 value;
+        expect_to_be_false(string_parse_f64(string_view(invalid[i]), &value));
+    }
+
+    f32 single;
+    expect_to_be_true(string_parse_f32(string_view("-0.75"), &single));
+    expect_float_to_be(-0.75f, single);
+    return true;
+}
+
+u8 string_builder_should_grow() {
+    // Heap backed, formatting past the initial capacity.
+    stringBuilder builder;
+    string_builder_create(4, 0, &builder);
+    expect_to_be_true(string_builder_append(&builder, string_view("Memory: ")));
+    expect_to_be_true(string_builder_append_format(&builder, "%d tags, %s", 42, "a longer formatted tail to force a retry"));
+    expect_to_be_true(string_builder_append_char(&builder, '!'));
+    expect_to_be_true(strings_equal("Memory: 42 tags, a longer formatted tail to force a retry!", builder.data));
+    expect_should_be(string_length(builder.data), builder.length);
+    string_builder_clear(&builder);
+    expect_should_be(0, builder.length);
+    expect_to_be_true(strings_equal("", builder.data));
+    string_builder_destroy(&builder);
+
+    // Arena backed: grows in place while on top, moves once something else was allocated after it.
+    linear_allocator arena;
+    create_linear_allocator(1024, 0, &arena);
+    string_builder_create(8, &arena, &builder);
+    const char* start = builder.data;
+    char block[101] = {0};
+    HsetMemory(block, 'a', 100);
+    expect_to_be_true(string_builder_append(&builder, string_view(block)));
+    expect_to_be_true(builder.data == start);
+    expect_to_be_true(builder.capacity > 100);
+
+    allocate_linear_allocator(&arena, 16);
+    HsetMemory(block, 'b', 100);
+    expect_to_be_true(string_builder_append(&builder, string_view(block)));
+    expect_to_be_false(builder.data == start);
+    expect_should_be(200, string_length(builder.data));
+    expect_should_be('a', builder.data[99]);
+    expect_should_be('b', builder.data[100]);
+
+    // Running out of arena leaves the text as it was.
+    char big[1024] = {0};
+    HsetMemory(big, 'x', sizeof(big) - 1);
+    HDEBUG("Note: The following error is intentionally caused by this test.");
+    expect_to_be_false(string_builder_append(&builder, string_view(big)));
+    expect_should_be(200, builder.length);
+    expect_should_be(0, builder.data[200]);
+
+    string_builder_destroy(&builder);
+    destroy_linear_allocator(&arena);
+    return true;
+}
+
+// Logs the throughput of searching a large text on every path, and of parsing numbers against the C runtime.
+// Checks a string_write_f64 result against what printf makes of the same value.
+static b8 fixed_matches_printf(f64 value, u32 precision) {
+    char expected[512];
+    char actual[512];
+    snprintf(expected, sizeof(expected), "%.*f", (int)precision, value);
+    u32 length = string_write_f64(actual, sizeof(actual), value, precision);
+    if (length != strlen(expected) || strcmp(expected, actual) != 0) {
+        HERROR("%.17g with precision %u: expected '%s', got '%s'", value, precision, expected, actual);
+        return false;
+    }
+    return true;
+}
+
+u8 string_write_should_match_printf() {
+    char expected[64];
+    char actual[STRING_NUMBER_BUFFER_SIZE];
+    const u64 integers[] = {0, 1, 9, 10, 99, 100, 12345, 4294967295ull, 10000000000000000000ull, 18446744073709551615ull};
+    for (u32 i = 0; i < sizeof(integers) / sizeof(u64); ++i) {
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)integers[i]);
+        expect_should_be(strlen(expected), string_write_u64(actual, integers[i]));
+        expect_to_be_true(strings_equal(expected, actual));
+    }
+    const i64 signed_integers[] = {0, -1, 42, -9876543210ll, (i64)0x8000000000000000ull, 0x7FFFFFFFFFFFFFFFll};
+    for (u32 i = 0; i < sizeof(signed_integers) / sizeof(i64); ++i) {
+        snprintf(expected, sizeof(expected), "%lld", (long long)signed_integers[i]);
+        expect_should_be(strlen(expected), string_write_i64(actual, signed_integers[i]));
+        expect_to_be_true(strings_equal(expected, actual));
+    }
+
+    // Ties are rounded to even on the exact binary value, like printf does.
+    const f64 values[] = {0.0, -0.0, 0.5, 1.5, 2.5, 0.125, 0.375, 1.005, 2.675, -0.001, 123456.789, 1e15, 1e300, -1e30};
+    for (u32 i = 0; i < sizeof(values) / sizeof(f64); ++i) {
+        for (u32 precision = 0; precision < 8; ++precision) {
+            expect_to_be_true(fixed_matches_printf(values[i], precision));
+        }
+    }
+    u32 random = 31;
+    for (u32 i = 0; i < 100000; ++i) {
+        // Decimal values with a few digits land on or near ties, random bits cover every magnitude.
+        u32 precision = next_random(&random) % 7;
+        f64 decimal = (f64)(i32)next_random(&random) / (f64)(1 + next_random(&random) % 10000);
+        expect_to_be_true(fixed_matches_printf(decimal, precision));
+        u64 bits = ((u64)next_random(&random) << 32) | next_random(&random);
+        f64 value;
+        memcpy(&value, &bits, sizeof(f64));
+        expect_to_be_true(fixed_matches_printf(value, precision));
+    }
+
+    // Too small a buffer.
+    expect_should_be(0, string_write_f64(actual, 4, 123.45, 2));
+
+    expect_should_be(8, string_write_bytes(actual, 1000));
+    expect_to_be_true(strings_equal("1000.00B", actual));
+    string_write_bytes(actual, 1536);
+    expect_to_be_true(strings_equal("1.50KiB", actual));
+    string_write_bytes(actual, 3ull * 1024 * 1024 * 1024);
+    expect_to_be_true(strings_equal("3.00GiB", actual));
+    string_write_bytes(actual, 0xFFFFFFFFFFFFFFFFull);
+    expect_to_be_true(strings_equal("17179869184.00GiB", actual));
+    return true;
+}
+
+u8 string_benchmark_search_and_parse() {
+    u64 size = BENCHMARK_TEXT_SIZE;
+    char* text = Hallocate(size, MEMORY_TAG_STRING);
+    u32 random = 17;
+    for (u64 i = 0; i < size; ++i) {
+        // Words and spaces, without the characters searched for.
+        text[i] = (next_random(&random) % 6 == 0) ? ' ' : (char)('a' + next_random(&random) % 20);
+    }
+    stringView str = {text, size};
+    f64 megabytes = (f64)size / (1024.0 * 1024.0);
+    hclock clock;
+
+    startClock(&clock);
+    const void* found = memchr(text, '#', size);
+    updateClock(&clock);
+    expect_to_be_true(found == 0);
+    HINFO("memchr: %.0f MB/s", megabytes / clock.elapsed);
+
+    const u32 required_features[3] = {0, CPU_FEATURE_SSE2, CPU_FEATURE_AVX2};
+    for (u32 m = 0; m < 3; ++m) {
+        if ((cpu_get_features() & required_features[m]) != required_features[m]) {
+            continue;
+        }
+        cpu_set_feature_mask(feature_masks[m]);
+
+        startClock(&clock);
+        i64 char_index = string_find_char(str, '#');
+        updateClock(&clock);
+        f64 char_time = clock.elapsed;
+
+        startClock(&clock);
+        i64 find_index = string_find(str, string_view("xyz#"));
+        updateClock(&clock);
+        f64 find_time = clock.elapsed;
+
+        startClock(&clock);
+        i64 any_index = string_find_any(str, string_view("#;\n\t"));
+        updateClock(&clock);
+        f64 any_time = clock.elapsed;
+
+        expect_should_be(-1, char_index);
+        expect_should_be(-1, find_index);
+        expect_should_be(-1, any_index);
+        HINFO("%s: find_char %.0f MB/s, find %.0f MB/s, find_any %.0f MB/s",
+              feature_names[m], megabytes / char_time, megabytes / find_time, megabytes / any_time);
+        cpu_set_feature_mask(0xFFFFFFFF);
+    }
+    Hfree(text, size, MEMORY_TAG_STRING);
+
+    // Number parsing, on the kind of values found in OBJ and material files.
+    char* numbers = Hallocate(BENCHMARK_NUMBER_COUNT * 16, MEMORY_TAG_STRING);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        string_format_n(numbers + i * 16, 16, "%.6f", (f64)(next_random(&random) % 2000000) / 1000.0 - 1000.0);
+    }
+
+    f64 sum = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        sum += strtod(numbers + i * 16, 0);
+    }
+    updateClock(&clock);
+    f64 strtod_time = clock.elapsed;
+
+    f64 parsed_sum = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        f64 value = 0;
+        string_parse_f64(string_view(numbers + i * 16), &value);
+        parsed_sum += value;
+    }
+    updateClock(&clock);
+    f64 parse_time = clock.elapsed;
+    Hfree(numbers, BENCHMARK_NUMBER_COUNT * 16, MEMORY_TAG_STRING);
+
+    expect_to_be_true(sum == parsed_sum);
+    HINFO("%u floats: strtod %.2f ms, string_parse_f64 %.2f ms (%.1fx).",
+          BENCHMARK_NUMBER_COUNT, strtod_time * 1000.0, parse_time * 1000.0, strtod_time / parse_time);
+    return true;
+}
+
+// Writes the same numbers with snprintf and with the string_write functions.
+u8 string_write_benchmark_vs_snprintf() {
+    u64* integers = Hallocate(sizeof(u64) * BENCHMARK_NUMBER_COUNT, MEMORY_TAG_ARRAY);
+    f64* floats = Hallocate(sizeof(f64) * BENCHMARK_NUMBER_COUNT, MEMORY_TAG_ARRAY);
+    u32 random = 23;
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        // Sizes and counts like the ones stats and logs print.
+        integers[i] = ((u64)next_random(&random) << 32 | next_random(&random)) >> (next_random(&random) % 64);
+        floats[i] = (f64)next_random(&random) / 1000.0;
+    }
+
+    char buffer[STRING_NUMBER_BUFFER_SIZE];
+    hclock clock;
+    u64 printf_length = 0;
+    u64 write_length = 0;
+
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        printf_length += snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)integers[i]);
+    }
+    updateClock(&clock);
+    f64 printf_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        write_length += string_write_u64(buffer, integers[i]);
+    }
+    updateClock(&clock);
+    expect_should_be(printf_length, write_length);
+    HINFO("%u integers: snprintf %.2f ms, string_write_u64 %.2f ms (%.1fx).",
+          BENCHMARK_NUMBER_COUNT, printf_time * 1000.0, clock.elapsed * 1000.0, printf_time / clock.elapsed);
+
+    printf_length = write_length = 0;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        printf_length += snprintf(buffer, sizeof(buffer), "%.2f", floats[i]);
+    }
+    updateClock(&clock);
+    printf_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        write_length += string_write_f64(buffer, sizeof(buffer), floats[i], 2);
+    }
+    updateClock(&clock);
+    expect_should_be(printf_length, write_length);
+    HINFO("%u floats: snprintf %.2f ms, string_write_f64 %.2f ms (%.1fx).",
+          BENCHMARK_NUMBER_COUNT, printf_time * 1000.0, clock.elapsed * 1000.0, printf_time / clock.elapsed);
+
+    // A memory usage report line, the way GetMemoryUsage_str used to put it together and the way it does now.
+    stringBuilder builder;
+    string_builder_create(0, 0, &builder);
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        string_builder_clear(&builder);
+        string_builder_append_format(&builder, "  %s: %.2f%s\n", "TEXTURE    ", (f64)(integers[i] >> 40) / 1024.0, "KiB");
+    }
+    updateClock(&clock);
+    printf_time = clock.elapsed;
+    startClock(&clock);
+    for (u32 i = 0; i < BENCHMARK_NUMBER_COUNT; ++i) {
+        string_builder_clear(&builder);
+        string_builder_append(&builder, string_view("  "));
+        string_builder_append(&builder, string_view("TEXTURE    "));
+        string_builder_append(&builder, string_view(": "));
+        string_builder_append_bytes(&builder, integers[i] >> 40);
+        string_builder_append_char(&builder, '\n');
+    }
+    updateClock(&clock);
+    string_builder_destroy(&builder);
+    HINFO("%u report lines: append_format %.2f ms, append_bytes %.2f ms (%.1fx).",
+          BENCHMARK_NUMBER_COUNT, printf_time * 1000.0, clock.elapsed * 1000.0, printf_time / clock.elapsed);
+
+    Hfree(integers, sizeof(u64) * BENCHMARK_NUMBER_COUNT, MEMORY_TAG_ARRAY);
+    Hfree(floats, sizeof(f64) * BENCHMARK_NUMBER_COUNT, MEMORY_TAG_ARRAY);
+    return true;
+}
+
+void hstring_register_tests() {
+    test_manager_register_test(string_search_should_match_reference, "String search should match reference");
+    test_manager_register_test(string_should_split_and_trim, "String should split and trim");
+    test_manager_register_test(string_should_parse_numbers, "String should parse numbers");
+    test_manager_register_test(string_builder_should_grow, "String builder should grow");
+    test_manager_register_benchmark(string_benchmark_search_and_parse, "String benchmark search and parse");
+    test_manager_register_test(string_write_should_match_printf, "String write should match printf");
+    test_manager_register_benchmark(string_write_benchmark_vs_snprintf, "String write benchmark vs snprintf");
+}